@@ -3,7 +3,7 @@
 MACRO(MULA_UNIT_TESTS libraries modulename)
     FOREACH(testname ${ARGN})
         add_executable("${modulename}-${testname}" ${testname}.cpp)
-        target_link_libraries("${modulename}-${testname}" ${libraries} ${QT_QTTEST_LIBRARY})
+        target_link_libraries("${modulename}-${testname}" ${libraries} ${Qt5Test_LIBRARIES})
         add_test("${modulename}-${testname}" ${modulename}-${testname})
         if(WINCE)
             target_link_libraries("${modulename}-${testname}" ${WCECOMPAT_LIBRARIES})
@@ -11,10 +11,10 @@ MACRO(MULA_UNIT_TESTS libraries modulename)
     ENDFOREACH(testname)
 ENDMACRO(MULA_UNIT_TESTS)
 
-MACRO(MULA_EXECUTABLE_TESTS libraries modulename1)
+MACRO(MULA_EXECUTABLE_TESTS libraries modulename)
     FOREACH(testname ${ARGN})
         add_executable("${modulename}-${testname}" ${testname}.cpp)
-        target_link_libraries("${modulename}-${testname}" ${libraries} ${QT_QTTEST_LIBRARY})
+        target_link_libraries("${modulename}-${testname}" ${libraries} ${Qt5Test_LIBRARIES})
         if(WINCE)
             target_link_libraries("${modulename}-${testname}" ${WCECOMPAT_LIBRARIES})
         endif(WINCE)
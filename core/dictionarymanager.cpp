@@ -23,17 +23,120 @@
 
 #include <QtCore/QFileInfoList>
 #include <QtCore/QDir>
+#include <QtCore/QAtomicInt>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QHash>
+#include <QtCore/QRunnable>
+#include <QtCore/QSemaphore>
 #include <QtCore/QSettings>
+#include <QtCore/QSharedPointer>
 #include <QtCore/QPluginLoader>
+#include <QtCore/QThreadPool>
+#include <QtCore/QtAlgorithms>
+#include <QtCore/QDebug>
 
 using namespace MulaCore;
 
+// Looks up the similar words of a word in one dictionary, either in the
+// thread pool or directly in the calling thread, and signals the semaphore of
+// the query when done
+class SimilarWordsJob : public QRunnable
+{
+    public:
+        SimilarWordsJob(DictionaryPlugin *dictionaryPlugin, const QString &dictionary, const QString &word,
+                        QSemaphore *semaphore)
+            : m_dictionaryPlugin(dictionaryPlugin)
+            , m_dictionary(dictionary)
+            , m_word(word)
+            , m_semaphore(semaphore)
+        {
+            setAutoDelete(false);
+        }
+
+        void run()
+        {
+            m_similarWords = m_dictionaryPlugin->findScoredSimilarWords(m_dictionary, m_word);
+            m_semaphore->release();
+        }
+
+        QList<SimilarWord> similarWords() const
+        {
+            return m_similarWords;
+        }
+
+    private:
+        DictionaryPlugin *m_dictionaryPlugin;
+        QString m_dictionary;
+        QString m_word;
+        QSemaphore *m_semaphore;
+        QList<SimilarWord> m_similarWords;
+};
+
+// The translation of a word in one dictionary, shared with the job that
+// produces it, so the query can give up on the job at its deadline
+class TranslationResult
+{
+    public:
+        TranslationResult()
+            : translated(false)
+        {
+        }
+
+        QAtomicInt finished;
+        QAtomicInt cancelled;
+        bool translated;
+        Translation translation;
+};
+
+// Translates a word in one dictionary, either in the thread pool or directly
+// in the calling thread, and signals the semaphore of the query when done
+class TranslationJob : public QRunnable
+{
+    public:
+        TranslationJob(DictionaryPlugin *dictionaryPlugin, const QString &dictionary, const QString &word,
+                       const QSharedPointer<TranslationResult> &result, const QSharedPointer<QSemaphore> &semaphore)
+            : m_dictionaryPlugin(dictionaryPlugin)
+            , m_dictionary(dictionary)
+            , m_word(word)
+            , m_result(result)
+            , m_semaphore(semaphore)
+        {
+        }
+
+        void run()
+        {
+            // A job started after the deadline of its query is not needed
+            if (!m_result->cancelled.loadAcquire() && m_dictionaryPlugin->isTranslatable(m_dictionary, m_word))
+            {
+                m_result->translation = m_dictionaryPlugin->translate(m_dictionary, m_word);
+                m_result->translated = true;
+            }
+
+            m_result->finished.storeRelease(1);
+            m_semaphore->release();
+        }
+
+    private:
+        DictionaryPlugin *m_dictionaryPlugin;
+        QString m_dictionary;
+        QString m_word;
+        QSharedPointer<TranslationResult> m_result;
+        QSharedPointer<QSemaphore> m_semaphore;
+};
+
+static bool
+similarWordLessThan(const SimilarWord &left, const SimilarWord &right)
+{
+    return left.distance() < right.distance();
+}
+
 MULA_DEFINE_SINGLETON( DictionaryManager )
 
 class DictionaryManager::Private
 {
     public:
         Private()
+            : translationTimeout(defaultTranslationTimeout)
         {
         }
 
@@ -41,9 +144,42 @@ class DictionaryManager::Private
         {
         }
 
+        QList<QPair<QString, QString> > orderedDictionaryList() const;
+
         QMultiHash<QString, QString> loadedDictionaryList;
+        QList<QPair<QString, QString> > dictionaryPriorityList;
+        int translationTimeout;
+        QThreadPool threadPool;
+        QHash<QPair<QString, QString>, QSharedPointer<TranslationResult> > lateTranslations;
+
+        static const int defaultTranslationTimeout = 2000;
+
+        static const int maximumSimilarWords = 24;
 };
 
+// Returns the loaded dictionaries, the ones of the priority list first
+QList<QPair<QString, QString> >
+DictionaryManager::Private::orderedDictionaryList() const
+{
+    QList<QPair<QString, QString> > dictionaries;
+    QMultiHash<QString, QString> remainingDictionaries = loadedDictionaryList;
+
+    typedef QPair<QString, QString> Dictionary;
+    foreach (const Dictionary& dictionary, dictionaryPriorityList)
+    {
+        if (remainingDictionaries.remove(dictionary.first, dictionary.second) > 0)
+            dictionaries.append(dictionary);
+    }
+
+    for (QMultiHash<QString, QString>::const_iterator i = loadedDictionaryList.begin(); i != loadedDictionaryList.end(); ++i)
+    {
+        if (remainingDictionaries.contains(i.key(), i.value()))
+            dictionaries.append(qMakePair(i.key(), i.value()));
+    }
+
+    return dictionaries;
+}
+
 DictionaryManager::DictionaryManager(QObject *parent)
     : MulaCore::Singleton< MulaCore::DictionaryManager >( parent )
     , d(new Private)
@@ -75,19 +211,86 @@ DictionaryManager::isTranslatable(const QString &word)
 QString
 DictionaryManager::translate(const QString &word)
 {
-    QString simplifiedWord = word.simplified();
-    QString translatedWord;
+    QElapsedTimer timer;
+    timer.start();
 
-    for (QMultiHash<QString, QString>::const_iterator i = d->loadedDictionaryList.begin(); i != d->loadedDictionaryList.end(); ++i)
+    QString simplifiedWord = word.simplified();
+    QSharedPointer<QSemaphore> semaphore(new QSemaphore);
+    QList<QSharedPointer<TranslationResult> > results;
+    QList<QPair<QString, QString> > translatedDictionaries;
+    QList<TranslationJob *> sequentialJobs;
+    int concurrentJobCount = 0;
+
+    typedef QPair<QString, QString> Dictionary;
+    foreach (const Dictionary& dictionary, d->orderedDictionaryList())
     {
-        MulaCore::DictionaryPlugin* dictionaryPlugin = MulaCore::PluginManager::instance()->plugin(i.key());
+        MulaCore::DictionaryPlugin* dictionaryPlugin = MulaCore::PluginManager::instance()->plugin(dictionary.first);
         if (!dictionaryPlugin)
             continue;
 
-        if (!dictionaryPlugin->isTranslatable(i.key(), simplifiedWord))
+        // A dictionary still busy with a query given up at its deadline is
+        // left out, so the late translations do not pile up in the pool
+        QSharedPointer<TranslationResult> lateResult = d->lateTranslations.value(dictionary);
+        if (lateResult)
+        {
+            if (!lateResult->finished.loadAcquire())
+                continue;
+
+            d->lateTranslations.remove(dictionary);
+        }
+
+        QSharedPointer<TranslationResult> result(new TranslationResult);
+        results.append(result);
+        translatedDictionaries.append(dictionary);
+
+        TranslationJob *job = new TranslationJob(dictionaryPlugin, dictionary.second, simplifiedWord, result, semaphore);
+
+        // The pool deletes the job when done, a late one outlives the query
+        if (dictionaryPlugin->features().testFlag(DictionaryPlugin::ConcurrentQueries))
+        {
+            d->threadPool.start(job);
+            ++concurrentJobCount;
+        }
+        else
+        {
+            sequentialJobs.append(job);
+        }
+    }
+
+    // The other plugins are queried in this thread meanwhile
+    foreach (TranslationJob *job, sequentialJobs)
+    {
+        job->run();
+        delete job;
+    }
+
+    int timeout = d->translationTimeout;
+    if (timeout >= 0)
+        timeout = qMax(0, timeout - int(timer.elapsed()));
+
+    if (!semaphore->tryAcquire(concurrentJobCount + sequentialJobs.size(), timeout))
+    {
+        qDebug() << "Not all the dictionaries translated" << simplifiedWord << "in" << d->translationTimeout << "ms";
+
+        for (int i = 0; i < results.size(); ++i)
+        {
+            const QSharedPointer<TranslationResult>& result = results.at(i);
+            if (result->finished.loadAcquire())
+                continue;
+
+            result->cancelled.storeRelease(1);
+            d->lateTranslations.insert(translatedDictionaries.at(i), result);
+        }
+    }
+
+    // Gather the translations in the order of the dictionaries
+    QString translatedWord;
+    foreach (const QSharedPointer<TranslationResult>& result, results)
+    {
+        if (!result->finished.loadAcquire() || !result->translated)
             continue;
 
-        MulaCore::Translation translation = dictionaryPlugin->translate(i.key(), simplifiedWord);
+        const MulaCore::Translation& translation = result->translation;
         translatedWord.append(QString("<p>\n")
             + "<font class=\"dict_name\">" + translation.dictionaryName() + "</font><br>\n"
             + "<font class=\"title\">" + translation.title() + "</font><br>\n"
@@ -97,11 +300,47 @@ DictionaryManager::translate(const QString &word)
     return translatedWord;
 }
 
+void
+DictionaryManager::setDictionaryPriorityList(const QList<QPair<QString, QString> > &dictionaryPriorityList)
+{
+    d->dictionaryPriorityList = dictionaryPriorityList;
+}
+
+QList<QPair<QString, QString> >
+DictionaryManager::dictionaryPriorityList() const
+{
+    return d->dictionaryPriorityList;
+}
+
+void
+DictionaryManager::setTranslationTimeout(int msecs)
+{
+    d->translationTimeout = msecs;
+}
+
+int
+DictionaryManager::translationTimeout() const
+{
+    return d->translationTimeout;
+}
+
 QStringList
 DictionaryManager::findSimilarWords(const QString &word)
 {
-    QString simplifiedWord = word.simplified();
     QStringList similarWords;
+    foreach (const SimilarWord& similarWord, findScoredSimilarWords(word))
+        similarWords.append(similarWord.word());
+
+    return similarWords;
+}
+
+QList<SimilarWord>
+DictionaryManager::findScoredSimilarWords(const QString &word)
+{
+    QString simplifiedWord = word.simplified();
+    QSemaphore semaphore;
+    QList<SimilarWordsJob *> jobs;
+    QList<SimilarWordsJob *> sequentialJobs;
 
     for (QMultiHash<QString, QString>::const_iterator i = d->loadedDictionaryList.begin(); i != d->loadedDictionaryList.end(); ++i)
     {
@@ -112,14 +351,53 @@ DictionaryManager::findSimilarWords(const QString &word)
         if (!dictionaryPlugin->features().testFlag(DictionaryPlugin::SearchSimilar))
             continue;
 
-        QStringList similarWords = dictionaryPlugin->findSimilarWords(i.value(), simplifiedWord);
-        foreach (const QString& similarWord, similarWords)
+        SimilarWordsJob *job = new SimilarWordsJob(dictionaryPlugin, i.value(), simplifiedWord, &semaphore);
+        jobs.append(job);
+
+        if (dictionaryPlugin->features().testFlag(DictionaryPlugin::ConcurrentQueries))
+            d->threadPool.start(job);
+        else
+            sequentialJobs.append(job);
+    }
+
+    // The other plugins are queried in this thread meanwhile
+    foreach (SimilarWordsJob *job, sequentialJobs)
+        job->run();
+
+    // The translations given up at their deadline may still run in the
+    // pool, so only the jobs of this query are waited for
+    semaphore.acquire(jobs.size());
+
+    // Merge the suggestions in the order of the dictionaries, keeping the
+    // best distance of every word
+    QList<SimilarWord> similarWords;
+    QHash<QString, int> positions;
+
+    foreach (SimilarWordsJob *job, jobs)
+    {
+        foreach (const SimilarWord& similarWord, job->similarWords())
         {
-            if (!similarWords.contains(similarWord, Qt::CaseSensitive))
+            QHash<QString, int>::const_iterator it = positions.constFind(similarWord.word());
+            if (it == positions.constEnd())
+            {
+                positions.insert(similarWord.word(), similarWords.size());
                 similarWords.append(similarWord);
+            }
+            else if (similarWord.distance() < similarWords.at(it.value()).distance())
+            {
+                similarWords[it.value()].setDistance(similarWord.distance());
+            }
         }
     }
 
+    qDeleteAll(jobs);
+
+    // The stable sort keeps the order of the plugins for equal distances
+    qStableSort(similarWords.begin(), similarWords.end(), similarWordLessThan);
+
+    while (similarWords.size() > d->maximumSimilarWords)
+        similarWords.removeLast();
+
     return similarWords;
 }
 
@@ -131,6 +409,9 @@ DictionaryManager::availableDictionaryList() const
     foreach (const QString& pluginName, MulaCore::PluginManager::instance()->availablePlugins())
     {
         DictionaryPlugin *dictionaryPlugin = MulaCore::PluginManager::instance()->plugin(pluginName);
+        if (!dictionaryPlugin)
+            continue;
+
         QStringList dictionaries = dictionaryPlugin->availableDictionaryList();
         foreach (const QString& dictionaryName, dictionaries)
             availableDictionaryList.insert(pluginName, dictionaryName);
@@ -142,25 +423,24 @@ DictionaryManager::availableDictionaryList() const
 void
 DictionaryManager::setLoadedDictionaryList(const QMultiHash<QString, QString> &loadedDictionaryList)
 {
-    QMultiHash<QString, QString> dictionaries = loadedDictionaryList;
-
-    // TODO: Setting the same values in all plugins. Cache it later since it is
-    // an expensive operation to call it all the time
-    foreach (const QString& pluginName, dictionaries.keys())
+    // Every plugin gets its own dictionaries, and reports the ones it could
+    // load
+    QMultiHash<QString, QString> dictionaries;
+    foreach (const QString& pluginName, loadedDictionaryList.uniqueKeys())
     {
         MulaCore::DictionaryPlugin* dictionaryPlugin = MulaCore::PluginManager::instance()->plugin(pluginName);
         if (!dictionaryPlugin)
             continue;
 
-        dictionaryPlugin->setLoadedDictionaryList(dictionaries.values());
+        dictionaryPlugin->setLoadedDictionaryList(loadedDictionaryList.values(pluginName));
         foreach (const QString& dictionaryName, dictionaryPlugin->loadedDictionaryList())
-                dictionaries.insert(pluginName, dictionaryName);
+            dictionaries.insert(pluginName, dictionaryName);
     }
 
     d->loadedDictionaryList.clear();
     for (QMultiHash<QString, QString>::const_iterator i = loadedDictionaryList.begin(); i != loadedDictionaryList.end(); ++i)
     {
-        if (dictionaries.keys().contains(i.key()) && dictionaries.value(i.key()).contains(i.value()))
+        if (dictionaries.contains(i.key(), i.value()))
             d->loadedDictionaryList.insert(i.key(), i.value());
     }
 }
@@ -176,8 +456,19 @@ DictionaryManager::saveDictionarySettings()
         rawDictionaryList.append(i.value());
     }
 
+    QStringList rawPriorityList;
+
+    typedef QPair<QString, QString> Dictionary;
+    foreach (const Dictionary& dictionary, d->dictionaryPriorityList)
+    {
+        rawPriorityList.append(dictionary.first);
+        rawPriorityList.append(dictionary.second);
+    }
+
     QSettings settings;
     settings.setValue("DictionaryManager/loadedDictionaryList", rawDictionaryList);
+    settings.setValue("DictionaryManager/dictionaryPriorityList", rawPriorityList);
+    settings.setValue("DictionaryManager/translationTimeout", d->translationTimeout);
 }
 
 void
@@ -186,6 +477,13 @@ DictionaryManager::loadDictionarySettings()
     QSettings settings;
     QStringList rawDictionaryList = settings.value("DictionaryManager/loadedDictionaryList").toStringList();
 
+    QStringList rawPriorityList = settings.value("DictionaryManager/dictionaryPriorityList").toStringList();
+    d->dictionaryPriorityList.clear();
+    for (int i = 0; i + 1 < rawPriorityList.size(); i += 2)
+        d->dictionaryPriorityList.append(qMakePair(rawPriorityList.at(i), rawPriorityList.at(i + 1)));
+
+    d->translationTimeout = settings.value("DictionaryManager/translationTimeout", Private::defaultTranslationTimeout).toInt();
+
     if (rawDictionaryList.isEmpty())
     {
         setLoadedDictionaryList(availableDictionaryList());
@@ -207,6 +505,9 @@ DictionaryManager::reloadDictionaryList()
     foreach (const QString& pluginName, MulaCore::PluginManager::instance()->availablePlugins())
     {
         DictionaryPlugin *dictionaryPlugin = MulaCore::PluginManager::instance()->plugin(pluginName);
+        if (!dictionaryPlugin)
+            continue;
+
         dictionaryPlugin->setLoadedDictionaryList(dictionaryPlugin->loadedDictionaryList());
         QStringList dictionaries = dictionaryPlugin->availableDictionaryList();
         foreach (const QString& dictionaryName, dictionaryPlugin->loadedDictionaryList())
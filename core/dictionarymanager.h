@@ -23,12 +23,14 @@
 #include "dictionaryplugin.h"
 #include "singleton.h"
 
+#include <QtCore/QList>
+#include <QtCore/QPair>
 #include <QtCore/QStringList>
 #include <QtCore/QMultiHash>
 
 namespace MulaCore
 {
-    class DictionaryManager: public MulaCore::Singleton<DictionaryManager>
+    class MULA_CORE_EXPORT DictionaryManager: public MulaCore::Singleton<DictionaryManager>
     {
         Q_OBJECT
         MULA_SINGLETON( DictionaryManager )
@@ -46,12 +48,58 @@ namespace MulaCore
              * Returns translation for word. If word not found, returns
              * "Not found!"
              *
+             * The dictionaries are queried concurrently when their plugins
+             * support it, and the translations are listed in the order of
+             * the priority list. The translations that have not arrived by
+             * the timeout are left out, and so are the dictionaries still busy
+             * with such a late translation.
+             *
              * @param word The word for translation
              *
-             * @see isTranslatable
+             * @see isTranslatable, setDictionaryPriorityList,
+             * setTranslationTimeout
              */
             QString translate(const QString &word);
 
+            /**
+             * Sets the order of the dictionaries in the translations. The
+             * first item in pair is a plugin name and the second item is a
+             * dictionary name. The loaded dictionaries missing from the list
+             * follow the listed ones.
+             *
+             * @param dictionaryPriorityList The dictionaries in the order of
+             * their priority
+             *
+             * @see dictionaryPriorityList, translate
+             */
+            void setDictionaryPriorityList(const QList<QPair<QString, QString> > &dictionaryPriorityList);
+
+            /**
+             * Returns the order of the dictionaries in the translations
+             *
+             * @see setDictionaryPriorityList
+             */
+            QList<QPair<QString, QString> > dictionaryPriorityList() const;
+
+            /**
+             * Sets how long translate waits for the dictionaries. The
+             * dictionaries queried in the calling thread are always waited
+             * for.
+             *
+             * @param msecs The timeout in milliseconds, or -1 to wait for all
+             * the dictionaries
+             *
+             * @see translationTimeout, translate
+             */
+            void setTranslationTimeout(int msecs);
+
+            /**
+             * Returns how long translate waits for the dictionaries
+             *
+             * @see setTranslationTimeout
+             */
+            int translationTimeout() const;
+
             /**
              * Returns a list of similar words contained in dictionaries.
              *
@@ -61,6 +109,20 @@ namespace MulaCore
              */
             QStringList findSimilarWords(const QString &word);
 
+            /**
+             * Returns the best similar words contained in dictionaries with
+             * their distances. The dictionaries are queried concurrently when
+             * their plugins support it, and the suggestions are merged into
+             * one ranking without duplicates.
+             *
+             * @param word The word for translation
+             *
+             * @return List of similar words, ordered from the best suggestion
+             *
+             * @see findSimilarWords
+             */
+            QList<SimilarWord> findScoredSimilarWords(const QString &word);
+
             /**
              * Returns a list of available dictionaries.
              * The first item in pair is a plugin name and the second item
@@ -39,6 +39,16 @@ DictionaryPlugin::features() const
     return None;
 }
 
+QList<Translation>
+DictionaryPlugin::translateBatch(const QString &dictionary, const QStringList &words)
+{
+    QList<Translation> translations;
+    foreach (const QString& word, words)
+        translations.append(translate(dictionary, word));
+
+    return translations;
+}
+
 QStringList
 DictionaryPlugin::findSimilarWords(const QString &dictionary, const QString &word)
 {
@@ -46,6 +56,16 @@ DictionaryPlugin::findSimilarWords(const QString &dictionary, const QString &wor
     return QStringList(word);
 }
 
+QList<SimilarWord>
+DictionaryPlugin::findScoredSimilarWords(const QString &dictionary, const QString &word)
+{
+    QList<SimilarWord> similarWords;
+    foreach (const QString& similarWord, findSimilarWords(dictionary, word))
+        similarWords.append(SimilarWord(similarWord, SimilarWord::UnknownDistance));
+
+    return similarWords;
+}
+
 int
 DictionaryPlugin::execSettingsDialog(QWidget *parent)
 {
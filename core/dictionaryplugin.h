@@ -21,8 +21,10 @@
 #define MULA_CORE_DICTIONARYPLUGIN_H
 
 #include "dictionaryinfo.h"
+#include "similarword.h"
 #include "translation.h"
 
+#include <QtCore/QList>
 #include <QtCore/QtPlugin>
 #include <QtCore/QUrl>
 
@@ -54,6 +56,13 @@ namespace MulaCore
                  * Dictionary plugin has a settings dialog.
                  */
                 SettingsDialog,
+
+                /**
+                 * Dictionary plugin can be queried concurrently from several
+                 * threads, as long as the queries target different
+                 * dictionaries.
+                 */
+                ConcurrentQueries = 0x04,
             };
 
             Q_DECLARE_FLAGS(Features, Feature)
@@ -158,6 +167,24 @@ namespace MulaCore
              */
             virtual Translation translate(const QString &dictionary, const QString &word) = 0;
 
+            /**
+             * Returns the translations of many words from the dictionary.
+             * Plugins should reimplement it if they can resolve the words
+             * together cheaper than one by one.
+             *
+             * The default implementation calls translate for every word.
+             *
+             * @param dictionary The name of the dictionary
+             * @param words The words that are looked up in the desired
+             * dictionary
+             *
+             * @return The translations in the order of the given words, an
+             * empty translation for the words that are not found
+             *
+             * @see translate
+             */
+            virtual QList<Translation> translateBatch(const QString &dictionary, const QStringList &words);
+
             /**
              * Returns a list of similar words from all the loaded dictionaries.
              * It works only if SearchSimilar feature is enabled.
@@ -170,6 +197,27 @@ namespace MulaCore
              */
             virtual QStringList findSimilarWords(const QString &dictionary, const QString &word);
 
+            /**
+             * Returns a list of similar words from the dictionary with their
+             * distances from the looked up word. It works only if
+             * SearchSimilar feature is enabled.
+             *
+             * The default implementation returns the result of
+             * findSimilarWords with unknown distances. Plugins that can score
+             * their suggestions should reimplement it, so their suggestions
+             * can be ranked against the ones of the other dictionaries.
+             *
+             * @param dictionary The name of the desired dictionary
+             * @param word The word that is being looked up in the desired
+             * dictionary
+             *
+             * @return The similar words with their distances, ordered from the
+             * best suggestion
+             *
+             * @see findSimilarWords
+             */
+            virtual QList<SimilarWord> findScoredSimilarWords(const QString &dictionary, const QString &word);
+
             /**
              * Returns information about the dictionary. The dictionary may be
              * not loaded but can be available.
@@ -203,7 +251,9 @@ namespace MulaCore
     Q_DECLARE_OPERATORS_FOR_FLAGS(DictionaryPlugin::Features)
 }
 
-Q_DECLARE_INTERFACE(MulaCore::DictionaryPlugin, "org.mula.DictionaryPlugin/1.0")
+// The version follows the layout of the virtual methods, so the plugins built
+// against another layout are refused when loaded
+Q_DECLARE_INTERFACE(MulaCore::DictionaryPlugin, "org.mula.DictionaryPlugin/2.0")
 
 #endif // MULA_CORE_DICTIONARYPLUGIN_H
 
@@ -44,6 +44,7 @@ class PluginManager::Private
         }
 
         QHash<QString, QPluginLoader*> plugins;
+        QHash<QString, DictionaryPlugin*> registeredPlugins;
 };
 
 PluginManager::PluginManager(QObject *parent)
@@ -107,7 +108,7 @@ PluginManager::availablePlugins() const
 QStringList
 PluginManager::loadedPlugins() const
 {
-    return d->plugins.keys();
+    return d->plugins.keys() + d->registeredPlugins.keys();
 }
 
 void
@@ -162,14 +163,30 @@ PluginManager::setLoadedPlugins(const QStringList &loadedPlugins)
 DictionaryPlugin*
 PluginManager::plugin(const QString &pluginName)
 {
+    if (d->registeredPlugins.contains(pluginName))
+        return d->registeredPlugins.value(pluginName);
+
     return d->plugins.contains(pluginName) ? qobject_cast<DictionaryPlugin*>(d->plugins[pluginName]->instance()) : 0;
 }
 
+void
+PluginManager::registerPlugin(const QString &name, DictionaryPlugin *plugin)
+{
+    d->registeredPlugins.insert(name, plugin);
+}
+
+void
+PluginManager::unregisterPlugin(const QString &name)
+{
+    d->registeredPlugins.remove(name);
+}
+
 void
 PluginManager::savePluginSettings()
 {
+    // Only the plugin libraries can be loaded again
     QSettings settings;
-    settings.setValue("PluginManager/loadedPlugins", loadedPlugins());
+    settings.setValue("PluginManager/loadedPlugins", QStringList(d->plugins.keys()));
 }
 
 void
@@ -77,6 +77,29 @@ namespace MulaCore
              */
             DictionaryPlugin *plugin(const QString &plugin);
 
+            /**
+             * Registers a dictionary plugin that is linked into the
+             * application instead of being loaded from a library. The plugin
+             * is listed among the loaded plugins until it is unregistered,
+             * and it is not saved in the plugin settings. The caller keeps the
+             * ownership of the plugin.
+             *
+             * @param name Identifier of the plugin instance
+             * @param plugin The dictionary plugin instance
+             *
+             * @see unregisterPlugin, plugin
+             */
+            void registerPlugin(const QString &name, DictionaryPlugin *plugin);
+
+            /**
+             * Unregisters a dictionary plugin registered by registerPlugin
+             *
+             * @param name Identifier of the plugin instance
+             *
+             * @see registerPlugin
+             */
+            void unregisterPlugin(const QString &name);
+
             /**
              * Save the plugin settings
              *
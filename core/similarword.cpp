@@ -0,0 +1,93 @@
+/******************************************************************************
+ * This file is part of the Mula project
+ * Copyright (c) 2011 Laszlo Papp <lpapp@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "similarword.h"
+
+#include <QtCore/QString>
+
+using namespace MulaCore;
+
+class SimilarWord::Private
+{
+    public:
+        Private()
+            : distance(UnknownDistance)
+        {
+        }
+
+        ~Private()
+        {
+        }
+
+        QString word;
+        int distance;
+};
+
+SimilarWord::SimilarWord()
+    : d(new Private)
+{
+}
+
+SimilarWord::SimilarWord(const QString &word, int distance)
+    : d(new Private)
+{
+    d->word = word;
+    d->distance = distance;
+}
+
+SimilarWord::SimilarWord(const SimilarWord &other)
+    : d(new Private(*other.d))
+{
+}
+
+SimilarWord::~SimilarWord()
+{
+    delete d;
+}
+
+SimilarWord &
+SimilarWord::operator=(const SimilarWord &other)
+{
+    *d = *other.d;
+    return *this;
+}
+
+QString
+SimilarWord::word() const
+{
+    return d->word;
+}
+
+int
+SimilarWord::distance() const
+{
+    return d->distance;
+}
+
+void
+SimilarWord::setWord(const QString &word)
+{
+    d->word = word;
+}
+
+void
+SimilarWord::setDistance(int distance)
+{
+    d->distance = distance;
+}
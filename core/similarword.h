@@ -0,0 +1,113 @@
+/******************************************************************************
+ * This file is part of the Mula project
+ * Copyright (c) 2011 Laszlo Papp <lpapp@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef MULA_CORE_SIMILARWORD_H
+#define MULA_CORE_SIMILARWORD_H
+
+#include "mula_core_export.h"
+
+class QString;
+
+namespace MulaCore
+{
+    /**
+     * This class represents a similar word suggestion with its score.
+     */
+    class MULA_CORE_EXPORT SimilarWord
+    {
+        public:
+
+            /**
+             * The distance of the suggestions that are not scored by the
+             * dictionary plugin. They are ranked after all the scored ones.
+             */
+            static const int UnknownDistance = 0x7fff;
+
+            /**
+             * Construct an empty similar word
+             */
+            SimilarWord();
+
+            /**
+             * Construct a similar word from data
+             *
+             * @param word The similar word
+             * @param distance The distance from the looked up word
+             */
+            SimilarWord(const QString &word, int distance);
+
+            /**
+             * Copy constructor
+             */
+            SimilarWord(const SimilarWord &other);
+
+            /**
+             * Destructor
+             */
+            virtual ~SimilarWord();
+
+            /**
+             * Assignment operator
+             */
+            SimilarWord &operator=(const SimilarWord &other);
+
+            /**
+             * Returns the similar word
+             *
+             * @return The similar word
+             *
+             * @see setWord
+             */
+            QString word() const;
+
+            /**
+             * Returns the distance from the looked up word, e.g. the edit
+             * distance. The smaller distance means the better suggestion.
+             *
+             * @return The distance from the looked up word
+             *
+             * @see setDistance
+             */
+            int distance() const;
+
+            /**
+             * Sets the similar word
+             *
+             * @param word The similar word
+             *
+             * @see word
+             */
+            void setWord(const QString &word);
+
+            /**
+             * Sets the distance from the looked up word
+             *
+             * @param distance The distance from the looked up word
+             *
+             * @see distance
+             */
+            void setDistance(int distance);
+
+        private:
+            class Private;
+            Private *const d;
+    };
+}
+
+#endif // MULA_CORE_SIMILARWORD_H
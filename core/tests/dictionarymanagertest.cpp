@@ -0,0 +1,240 @@
+/******************************************************************************
+ * This file is part of the Mula project
+ * Copyright (c) 2011 Laszlo Papp <lpapp@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include "dictionarymanagertest.h"
+
+#include <core/dictionarymanager.h>
+#include <core/dictionaryplugin.h>
+#include <core/pluginmanager.h>
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QRegExp>
+#include <QtCore/QSettings>
+#include <QtCore/QStandardPaths>
+#include <QtCore/QStringList>
+#include <QtCore/QThread>
+#include <QtTest/QtTest>
+
+using namespace MulaCore;
+
+// Translates every word in its dictionaries, optionally after a delay
+class FakeDictionaryPlugin : public DictionaryPlugin
+{
+    public:
+        FakeDictionaryPlugin(const QStringList &dictionaries, Features features)
+            : m_dictionaries(dictionaries)
+            , m_features(features)
+            , m_delay(0)
+        {
+        }
+
+        QString name() const { return "fake"; }
+        QString version() const { return "0.1"; }
+        QString description() const { return "A fake plugin"; }
+        QStringList authors() const { return QStringList(); }
+        Features features() const { return m_features; }
+        QStringList availableDictionaryList() { return m_dictionaries; }
+        QStringList loadedDictionaryList() const { return m_dictionaries; }
+        void setLoadedDictionaryList(const QStringList &loadedDictionaryList) { Q_UNUSED(loadedDictionaryList) }
+        DictionaryInfo dictionaryInfo(const QString &dictionary) { return DictionaryInfo(name(), dictionary); }
+
+        bool isTranslatable(const QString &dictionary, const QString &word)
+        {
+            return m_dictionaries.contains(dictionary) && !word.isEmpty();
+        }
+
+        Translation translate(const QString &dictionary, const QString &word)
+        {
+            m_translationCount.ref();
+            m_runningTranslations.ref();
+            if (m_delay > 0)
+                QThread::msleep(m_delay);
+
+            m_runningTranslations.deref();
+            return Translation(word, dictionary, "The translation of " + word);
+        }
+
+        void setDelay(int msecs) { m_delay = msecs; }
+        int runningTranslations() const { return m_runningTranslations.load(); }
+        int translationCount() const { return m_translationCount.load(); }
+
+    private:
+        QStringList m_dictionaries;
+        Features m_features;
+        int m_delay;
+        QAtomicInt m_runningTranslations;
+        QAtomicInt m_translationCount;
+};
+
+// Returns the dictionary names in the order of the translations
+static QStringList
+translatedDictionaries(const QString &translatedWord)
+{
+    QStringList dictionaries;
+    QRegExp dictionaryName("<font class=\"dict_name\">([^<]*)</font>");
+
+    int position = 0;
+    while ((position = dictionaryName.indexIn(translatedWord, position)) != -1)
+    {
+        dictionaries.append(dictionaryName.cap(1));
+        position += dictionaryName.matchedLength();
+    }
+
+    return dictionaries;
+}
+
+DictionaryManagerTest::DictionaryManagerTest()
+{
+}
+
+DictionaryManagerTest::~DictionaryManagerTest()
+{
+}
+
+void DictionaryManagerTest::initTestCase()
+{
+    QVERIFY(m_temporaryDir.isValid());
+    QStandardPaths::setTestModeEnabled(true);
+
+    // The managers read and write their settings, which must not touch the
+    // settings of the user
+    QSettings::setPath(QSettings::NativeFormat, QSettings::UserScope, m_temporaryDir.path());
+    QSettings::setPath(QSettings::IniFormat, QSettings::UserScope, m_temporaryDir.path());
+
+    m_sequentialPlugin.reset(new FakeDictionaryPlugin(QStringList() << "Alpha" << "Gamma",
+                                                      DictionaryPlugin::SearchSimilar));
+    m_concurrentPlugin.reset(new FakeDictionaryPlugin(QStringList() << "Beta",
+                                                      DictionaryPlugin::ConcurrentQueries));
+
+    PluginManager::instance()->registerPlugin("sequential", m_sequentialPlugin.data());
+    PluginManager::instance()->registerPlugin("concurrent", m_concurrentPlugin.data());
+
+    QMultiHash<QString, QString> dictionaries;
+    dictionaries.insert("sequential", "Alpha");
+    dictionaries.insert("sequential", "Gamma");
+    dictionaries.insert("concurrent", "Beta");
+    dictionaries.insert("missing", "Delta");
+    DictionaryManager::instance()->setLoadedDictionaryList(dictionaries);
+}
+
+void DictionaryManagerTest::cleanupTestCase()
+{
+    // The translation given up at the deadline still runs in the pool
+    QTRY_COMPARE_WITH_TIMEOUT(m_concurrentPlugin->runningTranslations(), 0, 10000);
+
+    PluginManager::instance()->unregisterPlugin("sequential");
+    PluginManager::instance()->unregisterPlugin("concurrent");
+}
+
+void DictionaryManagerTest::testLoadedDictionaryList()
+{
+    // The dictionaries of the missing plugin are dropped
+    QMultiHash<QString, QString> dictionaries = DictionaryManager::instance()->loadedDictionaryList();
+    QCOMPARE(dictionaries.size(), 3);
+    QVERIFY(dictionaries.contains("sequential", "Alpha"));
+    QVERIFY(dictionaries.contains("sequential", "Gamma"));
+    QVERIFY(dictionaries.contains("concurrent", "Beta"));
+}
+
+void DictionaryManagerTest::testPriorityOrder()
+{
+    DictionaryManager *dictionaryManager = DictionaryManager::instance();
+    dictionaryManager->setTranslationTimeout(-1);
+    m_concurrentPlugin->setDelay(100);
+
+    // The concurrent translation arrives last, but it is listed by priority
+    QList<QPair<QString, QString> > priorityList;
+    priorityList << qMakePair(QString("sequential"), QString("Gamma"))
+                 << qMakePair(QString("concurrent"), QString("Beta"))
+                 << qMakePair(QString("sequential"), QString("Alpha"));
+    dictionaryManager->setDictionaryPriorityList(priorityList);
+
+    QCOMPARE(translatedDictionaries(dictionaryManager->translate("word")),
+             QStringList() << "Gamma" << "Beta" << "Alpha");
+
+    // The dictionaries missing from the list follow the listed ones
+    priorityList.clear();
+    priorityList << qMakePair(QString("concurrent"), QString("Beta"));
+    dictionaryManager->setDictionaryPriorityList(priorityList);
+
+    QStringList dictionaries = translatedDictionaries(dictionaryManager->translate("word"));
+    QCOMPARE(dictionaries.size(), 3);
+    QCOMPARE(dictionaries.first(), QString("Beta"));
+}
+
+void DictionaryManagerTest::testTimeout()
+{
+    DictionaryManager *dictionaryManager = DictionaryManager::instance();
+    dictionaryManager->setTranslationTimeout(100);
+    dictionaryManager->setDictionaryPriorityList(QList<QPair<QString, QString> >());
+    m_concurrentPlugin->setDelay(2000);
+
+    // The slow dictionary is left out at the deadline
+    QElapsedTimer timer;
+    timer.start();
+    QStringList dictionaries = translatedDictionaries(dictionaryManager->translate("word"));
+    QVERIFY(timer.elapsed() < 1500);
+    QCOMPARE(dictionaries.size(), 2);
+    QVERIFY(dictionaries.contains("Alpha"));
+    QVERIFY(dictionaries.contains("Gamma"));
+    QCOMPARE(m_concurrentPlugin->runningTranslations(), 1);
+
+    // The similar words do not wait for the translation still running
+    timer.restart();
+    QCOMPARE(dictionaryManager->findSimilarWords("word"), QStringList() << "word");
+    QVERIFY(timer.elapsed() < 1500);
+    QCOMPARE(m_concurrentPlugin->runningTranslations(), 1);
+}
+
+void DictionaryManagerTest::testLateTranslation()
+{
+    DictionaryManager *dictionaryManager = DictionaryManager::instance();
+    dictionaryManager->setTranslationTimeout(100);
+    dictionaryManager->setDictionaryPriorityList(QList<QPair<QString, QString> >());
+
+    // The dictionary still busy with the query given up in testTimeout is
+    // not queried again meanwhile
+    int translationCount = m_concurrentPlugin->translationCount();
+    QCOMPARE(m_concurrentPlugin->runningTranslations(), 1);
+    for (int i = 0; i < 5; ++i)
+    {
+        QStringList dictionaries = translatedDictionaries(dictionaryManager->translate("word"));
+        QCOMPARE(dictionaries.size(), 2);
+        QVERIFY(!dictionaries.contains("Beta"));
+    }
+
+    QCOMPARE(m_concurrentPlugin->translationCount(), translationCount);
+    QCOMPARE(m_concurrentPlugin->runningTranslations(), 1);
+
+    // Once the late translation arrives, the dictionary is queried again
+    QTRY_COMPARE_WITH_TIMEOUT(m_concurrentPlugin->runningTranslations(), 0, 10000);
+    m_concurrentPlugin->setDelay(0);
+    dictionaryManager->setTranslationTimeout(-1);
+
+    QStringList dictionaries = translatedDictionaries(dictionaryManager->translate("word"));
+    QCOMPARE(dictionaries.size(), 3);
+    QVERIFY(dictionaries.contains("Beta"));
+    QCOMPARE(m_concurrentPlugin->translationCount(), translationCount + 1);
+}
+
+QTEST_MAIN(DictionaryManagerTest)
+
+#include "dictionarymanagertest.moc"
@@ -0,0 +1,120 @@
+/******************************************************************************
+ * This file is part of the Mula project
+ * Copyright (c) 2011 Laszlo Papp <lpapp@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include "dictionaryplugintest.h"
+
+#include <core/dictionaryplugin.h>
+
+#include <QtCore/QStringList>
+#include <QtTest/QtTest>
+
+using namespace MulaCore;
+
+// Translates the words of a fixed list, and records the translated words
+class FakeDictionaryPlugin : public DictionaryPlugin
+{
+    public:
+        FakeDictionaryPlugin()
+        {
+            m_headwords << "apple" << "banana" << "cherry";
+        }
+
+        QString name() const { return "fake"; }
+        QString version() const { return "0.1"; }
+        QString description() const { return "A fake plugin"; }
+        QStringList authors() const { return QStringList(); }
+        QStringList availableDictionaryList() { return QStringList() << "fruits"; }
+        QStringList loadedDictionaryList() const { return QStringList() << "fruits"; }
+        void setLoadedDictionaryList(const QStringList &loadedDictionaryList) { Q_UNUSED(loadedDictionaryList) }
+        DictionaryInfo dictionaryInfo(const QString &dictionary) { return DictionaryInfo(name(), dictionary); }
+
+        bool isTranslatable(const QString &dictionary, const QString &word)
+        {
+            return dictionary == "fruits" && m_headwords.contains(word);
+        }
+
+        Translation translate(const QString &dictionary, const QString &word)
+        {
+            m_translatedWords.append(word);
+            if (!isTranslatable(dictionary, word))
+                return Translation();
+
+            return Translation(word, dictionary, "The fruit " + word);
+        }
+
+        QStringList translatedWords() const { return m_translatedWords; }
+
+    private:
+        QStringList m_headwords;
+        QStringList m_translatedWords;
+};
+
+DictionaryPluginTest::DictionaryPluginTest()
+{
+}
+
+DictionaryPluginTest::~DictionaryPluginTest()
+{
+}
+
+void DictionaryPluginTest::testTranslateBatch()
+{
+    FakeDictionaryPlugin plugin;
+
+    // Unsorted words with duplicates and missing words
+    QStringList words;
+    words << "cherry" << "missing" << "apple" << "cherry" << "" << "banana";
+
+    QList<Translation> translations = plugin.translateBatch("fruits", words);
+    QCOMPARE(translations.size(), words.size());
+
+    // The default implementation translates every word in the given order
+    QCOMPARE(plugin.translatedWords(), words);
+
+    for (int i = 0; i < words.size(); ++i)
+    {
+        if (plugin.isTranslatable("fruits", words.at(i)))
+        {
+            QCOMPARE(translations.at(i).title(), words.at(i));
+            QCOMPARE(translations.at(i).dictionaryName(), QString("fruits"));
+            QCOMPARE(translations.at(i).translation(), "The fruit " + words.at(i));
+        }
+        else
+        {
+            QVERIFY(translations.at(i).title().isEmpty());
+            QVERIFY(translations.at(i).translation().isEmpty());
+        }
+    }
+
+    // The words of an unknown dictionary are not found
+    foreach (const Translation& translation, plugin.translateBatch("vegetables", words))
+        QVERIFY(translation.title().isEmpty());
+}
+
+void DictionaryPluginTest::testTranslateBatchEmpty()
+{
+    FakeDictionaryPlugin plugin;
+    QVERIFY(plugin.translateBatch("fruits", QStringList()).isEmpty());
+    QVERIFY(plugin.translatedWords().isEmpty());
+}
+
+QTEST_MAIN(DictionaryPluginTest)
+
+#include "dictionaryplugintest.moc"
@@ -0,0 +1,70 @@
+/******************************************************************************
+ * This file is part of the Mula project
+ * Copyright (c) 2011 Laszlo Papp <lpapp@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "similarwordtest.h"
+
+#include <core/similarword.h>
+
+#include <QtTest/QtTest>
+
+using namespace MulaCore;
+
+SimilarWordTest::SimilarWordTest()
+{
+
+}
+
+SimilarWordTest::~SimilarWordTest()
+{
+}
+
+void SimilarWordTest::testWord()
+{
+    SimilarWord similarWord;
+    QString word = "Word";
+    similarWord.setWord(word);
+    QCOMPARE(similarWord.word(), word);
+}
+
+void SimilarWordTest::testDistance()
+{
+    SimilarWord similarWord;
+    QCOMPARE(similarWord.distance(), int(SimilarWord::UnknownDistance));
+
+    int distance = 2;
+    similarWord.setDistance(distance);
+    QCOMPARE(similarWord.distance(), distance);
+}
+
+void SimilarWordTest::testCopy()
+{
+    SimilarWord similarWord("Word", 1);
+    SimilarWord copy(similarWord);
+    copy.setWord("Other");
+
+    QCOMPARE(similarWord.word(), QString("Word"));
+    QCOMPARE(copy.distance(), 1);
+
+    similarWord = copy;
+    QCOMPARE(similarWord.word(), QString("Other"));
+}
+
+QTEST_MAIN(SimilarWordTest)
+
+#include "similarwordtest.moc"
@@ -23,7 +23,10 @@
 #include "dictionaryzip.h"
 
 #include <QtCore/QFile>
+#include <QtCore/QMutex>
+#include <QtCore/QMutexLocker>
 #include <QtCore/QVector>
+#include <QtCore/QtEndian>
 
 using namespace MulaPluginStarDict;
 
@@ -45,6 +48,9 @@ class AbstractDictionary::Private
         QFile *dictionaryFile;
         DictionaryZip *compressedDictionaryFile;
 
+        // Guards the position of the shared dictionary file and the cache
+        QMutex dataMutex;
+
         QList<WordEntry> cacheItemList;
         int currentCacheItemIndex;
         static const int wordDataCacheSize = 10;
@@ -66,6 +72,8 @@ AbstractDictionary::~AbstractDictionary()
 const QByteArray
 AbstractDictionary::wordData(quint32 indexItemOffset, qint32 indexItemSize)
 {
+    QMutexLocker locker(&d->dataMutex);
+
     // Check first whether or not the data is already available in the cache
     foreach (const WordEntry& cacheItem, d->cacheItemList)
     {
@@ -98,7 +106,7 @@ AbstractDictionary::wordData(quint32 indexItemOffset, qint32 indexItemSize)
         {
             if (ch.isUpper())
             {
-                sectionSize = *reinterpret_cast<quint32 *>(originalData.mid(sectionPosition).data());
+                sectionSize = qFromBigEndian<quint32>(reinterpret_cast<const uchar *>(originalData.constData() + sectionPosition));
                 sectionSize += sizeof(quint32);
             }
             else
@@ -116,7 +124,9 @@ AbstractDictionary::wordData(quint32 indexItemOffset, qint32 indexItemSize)
         resultData.append(d->sameTypeSequence.at(sameTypeSequenceLength - 1));
         if (d->sameTypeSequence.at(sameTypeSequenceLength - 1).isUpper())
         {
-            resultData.append(reinterpret_cast<char*>(&sectionSize), sizeof(quint32));
+            uchar size[sizeof(quint32)];
+            qToBigEndian<quint32>(sectionSize, size);
+            resultData.append(reinterpret_cast<char*>(size), sizeof(size));
             resultData.append(originalData.mid(sectionPosition, sectionSize));
         }
         else
@@ -129,13 +139,20 @@ AbstractDictionary::wordData(quint32 indexItemOffset, qint32 indexItemSize)
     else
     {
         if (d->dictionaryFile->isOpen())
+        {
+            d->dictionaryFile->seek(indexItemOffset);
             originalData = d->dictionaryFile->read(indexItemSize);
+        }
         else
             originalData = d->compressedDictionaryFile->read(indexItemOffset, indexItemSize);
 
         resultData = originalData;
     }
 
+    // The cache is filled up first, then its items are replaced in turn
+    if (d->cacheItemList.size() < d->wordDataCacheSize)
+        d->cacheItemList.append(WordEntry());
+
     d->cacheItemList[d->currentCacheItemIndex].setData(resultData);
     d->cacheItemList[d->currentCacheItemIndex].setDataOffset(indexItemOffset);
     ++d->currentCacheItemIndex;
@@ -164,21 +181,32 @@ AbstractDictionary::containFindData()
 bool
 AbstractDictionary::findData(const QStringList &searchWords, qint32 indexItemOffset, qint32 indexItemSize)
 {
-    int wordCount = searchWords.size();
-    QVector<bool> wordFind(wordCount, false);
-    QByteArray tmpOriginalData;
     QByteArray originalData;
 
-    if (d->dictionaryFile->isOpen())
-    {
-        d->dictionaryFile->seek(indexItemOffset);
-        originalData = d->dictionaryFile->read(indexItemSize);
-    }
-    else
     {
-        originalData = d->compressedDictionaryFile->read(indexItemOffset, indexItemSize);
+        QMutexLocker locker(&d->dataMutex);
+        if (d->dictionaryFile->isOpen())
+        {
+            d->dictionaryFile->seek(indexItemOffset);
+            originalData = d->dictionaryFile->read(indexItemSize);
+        }
+        else
+        {
+            originalData = d->compressedDictionaryFile->read(indexItemOffset, indexItemSize);
+        }
     }
 
+    return containData(searchWords, originalData);
+}
+
+bool
+AbstractDictionary::containData(const QStringList &searchWords, const QByteArray &originalData) const
+{
+    int wordCount = searchWords.size();
+    int indexItemSize = originalData.size();
+    QVector<bool> wordFind(wordCount, false);
+    QByteArray tmpOriginalData;
+
     int sectionSize = 0;
     int sectionPosition = 0;
     int foundCount = 0;
@@ -217,8 +245,17 @@ AbstractDictionary::findData(const QStringList &searchWords, qint32 indexItemOff
             default:
                 if (ch.isUpper())
                 {
-                    sectionSize = *reinterpret_cast<quint32 *>(originalData.mid(sectionPosition).data());
-                    sectionSize += sizeof(quint32);
+                    // A resource does not contain any text, so truncated
+                    // data can not contain the words either
+                    int dataSize = originalData.size() - sectionPosition - int(sizeof(quint32));
+                    if (dataSize < 0)
+                        return false;
+
+                    quint32 resourceSize = qFromBigEndian<quint32>(reinterpret_cast<const uchar *>(originalData.constData() + sectionPosition));
+                    if (resourceSize > quint32(dataSize))
+                        return false;
+
+                    sectionSize = resourceSize + sizeof(quint32);
                 }
                 else
                 {
@@ -282,10 +319,18 @@ AbstractDictionary::findData(const QStringList &searchWords, qint32 indexItemOff
 
                 break;
             default:
-                if (QChar(originalData.at(sectionSize)).isUpper())
+                // The size of a resource follows its type
+                if (QChar(originalData.at(sectionPosition)).isUpper())
                 {
-                    originalData.fromRawData(reinterpret_cast<char*>(&sectionSize), 4);
-                    sectionSize += sizeof(quint32);
+                    int dataSize = originalData.size() - sectionPosition - 1 - int(sizeof(quint32));
+                    if (dataSize < 0)
+                        return false;
+
+                    quint32 resourceSize = qFromBigEndian<quint32>(reinterpret_cast<const uchar *>(originalData.constData() + sectionPosition + 1));
+                    if (resourceSize > quint32(dataSize))
+                        return false;
+
+                    sectionSize = 1 + sizeof(quint32) + resourceSize;
                 }
                 else
                 {
@@ -306,6 +351,16 @@ AbstractDictionary::compressedDictionaryFile() const
     return d->compressedDictionaryFile;
 }
 
+void
+AbstractDictionary::setCompressedDictionaryFile(DictionaryZip *compressedDictionaryFile)
+{
+    if (d->compressedDictionaryFile == compressedDictionaryFile)
+        return;
+
+    delete d->compressedDictionaryFile;
+    d->compressedDictionaryFile = compressedDictionaryFile;
+}
+
 QFile*
 AbstractDictionary::dictionaryFile() const
 {
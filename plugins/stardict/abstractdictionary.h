@@ -225,6 +225,25 @@ namespace MulaPluginStarDict
 
             bool findData(const QStringList &searchWords, qint32 indexItemOffset, qint32 indexItemSize);
 
+            /**
+             * Returns true if the given raw word data, as stored in the
+             * dictionary file, contains all the desired words, otherwise
+             * false.
+             *
+             * \note This method does not access the dictionary files, hence
+             * it can be used concurrently on data read by other means.
+             *
+             * @param searchWords       The desired words to look up
+             * @param originalData      The raw word data
+             *
+             * @return True if all the desired words can be found in the
+             * word data, otherwise false.
+             *
+             * @see findData, containFindData
+             */
+
+            bool containData(const QStringList &searchWords, const QByteArray &originalData) const;
+
             /**
              * Returns the compressed ".dict.dz" dictionary file
              *
@@ -235,6 +254,18 @@ namespace MulaPluginStarDict
 
             DictionaryZip* compressedDictionaryFile() const;
 
+            /**
+             * Sets the compressed ".dict.dz" dictionary file, and deletes the
+             * previous one
+             *
+             * @param compressedDictionaryFile The compressed dictionary file,
+             * the dictionary takes its ownership
+             *
+             * @see compressedDictionaryFile
+             */
+
+            void setCompressedDictionaryFile(DictionaryZip *compressedDictionaryFile);
+
             /**
              * Returns the ".dict" dictionary file
              *
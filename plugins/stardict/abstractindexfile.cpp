@@ -47,6 +47,7 @@ AbstractIndexFile::AbstractIndexFile()
 
 AbstractIndexFile::~AbstractIndexFile()
 {
+    delete d;
 }
 
 quint32
@@ -87,6 +87,18 @@ namespace MulaPluginStarDict
 
             virtual int lookup(const QByteArray& word) = 0;
 
+            /**
+             * Returns a new index file object over the already loaded index.
+             * The reader has its own file handle and caches, so it can be
+             * used in another thread while this object is used as well.
+             *
+             * \note The caller takes the ownership of the returned object.
+             *
+             * @return The new reader of the index, or NULL on failure
+             */
+
+            virtual AbstractIndexFile* createReader() const = 0;
+
             virtual quint32 wordEntryOffset() const;
             virtual void setWordEntryOffset(quint32 wordEntryOffset);
 
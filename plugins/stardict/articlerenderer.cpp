@@ -0,0 +1,689 @@
+/******************************************************************************
+ * This file is part of the Mula project
+ * Copyright (c) 2011 Laszlo Papp <lpapp@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "articlerenderer.h"
+
+#include <QtCore/QVector>
+#include <QtCore/QtEndian>
+
+using namespace MulaPluginStarDict;
+
+// A stage of the rendering, it gets the text character by character and
+// the markup in whole tags, and passes its output to the next stage
+class RenderStage
+{
+    public:
+        RenderStage(RenderStage *next)
+            : m_next(next)
+        {
+        }
+
+        virtual ~RenderStage()
+        {
+        }
+
+        virtual void putChar(QChar ch)
+        {
+            m_next->putChar(ch);
+        }
+
+        virtual void putMarkup(const QString& markup)
+        {
+            m_next->putMarkup(markup);
+        }
+
+        virtual void finish()
+        {
+            m_next->finish();
+        }
+
+    protected:
+        RenderStage *m_next;
+};
+
+// Appends everything to the rendered article
+class OutputStage : public RenderStage
+{
+    public:
+        OutputStage(QString& output)
+            : RenderStage(0)
+            , m_output(output)
+        {
+        }
+
+        void putChar(QChar ch)
+        {
+            m_output.append(ch);
+        }
+
+        void putMarkup(const QString& markup)
+        {
+            m_output.append(markup);
+        }
+
+        void finish()
+        {
+        }
+
+    private:
+        QString& m_output;
+};
+
+// Replaces the abbreviations, i.e. the longest "_\S+[.:]" of a word, with
+// their explanations
+class AbbreviationStage : public RenderStage
+{
+    public:
+        AbbreviationStage(RenderStage *next, ArticleRenderer::AbbreviationExpander *expander)
+            : RenderStage(next)
+            , m_expander(expander)
+        {
+        }
+
+        void putChar(QChar ch)
+        {
+            if (!m_word.isEmpty())
+            {
+                if (!ch.isSpace())
+                {
+                    m_word.append(ch);
+                    return;
+                }
+
+                flush();
+            }
+            else if (ch == '_')
+            {
+                m_word.append(ch);
+                return;
+            }
+
+            m_next->putChar(ch);
+        }
+
+        void putMarkup(const QString& markup)
+        {
+            flush();
+            m_next->putMarkup(markup);
+        }
+
+        void finish()
+        {
+            flush();
+            m_next->finish();
+        }
+
+    private:
+        void flush()
+        {
+            if (m_word.isEmpty())
+                return;
+
+            int end = m_word.size() - 1;
+            while (end >= 2 && m_word.at(end) != '.' && m_word.at(end) != ':')
+                --end;
+
+            int start = 0;
+            if (end >= 2)
+            {
+                QString explanation = m_expander->expand(m_word.left(end + 1));
+                if (!explanation.isNull())
+                {
+                    if (m_word.at(end) == ':')
+                        explanation += ':';
+
+                    m_next->putMarkup("<font class=\"explanation\">" + explanation + "</font>");
+                    start = end + 1;
+                }
+            }
+
+            for (int i = start; i < m_word.size(); ++i)
+                m_next->putChar(m_word.at(i));
+
+            m_word.clear();
+        }
+
+        ArticleRenderer::AbbreviationExpander *m_expander;
+        QString m_word;     // From the underscore to the end of the word
+};
+
+// Turns the numbered items starting a word, e.g. "1)", "2.", "3&gt;", into
+// the items of nested ordered lists, a list is opened by its first item
+class ListStage : public RenderStage
+{
+    public:
+        ListStage(RenderStage *next)
+            : RenderStage(next)
+            , m_wordStart(true)
+            , m_skipSpaces(false)
+        {
+        }
+
+        void putChar(QChar ch)
+        {
+            if (!m_number.isEmpty())
+            {
+                m_number.append(ch);
+                processNumber();
+                return;
+            }
+
+            if (ch.isSpace())
+            {
+                if (!m_skipSpaces)
+                    m_spaces.append(ch);
+
+                m_wordStart = true;
+                return;
+            }
+
+            m_skipSpaces = false;
+
+            if (m_wordStart && ch.isDigit())
+            {
+                m_number.append(ch);
+                return;
+            }
+
+            flushSpaces();
+            m_next->putChar(ch);
+            m_wordStart = false;
+        }
+
+        void putMarkup(const QString& markup)
+        {
+            flushNumber();
+            flushSpaces();
+            m_next->putMarkup(markup);
+            m_wordStart = true;
+            m_skipSpaces = false;
+        }
+
+        void finish()
+        {
+            flushNumber();
+            flushSpaces();
+
+            while (!m_openedLists.isEmpty())
+            {
+                m_next->putMarkup("</li></ol>");
+                m_openedLists.pop_back();
+            }
+
+            m_next->finish();
+        }
+
+    private:
+        // Decides whether the digits and the characters after them are an
+        // item as soon as enough characters have arrived
+        void processNumber()
+        {
+            int digitCount = 0;
+            while (digitCount < m_number.size() && m_number.at(digitCount).isDigit())
+                ++digitCount;
+
+            if (digitCount == m_number.size())
+                return;
+
+            QChar marker = m_number.at(digitCount);
+            int markerLength = 1;
+
+            if (marker == '&')
+            {
+                static const QString greaterThan("&gt;");
+                if (!greaterThan.startsWith(m_number.mid(digitCount)))
+                {
+                    flushNumber();
+                    return;
+                }
+
+                if (m_number.size() - digitCount < greaterThan.size())
+                    return;
+
+                marker = '>';
+                markerLength = greaterThan.size();
+            }
+            else if (marker != '>' && marker != '.' && marker != ')')
+            {
+                flushNumber();
+                return;
+            }
+
+            // The marker has to end the word, so "1.5" is not an item
+            if (m_number.size() == digitCount + markerLength)
+                return;
+
+            if (!m_number.at(digitCount + markerLength).isSpace())
+            {
+                flushNumber();
+                return;
+            }
+
+            QString replacement;
+            if (digitCount == 1 && m_number.at(0) == '1')
+            {
+                // The first item of a list closes the previous list with the
+                // same marker, and the lists nested into that one
+                if (m_openedLists.contains(marker))
+                    closeLists(marker, replacement);
+
+                m_openedLists.append(marker);
+                replacement += "<ol>";
+            }
+            else
+            {
+                // The next item of a list that is not open is kept as text
+                if (!m_openedLists.contains(marker))
+                {
+                    flushNumber();
+                    return;
+                }
+
+                while (m_openedLists.last() != marker)
+                {
+                    replacement += "</li></ol>";
+                    m_openedLists.pop_back();
+                }
+
+                replacement += "</li>";
+            }
+
+            replacement += "<li>";
+
+            // The whitespace around the number is dropped
+            m_spaces.clear();
+            m_number.clear();
+            m_skipSpaces = true;
+            m_wordStart = true;
+
+            m_next->putMarkup(replacement);
+        }
+
+        void closeLists(QChar marker, QString& replacement)
+        {
+            while (!m_openedLists.isEmpty())
+            {
+                QChar last = m_openedLists.last();
+                replacement += "</li></ol>";
+                m_openedLists.pop_back();
+
+                if (last == marker)
+                    break;
+            }
+        }
+
+        // Passes the digits and the characters after them as text
+        void flushNumber()
+        {
+            if (m_number.isEmpty())
+                return;
+
+            QString number = m_number;
+            m_number.clear();
+
+            flushSpaces();
+            m_skipSpaces = false;
+
+            int i = 0;
+            for (; i < number.size() && number.at(i).isDigit(); ++i)
+                m_next->putChar(number.at(i));
+
+            m_wordStart = false;
+
+            for (; i < number.size(); ++i)
+                putChar(number.at(i));
+        }
+
+        void flushSpaces()
+        {
+            for (int i = 0; i < m_spaces.size(); ++i)
+                m_next->putChar(m_spaces.at(i));
+
+            m_spaces.clear();
+        }
+
+        QString m_spaces;               // The whitespace before the next word
+        QString m_number;               // The digits of a possible item and the characters after them
+        QVector<QChar> m_openedLists;   // The markers of the open lists
+        bool m_wordStart;
+        bool m_skipSpaces;
+};
+
+// Trims the article, and turns the tabs, the line breaks and the
+// transcriptions into HTML
+class SpaceStage : public RenderStage
+{
+    public:
+        SpaceStage(RenderStage *next)
+            : RenderStage(next)
+            , m_started(false)
+        {
+        }
+
+        void putChar(QChar ch)
+        {
+            if (ch.isSpace())
+            {
+                if (m_started)
+                    m_spaces.append(ch);
+
+                return;
+            }
+
+            flushSpaces();
+            m_started = true;
+
+            if (ch == '[')
+                m_next->putMarkup("<font class=\"transcription\">[");
+            else if (ch == ']')
+                m_next->putMarkup("]</font>");
+            else
+                m_next->putChar(ch);
+        }
+
+        void putMarkup(const QString& markup)
+        {
+            flushSpaces();
+            m_started = true;
+            m_next->putMarkup(markup);
+        }
+
+        void finish()
+        {
+            // The trailing whitespace is dropped
+            m_spaces.clear();
+            m_next->finish();
+        }
+
+    private:
+        // A run of whitespace with a line break becomes a line break, or a
+        // new paragraph if there are several line breaks
+        void flushSpaces()
+        {
+            int lineBreak = m_spaces.indexOf('\n');
+            int end = lineBreak == -1 ? m_spaces.size() : lineBreak;
+
+            for (int i = 0; i < end; ++i)
+            {
+                if (m_spaces.at(i) == '\t')
+                    m_next->putMarkup("&nbsp;&nbsp;&nbsp;&nbsp;");
+                else
+                    m_next->putChar(m_spaces.at(i));
+            }
+
+            if (lineBreak != -1)
+                m_next->putMarkup(m_spaces.count('\n') > 1 ? "</p><p>" : "<br>");
+
+            m_spaces.clear();
+        }
+
+        QString m_spaces;
+        bool m_started;
+};
+
+static void
+putText(RenderStage *stage, const QString& text)
+{
+    const QChar *end = text.constData() + text.size();
+    for (const QChar *ch = text.constData(); ch != end; ++ch)
+        stage->putChar(*ch);
+}
+
+// Passes the tags as markup, and the text between them character by
+// character
+static void
+putMarkupText(RenderStage *stage, const QString& text)
+{
+    int position = 0;
+    while (position < text.size())
+    {
+        if (text.at(position) == '<')
+        {
+            int end = text.indexOf('>', position);
+            if (end != -1)
+            {
+                stage->putMarkup(text.mid(position, end - position + 1));
+                position = end + 1;
+                continue;
+            }
+        }
+
+        stage->putChar(text.at(position));
+        ++position;
+    }
+}
+
+struct XdxfTag
+{
+    const char *name;
+    const char *openingHtml;
+    const char *closingHtml;
+};
+
+static const XdxfTag xdxfTags[] = {
+    { "abr", "<font class=\"abbreviature\">", "</font>" },
+    { "ex", "<font class=\"example\">", "</font>" },
+    { "tr", "<font class=\"transcription\">[", "]</font>" },
+};
+
+// Converts the XDXF tags of the text while passing it to the stage, the
+// keys between <k> and </k> are dropped, and the unknown tags are kept
+static void
+putXdxf(RenderStage *stage, const QString& text)
+{
+    const QChar *data = text.constData();
+    int size = text.size();
+    int keyDepth = 0;
+    int position = 0;
+
+    while (position < size)
+    {
+        int end;
+        if (data[position] != '<' || (end = text.indexOf('>', position)) == -1)
+        {
+            if (keyDepth == 0)
+                stage->putChar(data[position]);
+
+            ++position;
+            continue;
+        }
+
+        bool closing = data[position + 1] == '/';
+        bool empty = data[end - 1] == '/';
+        int nameStart = position + (closing ? 2 : 1);
+        int nameEnd = nameStart;
+        while (nameEnd < end && !data[nameEnd].isSpace() && data[nameEnd] != '/')
+            ++nameEnd;
+
+        QStringRef name = text.midRef(nameStart, nameEnd - nameStart);
+        int tagStart = position;
+        position = end + 1;
+
+        if (name == QLatin1String("k"))
+        {
+            if (closing)
+                keyDepth = qMax(0, keyDepth - 1);
+            else if (!empty)
+                ++keyDepth;
+
+            continue;
+        }
+
+        if (keyDepth > 0)
+            continue;
+
+        const XdxfTag *tag = 0;
+        for (unsigned int i = 0; i < sizeof(xdxfTags) / sizeof(xdxfTags[0]); ++i)
+        {
+            if (name == QLatin1String(xdxfTags[i].name))
+            {
+                tag = &xdxfTags[i];
+                break;
+            }
+        }
+
+        if (!tag)
+            stage->putMarkup(text.mid(tagStart, position - tagStart));
+        else if (closing)
+            stage->putMarkup(QLatin1String(tag->closingHtml));
+        else if (!empty)
+            stage->putMarkup(QLatin1String(tag->openingHtml));
+    }
+}
+
+class ArticleRenderer::Private
+{
+    public:
+        Private()
+            : htmlSpaces(false)
+            , reformatLists(false)
+            , expander(0)
+        {
+        }
+
+        ~Private()
+        {
+        }
+
+        bool htmlSpaces;
+        bool reformatLists;
+        AbbreviationExpander *expander;
+};
+
+ArticleRenderer::ArticleRenderer()
+    : d(new Private)
+{
+}
+
+ArticleRenderer::~ArticleRenderer()
+{
+    delete d;
+}
+
+void
+ArticleRenderer::setHtmlSpaces(bool htmlSpaces)
+{
+    d->htmlSpaces = htmlSpaces;
+}
+
+void
+ArticleRenderer::setReformatLists(bool reformatLists)
+{
+    d->reformatLists = reformatLists;
+}
+
+void
+ArticleRenderer::setAbbreviationExpander(AbbreviationExpander *expander)
+{
+    d->expander = expander;
+}
+
+QString
+ArticleRenderer::render(const QByteArray& data) const
+{
+    // The markup makes the article longer than the word data
+    QString output;
+    output.reserve(data.size() + data.size() / 2);
+
+    OutputStage outputStage(output);
+    RenderStage *stage = &outputStage;
+
+    SpaceStage spaceStage(stage);
+    if (d->htmlSpaces)
+        stage = &spaceStage;
+
+    ListStage listStage(stage);
+    if (d->reformatLists)
+        stage = &listStage;
+
+    AbbreviationStage abbreviationStage(stage, d->expander);
+    if (d->expander)
+        stage = &abbreviationStage;
+
+    int position = 0;
+    while (position < data.size())
+    {
+        char type = data.at(position++);
+
+        // The upper case fields start with their size, they are not rendered
+        if (QChar(type).isUpper())
+        {
+            if (position + int(sizeof(quint32)) > data.size())
+                break;
+
+            position += sizeof(quint32) + qFromBigEndian<quint32>(reinterpret_cast<const uchar*>(data.constData() + position));
+            continue;
+        }
+
+        // The lower case fields end with a null character
+        int end = data.indexOf('\0', position);
+        if (end == -1)
+            end = data.size();
+
+        const char *field = data.constData() + position;
+        int fieldSize = end - position;
+
+        switch (type)
+        {
+            case 'm':
+                putText(stage, QString::fromUtf8(field, fieldSize));
+                break;
+
+            case 'l':
+                putText(stage, QString::fromLocal8Bit(field, fieldSize));
+                break;
+
+            case 'g':
+            case 'h':
+                putMarkupText(stage, QString::fromUtf8(field, fieldSize));
+                break;
+
+            case 't':
+                stage->putMarkup("<font class=\"example\">");
+                putText(stage, QString::fromUtf8(field, fieldSize));
+                stage->putMarkup("</font>");
+                break;
+
+            case 'x':
+                putXdxf(stage, QString::fromUtf8(field, fieldSize));
+                break;
+
+            default:
+                ; // nothing
+        }
+
+        position = end + 1;
+    }
+
+    stage->finish();
+
+    return output;
+}
+
+void
+ArticleRenderer::xdxf2html(QString &string)
+{
+    QString output;
+    output.reserve(string.size() + string.size() / 2);
+
+    OutputStage outputStage(output);
+    putXdxf(&outputStage, string);
+
+    string = output;
+}
@@ -0,0 +1,139 @@
+/******************************************************************************
+ * This file is part of the Mula project
+ * Copyright (c) 2011 Laszlo Papp <lpapp@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef MULA_PLUGIN_STARDICT_ARTICLERENDERER_H
+#define MULA_PLUGIN_STARDICT_ARTICLERENDERER_H
+
+#include <QtCore/QByteArray>
+#include <QtCore/QString>
+
+namespace MulaPluginStarDict
+{
+    /**
+     * \brief Renders the word data of a dictionary article as HTML
+     *
+     * The renderer decodes the fields of the word data once, and streams the
+     * text of the fields through the enabled stages into the output:
+     *
+     * - expanding the abbreviations, e.g. "_adj.", with their own articles,
+     * - reformatting the numbered items, e.g. "1)", "2)", as nested lists,
+     * - trimming the article, and turning the tabs, the line breaks and the
+     *   transcriptions in square brackets into HTML.
+     *
+     * Every stage only looks ahead a few characters, and the tags of the
+     * markup fields pass the stages untouched, so the article is rendered in
+     * one forward pass instead of editing the whole text for every stage.
+     *
+     * \see StarDict::parseData
+     */
+
+    class ArticleRenderer
+    {
+        public:
+
+            /**
+             * \brief Looks up the explanation of an abbreviation
+             */
+
+            class AbbreviationExpander
+            {
+                public:
+                    virtual ~AbbreviationExpander() {}
+
+                    /**
+                     * Returns the explanation of the abbreviation
+                     *
+                     * @param abbreviation The abbreviation with its leading
+                     * underscore and trailing period or colon, e.g. "_adj."
+                     *
+                     * @return The explanation as HTML, or a null string if
+                     * the abbreviation is not known
+                     */
+
+                    virtual QString expand(const QString& abbreviation) = 0;
+            };
+
+            /**
+             * Constructor, all the stages are disabled by default
+             */
+
+            ArticleRenderer();
+
+            /**
+             * Destructor
+             */
+
+            virtual ~ArticleRenderer();
+
+            /**
+             * Sets whether the whitespace of the article is turned into HTML
+             *
+             * @param htmlSpaces Whether to trim the article, and convert the
+             * tabs, the line breaks and the transcriptions
+             */
+
+            void setHtmlSpaces(bool htmlSpaces);
+
+            /**
+             * Sets whether the numbered items are reformatted as lists
+             *
+             * @param reformatLists Whether to reformat the numbered items
+             */
+
+            void setReformatLists(bool reformatLists);
+
+            /**
+             * Sets the expander of the abbreviations, the abbreviations are
+             * kept as they are without an expander
+             *
+             * @param expander The expander, the renderer does not take its
+             * ownership
+             */
+
+            void setAbbreviationExpander(AbbreviationExpander *expander);
+
+            /**
+             * Renders the word data
+             *
+             * @param data The word data with the type of every field, as
+             * returned by AbstractDictionary::wordData()
+             *
+             * @return The article as HTML
+             */
+
+            QString render(const QByteArray& data) const;
+
+            /**
+             * Converts the XDXF markup of an article to HTML in one pass
+             * over the text. The abbreviations, the examples and the
+             * transcriptions become styled fonts, the keys are dropped, and
+             * the other tags are kept.
+             *
+             * @param string The XDXF markup to convert in place
+             */
+
+            static void xdxf2html(QString& string);
+
+        private:
+            class Private;
+            Private *const d;
+    };
+}
+
+#endif // MULA_PLUGIN_STARDICT_ARTICLERENDERER_H
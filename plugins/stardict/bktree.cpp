@@ -0,0 +1,473 @@
+/******************************************************************************
+ * This file is part of the Mula project
+ * Copyright (c) 2011 Laszlo Papp <lpapp@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "bktree.h"
+
+#include "cachelocations.h"
+#include "distance.h"
+#include "indexfilescanner.h"
+
+#include <QtCore/QDateTime>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QVarLengthArray>
+#include <QtCore/QVector>
+#include <QtCore/QtAlgorithms>
+#include <QtCore/QDebug>
+
+#include <limits.h>
+
+using namespace MulaPluginStarDict;
+
+// The length of the words in the index file should be less than 256 bytes
+static const int maximumWordLength = 256;
+
+struct BkTreeNode
+{
+    quint32 wordIndex;
+    quint32 textOffset;
+    quint32 textLength;
+    quint32 firstEdge;
+    quint32 edgeCount;
+};
+
+struct BkTreeEdge
+{
+    quint32 distance;
+    quint32 child;
+};
+
+inline bool
+operator<(const BkTreeEdge& left, const BkTreeEdge& right)
+{
+    return left.distance < right.distance;
+}
+
+class BkTree::Private
+{
+    public:
+        Private()
+            : cacheMagicString("StarDict's BK-Tree, Version: 0.3")
+            , mappedData(0)
+            , nodeCount(0)
+            , edgeCount(0)
+            , textSize(0)
+            , nodes(0)
+            , edges(0)
+            , text(0)
+        {
+        }
+
+        ~Private()
+        {
+        }
+
+        void unload();
+        bool isValid() const;
+
+        QByteArray cacheMagicString;
+        QFile mapFile;
+        uchar *mappedData;
+
+        quint32 nodeCount;
+        quint32 edgeCount;
+        quint32 textSize;
+
+        const BkTreeNode *nodes;
+        const BkTreeEdge *edges;
+        const quint32 *text;
+};
+
+void
+BkTree::Private::unload()
+{
+    if (mappedData)
+        mapFile.unmap(mappedData);
+
+    mapFile.close();
+    mappedData = 0;
+    nodes = 0;
+    edges = 0;
+    text = 0;
+}
+
+// Checks that every offset read from the mapped file stays within its
+// section, and that every edge leads to a later node, so a corrupt cache can
+// neither be read out of bounds nor make the search loop
+bool
+BkTree::Private::isValid() const
+{
+    for (quint32 i = 0; i < nodeCount; ++i)
+    {
+        const BkTreeNode& node = nodes[i];
+        if (node.textLength > quint32(maximumWordLength)
+            || quint64(node.textOffset) + node.textLength > textSize
+            || quint64(node.firstEdge) + node.edgeCount > edgeCount)
+        {
+            return false;
+        }
+
+        for (quint32 j = node.firstEdge; j < node.firstEdge + node.edgeCount; ++j)
+        {
+            if (edges[j].child <= i || edges[j].child >= nodeCount)
+                return false;
+        }
+    }
+
+    return true;
+}
+
+BkTree::BkTree()
+    : d(new Private)
+{
+}
+
+BkTree::~BkTree()
+{
+    d->unload();
+    delete d;
+}
+
+int
+BkTree::distance(const quint32 *string1, int length1, const quint32 *string2, int length2)
+{
+    // The algorithm of Lowrance and Wagner over a matrix with an extra row
+    // and column of the infinite distance around the usual one. The edit
+    // before a transposition may be anywhere before it, so the whole matrix
+    // is kept.
+    const int width = length2 + 2;
+    const int infinity = length1 + length2;
+    QVarLengthArray<int, 1024> matrix((length1 + 2) * width);
+    QVarLengthArray<int, maximumWordLength + 1> lastRows(length2 + 1);
+
+    matrix[0] = infinity;
+    for (int i = 0; i <= length1; ++i)
+    {
+        matrix[(i + 1) * width] = infinity;
+        matrix[(i + 1) * width + 1] = i;
+    }
+
+    for (int j = 0; j <= length2; ++j)
+    {
+        matrix[j + 1] = infinity;
+        matrix[width + j + 1] = j;
+        lastRows[j] = 0;
+    }
+
+    for (int i = 1; i <= length1; ++i)
+    {
+        // The last column of this row whose character equals the one of
+        // the row
+        int lastColumn = 0;
+
+        for (int j = 1; j <= length2; ++j)
+        {
+            // The last row before this one whose character equals the one
+            // of the column
+            int lastRow = lastRows[j];
+            int previousColumn = lastColumn;
+            int cost = 1;
+
+            if (string1[i - 1] == string2[j - 1])
+            {
+                cost = 0;
+                lastColumn = j;
+            }
+
+            int value = qMin(matrix[i * width + j] + cost,
+                             qMin(matrix[(i + 1) * width + j], matrix[i * width + j + 1]) + 1);
+            value = qMin(value, matrix[lastRow * width + previousColumn] + (i - lastRow - 1) + 1 + (j - previousColumn - 1));
+            matrix[(i + 1) * width + j + 1] = value;
+        }
+
+        for (int j = 1; j <= length2; ++j)
+        {
+            if (string2[j - 1] == string1[i - 1])
+                lastRows[j] = i;
+        }
+    }
+
+    return matrix[(length1 + 1) * width + length2 + 1];
+}
+
+bool
+BkTree::isLoaded() const
+{
+    return d->nodes != 0;
+}
+
+bool
+BkTree::load(const QString& indexFilePath)
+{
+    const int headerSize = d->cacheMagicString.size() + 3 * sizeof(quint32);
+
+    foreach (const QString& cacheLocation, cacheLocations(indexFilePath, ".bkt"))
+    {
+        QFileInfo fileInfoIndex(indexFilePath);
+        QFileInfo fileInfoCache(cacheLocation);
+
+        if (!fileInfoCache.exists() || fileInfoCache.lastModified() < fileInfoIndex.lastModified())
+            continue;
+
+        d->unload();
+
+        d->mapFile.setFileName(cacheLocation);
+        if (!d->mapFile.open(QIODevice::ReadOnly))
+        {
+            qDebug() << "Failed to open file:" << cacheLocation;
+            continue;
+        }
+
+        if (d->mapFile.size() < headerSize)
+        {
+            d->unload();
+            continue;
+        }
+
+        d->mappedData = d->mapFile.map(0, d->mapFile.size());
+        if (d->mappedData == NULL)
+        {
+            qDebug() << Q_FUNC_INFO << QString("Mapping the file %1 failed!").arg(cacheLocation);
+            d->unload();
+            continue;
+        }
+
+        if (d->cacheMagicString != QByteArray::fromRawData(reinterpret_cast<const char*>(d->mappedData), d->cacheMagicString.size()))
+        {
+            d->unload();
+            continue;
+        }
+
+        const quint32 *header = reinterpret_cast<const quint32*>(d->mappedData + d->cacheMagicString.size());
+        d->nodeCount = header[0];
+        d->edgeCount = header[1];
+        d->textSize = header[2];
+
+        qint64 expectedSize = headerSize + qint64(d->nodeCount) * sizeof(BkTreeNode)
+                            + qint64(d->edgeCount) * sizeof(BkTreeEdge) + qint64(d->textSize) * sizeof(quint32);
+
+        if (d->nodeCount == 0 || d->mapFile.size() != expectedSize)
+        {
+            d->unload();
+            continue;
+        }
+
+        d->nodes = reinterpret_cast<const BkTreeNode*>(d->mappedData + headerSize);
+        d->edges = reinterpret_cast<const BkTreeEdge*>(d->nodes + d->nodeCount);
+        d->text = reinterpret_cast<const quint32*>(d->edges + d->edgeCount);
+
+        if (!d->isValid())
+        {
+            qDebug() << "The BK-tree cache file is corrupt:" << cacheLocation;
+            d->unload();
+            continue;
+        }
+
+        return true;
+    }
+
+    return false;
+}
+
+bool
+BkTree::build(const QString& indexFilePath)
+{
+    IndexFileScanner scanner;
+    if (!scanner.open(indexFilePath))
+        return false;
+
+    // The folded headwords are collected first, since they are inserted in
+    // a different order than the one of the index file
+    quint32 word[maximumWordLength];
+    QVector<quint32> text;
+    QVector<quint32> wordOffsets;
+
+    while (scanner.next())
+    {
+        QByteArray utf8Word = scanner.word();
+        int wordLength = BitParallelEditDistance::foldUtf8(utf8Word.constData(), utf8Word.size(), word, maximumWordLength);
+
+        wordOffsets.append(text.size());
+        for (int j = 0; j < wordLength; ++j)
+            text.append(word[j]);
+    }
+
+    int wordCount = wordOffsets.size();
+    if (wordCount <= 0)
+        return false;
+
+    wordOffsets.append(text.size());
+
+    QVector<BkTreeNode> nodes;
+    QVector<QVector<BkTreeEdge> > children;
+
+    // Inserting the headwords in sorted order would degenerate the tree, so
+    // they are visited in a fixed pseudo random permutation instead.
+    qint64 stride = 1;
+    const qint64 primes[] = { 1299709, 104729, 7919, 1 };
+    for (int i = 0; stride == 1 && primes[i] != 1; ++i)
+    {
+        if (wordCount % primes[i])
+            stride = primes[i];
+    }
+
+    for (int i = 0; i < wordCount; ++i)
+    {
+        int wordIndex = (i * stride) % wordCount;
+        quint32 wordOffset = wordOffsets.at(wordIndex);
+        int wordLength = wordOffsets.at(wordIndex + 1) - wordOffset;
+        if (wordLength == 0)
+            continue;
+
+        int parent = -1;
+        int edgeDistance = 0;
+
+        if (!nodes.isEmpty())
+        {
+            int current = 0;
+            forever
+            {
+                const BkTreeNode& node = nodes.at(current);
+                edgeDistance = distance(text.constData() + wordOffset, wordLength,
+                                        text.constData() + node.textOffset, node.textLength);
+
+                // Headwords that differ only in case hang below each other
+                // on edges of zero distance, so all of them are found
+                int child = -1;
+                foreach (const BkTreeEdge& edge, children.at(current))
+                {
+                    if (int(edge.distance) == edgeDistance)
+                    {
+                        child = edge.child;
+                        break;
+                    }
+                }
+
+                if (child == -1)
+                {
+                    parent = current;
+                    break;
+                }
+
+                current = child;
+            }
+        }
+
+        BkTreeNode node;
+        node.wordIndex = wordIndex;
+        node.textOffset = wordOffset;
+        node.textLength = wordLength;
+        node.firstEdge = 0;
+        node.edgeCount = 0;
+
+        nodes.append(node);
+        children.append(QVector<BkTreeEdge>());
+
+        if (parent != -1)
+        {
+            BkTreeEdge edge;
+            edge.distance = edgeDistance;
+            edge.child = nodes.size() - 1;
+            children[parent].append(edge);
+        }
+    }
+
+    // Flatten the children lists, sorted by distance for early termination
+    QVector<BkTreeEdge> edges;
+    for (int i = 0; i < nodes.size(); ++i)
+    {
+        qSort(children[i]);
+        nodes[i].firstEdge = edges.size();
+        nodes[i].edgeCount = children.at(i).size();
+        edges += children.at(i);
+    }
+
+    foreach (const QString& cacheLocation, cacheLocations(indexFilePath, ".bkt"))
+    {
+        QFile file(cacheLocation);
+        if (!file.open(QIODevice::WriteOnly))
+        {
+            qDebug() << "Failed to open file for writing:" << cacheLocation;
+            continue;
+        }
+
+        quint32 header[3] = { quint32(nodes.size()), quint32(edges.size()), quint32(text.size()) };
+
+        qint64 nodesSize = nodes.size() * sizeof(BkTreeNode);
+        qint64 edgesSize = edges.size() * sizeof(BkTreeEdge);
+        qint64 textSize = text.size() * sizeof(quint32);
+
+        if (file.write(d->cacheMagicString) != d->cacheMagicString.size()
+            || file.write(reinterpret_cast<const char*>(header), sizeof(header)) != sizeof(header)
+            || file.write(reinterpret_cast<const char*>(nodes.constData()), nodesSize) != nodesSize
+            || file.write(reinterpret_cast<const char*>(edges.constData()), edgesSize) != edgesSize
+            || file.write(reinterpret_cast<const char*>(text.constData()), textSize) != textSize)
+        {
+            file.remove();
+            continue;
+        }
+
+        file.close();
+
+        qDebug() << "Save to cache" << cacheLocation;
+
+        return load(indexFilePath);
+    }
+
+    return false;
+}
+
+QList<QPair<int, int> >
+BkTree::search(const QString& word, int maximumDistance) const
+{
+    QList<QPair<int, int> > result;
+    if (!isLoaded())
+        return result;
+
+    quint32 query[maximumWordLength];
+    QByteArray utf8Word = word.toUtf8();
+    int queryLength = BitParallelEditDistance::foldUtf8(utf8Word.constData(), utf8Word.size(), query, maximumWordLength);
+
+    QVector<quint32> stack;
+    stack.append(0);
+
+    while (!stack.isEmpty())
+    {
+        const BkTreeNode& node = d->nodes[stack.last()];
+        stack.resize(stack.size() - 1);
+
+        int distance = BkTree::distance(query, queryLength, d->text + node.textOffset, node.textLength);
+        if (distance <= maximumDistance)
+            result.append(qMakePair(int(node.wordIndex), distance));
+
+        // By the triangle inequality only the children whose edge distance
+        // is within maximumDistance of distance can contain matches
+        for (quint32 i = node.firstEdge; i < node.firstEdge + node.edgeCount; ++i)
+        {
+            int edgeDistance = d->edges[i].distance;
+            if (edgeDistance > distance + maximumDistance)
+                break;
+
+            if (edgeDistance >= distance - maximumDistance)
+                stack.append(d->edges[i].child);
+        }
+    }
+
+    return result;
+}
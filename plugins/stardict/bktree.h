@@ -0,0 +1,139 @@
+/******************************************************************************
+ * This file is part of the Mula project
+ * Copyright (c) 2011 Laszlo Papp <lpapp@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef MULA_PLUGIN_STARDICT_BKTREE_H
+#define MULA_PLUGIN_STARDICT_BKTREE_H
+
+#include <QtCore/QList>
+#include <QtCore/QPair>
+#include <QtCore/QString>
+
+namespace MulaPluginStarDict
+{
+    /**
+     * \brief Burkhard-Keller tree over the headwords of a dictionary
+     *
+     * The BK-tree is a metric tree that makes it possible to find the
+     * headwords within a given edit distance without computing the distance
+     * against every headword. Every child edge of a node is labelled with the
+     * distance between the child and the node, hence only the subtrees whose
+     * edge label is within the query radius around the distance of the node
+     * need to be visited.
+     *
+     * The tree is built over the lower case headwords with the unrestricted
+     * Damerau-Levenshtein distance. The optimal string alignment distance of
+     * the fuzzy scan does not satisfy the triangle inequality, but this one
+     * does, and it is never greater than that, so searching with the radius
+     * of the scan finds every headword the scan would find.
+     *
+     * The nodes, the edges and the UTF-32 headwords are stored in a flat,
+     * native byte ordered ".bkt" cache file next to the offset cache file,
+     * which is mapped into the memory when loaded.
+     *
+     * \see OffsetCacheFile
+     */
+
+    class BkTree
+    {
+        public:
+
+            /**
+             * Constructor
+             */
+
+            BkTree();
+
+            /**
+             * Destructor
+             */
+
+            virtual ~BkTree();
+
+            /**
+             * Loads the cache file of the tree belonging to the desired index
+             * file. The cache is ignored if it is older than the index file.
+             *
+             * @param   indexFilePath   The complete file path of the index file
+             *
+             * @return True if the loading was successful, otherwise false.
+             *
+             * @see build
+             */
+
+            bool load(const QString& indexFilePath);
+
+            /**
+             * Builds the tree over all the headwords of the index file, saves
+             * it into the cache file belonging to the index file, and then
+             * loads it. The headwords are read from the index file directly,
+             * so the method can be called from any thread.
+             *
+             * @param   indexFilePath   The complete file path of the index file
+             *
+             * @return True if the building was successful, otherwise false.
+             *
+             * @see load
+             */
+
+            bool build(const QString& indexFilePath);
+
+            /**
+             * Returns whether or not the tree is loaded
+             *
+             * @return True if the tree is loaded, otherwise false.
+             */
+
+            bool isLoaded() const;
+
+            /**
+             * Returns the distance the tree is built with, i.e. the
+             * unrestricted Damerau-Levenshtein distance between two UTF-32
+             * strings. Unlike the distance of BitParallelEditDistance, a
+             * transposed pair of characters can be edited further.
+             *
+             * @param string1   The first string
+             * @param length1   The length of the first string
+             * @param string2   The second string
+             * @param length2   The length of the second string
+             *
+             * @return The distance of the strings
+             */
+
+            static int distance(const quint32 *string1, int length1, const quint32 *string2, int length2);
+
+            /**
+             * Returns the headwords within the desired distance from the word.
+             * Headwords that differ only in case are all reported.
+             *
+             * @param   word                The word to look up
+             * @param   maximumDistance     The maximum distance
+             *
+             * @return The index of the matched headwords and their distance
+             * from the word
+             */
+
+            QList<QPair<int, int> > search(const QString& word, int maximumDistance) const;
+
+        private:
+            class Private;
+            Private *const d;
+    };
+}
+
+#endif // MULA_PLUGIN_STARDICT_BKTREE_H
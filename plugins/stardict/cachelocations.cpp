@@ -0,0 +1,49 @@
+/******************************************************************************
+ * This file is part of the Mula project
+ * Copyright (c) 2011 Laszlo Papp <lpapp@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "cachelocations.h"
+
+#include <QtCore/QDir>
+#include <QtCore/QFileInfo>
+#include <QtCore/QStandardPaths>
+
+namespace MulaPluginStarDict
+{
+
+QStringList
+cacheLocations(const QString& completeFilePath, const QString& extension)
+{
+    QStringList result;
+    result.append(completeFilePath + extension);
+
+    QString cacheLocation = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    QFileInfo cacheLocationFileInfo(cacheLocation);
+    QDir cacheLocationDir;
+
+    if (!cacheLocationFileInfo.exists() && cacheLocationDir.mkpath(cacheLocation) == false)
+        return result;
+
+    if (!cacheLocationFileInfo.isDir())
+        return result;
+
+    result.append(cacheLocation + QDir::separator() + "sdcv" + QDir::separator() + QFileInfo(completeFilePath).fileName() + extension);
+    return result;
+}
+
+}
@@ -0,0 +1,43 @@
+/******************************************************************************
+ * This file is part of the Mula project
+ * Copyright (c) 2011 Laszlo Papp <lpapp@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef MULA_PLUGIN_STARDICT_CACHELOCATIONS_H
+#define MULA_PLUGIN_STARDICT_CACHELOCATIONS_H
+
+#include <QtCore/QStringList>
+
+namespace MulaPluginStarDict
+{
+    /**
+     * Returns a string list of the possible locations of a cache file that
+     * belongs to the desired dictionary file. The first location is next to
+     * the dictionary file, the second one is in the ${CACHE_LOCATION}/sdcv/
+     * folder where the cache path is provided by QStandardPaths using the
+     * CacheLocation argument.
+     *
+     * @param   completeFilePath    The complete path of the dictionary file
+     * @param   extension           The extension of the cache file, e.g. ".oft"
+     *
+     * @return  List of the cache locations
+     */
+
+    QStringList cacheLocations(const QString& completeFilePath, const QString& extension);
+}
+
+#endif // MULA_PLUGIN_STARDICT_CACHELOCATIONS_H
@@ -0,0 +1,213 @@
+/******************************************************************************
+ * This file is part of the Mula project
+ * Copyright (c) 2011 Laszlo Papp <lpapp@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "datasearchjob.h"
+
+#include "abstractdictionary.h"
+#include "dictionaryzip.h"
+
+#include <QtCore/QFile>
+#include <QtCore/QMap>
+#include <QtCore/QSemaphore>
+#include <QtCore/QtAlgorithms>
+
+using namespace MulaPluginStarDict;
+
+class DataOffsetLessThan
+{
+    public:
+        DataOffsetLessThan(const QVector<WordEntry>& wordEntries)
+            : m_wordEntries(wordEntries)
+        {
+        }
+
+        bool operator()(int left, int right) const
+        {
+            return m_wordEntries.at(left).dataOffset() < m_wordEntries.at(right).dataOffset();
+        }
+
+    private:
+        const QVector<WordEntry>& m_wordEntries;
+};
+
+class DataSearchJob::Private
+{
+    public:
+        Private()
+            : dictionary(0)
+            , finished(0)
+        {
+        }
+
+        ~Private()
+        {
+        }
+
+        QByteArray read(quint32 offset, quint32 size);
+        QByteArray chunk(int chunkIndex);
+
+        AbstractDictionary *dictionary;
+        QStringList searchWords;
+        QSemaphore *finished;
+
+        QVector<long> indexes;
+        QVector<WordEntry> wordEntries;
+        QVector<long> matchedIndexes;
+
+        // Private file handle and inflated chunks, so that the job never
+        // touches the state shared with the other jobs of the same dictionary
+        QFile file;
+        QMap<int, QByteArray> chunks;
+};
+
+QByteArray
+DataSearchJob::Private::chunk(int chunkIndex)
+{
+    QMap<int, QByteArray>::const_iterator it = chunks.constFind(chunkIndex);
+    if (it != chunks.constEnd())
+        return it.value();
+
+    QByteArray chunkData = dictionary->compressedDictionaryFile()->readChunk(chunkIndex);
+    chunks.insert(chunkIndex, chunkData);
+
+    return chunkData;
+}
+
+QByteArray
+DataSearchJob::Private::read(quint32 offset, quint32 size)
+{
+    DictionaryZip *dictionaryZip = dictionary->compressedDictionaryFile();
+
+    if (dictionaryZip && dictionaryZip->chunkCount() > 0)
+    {
+        quint32 chunkLength = dictionaryZip->chunkLength();
+        quint32 end = offset + size;
+        QByteArray result;
+        result.reserve(size);
+
+        for (quint32 chunkStart = offset - offset % chunkLength; chunkStart < end; chunkStart += chunkLength)
+        {
+            quint32 from = qMax(offset, chunkStart) - chunkStart;
+            quint32 to = qMin(end, chunkStart + chunkLength) - chunkStart;
+            result.append(chunk(chunkStart / chunkLength).mid(from, to - from));
+        }
+
+        return result;
+    }
+
+    if (dictionaryZip)
+        return dictionaryZip->read(offset, size);
+
+    if (!file.isOpen())
+    {
+        file.setFileName(dictionary->dictionaryFile()->fileName());
+        if (!file.open(QIODevice::ReadOnly))
+            return QByteArray();
+    }
+
+    file.seek(offset);
+    return file.read(size);
+}
+
+DataSearchJob::DataSearchJob(AbstractDictionary *dictionary, const QStringList& searchWords, QSemaphore *finished)
+    : d(new Private)
+{
+    d->dictionary = dictionary;
+    d->searchWords = searchWords;
+    d->finished = finished;
+
+    setAutoDelete(false);
+}
+
+DataSearchJob::~DataSearchJob()
+{
+    delete d;
+}
+
+void
+DataSearchJob::addWordEntry(long index, const WordEntry& wordEntry)
+{
+    d->indexes.append(index);
+    d->wordEntries.append(wordEntry);
+}
+
+QVector<long>
+DataSearchJob::matchedIndexes() const
+{
+    return d->matchedIndexes;
+}
+
+void
+DataSearchJob::run()
+{
+    d->matchedIndexes.clear();
+
+    // Visit the entries in data offset order instead of headword order, so
+    // that the data file is streamed through once, chunk by chunk.
+    QVector<int> order(d->wordEntries.size());
+    for (int i = 0; i < order.size(); ++i)
+        order[i] = i;
+
+    qStableSort(order.begin(), order.end(), DataOffsetLessThan(d->wordEntries));
+
+    DictionaryZip *dictionaryZip = d->dictionary->compressedDictionaryFile();
+    int chunkLength = dictionaryZip ? dictionaryZip->chunkLength() : 0;
+
+    bool hasPrevious = false;
+    quint32 previousOffset = 0;
+    quint32 previousSize = 0;
+    bool previousMatched = false;
+
+    foreach (int i, order)
+    {
+        const WordEntry& wordEntry = d->wordEntries.at(i);
+
+        // Several headwords may share the same word data
+        if (hasPrevious && wordEntry.dataOffset() == previousOffset && wordEntry.dataSize() == previousSize)
+        {
+            if (previousMatched)
+                d->matchedIndexes.append(d->indexes.at(i));
+
+            continue;
+        }
+
+        // The chunks before the current entry are never needed again
+        if (chunkLength > 0)
+        {
+            int firstChunk = wordEntry.dataOffset() / chunkLength;
+            while (!d->chunks.isEmpty() && d->chunks.constBegin().key() < firstChunk)
+                d->chunks.erase(d->chunks.begin());
+        }
+
+        QByteArray originalData = d->read(wordEntry.dataOffset(), wordEntry.dataSize());
+
+        hasPrevious = true;
+        previousOffset = wordEntry.dataOffset();
+        previousSize = wordEntry.dataSize();
+        previousMatched = d->dictionary->containData(d->searchWords, originalData);
+
+        if (previousMatched)
+            d->matchedIndexes.append(d->indexes.at(i));
+    }
+
+    d->chunks.clear();
+    d->file.close();
+
+    d->finished->release();
+}
@@ -0,0 +1,110 @@
+/******************************************************************************
+ * This file is part of the Mula project
+ * Copyright (c) 2011 Laszlo Papp <lpapp@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef MULA_PLUGIN_STARDICT_DATASEARCHJOB_H
+#define MULA_PLUGIN_STARDICT_DATASEARCHJOB_H
+
+#include "wordentry.h"
+
+#include <QtCore/QRunnable>
+#include <QtCore/QStringList>
+#include <QtCore/QVector>
+
+class QSemaphore;
+
+namespace MulaPluginStarDict
+{
+    class AbstractDictionary;
+
+    /**
+     * \brief Searches the word data of a range of word entries for the
+     * desired words.
+     *
+     * The job is used for the full-text data search. The word entries of a
+     * dictionary are partitioned along the chunk boundaries of the ".dict.dz"
+     * file, and each partition is processed by a separate job on a thread
+     * pool. Every job uses its own file handle and decompression state, so
+     * the jobs of the same dictionary can run concurrently.
+     *
+     * The job visits its word entries in data offset order rather than in
+     * headword order, so every chunk is inflated only once and the data file
+     * is read sequentially.
+     *
+     * \note The job is not deleted automatically by the thread pool, since the
+     * results need to be fetched after it has finished. The end of the job is
+     * signaled through a semaphore shared by the jobs of the search.
+     *
+     * \see StarDictDictionaryManager::lookupData
+     */
+
+    class DataSearchJob : public QRunnable
+    {
+        public:
+
+            /**
+             * Constructor
+             *
+             * @param dictionary    The dictionary whose data is searched
+             * @param searchWords   The words that all need to be contained by
+             * the word data
+             * @param finished      The semaphore released once the job has
+             * finished
+             */
+
+            DataSearchJob(AbstractDictionary *dictionary, const QStringList& searchWords, QSemaphore *finished);
+
+            /**
+             * Destructor
+             */
+
+            virtual ~DataSearchJob();
+
+            /**
+             * Adds a word entry to the range processed by this job
+             *
+             * @param index         The index of the word entry in the index file
+             * @param wordEntry     The word entry with its data offset and size
+             *
+             * @see matchedIndexes
+             */
+
+            void addWordEntry(long index, const WordEntry& wordEntry);
+
+            /**
+             * Returns the indices of the word entries whose data contain all
+             * the desired words. The indices are not sorted.
+             *
+             * @return The indices of the matched word entries
+             *
+             * @see addWordEntry
+             */
+
+            QVector<long> matchedIndexes() const;
+
+            /** Reimplemented from QRunnable::run() */
+
+            void run();
+
+        private:
+            class Private;
+            Private *const d;
+    };
+}
+
+#endif // MULA_PLUGIN_STARDICT_DATASEARCHJOB_H
@@ -19,21 +19,92 @@
 
 #include "dictionary.h"
 
+#include "bktree.h"
 #include "dictionaryzip.h"
+#include "file.h"
+#include "headwordbloomfilter.h"
+#include "headwordbucketindex.h"
+#include "headwordperfecthash.h"
 #include "stardictdictionaryinfo.h"
 #include "indexfile.h"
 #include "offsetcachefile.h"
-
+#include "phoneticindex.h"
+#include "suffixarrayindex.h"
+#include "symmetricdeleteindex.h"
+#include "trigramindex.h"
+#include "wildcardmatcher.h"
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QHash>
+#include <QtCore/QMutex>
+#include <QtCore/QRunnable>
 #include <QtCore/QScopedPointer>
+#include <QtCore/QSharedPointer>
+#include <QtCore/QThreadPool>
+#include <QtCore/QtAlgorithms>
 #include <QtCore/QFile>
 #include <QtCore/QDebug>
 
+#include <algorithm>
+
 using namespace MulaPluginStarDict;
 
+// Builds a cache index of an index file in the background, and raises the
+// shared flag when it is done, so the dictionary can load it
+template <class Index>
+class IndexBuildJob : public QRunnable
+{
+    public:
+        IndexBuildJob(const QString& indexFilePath, const QSharedPointer<QAtomicInt>& finished)
+            : m_indexFilePath(indexFilePath)
+            , m_finished(finished)
+        {
+        }
+
+        void run()
+        {
+            Index().build(m_indexFilePath);
+            m_finished->storeRelease(1);
+        }
+
+    private:
+        QString m_indexFilePath;
+        QSharedPointer<QAtomicInt> m_finished;
+};
+
+// Loads the cache index of the index file, or starts building it in the
+// background if it is not available yet. The index is only returned once it
+// is loaded.
+template <class Index>
+static const Index*
+backgroundIndex(const QString& indexFilePath, QScopedPointer<Index>& index, QSharedPointer<QAtomicInt>& built)
+{
+    if (index.isNull())
+    {
+        index.reset(new Index);
+        if (!index->load(indexFilePath))
+        {
+            built = QSharedPointer<QAtomicInt>(new QAtomicInt(0));
+            QThreadPool::globalInstance()->start(new IndexBuildJob<Index>(indexFilePath, built));
+        }
+    }
+    else if (!built.isNull() && built->loadAcquire())
+    {
+        // The building has finished, either successfully or not
+        built.clear();
+        index->load(indexFilePath);
+    }
+
+    return index->isLoaded() ? index.data() : 0;
+}
+
 class Dictionary::Private
 {
     public:
-        Private()
+        Private(Dictionary *dictionary)
+            : dictionary(dictionary)
+            , compressed(false)
+            , openFailed(false)
         {
         }
 
@@ -41,12 +112,146 @@ class Dictionary::Private
         {
         }
 
+        bool open();
+        bool openFiles();
+        void closeFiles();
+
+        Dictionary *dictionary;
         StarDictDictionaryInfo dictionaryInfo;
         QScopedPointer<AbstractIndexFile> indexFile;
+        QString indexFilePath;
+        QString dataFilePath;
+        bool compressed;
+
+        // The files are opened on the first use in the lazy mode, which may
+        // happen in concurrent queries
+        QMutex openMutex;
+        QAtomicInt opened;
+        QAtomicInt accessed;
+        bool openFailed;
+
+        // The index file keeps the entry of the last read key in its buffers
+        QMutex indexFileMutex;
+
+        // The cache indices are created on the first use, which may happen
+        // in concurrent queries
+        QMutex indexMutex;
+
+        QScopedPointer<BkTree> bkTree;
+        QSharedPointer<QAtomicInt> bkTreeBuilt;
+        QScopedPointer<HeadwordBloomFilter> headwordBloomFilter;
+        QSharedPointer<QAtomicInt> headwordBloomFilterBuilt;
+        QScopedPointer<HeadwordBucketIndex> headwordBucketIndex;
+        QScopedPointer<HeadwordPerfectHash> headwordPerfectHash;
+        QSharedPointer<QAtomicInt> headwordPerfectHashBuilt;
+        QScopedPointer<SymmetricDeleteIndex> symmetricDeleteIndex;
+        QSharedPointer<QAtomicInt> symmetricDeleteIndexBuilt;
+        QScopedPointer<PhoneticIndex> phoneticIndex;
+        QSharedPointer<QAtomicInt> phoneticIndexBuilt;
+        QScopedPointer<TrigramIndex> trigramIndex;
+        QSharedPointer<QAtomicInt> trigramIndexBuilt;
+        QScopedPointer<SuffixArrayIndex> suffixArrayIndex;
+        QSharedPointer<QAtomicInt> suffixArrayIndexBuilt;
+
+        static const int minimumIndexedRangeSize = 1024; // the narrowest range of headwords searched with the suffix array
 };
 
+// Opens the files on the first use, and marks the dictionary used for the
+// idle check
+bool
+Dictionary::Private::open()
+{
+    accessed.storeRelease(1);
+
+    if (opened.loadAcquire())
+        return true;
+
+    QMutexLocker locker(&openMutex);
+    if (opened.loadAcquire())
+        return true;
+
+    if (openFailed)
+        return false;
+
+    if (!openFiles())
+    {
+        closeFiles();
+        openFailed = true;
+        return false;
+    }
+
+    opened.storeRelease(1);
+    return true;
+}
+
+bool
+Dictionary::Private::openFiles()
+{
+    if (compressed)
+    {
+        DictionaryZip *dictionaryZip = new DictionaryZip;
+        if (!dictionaryZip->open(dataFilePath, 0))
+        {
+            qDebug() << "Failed to open file:" << dataFilePath;
+            delete dictionaryZip;
+            return false;
+        }
+
+        dictionary->setCompressedDictionaryFile(dictionaryZip);
+    }
+    else
+    {
+        dictionary->dictionaryFile()->setFileName(dataFilePath);
+        if (!dictionary->dictionaryFile()->open(QIODevice::ReadOnly))
+        {
+            qDebug() << "Failed to open file:" << dataFilePath;
+            return false;
+        }
+    }
+
+    if (indexFilePath.endsWith(QLatin1String(".gz")))
+        indexFile.reset(new IndexFile);
+    else
+        indexFile.reset(new OffsetCacheFile);
+
+    if (!indexFile->load(indexFilePath))
+    {
+        qDebug() << "Failed to load the index file:" << indexFilePath;
+        return false;
+    }
+
+    return true;
+}
+
+// Releases the files and the cache indices, the background index builds
+// finish on their own and the caches are loaded again on the next use
+void
+Dictionary::Private::closeFiles()
+{
+    QMutexLocker locker(&indexMutex);
+    indexFile.reset();
+    bkTree.reset();
+    bkTreeBuilt.clear();
+    headwordBloomFilter.reset();
+    headwordBloomFilterBuilt.clear();
+    headwordPerfectHash.reset();
+    headwordPerfectHashBuilt.clear();
+    headwordBucketIndex.reset();
+    symmetricDeleteIndex.reset();
+    symmetricDeleteIndexBuilt.clear();
+    phoneticIndex.reset();
+    phoneticIndexBuilt.clear();
+    trigramIndex.reset();
+    trigramIndexBuilt.clear();
+    suffixArrayIndex.reset();
+    suffixArrayIndexBuilt.clear();
+
+    dictionary->dictionaryFile()->close();
+    dictionary->setCompressedDictionaryFile(0);
+}
+
 Dictionary::Dictionary()
-    : d(new Private)
+    : d(new Private(this))
 {
 }
 
@@ -75,28 +280,50 @@ Dictionary::ifoFilePath() const
 QString
 Dictionary::key(long index) const
 {
-    if (d->indexFile.isNull())
+    if (!d->open())
         return QString();
 
+    QMutexLocker locker(&d->indexFileMutex);
     return d->indexFile->key(index);
 }
 
+QByteArray
+Dictionary::utf8Key(long index) const
+{
+    if (!d->open())
+        return QByteArray();
+
+    QMutexLocker locker(&d->indexFileMutex);
+    return d->indexFile->key(index);
+}
+
+AbstractIndexFile*
+Dictionary::createIndexReader() const
+{
+    if (!d->open())
+        return 0;
+
+    QMutexLocker locker(&d->indexFileMutex);
+    return d->indexFile->createReader();
+}
+
 QString
 Dictionary::data(long index)
 {
-    Q_UNUSED(index);
-    if (d->indexFile.isNull())
+    WordEntry entry = wordEntry(index);
+    if (entry.data().isEmpty())
         return QString();
 
-    return AbstractDictionary::wordData(d->indexFile->wordEntryOffset(), d->indexFile->wordEntrySize());
+    return AbstractDictionary::wordData(entry.dataOffset(), entry.dataSize());
 }
 
 WordEntry
 Dictionary::wordEntry(long index)
 {
-    if (d->indexFile.isNull())
+    if (!d->open())
         return WordEntry();
 
+    QMutexLocker locker(&d->indexFileMutex);
     WordEntry wordEntry;
     wordEntry.setData(d->indexFile->key(index));
     wordEntry.setDataOffset(d->indexFile->wordEntryOffset());
@@ -108,72 +335,287 @@ Dictionary::wordEntry(long index)
 int
 Dictionary::lookup(const QString& word)
 {
-    if (d->indexFile.isNull())
-        return -1;
+    if (!d->open())
+        return invalidIndex;
 
+    // Most of the probed words are missing, which the filter tells without
+    // touching the index file
+    const HeadwordBloomFilter *filter = headwordBloomFilter();
+    if (filter && !filter->mayContain(word))
+        return invalidIndex;
+
+    const HeadwordPerfectHash *perfectHash = headwordPerfectHash();
+    if (perfectHash)
+    {
+        int index = perfectHash->find(word);
+        if (index == invalidIndex)
+            return invalidIndex;
+
+        // The exact match is among the ASCII case variants starting at the
+        // index, a headword of another spelling only shows up on a hash
+        // collision
+        QString foldedWord = asciiCaseFolded(word);
+        int first = index;
+        for (int count = articleCount(); index < count; ++index)
+        {
+            QString headword = key(index);
+            if (headword == word)
+                return index;
+
+            if (asciiCaseFolded(headword) != foldedWord)
+                break;
+        }
+
+        if (index > first)
+            return invalidIndex;
+    }
+
+    QMutexLocker locker(&d->indexFileMutex);
     return d->indexFile->lookup(word.toUtf8());
 }
 
-bool
-Dictionary::load(const QString& ifoFilePath)
+// Orders the positions of the words to look up in the index order
+class WordPositionLessThan
 {
-    if (!loadIfoFile(ifoFilePath))
-        return false;
-
-    QString completeFilePath = ifoFilePath;
-    completeFilePath.replace(completeFilePath.length() - sizeof("ifo") + 1, sizeof("ifo") - 1, "dict.dz");
-
-    if (QFile(completeFilePath).exists())
-    {
-        DictionaryZip *dictionaryZip = compressedDictionaryFile();
-        if (!dictionaryZip)
+    public:
+        WordPositionLessThan(const QStringList& words)
+            : m_words(words)
         {
-            delete dictionaryZip;
-            dictionaryZip = 0;
         }
 
-        dictionaryZip = new DictionaryZip();
-        if (!dictionaryZip->open(completeFilePath, 0))
+        bool operator()(int position1, int position2) const
         {
-            qDebug() << "Failed to open file:" << completeFilePath;
-            return false;
+            return stardictStringCompare(m_words.at(position1), m_words.at(position2)) < 0;
         }
+
+    private:
+        const QStringList& m_words;
+};
+
+QVector<int>
+Dictionary::lookupBatch(const QStringList& words)
+{
+    QVector<int> indexList(words.size(), invalidIndex);
+    if (!d->open() || words.isEmpty())
+        return indexList;
+
+    // Every lookup is a hash with the perfect hash table, the order of the
+    // words does not matter then
+    if (headwordPerfectHash())
+    {
+        for (int i = 0; i < words.size(); ++i)
+            indexList[i] = lookup(words.at(i));
+
+        return indexList;
     }
-    else
+
+    // Only the possible hits are searched in the index
+    const HeadwordBloomFilter *filter = headwordBloomFilter();
+    QVector<int> positions;
+    for (int i = 0; i < words.size(); ++i)
     {
-        completeFilePath.chop(sizeof(".dz"));
+        if (!filter || filter->mayContain(words.at(i)))
+            positions.append(i);
+    }
+
+    qStableSort(positions.begin(), positions.end(), WordPositionLessThan(words));
 
-        QFile *uncompressedDictionaryFile = dictionaryFile();
-        if (uncompressedDictionaryFile)
+    int wordCount = articleCount();
+    int first = 0;
+    foreach (int position, positions)
+    {
+        const QString& word = words.at(position);
+
+        // Gallop from the lower bound of the previous word to find the range
+        // of the lower bound of this one
+        int step = 1;
+        int last = first;
+        while (last < wordCount && stardictStringCompare(key(last), word) < 0)
         {
-            delete uncompressedDictionaryFile;
-            uncompressedDictionaryFile = 0;
+            first = last + 1;
+            last += step;
+            step *= 2;
         }
 
-        uncompressedDictionaryFile = new QFile(completeFilePath);
-        if( uncompressedDictionaryFile->open( QIODevice::ReadOnly ) )
+        if (last > wordCount)
+            last = wordCount;
+
+        int count = last - first;
+        while (count > 0)
         {
-            qDebug() << "Failed to open file:" << completeFilePath;
-            return -1;
+            int half = count / 2;
+            if (stardictStringCompare(key(first + half), word) < 0)
+            {
+                first += half + 1;
+                count -= half + 1;
+            }
+            else
+            {
+                count = half;
+            }
         }
+
+        if (first == wordCount)
+            break;
+
+        if (stardictStringCompare(key(first), word) == 0)
+            indexList[position] = first;
     }
 
-    completeFilePath = ifoFilePath;
-    completeFilePath.replace(completeFilePath.length() - sizeof("ifo") + 1, sizeof("ifo") - 1, "idx.gz");
+    return indexList;
+}
+
+const BkTree*
+Dictionary::bkTree()
+{
+    if (!d->open())
+        return 0;
+
+    QMutexLocker locker(&d->indexMutex);
+    return backgroundIndex(d->indexFilePath, d->bkTree, d->bkTreeBuilt);
+}
 
-    if (QFile(completeFilePath).exists())
+const HeadwordBucketIndex*
+Dictionary::headwordBucketIndex()
+{
+    if (!d->open())
+        return 0;
+
+    QMutexLocker locker(&d->indexMutex);
+
+    if (d->headwordBucketIndex.isNull())
     {
-        d->indexFile.reset(new IndexFile);
+        d->headwordBucketIndex.reset(new HeadwordBucketIndex);
+        if (!d->headwordBucketIndex->load(d->indexFilePath) && !d->headwordBucketIndex->build(d->indexFilePath))
+            qDebug() << "Failed to build the bucket index for" << d->indexFilePath;
     }
-    else
+
+    return d->headwordBucketIndex->isLoaded() ? d->headwordBucketIndex.data() : 0;
+}
+
+const SymmetricDeleteIndex*
+Dictionary::symmetricDeleteIndex()
+{
+    if (!d->open())
+        return 0;
+
+    QMutexLocker locker(&d->indexMutex);
+    return backgroundIndex(d->indexFilePath, d->symmetricDeleteIndex, d->symmetricDeleteIndexBuilt);
+}
+
+const PhoneticIndex*
+Dictionary::phoneticIndex()
+{
+    if (!d->open())
+        return 0;
+
+    QMutexLocker locker(&d->indexMutex);
+    return backgroundIndex(d->indexFilePath, d->phoneticIndex, d->phoneticIndexBuilt);
+}
+
+const TrigramIndex*
+Dictionary::trigramIndex()
+{
+    if (!d->open())
+        return 0;
+
+    QMutexLocker locker(&d->indexMutex);
+    return backgroundIndex(d->indexFilePath, d->trigramIndex, d->trigramIndexBuilt);
+}
+
+const HeadwordPerfectHash*
+Dictionary::headwordPerfectHash()
+{
+    if (!d->open())
+        return 0;
+
+    QMutexLocker locker(&d->indexMutex);
+    return backgroundIndex(d->indexFilePath, d->headwordPerfectHash, d->headwordPerfectHashBuilt);
+}
+
+const HeadwordBloomFilter*
+Dictionary::headwordBloomFilter()
+{
+    if (!d->open())
+        return 0;
+
+    QMutexLocker locker(&d->indexMutex);
+    return backgroundIndex(d->indexFilePath, d->headwordBloomFilter, d->headwordBloomFilterBuilt);
+}
+
+const SuffixArrayIndex*
+Dictionary::suffixArrayIndex()
+{
+    if (!d->open())
+        return 0;
+
+    QMutexLocker locker(&d->indexMutex);
+    return backgroundIndex(d->indexFilePath, d->suffixArrayIndex, d->suffixArrayIndexBuilt);
+}
+
+bool
+Dictionary::load(const QString& ifoFilePath, bool lazy)
+{
+    close();
+
+    if (!loadIfoFile(ifoFilePath))
+        return false;
+
+    QString basePath = ifoFilePath;
+    basePath.chop(sizeof("ifo") - 1);
+
+    d->compressed = QFile::exists(basePath + "dict.dz");
+    d->dataFilePath = basePath + (d->compressed ? "dict.dz" : "dict");
+    if (!d->compressed && !QFile::exists(d->dataFilePath))
     {
-        completeFilePath.chop(sizeof(".gz"));
-        d->indexFile.reset(new OffsetCacheFile);
+        qDebug() << "Missing the dictionary file of" << ifoFilePath;
+        return false;
     }
 
-    if (!d->indexFile->load(completeFilePath))
+    d->indexFilePath = basePath + (QFile::exists(basePath + "idx.gz") ? "idx.gz" : "idx");
+    if (!QFile::exists(d->indexFilePath))
+    {
+        qDebug() << "Missing the index file of" << ifoFilePath;
         return false;
+    }
+
+    d->openFailed = false;
 
+    return lazy || d->open();
+}
+
+bool
+Dictionary::open()
+{
+    return d->open();
+}
+
+bool
+Dictionary::isOpen() const
+{
+    return d->opened.loadAcquire();
+}
+
+void
+Dictionary::close()
+{
+    QMutexLocker locker(&d->openMutex);
+    if (!d->opened.loadAcquire())
+        return;
+
+    d->closeFiles();
+    d->opened.storeRelease(0);
+    d->accessed.storeRelease(0);
+}
+
+bool
+Dictionary::closeIfIdle()
+{
+    // The dictionary used since the previous check gets another period
+    if (!isOpen() || d->accessed.fetchAndStoreAcquire(0))
+        return false;
+
+    close();
     return true;
 }
 
@@ -191,17 +633,167 @@ Dictionary::loadIfoFile(const QString& ifoFilePath)
     return true;
 }
 
+// Returns whether the literal prefix of a pattern consists of ASCII
+// characters only
+static bool
+isAscii(const QByteArray& prefix)
+{
+    for (int i = 0; i < prefix.size(); ++i)
+    {
+        if (uchar(prefix.at(i)) >= 0x80)
+            return false;
+    }
+
+    return true;
+}
+
+// Returns the index of the first headword that does not start with a string
+// less than the ASCII prefix. The index file compares only the ASCII letters
+// case-insensitively, so the UTF-8 keys are compared the same way.
+static int
+asciiPrefixLowerBound(const Dictionary *dictionary, const QByteArray& prefix)
+{
+    int first = 0;
+    int count = dictionary->articleCount();
+
+    while (count > 0)
+    {
+        int step = count / 2;
+        if (qstrnicmp(dictionary->utf8Key(first + step).constData(), prefix.constData(), prefix.size()) < 0)
+        {
+            first += step + 1;
+            count -= step + 1;
+        }
+        else
+        {
+            count = step;
+        }
+    }
+
+    return first;
+}
+
+// Returns the index after the last headword starting with the ASCII prefix,
+// regardless of the case of its ASCII letters
+static int
+asciiPrefixUpperBound(const Dictionary *dictionary, const QByteArray& prefix, int first)
+{
+    int count = dictionary->articleCount() - first;
+
+    while (count > 0)
+    {
+        int step = count / 2;
+        if (!qstrnicmp(dictionary->utf8Key(first + step).constData(), prefix.constData(), prefix.size()))
+        {
+            first += step + 1;
+            count -= step + 1;
+        }
+        else
+        {
+            count = step;
+        }
+    }
+
+    return first;
+}
+
+struct DataRequest
+{
+    int index;
+    quint32 offset;
+    quint32 size;
+};
+
+// Orders the word data to read in the order of the data file
+class DataRequestLessThan
+{
+    public:
+        bool operator()(const DataRequest& request1, const DataRequest& request2) const
+        {
+            return request1.offset < request2.offset;
+        }
+};
+
+QVector<QByteArray>
+Dictionary::dataBatch(const QVector<int>& indices)
+{
+    QVector<QByteArray> dataList(indices.size());
+    if (!d->open() || indices.isEmpty())
+        return dataList;
+
+    QVector<int> sortedIndices;
+    int wordCount = articleCount();
+    foreach (int index, indices)
+    {
+        if (index >= 0 && index < wordCount)
+            sortedIndices.append(index);
+    }
+
+    qSort(sortedIndices);
+    sortedIndices.erase(std::unique(sortedIndices.begin(), sortedIndices.end()), sortedIndices.end());
+
+    QVector<DataRequest> requests;
+    requests.reserve(sortedIndices.size());
+    foreach (int index, sortedIndices)
+    {
+        WordEntry entry = wordEntry(index);
+        DataRequest request = { index, entry.dataOffset(), entry.dataSize() };
+        requests.append(request);
+    }
+
+    qSort(requests.begin(), requests.end(), DataRequestLessThan());
+
+    QHash<int, QByteArray> dataHash;
+    dataHash.reserve(requests.size());
+    foreach (const DataRequest& request, requests)
+        dataHash.insert(request.index, wordData(request.offset, request.size));
+
+    for (int i = 0; i < indices.size(); ++i)
+        dataList[i] = dataHash.value(indices.at(i));
+
+    return dataList;
+}
+
 QVector<int>
 Dictionary::lookupPattern(const QString& pattern, int maximumIndexListSize)
 {
     QVector<int> indexList;
+    WildcardMatcher matcher(pattern);
+
+    // The matching headwords start with the literal prefix of the pattern.
+    // The headwords sharing an ASCII prefix in any case are in a single
+    // range of the index, while the case variants of the other letters are
+    // spread over it, so only an ASCII prefix narrows the range.
+    int first = 0;
+    int last = articleCount();
+
+    QByteArray prefix = matcher.literalPrefix();
+    if (!prefix.isEmpty() && isAscii(prefix))
+    {
+        first = asciiPrefixLowerBound(this, prefix);
+        last = asciiPrefixUpperBound(this, prefix, first);
+    }
 
-    QRegExp rx(pattern);
-    rx.setPatternSyntax(QRegExp::Wildcard);
+    // Only check the headwords containing the longest literal part of the
+    // pattern when the suffix array is available and the range is not
+    // narrow already
+    QVector<quint32> candidates;
+    const SuffixArrayIndex *suffixArrayIndex = last - first >= Private::minimumIndexedRangeSize ? this->suffixArrayIndex() : 0;
+    if (suffixArrayIndex && suffixArrayIndex->patternCandidates(pattern, candidates))
+    {
+        const quint32 *it = qLowerBound(candidates.constBegin(), candidates.constEnd(), quint32(first));
+        for (; it != candidates.constEnd() && int(*it) < last && indexList.size() < maximumIndexListSize - 1; ++it)
+        {
+            if (matcher.exactMatch(utf8Key(*it)))
+                indexList.append(*it);
+        }
+
+        return indexList;
+    }
 
-    for (int i = 0; i < articleCount() && indexList.size() < maximumIndexListSize - 1; ++i)
+    for (int i = first; i < last && indexList.size() < maximumIndexListSize - 1; ++i)
     {
-        if (rx.exactMatch(key(i)))
+        if (matcher.exactMatch(utf8Key(i)))
             indexList.append(i);
     }
 
@@ -28,6 +28,16 @@
 
 namespace MulaPluginStarDict
 {
+    class AbstractIndexFile;
+    class BkTree;
+    class HeadwordBloomFilter;
+    class HeadwordBucketIndex;
+    class HeadwordPerfectHash;
+    class PhoneticIndex;
+    class SuffixArrayIndex;
+    class SymmetricDeleteIndex;
+    class TrigramIndex;
+
     class Dictionary : public AbstractDictionary
     {
         public:
@@ -45,14 +55,69 @@ namespace MulaPluginStarDict
             virtual ~Dictionary();
 
             /**
-             * Loads the ".ifo" file
+             * Loads the ".ifo" file, and opens the data and the index files
+             * unless the lazy mode is requested. In the lazy mode, the files
+             * are only checked for existence, and they are opened on the
+             * first use, i.e. by the first method needing them.
              *
-             * @param ifoFilePath Path of the ".ifo" file
+             * @param ifoFilePath   Path of the ".ifo" file
+             * @param lazy          Whether to postpone opening the files
              *
              * @return True if the loading was successful, otherwise false.
+             *
+             * @see open, close
+             */
+
+            bool load(const QString& ifoFilePath, bool lazy = false);
+
+            /**
+             * Opens the data and the index files of the dictionary unless
+             * they are open already. The methods needing the files call it,
+             * so it only needs to be called explicitly to access the data
+             * files directly.
+             *
+             * @return True if the files are open, otherwise false.
+             *
+             * @see close, isOpen
+             */
+
+            bool open();
+
+            /**
+             * Closes the data and the index files, and releases the cache
+             * indices. The dictionary remains usable, the files are opened
+             * again on the next use.
+             *
+             * \note The method must not be called while the dictionary is
+             * being used by another thread.
+             *
+             * @see open, closeIfIdle
+             */
+
+            void close();
+
+            /**
+             * Closes the dictionary if it has not been used since the previous
+             * call of this method, otherwise marks it unused. Calling it
+             * periodically closes the dictionaries that are idle for at least
+             * a period.
+             *
+             * @return True if the dictionary has been closed, otherwise false.
+             *
+             * @see close
+             */
+
+            bool closeIfIdle();
+
+            /**
+             * Returns whether the data and the index files are open
+             *
+             * @return True if the files are open, otherwise false.
+             *
+             * @see open
              */
 
-            bool load(const QString& ifoFilePath);
+            bool isOpen() const;
 
             /**
              * Returns the count of the word entries in the ".idx" file.
@@ -97,6 +162,33 @@ namespace MulaPluginStarDict
 
             QString key(long index) const;
 
+            /**
+             * Returns the UTF-8 encoded word according to the relevant index
+             * as stored in the index file, without converting it
+             *
+             * @param   index   The index of the desired word
+             *
+             * @return  The UTF-8 encoded word
+             *
+             * @see key
+             */
+
+            QByteArray utf8Key(long index) const;
+
+            /**
+             * Returns a new reader of the loaded index file that can be used
+             * from another thread, e.g. to search the headwords concurrently.
+             *
+             * \note The caller takes the ownership of the returned object.
+             *
+             * @return The new reader of the index file, or NULL if the index
+             * file is not loaded
+             *
+             * @see utf8Key
+             */
+
+            AbstractIndexFile* createIndexReader() const;
+
             /**
              * Returns the desired word data of the dictionary with all its
              * fields
@@ -137,10 +229,46 @@ namespace MulaPluginStarDict
              *
              * @return The index where the desired word occurs among the word
              * entries, or -1 if there is no such a word.
+             *
+             * @see headwordBloomFilter, headwordPerfectHash
              */
 
             int lookup(const QString& word);
 
+            /**
+             * Returns the indices of the given words in a single pass over
+             * the sorted headwords. The words are looked up in the index
+             * order, and each search continues from the position of the
+             * previous word by galloping, so close words, e.g. the inflected
+             * forms of the same word, only cost a few comparisons.
+             *
+             * @param   words   The words to look up
+             *
+             * @return The indices of the words in the order of the given
+             * words, -1 for the words that are not found
+             *
+             * @see lookup
+             */
+
+            QVector<int> lookupBatch(const QStringList& words);
+
+            /**
+             * Returns the word data of the given indices. The word entries are
+             * fetched in the index order, and the data is read in the order
+             * of the offsets, so every chunk of a compressed data file is
+             * inflated at most once, and an uncompressed file is read
+             * sequentially. The duplicate indices are read once.
+             *
+             * @param   indices The indices of the desired words
+             *
+             * @return The word data in the order of the given indices, empty
+             * for invalid indices
+             *
+             * @see data, lookupBatch
+             */
+
+            QVector<QByteArray> dataBatch(const QVector<int>& indices);
+
             /**
              * Returns the list of indices matched against the desired word data
              * pattern in the dictionary. Note, this method returns maximum
@@ -157,6 +285,106 @@ namespace MulaPluginStarDict
 
             QVector<int> lookupPattern(const QString& pattern, int maximumIndexListSize);
 
+            /**
+             * Returns the BK-tree over the headwords of the dictionary for
+             * fuzzy searching. The tree is loaded and built the same way as
+             * the symmetric delete index.
+             *
+             * @return The BK-tree, or NULL if it is not available yet
+             *
+             * @see symmetricDeleteIndex
+             */
+
+            const BkTree* bkTree();
+
+            /**
+             * Returns the index of the headwords grouped by length and
+             * boundary letters for fuzzy searching. The index is loaded from
+             * the cache file when available, otherwise it is built and saved
+             * on the first call.
+             *
+             * @return The bucket index, or NULL if it is not available
+             */
+
+            const HeadwordBucketIndex* headwordBucketIndex();
+
+            /**
+             * Returns the symmetric delete index of the headwords for spelling
+             * suggestions. The index is loaded from the cache file when
+             * available, otherwise it is built in the background on the first
+             * call, and it becomes available on a later call once the building
+             * has finished.
+             *
+             * @return The symmetric delete index, or NULL if it is not
+             * available yet
+             */
+
+            const SymmetricDeleteIndex* symmetricDeleteIndex();
+
+            /**
+             * Returns the phonetic key index of the headwords for sound-alike
+             * suggestions. The index is loaded and built the same way as the
+             * symmetric delete index.
+             *
+             * @return The phonetic index, or NULL if it is not available yet
+             *
+             * @see symmetricDeleteIndex
+             */
+
+            const PhoneticIndex* phoneticIndex();
+
+            /**
+             * Returns the trigram index of the headwords for similarity
+             * queries. The index is optional, it is only built in the
+             * background on the first call, hence only the dictionaries that
+             * are actually searched this way pay for it.
+             *
+             * @return The trigram index, or NULL if it is not available yet
+             *
+             * @see symmetricDeleteIndex
+             */
+
+            const TrigramIndex* trigramIndex();
+
+            /**
+             * Returns the suffix array of the headwords for infix and suffix
+             * wildcard queries. The index is optional and it is built the same
+             * way as the trigram index.
+             *
+             * @return The suffix array, or NULL if it is not available yet
+             *
+             * @see trigramIndex
+             */
+
+            const SuffixArrayIndex* suffixArrayIndex();
+
+            /**
+             * Returns the Bloom filter of the headwords, which lets the
+             * lookups reject the missing words without searching the index
+             * file. The filter is built the same way as the symmetric delete
+             * index, and the lookups search the index file until it is
+             * available.
+             *
+             * @return The Bloom filter, or NULL if it is not available yet
+             *
+             * @see lookup, lookupBatch
+             */
+
+            const HeadwordBloomFilter* headwordBloomFilter();
+
+            /**
+             * Returns the minimal perfect hash table of the headwords, which
+             * turns the exact lookups into a hash and a compare. The table is
+             * built the same way as the Bloom filter.
+             *
+             * @return The perfect hash table, or NULL if it is not available
+             * yet
+             *
+             * @see lookup, headwordBloomFilter
+             */
+
+            const HeadwordPerfectHash* headwordPerfectHash();
+
         private:
             /**
              * Loads the ".ifo" file while marking the dictionary non-tree one
@@ -0,0 +1,560 @@
+/******************************************************************************
+ * This file is part of the Mula project
+ * Copyright (c) 2011 Laszlo Papp <lpapp@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "dictionarycatalog.h"
+
+#include "stardictdictionaryinfo.h"
+
+#include <QtCore/QDataStream>
+
+#include <QtCore/QDateTime>
+#include <QtCore/QDir>
+#include <QtCore/QFileInfo>
+#include <QtCore/QFileSystemWatcher>
+#include <QtCore/QHash>
+#include <QtCore/QSaveFile>
+#include <QtCore/QSet>
+#include <QtCore/QStandardPaths>
+#include <QtCore/QDebug>
+
+using namespace MulaPluginStarDict;
+
+struct CatalogDirectory
+{
+    QStringList entries;            // The ".ifo" files and the subdirectories in the listing order
+    QSet<QString> subdirectories;
+};
+
+struct CatalogEntry
+{
+    CatalogEntry()
+        : valid(false)
+        , wordCount(0)
+        , indexFileSize(0)
+        , indexOffsetBits(0)
+    {
+    }
+
+    QByteArray signature;
+    bool valid;                     // Whether the ".ifo" file could be parsed
+    QString bookName;
+    quint32 wordCount;
+    QString author;
+    QString email;
+    QString website;
+    QString dateTime;
+    QString description;
+    quint32 indexFileSize;
+    quint32 indexOffsetBits;
+    QString sameTypeSequence;
+};
+
+static QDataStream&
+operator<<(QDataStream& stream, const CatalogEntry& entry)
+{
+    return stream << entry.signature << entry.valid << entry.bookName << entry.wordCount
+                  << entry.author << entry.email << entry.website << entry.dateTime
+                  << entry.description << entry.indexFileSize << entry.indexOffsetBits
+                  << entry.sameTypeSequence;
+}
+
+static QDataStream&
+operator>>(QDataStream& stream, CatalogEntry& entry)
+{
+    return stream >> entry.signature >> entry.valid >> entry.bookName >> entry.wordCount
+                  >> entry.author >> entry.email >> entry.website >> entry.dateTime
+                  >> entry.description >> entry.indexFileSize >> entry.indexOffsetBits
+                  >> entry.sameTypeSequence;
+}
+
+class DictionaryCatalog::Private
+{
+    public:
+        Private()
+            : cacheMagicString("StarDict's Dictionary Catalog, Version: 0.1")
+            , cacheLoaded(false)
+            , cacheModified(false)
+            , bookNamesModified(true)
+        {
+        }
+
+        ~Private()
+        {
+        }
+
+        static QString normalizedPath(const QString& path);
+        static QByteArray signature(const QString& ifoFilePath);
+        static CatalogDirectory list(const QString& directoryName);
+
+        CatalogEntry parse(const QString& ifoFilePath);
+        void collect(const QString& directoryName, QStringList& ifoFilePaths) const;
+        void loadCache();
+        void saveCache();
+
+        const QByteArray cacheMagicString;
+        QString cacheFilePath;
+        bool cacheLoaded;
+        bool cacheModified;
+
+        // The entries of the cache file, they are taken over by the scans
+        // while the files of the dictionary have not changed
+        QHash<QString, CatalogEntry> cachedEntries;
+
+        QFileSystemWatcher watcher;
+        QStringList directoryList;
+        QHash<QString, CatalogDirectory> directories;
+        QHash<QString, CatalogEntry> entries;
+
+        // The first dictionary with the book name in the order of the
+        // directories, rebuilt on the next query after a change
+        QHash<QString, QString> bookNames;
+        bool bookNamesModified;
+};
+
+QString
+DictionaryCatalog::Private::normalizedPath(const QString& path)
+{
+    return QDir::cleanPath(QFileInfo(path).absoluteFilePath());
+}
+
+// The sizes and the modification times of the files of the dictionary, so a
+// replaced index or data file is noticed as well
+QByteArray
+DictionaryCatalog::Private::signature(const QString& ifoFilePath)
+{
+    static const char *const suffixes[] = { "ifo", "idx", "idx.gz", "dict", "dict.dz" };
+
+    QString basePath = ifoFilePath;
+    basePath.chop(sizeof("ifo") - 1);
+
+    QByteArray result;
+    for (unsigned int i = 0; i < sizeof(suffixes) / sizeof(suffixes[0]); ++i)
+    {
+        QFileInfo fileInfo(basePath + suffixes[i]);
+        if (fileInfo.exists())
+            result += QByteArray::number(fileInfo.size()) + ':' + QByteArray::number(fileInfo.lastModified().toMSecsSinceEpoch());
+
+        result += ';';
+    }
+
+    return result;
+}
+
+CatalogEntry
+DictionaryCatalog::Private::parse(const QString& ifoFilePath)
+{
+    if (!cacheLoaded)
+        loadCache();
+
+    // Only the files are checked while they have not changed
+    QByteArray ifoSignature = signature(ifoFilePath);
+    QHash<QString, CatalogEntry>::const_iterator it = cachedEntries.constFind(ifoFilePath);
+    if (it != cachedEntries.constEnd() && it->signature == ifoSignature)
+        return *it;
+
+    cacheModified = true;
+
+    CatalogEntry entry;
+    entry.signature = ifoSignature;
+
+    StarDictDictionaryInfo info;
+    if (info.loadFromIfoFile(ifoFilePath))
+    {
+        entry.valid = true;
+        entry.bookName = info.bookName();
+        entry.wordCount = info.wordCount();
+        entry.author = info.author();
+        entry.email = info.email();
+        entry.website = info.website();
+        entry.dateTime = info.dateTime();
+        entry.description = info.description();
+        entry.indexFileSize = info.indexFileSize();
+        entry.indexOffsetBits = info.indexOffsetBits();
+        entry.sameTypeSequence = info.sameTypeSequence();
+    }
+
+    return entry;
+}
+
+void
+DictionaryCatalog::Private::loadCache()
+{
+    cacheLoaded = true;
+
+    QFile file(cacheFilePath);
+    if (cacheFilePath.isEmpty() || !file.open(QIODevice::ReadOnly))
+        return;
+
+    if (file.read(cacheMagicString.size()) != cacheMagicString)
+        return;
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
+
+    QHash<QString, CatalogEntry> loadedEntries;
+    stream >> loadedEntries;
+
+    if (stream.status() != QDataStream::Ok)
+    {
+        qDebug() << "Ignoring the corrupt catalog cache" << cacheFilePath;
+        return;
+    }
+
+    cachedEntries = loadedEntries;
+}
+
+void
+DictionaryCatalog::Private::saveCache()
+{
+    // The cache is kept up to date with the entries of the catalog
+    cachedEntries = entries;
+
+    if (!cacheModified || cacheFilePath.isEmpty())
+        return;
+
+    QDir().mkpath(QFileInfo(cacheFilePath).absolutePath());
+
+    QSaveFile file(cacheFilePath);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        qDebug() << "Failed to open file for writing:" << cacheFilePath;
+        return;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
+
+    file.write(cacheMagicString);
+    stream << entries;
+
+    if (stream.status() != QDataStream::Ok || !file.commit())
+        return;
+
+    cacheModified = false;
+    qDebug() << "Save to cache" << cacheFilePath;
+}
+
+CatalogDirectory
+DictionaryCatalog::Private::list(const QString& directoryName)
+{
+    CatalogDirectory directory;
+
+    foreach (const QFileInfo& entryFileInfo, QDir(directoryName).entryInfoList(QDir::AllEntries | QDir::NoDotAndDotDot))
+    {
+        QString absolutePath = entryFileInfo.absoluteFilePath();
+
+        if (entryFileInfo.isDir())
+        {
+            directory.entries.append(absolutePath);
+            directory.subdirectories.insert(absolutePath);
+        }
+        else if (absolutePath.endsWith(QLatin1String(".ifo")))
+        {
+            directory.entries.append(absolutePath);
+        }
+    }
+
+    return directory;
+}
+
+void
+DictionaryCatalog::Private::collect(const QString& directoryName, QStringList& ifoFilePaths) const
+{
+    QHash<QString, CatalogDirectory>::const_iterator it = directories.constFind(directoryName);
+    if (it == directories.constEnd())
+        return;
+
+    foreach (const QString& entry, it->entries)
+    {
+        if (it->subdirectories.contains(entry))
+            collect(entry, ifoFilePaths);
+        else
+            ifoFilePaths.append(entry);
+    }
+}
+
+DictionaryCatalog::DictionaryCatalog(QObject *parent)
+    : QObject(parent)
+    , d(new Private)
+{
+    d->cacheFilePath = QStandardPaths::writableLocation(QStandardPaths::CacheLocation)
+                       + QDir::separator() + "sdcv" + QDir::separator() + "dictionarycatalog.cache";
+
+    connect(&d->watcher, SIGNAL(directoryChanged(QString)), SLOT(rescanDirectory(QString)));
+    connect(&d->watcher, SIGNAL(fileChanged(QString)), SLOT(rescanIfoFile(QString)));
+}
+
+DictionaryCatalog::~DictionaryCatalog()
+{
+    delete d;
+}
+
+void
+DictionaryCatalog::setDirectories(const QStringList& directoryList)
+{
+    QStringList normalizedDirectoryList;
+    foreach (const QString& directoryName, directoryList)
+        normalizedDirectoryList.append(d->normalizedPath(directoryName));
+
+    foreach (const QString& directoryName, d->directoryList)
+    {
+        if (!normalizedDirectoryList.contains(directoryName))
+            removeDirectory(directoryName, false);
+    }
+
+    foreach (const QString& directoryName, normalizedDirectoryList)
+    {
+        if (!d->directories.contains(directoryName))
+            scanDirectory(directoryName, false);
+    }
+
+    d->directoryList = normalizedDirectoryList;
+    d->bookNamesModified = true;
+    d->saveCache();
+}
+
+void
+DictionaryCatalog::setCacheFilePath(const QString& cacheFilePath)
+{
+    d->cacheFilePath = cacheFilePath;
+    d->cacheLoaded = false;
+    d->cachedEntries.clear();
+}
+
+QString
+DictionaryCatalog::cacheFilePath() const
+{
+    return d->cacheFilePath;
+}
+
+QStringList
+DictionaryCatalog::directories() const
+{
+    return d->directoryList;
+}
+
+bool
+DictionaryCatalog::contains(const QString& directoryName) const
+{
+    return d->directories.contains(d->normalizedPath(directoryName));
+}
+
+QStringList
+DictionaryCatalog::ifoFilePaths() const
+{
+    QStringList result;
+    foreach (const QString& directoryName, d->directoryList)
+        d->collect(directoryName, result);
+
+    return result;
+}
+
+QStringList
+DictionaryCatalog::ifoFilePaths(const QString& directoryName) const
+{
+    QStringList result;
+    d->collect(d->normalizedPath(directoryName), result);
+    return result;
+}
+
+QString
+DictionaryCatalog::bookName(const QString& ifoFilePath) const
+{
+    return d->entries.value(ifoFilePath).bookName;
+}
+
+QString
+DictionaryCatalog::ifoFilePath(const QString& bookName) const
+{
+    if (d->bookNamesModified)
+    {
+        d->bookNames.clear();
+
+        // The first one wins, like with a walk of the directories
+        foreach (const QString& ifoFilePath, ifoFilePaths())
+        {
+            const CatalogEntry& entry = d->entries[ifoFilePath];
+            if (entry.valid && !d->bookNames.contains(entry.bookName))
+                d->bookNames.insert(entry.bookName, ifoFilePath);
+        }
+
+        d->bookNamesModified = false;
+    }
+
+    return d->bookNames.value(bookName);
+}
+
+bool
+DictionaryCatalog::dictionaryInfo(const QString& ifoFilePath, StarDictDictionaryInfo& info) const
+{
+    QHash<QString, CatalogEntry>::const_iterator it = d->entries.constFind(ifoFilePath);
+    if (it == d->entries.constEnd() || !it->valid)
+        return false;
+
+    info.setIfoFilePath(ifoFilePath);
+    info.setBookName(it->bookName);
+    info.setWordCount(it->wordCount);
+    info.setAuthor(it->author);
+    info.setEmail(it->email);
+    info.setWebsite(it->website);
+    info.setDateTime(it->dateTime);
+    info.setDescription(it->description);
+    info.setIndexFileSize(it->indexFileSize);
+    info.setIndexOffsetBits(it->indexOffsetBits);
+    info.setSameTypeSequence(it->sameTypeSequence);
+
+    return true;
+}
+
+void
+DictionaryCatalog::scanDirectory(const QString& directoryName, bool notify)
+{
+    if (d->directories.contains(directoryName) || !QFileInfo(directoryName).isDir())
+        return;
+
+    CatalogDirectory directory = d->list(directoryName);
+    d->directories.insert(directoryName, directory);
+    d->watcher.addPath(directoryName);
+
+    foreach (const QString& entry, directory.entries)
+    {
+        if (directory.subdirectories.contains(entry))
+            scanDirectory(entry, notify);
+        else
+            addIfoFile(entry, notify);
+    }
+}
+
+void
+DictionaryCatalog::removeDirectory(const QString& directoryName, bool notify)
+{
+    if (!d->directories.contains(directoryName))
+        return;
+
+    CatalogDirectory directory = d->directories.take(directoryName);
+    d->watcher.removePath(directoryName);
+
+    foreach (const QString& entry, directory.entries)
+    {
+        if (directory.subdirectories.contains(entry))
+            removeDirectory(entry, notify);
+        else
+            removeIfoFile(entry, notify);
+    }
+}
+
+void
+DictionaryCatalog::addIfoFile(const QString& ifoFilePath, bool notify)
+{
+    d->entries.insert(ifoFilePath, d->parse(ifoFilePath));
+    d->watcher.addPath(ifoFilePath);
+    d->bookNamesModified = true;
+
+    if (notify)
+        emit dictionaryAdded(ifoFilePath);
+}
+
+void
+DictionaryCatalog::removeIfoFile(const QString& ifoFilePath, bool notify)
+{
+    if (d->entries.remove(ifoFilePath) == 0)
+        return;
+
+    d->watcher.removePath(ifoFilePath);
+    d->bookNamesModified = true;
+    d->cacheModified = true;
+
+    if (notify)
+        emit dictionaryRemoved(ifoFilePath);
+}
+
+void
+DictionaryCatalog::rescanDirectory(const QString& directoryName)
+{
+    if (!d->directories.contains(directoryName))
+        return;
+
+    if (!QFileInfo(directoryName).isDir())
+    {
+        removeDirectory(directoryName, true);
+        d->saveCache();
+        return;
+    }
+
+    // Only the difference to the previous listing is processed
+    CatalogDirectory previousDirectory = d->directories.value(directoryName);
+    CatalogDirectory directory = d->list(directoryName);
+    QSet<QString> previousEntries = previousDirectory.entries.toSet();
+    QSet<QString> entries = directory.entries.toSet();
+
+    foreach (const QString& entry, previousDirectory.entries)
+    {
+        if (entries.contains(entry))
+            continue;
+
+        if (previousDirectory.subdirectories.contains(entry))
+            removeDirectory(entry, true);
+        else
+            removeIfoFile(entry, true);
+    }
+
+    d->directories.insert(directoryName, directory);
+
+    foreach (const QString& entry, directory.entries)
+    {
+        if (directory.subdirectories.contains(entry))
+        {
+            if (!previousEntries.contains(entry))
+                scanDirectory(entry, true);
+        }
+        else if (!previousEntries.contains(entry))
+        {
+            addIfoFile(entry, true);
+        }
+        else
+        {
+            rescanIfoFile(entry);
+        }
+    }
+
+    d->saveCache();
+}
+
+void
+DictionaryCatalog::rescanIfoFile(const QString& ifoFilePath)
+{
+    QHash<QString, CatalogEntry>::iterator it = d->entries.find(ifoFilePath);
+    if (it == d->entries.end())
+        return;
+
+    // The removal is noticed by the rescan of the directory
+    if (!QFileInfo(ifoFilePath).exists())
+        return;
+
+    // A replaced file is not watched anymore
+    d->watcher.addPath(ifoFilePath);
+
+    if (it->signature == d->signature(ifoFilePath))
+        return;
+
+    *it = d->parse(ifoFilePath);
+    d->bookNamesModified = true;
+    d->saveCache();
+    emit dictionaryChanged(ifoFilePath);
+}
@@ -0,0 +1,225 @@
+/******************************************************************************
+ * This file is part of the Mula project
+ * Copyright (c) 2011 Laszlo Papp <lpapp@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef MULA_PLUGIN_STARDICT_DICTIONARYCATALOG_H
+#define MULA_PLUGIN_STARDICT_DICTIONARYCATALOG_H
+
+#include <QtCore/QObject>
+#include <QtCore/QStringList>
+
+namespace MulaPluginStarDict
+{
+    class StarDictDictionaryInfo;
+
+    /**
+     * \brief Catalog of the dictionaries in the dictionary directories
+     *
+     * The catalog scans the dictionary directories recursively once, and
+     * records the ".ifo" files with the book names parsed from them. Then it
+     * watches the directories and the ".ifo" files, and only rescans the
+     * directory of a change: the new dictionaries are parsed, the removed
+     * ones are dropped, and the ones whose ".ifo", ".idx" or ".dict" file has
+     * changed are parsed again. The changes are reported by the signals, so
+     * the loaded dictionaries can be updated one by one.
+     *
+     * The ".ifo" files of a directory are listed in the same order as by a
+     * recursive walk with QDir::entryInfoList().
+     *
+     * The parsed ".ifo" files are saved to a cache file, and they are only
+     * parsed again on the next start if the size or the modification time of
+     * a file of the dictionary has changed.
+     *
+     * \see StarDictDictionaryManager::setCatalog
+     */
+
+    class DictionaryCatalog : public QObject
+    {
+        Q_OBJECT
+
+        public:
+
+            /**
+             * Constructor
+             *
+             * @param parent The parent object
+             */
+
+            DictionaryCatalog(QObject *parent = 0);
+
+            /**
+             * Destructor
+             */
+
+            virtual ~DictionaryCatalog();
+
+            /**
+             * Sets the dictionary directories, scans the new ones and stops
+             * watching the ones not listed anymore. No signals are emitted
+             * for the dictionaries of the scanned directories.
+             *
+             * @param directoryList The dictionary directories
+             *
+             * @see directories
+             */
+
+            void setDirectories(const QStringList& directoryList);
+
+            /**
+             * Returns the dictionary directories
+             *
+             * @return The dictionary directories
+             *
+             * @see setDirectories
+             */
+
+            QStringList directories() const;
+
+            /**
+             * Sets the cache file of the parsed ".ifo" files. The default is
+             * in the cache location provided by QStandardPaths. It should be
+             * set before the directories, an empty path disables the cache.
+             *
+             * @param cacheFilePath The path of the cache file
+             *
+             * @see cacheFilePath
+             */
+
+            void setCacheFilePath(const QString& cacheFilePath);
+
+            /**
+             * Returns the cache file of the parsed ".ifo" files
+             *
+             * @return The path of the cache file
+             *
+             * @see setCacheFilePath
+             */
+
+            QString cacheFilePath() const;
+
+            /**
+             * Returns whether the directory is a scanned dictionary directory
+             *
+             * @param directoryName The directory
+             *
+             * @return True if the directory is in the catalog, otherwise false.
+             */
+
+            bool contains(const QString& directoryName) const;
+
+            /**
+             * Returns the ".ifo" files of all the dictionary directories
+             *
+             * @return The absolute paths of the ".ifo" files
+             */
+
+            QStringList ifoFilePaths() const;
+
+            /**
+             * Returns the ".ifo" files in the directory and its
+             * subdirectories
+             *
+             * @param directoryName The directory
+             *
+             * @return The absolute paths of the ".ifo" files, or an empty list
+             * if the directory is not in the catalog
+             */
+
+            QStringList ifoFilePaths(const QString& directoryName) const;
+
+            /**
+             * Returns the book name of the dictionary
+             *
+             * @param ifoFilePath The absolute path of the ".ifo" file
+             *
+             * @return The book name, or an empty string if the ".ifo" file is
+             * not in the catalog, or it could not be parsed
+             *
+             * @see ifoFilePath
+             */
+
+            QString bookName(const QString& ifoFilePath) const;
+
+            /**
+             * Returns the ".ifo" file of the dictionary with the book name
+             *
+             * @param bookName The book name of the dictionary
+             *
+             * @return The absolute path of the ".ifo" file, or an empty string
+             * if there is no such a dictionary
+             *
+             * @see bookName
+             */
+
+            QString ifoFilePath(const QString& bookName) const;
+
+            /**
+             * Fills the information of the dictionary parsed from its ".ifo"
+             * file, without reading the file again
+             *
+             * @param ifoFilePath   The absolute path of the ".ifo" file
+             * @param info          The information to fill
+             *
+             * @return True if the ".ifo" file is in the catalog and it could
+             * be parsed, otherwise false.
+             */
+
+            bool dictionaryInfo(const QString& ifoFilePath, StarDictDictionaryInfo& info) const;
+
+        Q_SIGNALS:
+
+            /**
+             * Emitted when a dictionary has been added to a directory
+             *
+             * @param ifoFilePath The absolute path of the ".ifo" file
+             */
+
+            void dictionaryAdded(const QString& ifoFilePath);
+
+            /**
+             * Emitted when a dictionary has been removed from a directory
+             *
+             * @param ifoFilePath The absolute path of the ".ifo" file
+             */
+
+            void dictionaryRemoved(const QString& ifoFilePath);
+
+            /**
+             * Emitted when a file of a dictionary has changed
+             *
+             * @param ifoFilePath The absolute path of the ".ifo" file
+             */
+
+            void dictionaryChanged(const QString& ifoFilePath);
+
+        private Q_SLOTS:
+            void rescanDirectory(const QString& directoryName);
+            void rescanIfoFile(const QString& ifoFilePath);
+
+        private:
+            void scanDirectory(const QString& directoryName, bool notify);
+            void removeDirectory(const QString& directoryName, bool notify);
+            void addIfoFile(const QString& ifoFilePath, bool notify);
+            void removeIfoFile(const QString& ifoFilePath, bool notify);
+
+            class Private;
+            Private *const d;
+    };
+}
+
+#endif // MULA_PLUGIN_STARDICT_DICTIONARYCATALOG_H
@@ -0,0 +1,102 @@
+/******************************************************************************
+ * This file is part of the Mula project
+ * Copyright (c) 2011 Laszlo Papp <lpapp@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "dictionaryloadjob.h"
+
+#include "dictionary.h"
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QSemaphore>
+
+using namespace MulaPluginStarDict;
+
+class DictionaryLoadJob::Private
+{
+    public:
+        Private()
+            : lazy(false)
+            , dictionary(0)
+            , finished(0)
+            , elapsed(0)
+        {
+        }
+
+        ~Private()
+        {
+            delete dictionary;
+        }
+
+        QString ifoFilePath;
+        bool lazy;
+        Dictionary *dictionary;
+        QSemaphore *finished;
+        qint64 elapsed;
+};
+
+DictionaryLoadJob::DictionaryLoadJob(const QString& ifoFilePath, QSemaphore *finished, bool lazy)
+    : d(new Private)
+{
+    d->ifoFilePath = ifoFilePath;
+    d->finished = finished;
+    d->lazy = lazy;
+
+    setAutoDelete(false);
+}
+
+DictionaryLoadJob::~DictionaryLoadJob()
+{
+    delete d;
+}
+
+QString
+DictionaryLoadJob::ifoFilePath() const
+{
+    return d->ifoFilePath;
+}
+
+qint64
+DictionaryLoadJob::elapsed() const
+{
+    return d->elapsed;
+}
+
+Dictionary*
+DictionaryLoadJob::takeDictionary()
+{
+    Dictionary *dictionary = d->dictionary;
+    d->dictionary = 0;
+    return dictionary;
+}
+
+void
+DictionaryLoadJob::run()
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    Dictionary *dictionary = new Dictionary;
+    if (dictionary->load(d->ifoFilePath, d->lazy))
+        d->dictionary = dictionary;
+    else
+        delete dictionary;
+
+    // The time is read by the loading thread after the semaphore is acquired
+    d->elapsed = timer.elapsed();
+    d->finished->release();
+}
@@ -0,0 +1,106 @@
+/******************************************************************************
+ * This file is part of the Mula project
+ * Copyright (c) 2011 Laszlo Papp <lpapp@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef MULA_PLUGIN_STARDICT_DICTIONARYLOADJOB_H
+#define MULA_PLUGIN_STARDICT_DICTIONARYLOADJOB_H
+
+#include <QtCore/QRunnable>
+#include <QtCore/QString>
+
+class QSemaphore;
+
+namespace MulaPluginStarDict
+{
+    class Dictionary;
+
+    /**
+     * \brief Loads a dictionary according to its ".ifo" file
+     *
+     * Loading a dictionary parses the ".ifo" file, opens the data file and
+     * loads or builds the offset cache of the index file, which is mostly
+     * waiting for the disk. The dictionaries are independent of each other,
+     * so each of them is loaded by a separate job on a thread pool.
+     *
+     * \note The job is not deleted automatically by the thread pool, since the
+     * dictionary needs to be fetched after it has finished. The end of the job
+     * is signaled through a semaphore shared by the jobs of the same load, so
+     * the load does not wait for the other jobs of the pool.
+     *
+     * \see StarDictDictionaryManager::load, StarDictDictionaryManager::reload
+     */
+
+    class DictionaryLoadJob : public QRunnable
+    {
+        public:
+
+            /**
+             * Constructor
+             *
+             * @param ifoFilePath   The path of the ".ifo" file of the dictionary
+             * @param finished      The semaphore released once the job has
+             * finished
+             * @param lazy          Whether to postpone opening the files of the
+             * dictionary until its first use
+             */
+
+            DictionaryLoadJob(const QString& ifoFilePath, QSemaphore *finished, bool lazy = false);
+
+            /**
+             * Destructor, deletes the dictionary unless it has been taken
+             */
+
+            virtual ~DictionaryLoadJob();
+
+            /**
+             * Returns the path of the ".ifo" file of the dictionary
+             *
+             * @return The path of the ".ifo" file
+             */
+
+            QString ifoFilePath() const;
+
+            /**
+             * Returns the time spent on loading the dictionary. It is only
+             * valid after the job has released its semaphore.
+             *
+             * @return The elapsed time in milliseconds
+             */
+
+            qint64 elapsed() const;
+
+            /**
+             * Returns the loaded dictionary and passes its ownership to the
+             * caller
+             *
+             * @return The dictionary, or NULL if the loading failed
+             */
+
+            Dictionary* takeDictionary();
+
+            /** Reimplemented from QRunnable::run() */
+
+            void run();
+
+        private:
+            class Private;
+            Private *const d;
+    };
+}
+
+#endif // MULA_PLUGIN_STARDICT_DICTIONARYLOADJOB_H
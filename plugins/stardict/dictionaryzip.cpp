@@ -27,6 +27,8 @@
 #include <QtCore/QString>
 #include <QtCore/QFileInfo>
 #include <QtCore/QDateTime>
+#include <QtCore/QMutex>
+#include <QtCore/QMutexLocker>
 
 #include <zlib.h>
 
@@ -34,19 +36,8 @@
 
 using namespace MulaPluginStarDict;
 
-#define USE_CACHE 1
-
 #define BUFFERSIZE 10240
 
-/*
- * Output buffer must be greater than or
- * equal to 110% of input buffer size, plus
- * 12 bytes.
-*/
-#define OUT_BUFFER_SIZE 0xffffL
-
-#define IN_BUFFER_SIZE ((unsigned long)((double)(OUT_BUFFER_SIZE - 12) * 0.89))
-
 /* For gzip-compatible header, as defined in RFC 1952 */
 
 /* Magic for GZIP (rfc1952)                */
@@ -124,7 +115,6 @@ class DictionaryZip::Private
             , end(0)
             , size(0)
             , type(DICTIONARY_UNKNOWN)
-            , initialized(0)
             , headerLength(GZ_XLEN - 1)
             , extraLength(0)
             , subLength(0)
@@ -140,6 +130,7 @@ class DictionaryZip::Private
             , crc(0)
             , originalLength(0)
             , compressedLength(0)
+            , stamp(0)
         {
         }
 
@@ -151,9 +142,9 @@ class DictionaryZip::Private
         unsigned char *end;	    /* end of mmap'd area */
         unsigned long size;		        /* size of mmap */
 
+        QByteArray cachedChunk(const DictionaryZip *dictionaryZip, int chunkIndex);
+
         int type;
-        z_stream zStream;
-        int initialized;
 
         int headerLength;
         int extraLength;
@@ -174,6 +165,8 @@ class DictionaryZip::Private
         unsigned long originalLength;
         unsigned long compressedLength;
         QList<DictionaryCache> cache;
+        QMutex cacheMutex;
+        int stamp;
         QFile mapFile;
 
         static const int dictionaryCacheSize = 5;
@@ -187,6 +180,7 @@ DictionaryZip::DictionaryZip()
 DictionaryZip::~DictionaryZip()
 {
     close();
+    delete d;
 }
 
 int
@@ -256,7 +250,7 @@ DictionaryZip::readHeader(const QString &fileName, int computeCRC)
             qWarning() << "Invalid ZIP file. Unexpected end of file.";
             return -1;
         } else {
-            mtime |= chtime << i*8;
+            mtime |= time_t(uchar(chtime)) << i*8;
         }
     }
     d->mtime.setTime_t(mtime);
@@ -280,11 +274,11 @@ DictionaryZip::readHeader(const QString &fileName, int computeCRC)
                 qWarning() << "Invalid ZIP file. Unexpected end of file.";
                 return -1;
             } else {
-                d->extraLength |= extraLength << i*8;
+                d->extraLength |= uchar(extraLength) << i*8;
             }
         }
 
-        d->headerLength += extraLength + 2;
+        d->headerLength += d->extraLength + 2;
 
         if (file.read( &si1, 1 ) < 0) {
             qWarning() << "Invalid ZIP file. Unexpected end of file.";
@@ -296,7 +290,7 @@ DictionaryZip::readHeader(const QString &fileName, int computeCRC)
             return -1;
         }
 
-        if (uchar(si1) == GZ_RND_S1 || uchar(si2) == GZ_RND_S2)
+        if (uchar(si1) == GZ_RND_S1 && uchar(si2) == GZ_RND_S2)
         {
             d->subLength = 0;
             char subLength;
@@ -305,7 +299,7 @@ DictionaryZip::readHeader(const QString &fileName, int computeCRC)
                     qWarning() << "Invalid ZIP file. Unexpected end of file.";
                     return -1;
                 } else {
-                    d->subLength |= subLength << i*8;
+                    d->subLength |= uchar(subLength) << i*8;
                 }
             }
 
@@ -316,7 +310,7 @@ DictionaryZip::readHeader(const QString &fileName, int computeCRC)
                     qWarning() << "Invalid ZIP file. Unexpected end of file.";
                     return -1;
                 } else {
-                    d->version |= version << i*8;
+                    d->version |= uchar(version) << i*8;
                 }
             }
 
@@ -332,7 +326,7 @@ DictionaryZip::readHeader(const QString &fileName, int computeCRC)
                     qWarning() << "Invalid ZIP file. Unexpected end of file.";
                     return -1;
                 } else {
-                    d->chunkLength |= chunkLength << i*8;
+                    d->chunkLength |= uchar(chunkLength) << i*8;
                 }
             }
 
@@ -343,7 +337,7 @@ DictionaryZip::readHeader(const QString &fileName, int computeCRC)
                     qWarning() << "Invalid ZIP file. Unexpected end of file.";
                     return -1;
                 } else {
-                    d->chunkCount |= chunkCount << i*8;
+                    d->chunkCount |= uchar(chunkCount) << i*8;
                 }
             }
 
@@ -364,26 +358,26 @@ DictionaryZip::readHeader(const QString &fileName, int computeCRC)
                         qWarning() << "Invalid ZIP file. Unexpected end of file.";
                         return -1;
                     } else {
-                        d->chunks[j] |= chunk << i*8;
+                        d->chunks[j] |= uchar(chunk) << i*8;
                     }
                 }
             }
             d->type = DICTIONARY_DZIP;
         }
-        else
-        {
-            file.seek(d->headerLength);
-        }
+
+        // Skip the other subfields of the extra field
+        file.seek(d->headerLength + 1);
     }
 
     if (d->flags & GZ_FNAME)
     { /* FIXME! Add checking against header len */
         int i = 0;
-        while (file.read(&buffer[i++], 1) && !file.atEnd());
+        while (i < BUFFERSIZE - 1 && file.getChar(&buffer[i]) && buffer[i] != '\0')
+            ++i;
         buffer[i] = '\0';
 
         d->originalFileName = buffer;
-        d->headerLength += d->originalFileName.length() + 1;
+        d->headerLength += i + 1;
     }
     else
     {
@@ -393,10 +387,11 @@ DictionaryZip::readHeader(const QString &fileName, int computeCRC)
     if (d->flags & GZ_COMMENT)
     { /* FIXME! Add checking for header len */
         int i = 0;
-        while (file.read(&buffer[i++], 1) && !file.atEnd());
+        while (i < BUFFERSIZE - 1 && file.getChar(&buffer[i]) && buffer[i] != '\0')
+            ++i;
         buffer[i] = '\0';
         d->comment = buffer;
-        d->headerLength += d->comment.length() + 1;
+        d->headerLength += i + 1;
     }
     else
     {
@@ -423,7 +418,7 @@ DictionaryZip::readHeader(const QString &fileName, int computeCRC)
             qWarning() << "Invalid ZIP file. Unexpected end of file.";
             return -1;
         } else {
-            d->crc |= chcrc << i*8;
+            d->crc |= (unsigned long)uchar(chcrc) << i*8;
         }
     }
 
@@ -434,7 +429,7 @@ DictionaryZip::readHeader(const QString &fileName, int computeCRC)
             qWarning() << "Invalid ZIP file. Unexpected end of file.";
             return -1;
         } else {
-            d->originalLength |= length << i*8;
+            d->originalLength |= (unsigned long)uchar(length) << i*8;
         }
     }
 
@@ -453,11 +448,45 @@ DictionaryZip::readHeader(const QString &fileName, int computeCRC)
     return 0;
 }
 
+QByteArray
+DictionaryZip::Private::cachedChunk(const DictionaryZip *dictionaryZip, int chunkIndex)
+{
+    {
+        QMutexLocker locker(&cacheMutex);
+        for (int i = 0; i < cache.size(); ++i)
+        {
+            if (cache.at(i).chunk() == chunkIndex)
+            {
+                cache[i].setStamp(++stamp);
+                return cache.at(i).byteArray();
+            }
+        }
+    }
+
+    // Inflate without holding the lock so that the readers of other chunks
+    // are not serialized behind this one
+    QByteArray chunkData = dictionaryZip->readChunk(chunkIndex);
+
+    QMutexLocker locker(&cacheMutex);
+    int leastRecentlyUsed = 0;
+    for (int i = 0; i < cache.size(); ++i)
+    {
+        if (cache.at(i).chunk() == chunkIndex)
+            return chunkData;
+
+        if (cache.at(i).stamp() < cache.at(leastRecentlyUsed).stamp())
+            leastRecentlyUsed = i;
+    }
+
+    if (!cache.isEmpty())
+        cache[leastRecentlyUsed] = DictionaryCache(chunkIndex, chunkData, ++stamp, chunkData.size());
+
+    return chunkData;
+}
+
 bool
 DictionaryZip::open(const QString& fileName, int computeCRC)
 {
-    d->initialized = 0;
-
     if (!QFileInfo(fileName).isFile())
     {
         qDebug() << Q_FUNC_INFO << QString("%1 is not a regular file -- ignoring").arg(fileName);
@@ -474,7 +503,7 @@ DictionaryZip::open(const QString& fileName, int computeCRC)
     if( !file.open( QIODevice::ReadOnly ) )
     {
         qDebug() << "Failed to open file:" << fileName;
-        return -1;
+        return false;
     }
 
     d->size = file.size();
@@ -483,7 +512,7 @@ DictionaryZip::open(const QString& fileName, int computeCRC)
     if( !d->mapFile.open( QIODevice::ReadOnly ) )
     {
         qDebug() << "Failed to open file:" << fileName;
-        return -1;
+        return false;
     }
 
     uchar *data = d->mapFile.map(0, d->size);
@@ -496,6 +525,8 @@ DictionaryZip::open(const QString& fileName, int computeCRC)
     d->start = data;
     d->end = d->start + d->size;
 
+    QMutexLocker locker(&d->cacheMutex);
+    d->cache.clear();
     for (int j = 0; j < d->dictionaryCacheSize; ++j)
     {
         DictionaryCache dictionaryCache;
@@ -516,43 +547,22 @@ DictionaryZip::close()
     if (d->chunks)
         ::free(d->chunks);
 
+    d->chunks = 0;
+
     if (d->offsets)
         ::free(d->offsets);
 
-    if (d->initialized)
-    {
-        if (inflateEnd( &d->zStream ))
-        {
-            qDebug() << Q_FUNC_INFO << QString("Cannot shut down inflation engine: %1").arg(d->zStream.msg);
-        }
-    }
+    d->offsets = 0;
 
-    /* for (int i = 0; i < DICTIONARY_CACHE_SIZE; ++i)
-    {
-        if (d->cache[i].inBuffer)
-            ::free(d->cache[i].inBuffer);
-    } */
+    QMutexLocker locker(&d->cacheMutex);
+    d->cache.clear();
 }
 
 QByteArray
 DictionaryZip::read(unsigned long start, unsigned long size)
 {
-    unsigned long end;
-    int count;
-    QByteArray inByteArray;
-    QByteArray outByteArray;
-    int firstChunk;
-    int lastChunk;
-    int firstOffset;
-    int lastOffset;
-    int found;
-    int target;
-    int lastStamp;
-    static int stamp = 0;
     QByteArray resultString;
 
-    end = start + size;
-
     switch (d->type)
     {
     case DICTIONARY_GZIP:
@@ -561,122 +571,24 @@ DictionaryZip::read(unsigned long start, unsigned long size)
         break;
 
     case DICTIONARY_TEXT:
-        resultString = QByteArray::fromRawData(reinterpret_cast<char*>(d->start), size);
+        resultString = QByteArray::fromRawData(reinterpret_cast<char*>(d->start + start), size);
         break;
 
     case DICTIONARY_DZIP:
-        if (!d->initialized)
+        if (size > 0)
         {
-            ++d->initialized;
-            d->zStream.zalloc = NULL;
-            d->zStream.zfree = NULL;
-            d->zStream.opaque = NULL;
-            d->zStream.next_in = 0;
-            d->zStream.avail_in = 0;
-            d->zStream.next_out = NULL;
-            d->zStream.avail_out = 0;
-
-            if (inflateInit2( &d->zStream, -15 ) != Z_OK)
-            {
-                qWarning() << Q_FUNC_INFO << QString("Cannot initialize inflation engine: %1").arg(d->zStream.msg);
-            }
-        }
+            unsigned long end = start + size;
+            int firstChunk = start / d->chunkLength;
+            int lastChunk = (end - 1) / d->chunkLength;
 
-        firstChunk = start / d->chunkLength;
-        firstOffset = start - firstChunk * d->chunkLength;
-        lastChunk = end / d->chunkLength;
-        lastOffset = end - lastChunk * d->chunkLength;
-        //PRINTF(DBG_UNZIP,
-        // ("   start = %lu, end = %lu\n"
-        //"firstChunk = %d, firstOffset = %d,"
-        //" lastChunk = %d, lastOffset = %d\n",
-        //start, end, firstChunk, firstOffset, lastChunk, lastOffset ));
-        for (int i = firstChunk; i <= lastChunk; ++i)
-        {
-            /* Access cache */
-            found = 0;
-            target = 0;
-            lastStamp = INT_MAX;
-            for (int j = 0; j < d->dictionaryCacheSize; ++j)
+            resultString.reserve(size);
+            for (int i = firstChunk; i <= lastChunk; ++i)
             {
-#if USE_CACHE
-                if (d->cache.at(j).chunk() == i)
-                {
-                    found = 1;
-                    target = j;
-                    break;
-                }
-#endif
-                if (d->cache.at(j).stamp() < lastStamp)
-                {
-                    lastStamp = d->cache.at(j).stamp();
-                    target = j;
-                }
-            }
-
-            d->cache[target].setStamp(++stamp);
-            if (found)
-            {
-                count = d->cache.at(target).count();
-                inByteArray = d->cache.at(target).byteArray();
-            }
-            else
-            {
-                d->cache[target].setChunk(i);
-
-                inByteArray = d->cache.at(target).byteArray();
-
-                if (d->chunks[i] >= OUT_BUFFER_SIZE )
-                {
-                    qDebug() << Q_FUNC_INFO << QString("chunks[%1] = %2 >= %3 (OUT_BUFFER_SIZE)").arg(i).arg(d->chunks[i]).arg(OUT_BUFFER_SIZE);
-                }
-
-                outByteArray = QByteArray::fromRawData(reinterpret_cast<char*>(d->start + d->offsets[i]), d->chunks[i]);
-
-                d->zStream.next_in = (Bytef *)outByteArray.data();
-                d->zStream.avail_in = d->chunks[i];
-                d->zStream.next_out = (Bytef *)inByteArray.data();
-                d->zStream.avail_out = IN_BUFFER_SIZE;
-
-                if (inflate( &d->zStream, Z_PARTIAL_FLUSH ) != Z_OK)
-                {
-                    qWarning() << Q_FUNC_INFO << QString("inflate: %1").arg(d->zStream.msg);
-                }
-
-                if (d->zStream.avail_in)
-                {
-                    qWarning() << Q_FUNC_INFO << QString("inflate did not flush (%1 pending, %2 avail)").arg(d->zStream.avail_in).arg(d->zStream.avail_out);
-                }
-
-                count = IN_BUFFER_SIZE - d->zStream.avail_out;
-
-                d->cache[target].setCount(count);
-            }
-
-            if (i == firstChunk)
-            {
-                if (i == lastChunk)
-                {
-                    inByteArray.append(inByteArray.mid(firstOffset, lastOffset - firstOffset));
-                }
-                else
-                {
-                    if (count != d->chunkLength )
-                    {
-                        qDebug() << Q_FUNC_INFO << QString("Length = %1 instead of %2").arg(count).arg(d->chunkLength);
-                    }
-
-                    inByteArray.append(inByteArray.mid(firstOffset, d->chunkLength - firstOffset));
-                }
-            }
-            else if (i == lastChunk)
-            {
-                inByteArray.append(inByteArray.left(lastOffset));
-            }
-            else
-            {
-                Q_ASSERT(count == d->chunkLength);
-                inByteArray.append(inByteArray.left(d->chunkLength));
+                QByteArray chunkData = d->cachedChunk(this, i);
+                unsigned long chunkStart = (unsigned long)i * d->chunkLength;
+                unsigned long from = qMax(start, chunkStart) - chunkStart;
+                unsigned long to = qMin(end, chunkStart + d->chunkLength) - chunkStart;
+                resultString.append(chunkData.mid(from, to - from));
             }
         }
         break;
@@ -688,3 +600,56 @@ DictionaryZip::read(unsigned long start, unsigned long size)
 
     return resultString;
 }
+
+int
+DictionaryZip::chunkLength() const
+{
+    return d->type == DICTIONARY_DZIP ? d->chunkLength : 0;
+}
+
+int
+DictionaryZip::chunkCount() const
+{
+    return d->type == DICTIONARY_DZIP ? d->chunkCount : 0;
+}
+
+QByteArray
+DictionaryZip::readChunk(int chunkIndex) const
+{
+    if (d->type != DICTIONARY_DZIP || chunkIndex < 0 || chunkIndex >= d->chunkCount)
+        return QByteArray();
+
+    // Every dictzip chunk is terminated by a full flush, so it can be
+    // inflated on its own with a private inflation engine
+    z_stream zStream;
+    zStream.zalloc = NULL;
+    zStream.zfree = NULL;
+    zStream.opaque = NULL;
+    zStream.next_in = (Bytef *)(d->start + d->offsets[chunkIndex]);
+    zStream.avail_in = d->chunks[chunkIndex];
+
+    if (inflateInit2( &zStream, -15 ) != Z_OK)
+    {
+        qWarning() << Q_FUNC_INFO << QString("Cannot initialize inflation engine: %1").arg(zStream.msg);
+        return QByteArray();
+    }
+
+    QByteArray chunkData(d->chunkLength, Qt::Uninitialized);
+    zStream.next_out = (Bytef *)chunkData.data();
+    zStream.avail_out = d->chunkLength;
+
+    int result = inflate( &zStream, Z_PARTIAL_FLUSH );
+    if (result != Z_OK && result != Z_STREAM_END && result != Z_BUF_ERROR)
+    {
+        qWarning() << Q_FUNC_INFO << QString("inflate: %1").arg(zStream.msg);
+        chunkData.clear();
+    }
+    else
+    {
+        chunkData.resize(d->chunkLength - zStream.avail_out);
+    }
+
+    inflateEnd( &zStream );
+
+    return chunkData;
+}
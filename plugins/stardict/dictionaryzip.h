@@ -48,8 +48,57 @@ namespace MulaPluginStarDict
             bool open(const QString& fileName, int computeCRC);
             void close();
 
+            /**
+             * Returns the uncompressed data between the given offsets. The
+             * recently inflated chunks are kept in a small cache shared by
+             * the callers, which is guarded so that the method can be called
+             * concurrently from several threads.
+             *
+             * @param start The offset of the data in the uncompressed file
+             * @param size The size of the data
+             *
+             * @return The uncompressed data
+             */
             QByteArray read(unsigned long start, unsigned long size);
 
+            /**
+             * Returns the uncompressed length of the chunks in the dictzip
+             * file, or 0 if the file is not in dictzip format
+             *
+             * @return The uncompressed length of the chunks
+             *
+             * @see chunkCount, readChunk
+             */
+
+            int chunkLength() const;
+
+            /**
+             * Returns the number of the compressed chunks in the dictzip
+             * file, or 0 if the file is not in dictzip format
+             *
+             * @return The number of the chunks
+             *
+             * @see chunkLength, readChunk
+             */
+
+            int chunkCount() const;
+
+            /**
+             * Returns the uncompressed content of the desired chunk.
+             *
+             * \note Unlike read(), this method bypasses the chunk cache and
+             * always inflates the chunk.
+             *
+             * @param chunkIndex The index of the desired chunk
+             *
+             * @return The uncompressed data of the chunk, or an empty byte
+             * array if the chunk cannot be inflated
+             *
+             * @see chunkLength, chunkCount
+             */
+
+            QByteArray readChunk(int chunkIndex) const;
+
         private:
             int readHeader(const QString &filename, int computeCRC);
 
@@ -50,6 +50,7 @@ The Levenshtein distance algorithm has been used in:
 #include "distance.h"
 
 #include <stdlib.h>
+#include <string.h>
 
 #include <QtCore/QString>
 
@@ -241,3 +242,266 @@ int EditDistance::CalEditDistance(const char *s, const char *t, const int limit)
     }
 }
 #endif
+
+/****************************************/
+/*  Bit-parallel bounded edit distance  */
+/****************************************/
+
+namespace
+{
+    // Pattern match vectors of a byte string
+    class BytePatternMasks
+    {
+        public:
+            BytePatternMasks()
+            {
+                memset(m_masks, 0, sizeof(m_masks));
+            }
+
+            void add(char ch, quint64 bit)
+            {
+                m_masks[static_cast<uchar>(ch)] |= bit;
+            }
+
+            quint64 mask(char ch) const
+            {
+                return m_masks[static_cast<uchar>(ch)];
+            }
+
+        private:
+            quint64 m_masks[256];
+    };
+
+    // Pattern match vectors of a UTF-32 string with at most 64 characters,
+    // stored in a small open addressing hash table
+    class Utf32PatternMasks
+    {
+        public:
+            Utf32PatternMasks()
+            {
+                memset(m_keys, 0xff, sizeof(m_keys));
+            }
+
+            void add(quint32 ch, quint64 bit)
+            {
+                int slot = find(ch);
+                if (m_keys[slot] != ch)
+                {
+                    m_keys[slot] = ch;
+                    m_masks[slot] = 0;
+                }
+                m_masks[slot] |= bit;
+            }
+
+            quint64 mask(quint32 ch) const
+            {
+                int slot = find(ch);
+                return m_keys[slot] == ch ? m_masks[slot] : 0;
+            }
+
+        private:
+            int find(quint32 ch) const
+            {
+                int slot = (ch * 2654435761U) >> (32 - tableBits);
+                while (m_keys[slot] != emptyKey && m_keys[slot] != ch)
+                    slot = (slot + 1) & (tableSize - 1);
+
+                return slot;
+            }
+
+            static const int tableBits = 7;
+            static const int tableSize = 1 << tableBits;
+            static const quint32 emptyKey = 0xffffffff;
+
+            quint32 m_keys[tableSize];
+            quint64 m_masks[tableSize];
+    };
+
+    template <typename Masks> struct PatternMasksFor;
+    template <> struct PatternMasksFor<char> { typedef BytePatternMasks Type; };
+    template <> struct PatternMasksFor<quint32> { typedef Utf32PatternMasks Type; };
+
+    // Optimal string alignment distance with three rows, for patterns longer
+    // than a machine word. The pattern is the shorter string, so only the
+    // strings both longer than the maximum length are cut.
+    template <typename Char>
+    int rowDistance(const Char *pattern, int patternLength, const Char *text, int textLength,
+                    int limit, bool transpositions)
+    {
+        const int maximumLength = BitParallelEditDistance::maximumLength;
+        if (patternLength > maximumLength)
+        {
+            patternLength = maximumLength;
+            textLength = maximumLength;
+        }
+
+        int rows[3 * (maximumLength + 1)];
+        int *previousPrevious = rows;
+        int *previous = previousPrevious + patternLength + 1;
+        int *current = previous + patternLength + 1;
+
+        for (int i = 0; i <= patternLength; ++i)
+            previous[i] = i;
+
+        for (int j = 1; j <= textLength; ++j)
+        {
+            current[0] = j;
+            int rowMinimum = j;
+            for (int i = 1; i <= patternLength; ++i)
+            {
+                int cost = pattern[i - 1] == text[j - 1] ? 0 : 1;
+                current[i] = qMin(qMin(previous[i] + 1, current[i - 1] + 1), previous[i - 1] + cost);
+
+                if (transpositions && i > 1 && j > 1
+                        && pattern[i - 1] == text[j - 2] && pattern[i - 2] == text[j - 1])
+                    current[i] = qMin(current[i], previousPrevious[i - 2] + 1);
+
+                rowMinimum = qMin(rowMinimum, current[i]);
+            }
+
+            if (rowMinimum >= limit)
+                return rowMinimum;
+
+            int *recycled = previousPrevious;
+            previousPrevious = previous;
+            previous = current;
+            current = recycled;
+        }
+
+        return previous[patternLength];
+    }
+
+    template <typename Char>
+    int bitParallelDistance(const Char *string1, int length1, const Char *string2, int length2,
+                            int limit, bool transpositions)
+    {
+        // Remove the common prefix and suffix, they do not change the distance
+        while (length1 && length2 && *string1 == *string2)
+        {
+            ++string1;
+            ++string2;
+            --length1;
+            --length2;
+        }
+
+        while (length1 && length2 && string1[length1 - 1] == string2[length2 - 1])
+        {
+            --length1;
+            --length2;
+        }
+
+        if (length1 == 0 || length2 == 0)
+            return length1 + length2;
+
+        // The shorter string is encoded in the bit vectors
+        const Char *pattern = string1;
+        int patternLength = length1;
+        const Char *text = string2;
+        int textLength = length2;
+
+        if (patternLength > textLength)
+        {
+            qSwap(pattern, text);
+            qSwap(patternLength, textLength);
+        }
+
+        if (textLength - patternLength >= limit)
+            return textLength - patternLength;
+
+        if (patternLength > 64)
+            return rowDistance(pattern, patternLength, text, textLength, limit, transpositions);
+
+        typename PatternMasksFor<Char>::Type patternMasks;
+        for (int i = 0; i < patternLength; ++i)
+            patternMasks.add(pattern[i], quint64(1) << i);
+
+        const quint64 lastBit = quint64(1) << (patternLength - 1);
+        quint64 verticalPositive = ~quint64(0);
+        quint64 verticalNegative = 0;
+        quint64 diagonalZero = 0;
+        quint64 previousMatch = 0;
+        int score = patternLength;
+
+        for (int j = 0; j < textLength; ++j)
+        {
+            quint64 match = patternMasks.mask(text[j]);
+
+            quint64 transposition = 0;
+            if (transpositions)
+                transposition = (((~diagonalZero) & match) << 1) & previousMatch;
+
+            diagonalZero = (((match & verticalPositive) + verticalPositive) ^ verticalPositive)
+                           | match | verticalNegative | transposition;
+
+            quint64 horizontalPositive = verticalNegative | ~(diagonalZero | verticalPositive);
+            quint64 horizontalNegative = verticalPositive & diagonalZero;
+
+            if (horizontalPositive & lastBit)
+                ++score;
+            else if (horizontalNegative & lastBit)
+                --score;
+
+            // Every remaining character can decrease the distance by one at most
+            if (score - (textLength - j - 1) >= limit)
+                return score - (textLength - j - 1);
+
+            horizontalPositive = (horizontalPositive << 1) | 1;
+            verticalNegative = horizontalPositive & diagonalZero;
+            verticalPositive = (horizontalNegative << 1) | ~(horizontalPositive | diagonalZero);
+            previousMatch = match;
+        }
+
+        return score;
+    }
+}
+
+int
+BitParallelEditDistance::distance(const quint32 *string1, int length1, const quint32 *string2, int length2,
+                                  int limit, bool transpositions)
+{
+    return bitParallelDistance(string1, length1, string2, length2, limit, transpositions);
+}
+
+int
+BitParallelEditDistance::distance(const char *string1, int length1, const char *string2, int length2,
+                                  int limit, bool transpositions)
+{
+    return bitParallelDistance(string1, length1, string2, length2, limit, transpositions);
+}
+
+int
+BitParallelEditDistance::foldUtf8(const char *utf8, int length, quint32 *buffer, int capacity)
+{
+    const uchar *data = reinterpret_cast<const uchar *>(utf8);
+    int count = 0;
+
+    for (int i = 0; i < length && count < capacity;)
+    {
+        quint32 ch = data[i];
+        int extraBytes = 0;
+
+        if (ch >= 0xf0)
+        {
+            ch &= 0x07;
+            extraBytes = 3;
+        }
+        else if (ch >= 0xe0)
+        {
+            ch &= 0x0f;
+            extraBytes = 2;
+        }
+        else if (ch >= 0xc0)
+        {
+            ch &= 0x1f;
+            extraBytes = 1;
+        }
+
+        ++i;
+        for (; extraBytes && i < length; --extraBytes, ++i)
+            ch = (ch << 6) | (data[i] & 0x3f);
+
+        buffer[count++] = ch < 0x80 ? quint32(ch >= 'A' && ch <= 'Z' ? ch + ('a' - 'A') : ch) : QChar::toLower(ch);
+    }
+
+    return count;
+}
@@ -41,4 +41,70 @@ class EditDistance
         int currentelements;
 };
 
+/**
+ * \brief Bit-parallel bounded edit distance
+ *
+ * Computes the edit distance with deletion, insertion, substitution and,
+ * optionally, transposition of adjacent characters (optimal string alignment)
+ * by using the bit-vector algorithm of Myers as extended for transpositions by
+ * Hyyro. The columns of the dynamic programming matrix are encoded in 64-bit
+ * words, so words up to 64 characters need a handful of word operations per
+ * character. Longer words fall back to computing the matrix row by row,
+ * keeping three rows of it on the stack.
+ *
+ * The methods do not allocate memory and do not have any state, so they are
+ * reentrant and can be used concurrently.
+ */
+class BitParallelEditDistance
+{
+    public:
+        /**
+         * The maximum length of the strings in characters, the same as the
+         * one of the headwords in the index files. If both strings are still
+         * longer after removing their common prefix and suffix, only their
+         * first maximumLength characters are compared.
+         */
+        static const int maximumLength = 256;
+
+        /**
+         * Returns the edit distance between two UTF-32 strings. The
+         * computation stops as soon as the distance is known to reach the
+         * limit, and then a value not less than the limit is returned.
+         *
+         * @param string1           The first string
+         * @param length1           The length of the first string
+         * @param string2           The second string
+         * @param length2           The length of the second string
+         * @param limit             The limit of the interesting distances
+         * @param transpositions    Whether or not a transposition of two
+         * adjacent characters counts as a single edit
+         *
+         * @return The edit distance, or a value not less than the limit
+         */
+        static int distance(const quint32 *string1, int length1, const quint32 *string2, int length2,
+                            int limit, bool transpositions = true);
+
+        /**
+         * Returns the edit distance between two byte strings. This is the
+         * same as the UTF-32 version, but uses a direct lookup table.
+         *
+         * @see distance
+         */
+        static int distance(const char *string1, int length1, const char *string2, int length2,
+                            int limit, bool transpositions = true);
+
+        /**
+         * Decodes the UTF-8 string into the buffer as lower case UTF-32
+         * characters. Characters that do not fit into the buffer are dropped.
+         *
+         * @param utf8      The UTF-8 string
+         * @param length    The length of the UTF-8 string in bytes
+         * @param buffer    The output buffer
+         * @param capacity  The capacity of the output buffer
+         *
+         * @return The number of characters written into the buffer
+         */
+        static int foldUtf8(const char *utf8, int length, quint32 *buffer, int capacity);
+};
+
 #endif
@@ -0,0 +1,856 @@
+/******************************************************************************
+ * This file is part of the Mula project
+ * Copyright (c) 2011 Laszlo Papp <lpapp@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "doublemetaphone.h"
+
+#include <QtCore/QChar>
+#include <QtCore/QString>
+
+using namespace MulaPluginStarDict;
+
+// The upper case letters of the prepared words, the remaining letters with
+// their own rules are stored with their Latin-1 codes
+static const char cedilla = '\xc7';
+static const char tilde = '\xd1';
+
+// Encodes a single word. The rules are checked in the order of the original
+// algorithm, and each rule consumes the letters that it has encoded.
+class DoubleMetaphoneEncoding
+{
+    public:
+        DoubleMetaphoneEncoding(const QByteArray& value);
+
+        void encode();
+
+        QByteArray primary;
+        QByteArray alternate;
+
+    private:
+        char at(int index) const;
+        bool contains(int index, const char *alternatives) const;
+        bool isVowel(int index) const;
+        bool isComplete() const;
+
+        void add(const char *both);
+        void add(const char *primaryCode, const char *alternateCode);
+
+        int handleC(int index);
+        int handleCC(int index);
+        int handleCH(int index);
+        int handleD(int index);
+        int handleG(int index);
+        int handleGH(int index);
+        int handleH(int index);
+        int handleJ(int index);
+        int handleL(int index);
+        int handleM(int index);
+        int handleP(int index);
+        int handleR(int index);
+        int handleS(int index);
+        int handleSC(int index);
+        int handleT(int index);
+        int handleW(int index);
+        int handleX(int index);
+        int handleZ(int index);
+
+        QByteArray value;
+        int last;
+        bool slavoGermanic;
+        bool germanic;
+};
+
+DoubleMetaphoneEncoding::DoubleMetaphoneEncoding(const QByteArray& value)
+    : value(value)
+    , last(value.size() - 1)
+{
+    slavoGermanic = value.contains('W') || value.contains('K') || value.contains("CZ") || value.contains("WITZ");
+    germanic = contains(0, "VAN |VON ") || contains(0, "SCH");
+}
+
+char
+DoubleMetaphoneEncoding::at(int index) const
+{
+    return index >= 0 && index <= last ? value.at(index) : '\0';
+}
+
+// Returns whether any of the '|' separated alternatives is found at the index
+bool
+DoubleMetaphoneEncoding::contains(int index, const char *alternatives) const
+{
+    if (index < 0)
+        return false;
+
+    const char *alternative = alternatives;
+    while (*alternative)
+    {
+        int length = 0;
+        while (alternative[length] && alternative[length] != '|')
+            ++length;
+
+        if (index + length <= value.size() && qstrncmp(value.constData() + index, alternative, length) == 0)
+            return true;
+
+        alternative += length;
+        if (*alternative)
+            ++alternative;
+    }
+
+    return false;
+}
+
+bool
+DoubleMetaphoneEncoding::isVowel(int index) const
+{
+    switch (at(index))
+    {
+    case 'A':
+    case 'E':
+    case 'I':
+    case 'O':
+    case 'U':
+    case 'Y':
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool
+DoubleMetaphoneEncoding::isComplete() const
+{
+    return primary.size() >= DoubleMetaphone::maximumKeyLength
+        && alternate.size() >= DoubleMetaphone::maximumKeyLength;
+}
+
+void
+DoubleMetaphoneEncoding::add(const char *both)
+{
+    add(both, both);
+}
+
+void
+DoubleMetaphoneEncoding::add(const char *primaryCode, const char *alternateCode)
+{
+    primary.append(primaryCode);
+    alternate.append(alternateCode);
+}
+
+void
+DoubleMetaphoneEncoding::encode()
+{
+    // Skip the silent first letter
+    int index = contains(0, "GN|KN|PN|WR|PS") ? 1 : 0;
+
+    while (!isComplete() && index <= last)
+    {
+        switch (at(index))
+        {
+        case 'A':
+        case 'E':
+        case 'I':
+        case 'O':
+        case 'U':
+        case 'Y':
+            // The vowels are only encoded at the beginning
+            if (index == 0)
+                add("A");
+            ++index;
+            break;
+        case 'B':
+            add("P");
+            index += at(index + 1) == 'B' ? 2 : 1;
+            break;
+        case cedilla:
+            add("S");
+            ++index;
+            break;
+        case 'C':
+            index = handleC(index);
+            break;
+        case 'D':
+            index = handleD(index);
+            break;
+        case 'F':
+            add("F");
+            index += at(index + 1) == 'F' ? 2 : 1;
+            break;
+        case 'G':
+            index = handleG(index);
+            break;
+        case 'H':
+            index = handleH(index);
+            break;
+        case 'J':
+            index = handleJ(index);
+            break;
+        case 'K':
+            add("K");
+            index += at(index + 1) == 'K' ? 2 : 1;
+            break;
+        case 'L':
+            index = handleL(index);
+            break;
+        case 'M':
+            index = handleM(index);
+            break;
+        case 'N':
+            add("N");
+            index += at(index + 1) == 'N' ? 2 : 1;
+            break;
+        case tilde:
+            add("N");
+            ++index;
+            break;
+        case 'P':
+            index = handleP(index);
+            break;
+        case 'Q':
+            add("K");
+            index += at(index + 1) == 'Q' ? 2 : 1;
+            break;
+        case 'R':
+            index = handleR(index);
+            break;
+        case 'S':
+            index = handleS(index);
+            break;
+        case 'T':
+            index = handleT(index);
+            break;
+        case 'V':
+            add("F");
+            index += at(index + 1) == 'V' ? 2 : 1;
+            break;
+        case 'W':
+            index = handleW(index);
+            break;
+        case 'X':
+            index = handleX(index);
+            break;
+        case 'Z':
+            index = handleZ(index);
+            break;
+        default:
+            ++index;
+            break;
+        }
+    }
+
+    primary.truncate(DoubleMetaphone::maximumKeyLength);
+    alternate.truncate(DoubleMetaphone::maximumKeyLength);
+}
+
+int
+DoubleMetaphoneEncoding::handleC(int index)
+{
+    // Various Germanic, e.g. "bacher", "macher"
+    if (contains(index, "CHIA")
+        || (index > 1 && !isVowel(index - 2) && contains(index - 1, "ACH")
+            && ((at(index + 2) != 'I' && at(index + 2) != 'E') || contains(index - 2, "BACHER|MACHER"))))
+    {
+        add("K");
+        return index + 2;
+    }
+
+    if (index == 0 && contains(index, "CAESAR"))
+    {
+        add("S");
+        return index + 2;
+    }
+
+    if (contains(index, "CH"))
+        return handleCH(index);
+
+    // "Czerny"
+    if (contains(index, "CZ") && !contains(index - 2, "WICZ"))
+    {
+        add("S", "X");
+        return index + 2;
+    }
+
+    // "focaccia"
+    if (contains(index + 1, "CIA"))
+    {
+        add("X");
+        return index + 3;
+    }
+
+    // Double "cc", but not "McClelland"
+    if (contains(index, "CC") && !(index == 1 && at(0) == 'M'))
+        return handleCC(index);
+
+    if (contains(index, "CK|CG|CQ"))
+    {
+        add("K");
+        return index + 2;
+    }
+
+    // Italian and English
+    if (contains(index, "CI|CE|CY"))
+    {
+        if (contains(index, "CIO|CIE|CIA"))
+            add("S", "X");
+        else
+            add("S");
+
+        return index + 2;
+    }
+
+    add("K");
+
+    // "Mac Caffrey", "Mac Gregor"
+    if (contains(index + 1, " C| Q| G"))
+        return index + 3;
+
+    if (contains(index + 1, "C|K|Q") && !contains(index + 1, "CE|CI"))
+        return index + 2;
+
+    return index + 1;
+}
+
+int
+DoubleMetaphoneEncoding::handleCC(int index)
+{
+    // "bellocchio", but not "bacchus"
+    if (contains(index + 2, "I|E|H") && !contains(index + 2, "HU"))
+    {
+        // "accident", "accede", "succeed"
+        if ((index == 1 && at(0) == 'A') || contains(index - 1, "UCCEE|UCCES"))
+            add("KS");
+        // "bacci", "bertucci" and other Italian
+        else
+            add("X");
+
+        return index + 3;
+    }
+
+    // Pierce's rule
+    add("K");
+    return index + 2;
+}
+
+int
+DoubleMetaphoneEncoding::handleCH(int index)
+{
+    // "Michael"
+    if (index > 0 && contains(index, "CHAE"))
+    {
+        add("K", "X");
+        return index + 2;
+    }
+
+    // Greek roots, e.g. "chemistry", "chorus"
+    if (index == 0 && (contains(index + 1, "HARAC|HARIS") || contains(index + 1, "HOR|HYM|HIA|HEM"))
+        && !contains(0, "CHORE"))
+    {
+        add("K");
+        return index + 2;
+    }
+
+    // Germanic, Greek or otherwise "ch" for the "kh" sound
+    if (germanic || contains(index - 2, "ORCHES|ARCHIT|ORCHID") || contains(index + 2, "T|S")
+        || ((index == 0 || contains(index - 1, "A|O|U|E"))
+            && (contains(index + 2, "L|R|N|M|B|H|F|V|W| ") || index + 1 == last)))
+    {
+        add("K");
+        return index + 2;
+    }
+
+    if (index == 0)
+        add("X");
+    else if (contains(0, "MC"))
+        add("K");
+    else
+        add("X", "K");
+
+    return index + 2;
+}
+
+int
+DoubleMetaphoneEncoding::handleD(int index)
+{
+    if (contains(index, "DG"))
+    {
+        // "edge"
+        if (contains(index + 2, "I|E|Y"))
+        {
+            add("J");
+            return index + 3;
+        }
+
+        // "Edgar"
+        add("TK");
+        return index + 2;
+    }
+
+    add("T");
+    return contains(index, "DT|DD") ? index + 2 : index + 1;
+}
+
+int
+DoubleMetaphoneEncoding::handleG(int index)
+{
+    if (at(index + 1) == 'H')
+        return handleGH(index);
+
+    if (at(index + 1) == 'N')
+    {
+        if (index == 1 && isVowel(0) && !slavoGermanic)
+            add("KN", "N");
+        // Not e.g. "Cagney"
+        else if (!contains(index + 2, "EY") && !slavoGermanic)
+            add("N", "KN");
+        else
+            add("KN");
+
+        return index + 2;
+    }
+
+    // "Tagliaro"
+    if (contains(index + 1, "LI") && !slavoGermanic)
+    {
+        add("KL", "L");
+        return index + 2;
+    }
+
+    // "-ges-", "-gep-", "-gel-", "-gie-" at the beginning
+    if (index == 0 && (at(index + 1) == 'Y' || contains(index + 1, "ES|EP|EB|EL|EY|IB|IL|IN|IE|EI|ER")))
+    {
+        add("K", "J");
+        return index + 2;
+    }
+
+    // "-ger-", "-gy-"
+    if ((contains(index + 1, "ER") || at(index + 1) == 'Y')
+        && !contains(0, "DANGER|RANGER|MANGER") && !contains(index - 1, "E|I") && !contains(index - 1, "RGY|OGY"))
+    {
+        add("K", "J");
+        return index + 2;
+    }
+
+    // Italian, e.g. "biaggi"
+    if (contains(index + 1, "E|I|Y") || contains(index - 1, "AGGI|OGGI"))
+    {
+        // Obviously Germanic
+        if (germanic || contains(index + 1, "ET"))
+            add("K");
+        else if (contains(index + 1, "IER"))
+            add("J");
+        else
+            add("J", "K");
+
+        return index + 2;
+    }
+
+    add("K");
+    return at(index + 1) == 'G' ? index + 2 : index + 1;
+}
+
+int
+DoubleMetaphoneEncoding::handleGH(int index)
+{
+    if (index > 0 && !isVowel(index - 1))
+    {
+        add("K");
+        return index + 2;
+    }
+
+    // "ghislane", "ghiradelli"
+    if (index == 0)
+    {
+        add(at(index + 2) == 'I' ? "J" : "K");
+        return index + 2;
+    }
+
+    // Parker's rule with some further refinements, e.g. "hugh"
+    if ((index > 1 && contains(index - 2, "B|H|D")) || (index > 2 && contains(index - 3, "B|H|D"))
+        || (index > 3 && contains(index - 4, "B|H")))
+        return index + 2;
+
+    // "laugh", "McLaughlin", "cough", "gough", "rough", "tough"
+    if (index > 2 && at(index - 1) == 'U' && contains(index - 3, "C|G|L|R|T"))
+        add("F");
+    else if (at(index - 1) != 'I')
+        add("K");
+
+    return index + 2;
+}
+
+int
+DoubleMetaphoneEncoding::handleH(int index)
+{
+    // Only kept at the beginning or between vowels, also takes care of "hh"
+    if ((index == 0 || isVowel(index - 1)) && isVowel(index + 1))
+    {
+        add("H");
+        return index + 2;
+    }
+
+    return index + 1;
+}
+
+int
+DoubleMetaphoneEncoding::handleJ(int index)
+{
+    // Obviously Spanish, e.g. "Jose", "San Jacinto"
+    if (contains(index, "JOSE") || contains(0, "SAN "))
+    {
+        if ((index == 0 && (at(index + 4) == ' ' || value.size() == 4)) || contains(0, "SAN "))
+            add("H");
+        else
+            add("J", "H");
+
+        return index + 1;
+    }
+
+    if (index == 0)
+        add("J", "A");
+    // Spanish pronunciation of e.g. "bajador"
+    else if (isVowel(index - 1) && !slavoGermanic && (at(index + 1) == 'A' || at(index + 1) == 'O'))
+        add("J", "H");
+    else if (index == last)
+        add("J", "");
+    else if (!contains(index + 1, "L|T|K|S|N|M|B|Z") && !contains(index - 1, "S|K|L"))
+        add("J");
+
+    return at(index + 1) == 'J' ? index + 2 : index + 1;
+}
+
+int
+DoubleMetaphoneEncoding::handleL(int index)
+{
+    if (at(index + 1) != 'L')
+    {
+        add("L");
+        return index + 1;
+    }
+
+    // Spanish, e.g. "cabrillo", "gallegos"
+    if ((index == last - 2 && contains(index - 1, "ILLO|ILLA|ALLE"))
+        || ((contains(last - 1, "AS|OS") || contains(last, "A|O")) && contains(index - 1, "ALLE")))
+        add("L", "");
+    else
+        add("L");
+
+    return index + 2;
+}
+
+int
+DoubleMetaphoneEncoding::handleM(int index)
+{
+    add("M");
+
+    // "dumb", "thumb"
+    if (at(index + 1) == 'M' || (contains(index - 1, "UMB") && (index + 1 == last || contains(index + 2, "ER"))))
+        return index + 2;
+
+    return index + 1;
+}
+
+int
+DoubleMetaphoneEncoding::handleP(int index)
+{
+    if (at(index + 1) == 'H')
+    {
+        add("F");
+        return index + 2;
+    }
+
+    // Also accounts for "Campbell", "raspberry"
+    add("P");
+    return contains(index + 1, "P|B") ? index + 2 : index + 1;
+}
+
+int
+DoubleMetaphoneEncoding::handleR(int index)
+{
+    // French, e.g. "Rogier", but not "Hochmeier"
+    if (index == last && !slavoGermanic && contains(index - 2, "IE") && !contains(index - 4, "ME|MA"))
+        add("", "R");
+    else
+        add("R");
+
+    return at(index + 1) == 'R' ? index + 2 : index + 1;
+}
+
+int
+DoubleMetaphoneEncoding::handleS(int index)
+{
+    // "island", "isle", "carlisle", "carlysle"
+    if (contains(index - 1, "ISL|YSL"))
+        return index + 1;
+
+    // "sugar-"
+    if (index == 0 && contains(index, "SUGAR"))
+    {
+        add("X", "S");
+        return index + 1;
+    }
+
+    if (contains(index, "SH"))
+    {
+        // Germanic
+        if (contains(index + 1, "HEIM|HOEK|HOLM|HOLZ"))
+            add("S");
+        else
+            add("X");
+
+        return index + 2;
+    }
+
+    // Italian and Armenian
+    if (contains(index, "SIO|SIA"))
+    {
+        if (slavoGermanic)
+            add("S");
+        else
+            add("S", "X");
+
+        return index + 3;
+    }
+
+    // German and anglicisations, e.g. "smith" matches "schmidt" and "snider"
+    // matches "schneider", also "-sz-" in Slavic languages
+    if ((index == 0 && contains(index + 1, "M|N|L|W")) || contains(index + 1, "Z"))
+    {
+        add("S", "X");
+        return contains(index + 1, "Z") ? index + 2 : index + 1;
+    }
+
+    if (contains(index, "SC"))
+        return handleSC(index);
+
+    // French, e.g. "resnais", "artois"
+    if (index == last && contains(index - 2, "AI|OI"))
+        add("", "S");
+    else
+        add("S");
+
+    return contains(index + 1, "S|Z") ? index + 2 : index + 1;
+}
+
+int
+DoubleMetaphoneEncoding::handleSC(int index)
+{
+    // Schlesinger's rule
+    if (at(index + 2) == 'H')
+    {
+        // Dutch origin, e.g. "school", "schooner"
+        if (contains(index + 3, "OO|ER|EN|UY|ED|EM"))
+        {
+            // "schermerhorn", "schenker"
+            if (contains(index + 3, "ER|EN"))
+                add("X", "SK");
+            else
+                add("SK");
+        }
+        else if (index == 0 && !isVowel(3) && at(3) != 'W')
+        {
+            add("X", "S");
+        }
+        else
+        {
+            add("X");
+        }
+    }
+    else if (contains(index + 2, "I|E|Y"))
+    {
+        add("S");
+    }
+    else
+    {
+        add("SK");
+    }
+
+    return index + 3;
+}
+
+int
+DoubleMetaphoneEncoding::handleT(int index)
+{
+    if (contains(index, "TION|TIA|TCH"))
+    {
+        add("X");
+        return index + 3;
+    }
+
+    if (contains(index, "TH|TTH"))
+    {
+        // "Thomas", "Thames" or Germanic
+        if (contains(index + 2, "OM|AM") || germanic)
+            add("T");
+        else
+            add("0", "T");
+
+        return index + 2;
+    }
+
+    add("T");
+    return contains(index + 1, "T|D") ? index + 2 : index + 1;
+}
+
+int
+DoubleMetaphoneEncoding::handleW(int index)
+{
+    // Also in the middle of the word
+    if (contains(index, "WR"))
+    {
+        add("R");
+        return index + 2;
+    }
+
+    if (index == 0 && (isVowel(index + 1) || contains(index, "WH")))
+    {
+        // "Wasserman" matches "Vasserman", "Uomo" matches "Womo"
+        if (isVowel(index + 1))
+            add("A", "F");
+        else
+            add("A");
+
+        return index + 1;
+    }
+
+    // "Arnow" matches "Arnoff"
+    if ((index == last && isVowel(index - 1)) || contains(index - 1, "EWSKI|EWSKY|OWSKI|OWSKY") || contains(0, "SCH"))
+    {
+        add("", "F");
+        return index + 1;
+    }
+
+    // Polish, e.g. "Filipowicz"
+    if (contains(index, "WICZ|WITZ"))
+    {
+        add("TS", "FX");
+        return index + 4;
+    }
+
+    return index + 1;
+}
+
+int
+DoubleMetaphoneEncoding::handleX(int index)
+{
+    // "Xavier"
+    if (index == 0)
+    {
+        add("S");
+        return index + 1;
+    }
+
+    // French, e.g. "breaux"
+    if (!(index == last && (contains(index - 3, "IAU|EAU") || contains(index - 2, "AU|OU"))))
+        add("KS");
+
+    return contains(index + 1, "C|X") ? index + 2 : index + 1;
+}
+
+int
+DoubleMetaphoneEncoding::handleZ(int index)
+{
+    // Chinese pinyin, e.g. "Zhao"
+    if (at(index + 1) == 'H')
+    {
+        add("J");
+        return index + 2;
+    }
+
+    if (contains(index + 1, "ZO|ZI|ZA") || (slavoGermanic && index > 0 && at(index - 1) != 'T'))
+        add("S", "TS");
+    else
+        add("S");
+
+    return at(index + 1) == 'Z' ? index + 2 : index + 1;
+}
+
+// Converts the word to the upper case letters of the rules, returns false if
+// the word is not written in the Latin script
+static bool
+prepare(const quint32 *word, int length, QByteArray& value)
+{
+    value.reserve(length);
+
+    for (int i = 0; i < length; ++i)
+    {
+        quint32 character = word[i];
+
+        if (character >= 'a' && character <= 'z')
+            value.append(char(character - 'a' + 'A'));
+        else if (character >= 'A' && character <= 'Z')
+            value.append(char(character));
+        else if (character == ' ' || character == '-')
+            value.append(' ');
+        else if (character == 0xe7 || character == 0xc7)
+            value.append(cedilla);
+        else if (character == 0xf1 || character == 0xd1)
+            value.append(tilde);
+        else if (character == 0xdf)
+            value.append("SS");
+        else if (character < 0x80 || !QChar::isLetter(character))
+            continue;
+        else if (character < 0x250 || (character >= 0x1e00 && character < 0x1f00))
+        {
+            // Latin letters with diacritics, e.g. "é", "ő", "ş"
+            QString decomposition = QChar::decomposition(character);
+            if (decomposition.isEmpty() || decomposition.at(0).unicode() >= 0x80
+                    || !decomposition.at(0).isLetter())
+                continue;
+
+            value.append(decomposition.at(0).toUpper().toLatin1());
+        }
+        else
+            return false;
+    }
+
+    return !value.trimmed().isEmpty();
+}
+
+DoubleMetaphone::DoubleMetaphone()
+{
+}
+
+DoubleMetaphone::~DoubleMetaphone()
+{
+}
+
+QByteArray
+DoubleMetaphone::name() const
+{
+    return "doublemetaphone";
+}
+
+QList<QByteArray>
+DoubleMetaphone::encode(const quint32 *word, int length) const
+{
+    QList<QByteArray> keys;
+
+    QByteArray value;
+    if (!prepare(word, length, value))
+        return keys;
+
+    DoubleMetaphoneEncoding encoding(value);
+    encoding.encode();
+
+    if (!encoding.primary.isEmpty())
+        keys.append(encoding.primary);
+
+    if (!encoding.alternate.isEmpty() && encoding.alternate != encoding.primary)
+        keys.append(encoding.alternate);
+
+    return keys;
+}
@@ -0,0 +1,67 @@
+/******************************************************************************
+ * This file is part of the Mula project
+ * Copyright (c) 2011 Laszlo Papp <lpapp@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef MULA_PLUGIN_STARDICT_DOUBLEMETAPHONE_H
+#define MULA_PLUGIN_STARDICT_DOUBLEMETAPHONE_H
+
+#include "phoneticencoder.h"
+
+namespace MulaPluginStarDict
+{
+    /**
+     * \brief Phonetic encoder implementing the Double Metaphone algorithm of
+     * Lawrence Philips
+     *
+     * The word is reduced to its consonant sounds, and the vowels are only
+     * kept at the beginning of the word, e.g. both "knowledge" and "nolij"
+     * are encoded as "NLJ". The rules cover the English spelling and the
+     * usual spelling of the names of Germanic, Slavic, Romance, Greek and
+     * Chinese origin. Where the pronunciation depends on the origin of the
+     * word, an alternate key is returned as well, e.g. "Smith" is "SM0" or
+     * "XMT", which matches "Schmidt".
+     *
+     * Only the words of the Latin script are encoded. The letters with
+     * diacritics are reduced to their base letters, except for "ç" and "ñ"
+     * which have their own rules.
+     */
+
+    class DoubleMetaphone : public PhoneticEncoder
+    {
+        public:
+
+            /**
+             * Constructor
+             */
+
+            DoubleMetaphone();
+
+            /**
+             * Destructor
+             */
+
+            virtual ~DoubleMetaphone();
+
+            QByteArray name() const;
+            QList<QByteArray> encode(const quint32 *word, int length) const;
+
+            static const int maximumKeyLength = 4;
+    };
+}
+
+#endif // MULA_PLUGIN_STARDICT_DOUBLEMETAPHONE_H
@@ -30,4 +30,20 @@ static inline int stardictStringCompare(QString string1, QString string2)
     return retval ? retval : string1.compare(string2);
 }
 
+// The StarDict tools sort the index files comparing only the ASCII letters
+// case-insensitively, so the headwords equal after this folding are adjacent
+// in the index, while "Ärger" and "ärger" may be far apart
+static inline QString asciiCaseFolded(const QString& string)
+{
+    QString folded = string;
+    for (int i = 0; i < folded.size(); ++i)
+    {
+        ushort character = folded.at(i).unicode();
+        if (character >= 'A' && character <= 'Z')
+            folded[i] = QChar(character - 'A' + 'a');
+    }
+
+    return folded;
+}
+
 #endif // MULA_PLUGIN_STARDICT_FILE
@@ -0,0 +1,168 @@
+/******************************************************************************
+ * This file is part of the Mula project
+ * Copyright (c) 2011 Laszlo Papp <lpapp@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "fuzzysearchjob.h"
+
+#include "abstractindexfile.h"
+#include "distance.h"
+
+#include <QtCore/QScopedPointer>
+#include <QtCore/QSemaphore>
+
+#include <algorithm>
+
+using namespace MulaPluginStarDict;
+
+class FuzzySearchJob::Private
+{
+    public:
+        Private(AbstractIndexFile *indexReader, const quint32 *searchWord, int searchWordLength,
+                int first, int last, int resultListSize, QAtomicInt *cutoff, QSemaphore *finished)
+            : indexReader(indexReader)
+            , searchWord(searchWordLength)
+            , first(first)
+            , last(last)
+            , resultListSize(resultListSize)
+            , cutoff(cutoff)
+            , finished(finished)
+        {
+            for (int i = 0; i < searchWordLength; ++i)
+                this->searchWord[i] = searchWord[i];
+        }
+
+        ~Private()
+        {
+        }
+
+        void search();
+        void insert(const FuzzyMatch& match);
+        void lowerCutoff(int distance);
+
+        // The length of the words in the index file should be less than 256
+        static const int maximumWordLength = 256;
+
+        QScopedPointer<AbstractIndexFile> indexReader;
+        QVector<quint32> searchWord;
+        int first;
+        int last;
+        int resultListSize;
+        QAtomicInt *cutoff;
+        QSemaphore *finished;
+
+        // Max-heap of the best matches, the worst one is on the top
+        QVector<FuzzyMatch> heap;
+};
+
+void
+FuzzySearchJob::Private::insert(const FuzzyMatch& match)
+{
+    // The same headword can occur more than once in the index
+    foreach (const FuzzyMatch& heapMatch, heap)
+    {
+        if (heapMatch.word == match.word)
+            return;
+    }
+
+    if (heap.size() == resultListSize)
+    {
+        if (!(match < heap.first()))
+            return;
+
+        std::pop_heap(heap.begin(), heap.end());
+        heap.last() = match;
+    }
+    else
+    {
+        heap.append(match);
+    }
+
+    std::push_heap(heap.begin(), heap.end());
+
+    if (heap.size() == resultListSize)
+        lowerCutoff(heap.first().distance);
+}
+
+void
+FuzzySearchJob::Private::lowerCutoff(int distance)
+{
+    int current = cutoff->load();
+    while (distance < current && !cutoff->testAndSetOrdered(current, distance))
+        current = cutoff->load();
+}
+
+FuzzySearchJob::FuzzySearchJob(AbstractIndexFile *indexReader, const quint32 *searchWord, int searchWordLength,
+                               int first, int last, int resultListSize, QAtomicInt *cutoff, QSemaphore *finished)
+    : d(new Private(indexReader, searchWord, searchWordLength, first, last, resultListSize, cutoff, finished))
+{
+    setAutoDelete(false);
+}
+
+FuzzySearchJob::~FuzzySearchJob()
+{
+    delete d;
+}
+
+QVector<FuzzyMatch>
+FuzzySearchJob::matches() const
+{
+    return d->heap;
+}
+
+void
+FuzzySearchJob::Private::search()
+{
+    const quint32 *searchData = searchWord.constData();
+    const int searchWordLength = searchWord.size();
+    quint32 checkWord[maximumWordLength];
+
+    for (int index = first; index < last; ++index)
+    {
+        // Every distance above the cutoff is rejected by all the jobs
+        int limit = cutoff->load() + 1;
+
+        QByteArray word = indexReader->key(index);
+        int checkWordLength = BitParallelEditDistance::foldUtf8(word.constData(), word.size(),
+                                                                checkWord, maximumWordLength);
+
+        // skip too long or too short words
+        if (checkWordLength - searchWordLength >= limit || searchWordLength - checkWordLength >= limit)
+            continue;
+
+        int distance = BitParallelEditDistance::distance(checkWord, checkWordLength, searchData, searchWordLength, limit);
+
+        // when the search word is short, we need less fuzzy
+        if (distance < limit && distance < searchWordLength)
+        {
+            FuzzyMatch match;
+            match.distance = distance;
+            match.index = index;
+            match.word = word;
+            insert(match);
+        }
+    }
+}
+
+void
+FuzzySearchJob::run()
+{
+    if (d->resultListSize > 0)
+        d->search();
+
+    d->finished->release();
+}
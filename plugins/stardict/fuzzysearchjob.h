@@ -0,0 +1,130 @@
+/******************************************************************************
+ * This file is part of the Mula project
+ * Copyright (c) 2011 Laszlo Papp <lpapp@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef MULA_PLUGIN_STARDICT_FUZZYSEARCHJOB_H
+#define MULA_PLUGIN_STARDICT_FUZZYSEARCHJOB_H
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QByteArray>
+#include <QtCore/QRunnable>
+#include <QtCore/QVector>
+
+class QSemaphore;
+
+namespace MulaPluginStarDict
+{
+    class AbstractIndexFile;
+
+    /**
+     * \brief A headword found by the fuzzy search with its distance
+     */
+
+    struct FuzzyMatch
+    {
+        int distance;
+        int index;
+        QByteArray word;
+    };
+
+    /**
+     * Orders the matches by distance, and the matches of the same distance
+     * by their position in the index, hence the best matches are the same as
+     * the ones of a sequential scan regardless of how the range is split.
+     */
+
+    inline bool
+    operator<(const FuzzyMatch& left, const FuzzyMatch& right)
+    {
+        return left.distance != right.distance ? left.distance < right.distance : left.index < right.index;
+    }
+
+    /**
+     * \brief Computes the edit distance of the search word against a range of
+     * headwords.
+     *
+     * The job is used for the parallel fuzzy search. The headwords of a
+     * dictionary are split into contiguous ranges, and each range is
+     * processed by a separate job on a thread pool through its own index
+     * reader.
+     *
+     * Every job keeps its best matches in a bounded max-heap. Once the heap of
+     * a job is full, the distance of its worst match bounds the distance of
+     * the overall results, so it is published in the cutoff shared by the
+     * jobs. Every job uses the smallest cutoff as the limit of the distance
+     * computation, which tightens the search of all the jobs.
+     *
+     * \note The job is not deleted automatically by the thread pool, since the
+     * results need to be fetched after it has finished. The end of the job is
+     * signaled through a semaphore, so that a search only waits for its own
+     * jobs rather than for every job of the shared pool.
+     *
+     * \see StarDictDictionaryManager::lookupWithFuzzy
+     */
+
+    class FuzzySearchJob : public QRunnable
+    {
+        public:
+
+            /**
+             * Constructor
+             *
+             * @param indexReader       The index reader of the job, the job
+             * takes its ownership
+             * @param searchWord        The lower case UTF-32 search word
+             * @param searchWordLength  The length of the search word
+             * @param first             The index of the first headword of the
+             * range
+             * @param last              The index after the last headword of
+             * the range
+             * @param resultListSize    The maximum number of matches
+             * @param cutoff            The largest distance that can still be
+             * accepted, shared by the jobs of the search
+             * @param finished          The semaphore released once the job has
+             * finished, shared by the jobs of the search
+             */
+
+            FuzzySearchJob(AbstractIndexFile *indexReader, const quint32 *searchWord, int searchWordLength,
+                           int first, int last, int resultListSize, QAtomicInt *cutoff, QSemaphore *finished);
+
+            /**
+             * Destructor
+             */
+
+            virtual ~FuzzySearchJob();
+
+            /**
+             * Returns the best matches found in the range, in no particular
+             * order
+             *
+             * @return The best matches of the range
+             */
+
+            QVector<FuzzyMatch> matches() const;
+
+            /** Reimplemented from QRunnable::run() */
+
+            void run();
+
+        private:
+            class Private;
+            Private *const d;
+    };
+}
+
+#endif // MULA_PLUGIN_STARDICT_FUZZYSEARCHJOB_H
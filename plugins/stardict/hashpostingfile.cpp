@@ -0,0 +1,200 @@
+/******************************************************************************
+ * This file is part of the Mula project
+ * Copyright (c) 2011 Laszlo Papp <lpapp@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "hashpostingfile.h"
+
+#include "cachelocations.h"
+
+#include <QtCore/QDateTime>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QSaveFile>
+#include <QtCore/QtAlgorithms>
+#include <QtCore/QDebug>
+
+using namespace MulaPluginStarDict;
+
+class HashPostingFile::Private
+{
+    public:
+        Private(const QByteArray& magicString, const QString& extension)
+            : cacheMagicString(magicString)
+            , extension(extension)
+            , mappedData(0)
+            , postingCount(0)
+            , postings(0)
+        {
+        }
+
+        ~Private()
+        {
+        }
+
+        void unload();
+
+        QByteArray cacheMagicString;
+        QString extension;
+        QFile mapFile;
+        uchar *mappedData;
+
+        quint32 postingCount;
+        const HashPosting *postings;
+};
+
+void
+HashPostingFile::Private::unload()
+{
+    if (mappedData)
+        mapFile.unmap(mappedData);
+
+    mapFile.close();
+    mappedData = 0;
+    postingCount = 0;
+    postings = 0;
+}
+
+HashPostingFile::HashPostingFile(const QByteArray& magicString, const QString& extension)
+    : d(new Private(magicString, extension))
+{
+}
+
+HashPostingFile::~HashPostingFile()
+{
+    d->unload();
+    delete d;
+}
+
+bool
+HashPostingFile::isLoaded() const
+{
+    return d->postings != 0;
+}
+
+int
+HashPostingFile::postingCount() const
+{
+    return d->postingCount;
+}
+
+qint64
+HashPostingFile::fileSize() const
+{
+    return isLoaded() ? d->mapFile.size() : 0;
+}
+
+bool
+HashPostingFile::load(const QString& indexFilePath)
+{
+    const int headerSize = d->cacheMagicString.size() + sizeof(quint32);
+
+    foreach (const QString& cacheLocation, cacheLocations(indexFilePath, d->extension))
+    {
+        QFileInfo fileInfoIndex(indexFilePath);
+        QFileInfo fileInfoCache(cacheLocation);
+
+        if (!fileInfoCache.exists() || fileInfoCache.lastModified() < fileInfoIndex.lastModified())
+            continue;
+
+        d->unload();
+
+        d->mapFile.setFileName(cacheLocation);
+        if (!d->mapFile.open(QIODevice::ReadOnly))
+        {
+            qDebug() << "Failed to open file:" << cacheLocation;
+            continue;
+        }
+
+        if (d->mapFile.size() < headerSize)
+            continue;
+
+        d->mappedData = d->mapFile.map(0, d->mapFile.size());
+        if (d->mappedData == NULL)
+        {
+            qDebug() << Q_FUNC_INFO << QString("Mapping the file %1 failed!").arg(cacheLocation);
+            continue;
+        }
+
+        if (d->cacheMagicString != QByteArray::fromRawData(reinterpret_cast<const char*>(d->mappedData), d->cacheMagicString.size()))
+            continue;
+
+        quint32 postingCount = *reinterpret_cast<const quint32*>(d->mappedData + d->cacheMagicString.size());
+        if (postingCount == 0 || d->mapFile.size() != headerSize + qint64(postingCount) * sizeof(HashPosting))
+            continue;
+
+        d->postingCount = postingCount;
+        d->postings = reinterpret_cast<const HashPosting*>(d->mappedData + headerSize);
+
+        return true;
+    }
+
+    d->unload();
+    return false;
+}
+
+bool
+HashPostingFile::save(const QString& indexFilePath, QVector<HashPosting>& postings)
+{
+    if (postings.isEmpty())
+        return false;
+
+    qSort(postings);
+
+    foreach (const QString& cacheLocation, cacheLocations(indexFilePath, d->extension))
+    {
+        QSaveFile file(cacheLocation);
+        if (!file.open(QIODevice::WriteOnly))
+        {
+            qDebug() << "Failed to open file for writing:" << cacheLocation;
+            continue;
+        }
+
+        quint32 postingCount = postings.size();
+        qint64 postingsSize = postings.size() * sizeof(HashPosting);
+
+        if (file.write(d->cacheMagicString) != d->cacheMagicString.size()
+            || file.write(reinterpret_cast<const char*>(&postingCount), sizeof(postingCount)) != sizeof(postingCount)
+            || file.write(reinterpret_cast<const char*>(postings.constData()), postingsSize) != postingsSize
+            || !file.commit())
+        {
+            continue;
+        }
+
+        qDebug() << "Save to cache" << cacheLocation;
+
+        return load(indexFilePath);
+    }
+
+    return false;
+}
+
+void
+HashPostingFile::find(quint32 hash, QVector<quint32>& ids) const
+{
+    if (!isLoaded())
+        return;
+
+    HashPosting key;
+    key.hash = hash;
+    key.id = 0;
+
+    // The first posting not less than the smallest one of the hash
+    const HashPosting *it = qLowerBound(d->postings, d->postings + d->postingCount, key);
+    for (; it != d->postings + d->postingCount && it->hash == hash; ++it)
+        ids.append(it->id);
+}
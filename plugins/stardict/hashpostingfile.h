@@ -0,0 +1,153 @@
+/******************************************************************************
+ * This file is part of the Mula project
+ * Copyright (c) 2011 Laszlo Papp <lpapp@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef MULA_PLUGIN_STARDICT_HASHPOSTINGFILE_H
+#define MULA_PLUGIN_STARDICT_HASHPOSTINGFILE_H
+
+#include <QtCore/QByteArray>
+#include <QtCore/QVector>
+
+class QString;
+
+namespace MulaPluginStarDict
+{
+    /**
+     * \brief An entry of a posting file, the hash of a key and the index of
+     * a word entry that belongs to the key
+     */
+
+    struct HashPosting
+    {
+        quint32 hash;
+        quint32 id;
+    };
+
+    inline bool
+    operator<(const HashPosting& left, const HashPosting& right)
+    {
+        return left.hash != right.hash ? left.hash < right.hash : left.id < right.id;
+    }
+
+    /**
+     * \brief Persisted multimap from key hashes to word entry indices
+     *
+     * The postings are stored sorted by hash in a flat, native byte ordered
+     * cache file next to the index file, or in the cache folder, which is
+     * mapped into the memory when loaded. The word entry indices of a hash
+     * are found by a binary search, so the file is usable right after the
+     * mapping without any parsing.
+     *
+     * The file is shared by the indices that map some derived keys of the
+     * headwords to the headwords, the magic string of the file tells the
+     * indices apart. The hashes are not verified, so the users need to check
+     * the returned word entries.
+     *
+     * \see cacheLocations
+     */
+
+    class HashPostingFile
+    {
+        public:
+
+            /**
+             * Constructor
+             *
+             * @param   magicString     The magic string of the file format
+             * @param   extension       The extension of the cache file
+             */
+
+            HashPostingFile(const QByteArray& magicString, const QString& extension);
+
+            /**
+             * Destructor
+             */
+
+            virtual ~HashPostingFile();
+
+            /**
+             * Loads the cache file belonging to the desired index file. The
+             * cache is ignored if it is older than the index file.
+             *
+             * @param   indexFilePath   The complete file path of the index file
+             *
+             * @return True if the loading was successful, otherwise false.
+             *
+             * @see save
+             */
+
+            bool load(const QString& indexFilePath);
+
+            /**
+             * Sorts the postings, saves them into the cache file belonging to
+             * the desired index file and loads the saved file. The file is
+             * replaced atomically, so it can be written while other processes
+             * or threads are loading it.
+             *
+             * @param   indexFilePath   The complete file path of the index file
+             * @param   postings        The postings in any order
+             *
+             * @return True if the saving and the loading was successful,
+             * otherwise false.
+             *
+             * @see load
+             */
+
+            bool save(const QString& indexFilePath, QVector<HashPosting>& postings);
+
+            /**
+             * Returns whether the postings are loaded
+             *
+             * @return True if the postings are loaded, otherwise false.
+             */
+
+            bool isLoaded() const;
+
+            /**
+             * Returns the number of the postings
+             *
+             * @return The number of the postings
+             */
+
+            int postingCount() const;
+
+            /**
+             * Returns the size of the loaded cache file in bytes
+             *
+             * @return The size of the cache file
+             */
+
+            qint64 fileSize() const;
+
+            /**
+             * Appends the word entry indices that belong to the hash to the
+             * list. The indices are appended in ascending order.
+             *
+             * @param   hash    The hash of the key
+             * @param   ids     The list to append the word entry indices to
+             */
+
+            void find(quint32 hash, QVector<quint32>& ids) const;
+
+        private:
+            class Private;
+            Private *const d;
+    };
+}
+
+#endif // MULA_PLUGIN_STARDICT_HASHPOSTINGFILE_H
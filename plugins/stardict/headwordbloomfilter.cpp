@@ -0,0 +1,279 @@
+/******************************************************************************
+ * This file is part of the Mula project
+ * Copyright (c) 2011 Laszlo Papp <lpapp@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "headwordbloomfilter.h"
+
+#include "cachelocations.h"
+#include "indexfilescanner.h"
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QSaveFile>
+#include <QtCore/QString>
+#include <QtCore/QVector>
+#include <QtCore/QDebug>
+
+using namespace MulaPluginStarDict;
+
+class HeadwordBloomFilter::Private
+{
+    public:
+        Private()
+            : cacheMagicString("StarDict's Bloom Filter, Version: 0.1")
+            , mappedData(0)
+            , blockCount(0)
+            , hashCount(0)
+            , blocks(0)
+        {
+        }
+
+        ~Private()
+        {
+        }
+
+        void unload();
+
+        static quint64 hash(const QString& word);
+        static void add(quint32 *blocks, quint32 blockCount, int hashCount, quint64 hash);
+        static bool contains(const quint32 *blocks, quint32 blockCount, int hashCount, quint64 hash);
+
+        static const int blockSize = 16; // the number of the 32 bit words in a block of a cache line
+        static const int bitsPerHeadword = 10;
+        static const int defaultHashCount = 7;
+
+        QByteArray cacheMagicString;
+        QFile mapFile;
+        uchar *mappedData;
+        quint32 blockCount;
+        quint32 hashCount;
+        const quint32 *blocks;
+};
+
+void
+HeadwordBloomFilter::Private::unload()
+{
+    if (mappedData)
+        mapFile.unmap(mappedData);
+
+    mapFile.close();
+    mappedData = 0;
+    blockCount = 0;
+    hashCount = 0;
+    blocks = 0;
+}
+
+quint64
+HeadwordBloomFilter::Private::hash(const QString& word)
+{
+    // FNV-1a over the lower case UTF-16 characters with a final mix, so the
+    // upper and the lower half are both usable
+    quint64 result = Q_UINT64_C(14695981039346656037);
+    foreach (QChar character, word.toLower())
+    {
+        result ^= character.unicode();
+        result *= Q_UINT64_C(1099511628211);
+    }
+
+    result ^= result >> 33;
+    result *= Q_UINT64_C(0xff51afd7ed558ccd);
+    result ^= result >> 33;
+
+    return result;
+}
+
+// The upper half of the hash selects the block, the lower half generates the
+// bit positions within the block by double hashing
+void
+HeadwordBloomFilter::Private::add(quint32 *blocks, quint32 blockCount, int hashCount, quint64 hash)
+{
+    quint32 *block = blocks + (((hash >> 32) * blockCount) >> 32) * blockSize;
+    quint32 bitHash = quint32(hash);
+    quint32 delta = (bitHash >> 17) | (bitHash << 15);
+
+    for (int i = 0; i < hashCount; ++i)
+    {
+        quint32 bit = bitHash & (blockSize * 32 - 1);
+        block[bit >> 5] |= 1u << (bit & 31);
+        bitHash += delta;
+    }
+}
+
+bool
+HeadwordBloomFilter::Private::contains(const quint32 *blocks, quint32 blockCount, int hashCount, quint64 hash)
+{
+    const quint32 *block = blocks + (((hash >> 32) * blockCount) >> 32) * blockSize;
+    quint32 bitHash = quint32(hash);
+    quint32 delta = (bitHash >> 17) | (bitHash << 15);
+
+    for (int i = 0; i < hashCount; ++i)
+    {
+        quint32 bit = bitHash & (blockSize * 32 - 1);
+        if (!(block[bit >> 5] & (1u << (bit & 31))))
+            return false;
+
+        bitHash += delta;
+    }
+
+    return true;
+}
+
+HeadwordBloomFilter::HeadwordBloomFilter()
+    : d(new Private)
+{
+}
+
+HeadwordBloomFilter::~HeadwordBloomFilter()
+{
+    d->unload();
+    delete d;
+}
+
+bool
+HeadwordBloomFilter::isLoaded() const
+{
+    return d->blocks != 0;
+}
+
+qint64
+HeadwordBloomFilter::fileSize() const
+{
+    return isLoaded() ? d->mapFile.size() : 0;
+}
+
+bool
+HeadwordBloomFilter::load(const QString& indexFilePath)
+{
+    const int headerSize = d->cacheMagicString.size() + 2 * sizeof(quint32);
+
+    foreach (const QString& cacheLocation, cacheLocations(indexFilePath, ".blm"))
+    {
+        QFileInfo fileInfoIndex(indexFilePath);
+        QFileInfo fileInfoCache(cacheLocation);
+
+        if (!fileInfoCache.exists() || fileInfoCache.lastModified() < fileInfoIndex.lastModified())
+            continue;
+
+        d->unload();
+
+        d->mapFile.setFileName(cacheLocation);
+        if (!d->mapFile.open(QIODevice::ReadOnly))
+        {
+            qDebug() << "Failed to open file:" << cacheLocation;
+            continue;
+        }
+
+        if (d->mapFile.size() < headerSize)
+            continue;
+
+        d->mappedData = d->mapFile.map(0, d->mapFile.size());
+        if (d->mappedData == NULL)
+        {
+            qDebug() << Q_FUNC_INFO << QString("Mapping the file %1 failed!").arg(cacheLocation);
+            continue;
+        }
+
+        if (d->cacheMagicString != QByteArray::fromRawData(reinterpret_cast<const char*>(d->mappedData), d->cacheMagicString.size()))
+            continue;
+
+        const quint32 *counts = reinterpret_cast<const quint32*>(d->mappedData + d->cacheMagicString.size());
+        quint32 blockCount = counts[0];
+        quint32 hashCount = counts[1];
+
+        if (blockCount == 0 || hashCount == 0
+            || d->mapFile.size() != headerSize + qint64(blockCount) * Private::blockSize * sizeof(quint32))
+            continue;
+
+        d->blockCount = blockCount;
+        d->hashCount = hashCount;
+        d->blocks = counts + 2;
+
+        return true;
+    }
+
+    d->unload();
+    return false;
+}
+
+bool
+HeadwordBloomFilter::build(const QString& indexFilePath)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    IndexFileScanner scanner;
+    if (!scanner.open(indexFilePath))
+        return false;
+
+    QVector<quint64> hashes;
+    while (scanner.next())
+        hashes.append(d->hash(QString::fromUtf8(scanner.word())));
+
+    if (hashes.isEmpty())
+        return false;
+
+    quint32 blockCount = (qint64(hashes.size()) * Private::bitsPerHeadword + Private::blockSize * 32 - 1) / (Private::blockSize * 32);
+    QVector<quint32> blocks(blockCount * Private::blockSize, 0);
+
+    foreach (quint64 hash, hashes)
+        d->add(blocks.data(), blockCount, Private::defaultHashCount, hash);
+
+    foreach (const QString& cacheLocation, cacheLocations(indexFilePath, ".blm"))
+    {
+        QSaveFile file(cacheLocation);
+        if (!file.open(QIODevice::WriteOnly))
+        {
+            qDebug() << "Failed to open file for writing:" << cacheLocation;
+            continue;
+        }
+
+        quint32 counts[2] = { blockCount, quint32(Private::defaultHashCount) };
+        qint64 blocksSize = blocks.size() * sizeof(quint32);
+
+        if (file.write(d->cacheMagicString) != d->cacheMagicString.size()
+            || file.write(reinterpret_cast<const char*>(counts), sizeof(counts)) != sizeof(counts)
+            || file.write(reinterpret_cast<const char*>(blocks.constData()), blocksSize) != blocksSize
+            || !file.commit())
+        {
+            continue;
+        }
+
+        qDebug() << "Save to cache" << cacheLocation;
+
+        if (!load(indexFilePath))
+            break;
+
+        qDebug() << "Built the Bloom filter for" << indexFilePath << "in" << timer.elapsed() << "ms,"
+                 << hashes.size() << "headwords," << fileSize() << "bytes";
+
+        return true;
+    }
+
+    qDebug() << "Failed to build the Bloom filter for" << indexFilePath;
+    return false;
+}
+
+bool
+HeadwordBloomFilter::mayContain(const QString& word) const
+{
+    if (!isLoaded())
+        return true;
+
+    return d->contains(d->blocks, d->blockCount, d->hashCount, d->hash(word));
+}
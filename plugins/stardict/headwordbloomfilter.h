@@ -0,0 +1,128 @@
+/******************************************************************************
+ * This file is part of the Mula project
+ * Copyright (c) 2011 Laszlo Papp <lpapp@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef MULA_PLUGIN_STARDICT_HEADWORDBLOOMFILTER_H
+#define MULA_PLUGIN_STARDICT_HEADWORDBLOOMFILTER_H
+
+#include <QtCore/QtGlobal>
+
+class QString;
+
+namespace MulaPluginStarDict
+{
+    /**
+     * \brief Blocked Bloom filter over the lower case headwords
+     *
+     * Most of the words probed by the similar word lookups, e.g. the case
+     * variants and the base forms of an inflected word, are not in the
+     * dictionary. The filter tells the definite misses apart with a few
+     * hashed reads from a single cache line, so only the possible hits pay
+     * for the binary search over the index file.
+     *
+     * Every headword sets a handful of bits in one 512 bit block selected by
+     * its hash, which keeps the false positive rate around 1% with 10 bits
+     * per headword. The headwords are folded to lower case, so the filter
+     * answers for all the case variants of a word at once.
+     *
+     * The filter is stored in a ".blm" file next to the offset cache file,
+     * which is mapped into the memory when loaded.
+     *
+     * \see cacheLocations
+     */
+
+    class HeadwordBloomFilter
+    {
+        public:
+
+            /**
+             * Constructor
+             */
+
+            HeadwordBloomFilter();
+
+            /**
+             * Destructor
+             */
+
+            virtual ~HeadwordBloomFilter();
+
+            /**
+             * Loads the cache file of the filter belonging to the desired
+             * index file. The cache is ignored if it is older than the index
+             * file.
+             *
+             * @param   indexFilePath   The complete file path of the index file
+             *
+             * @return True if the loading was successful, otherwise false.
+             *
+             * @see build
+             */
+
+            bool load(const QString& indexFilePath);
+
+            /**
+             * Builds the filter over all the headwords of the index file and
+             * saves it into the cache file. The headwords are read from the
+             * index file directly, so the method can be called from any
+             * thread.
+             *
+             * @param   indexFilePath   The complete file path of the index file
+             *
+             * @return True if the building was successful, otherwise false.
+             *
+             * @see load
+             */
+
+            bool build(const QString& indexFilePath);
+
+            /**
+             * Returns whether the filter is loaded
+             *
+             * @return True if the filter is loaded, otherwise false.
+             */
+
+            bool isLoaded() const;
+
+            /**
+             * Returns the size of the loaded cache file in bytes
+             *
+             * @return The size of the cache file
+             */
+
+            qint64 fileSize() const;
+
+            /**
+             * Returns whether the word may be a headword regardless of the
+             * case. False positives are possible, false negatives are not.
+             *
+             * @param   word    The word to check
+             *
+             * @return False if the word is definitely not a headword,
+             * otherwise true, including when the filter is not loaded.
+             */
+
+            bool mayContain(const QString& word) const;
+
+        private:
+            class Private;
+            Private *const d;
+    };
+}
+
+#endif // MULA_PLUGIN_STARDICT_HEADWORDBLOOMFILTER_H
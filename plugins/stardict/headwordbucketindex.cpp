@@ -0,0 +1,176 @@
+/******************************************************************************
+ * This file is part of the Mula project
+ * Copyright (c) 2011 Laszlo Papp <lpapp@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "headwordbucketindex.h"
+
+#include "distance.h"
+#include "hashpostingfile.h"
+#include "indexfilescanner.h"
+
+#include <QtCore/QString>
+#include <QtCore/QtAlgorithms>
+#include <QtCore/QDebug>
+
+#include <algorithm>
+
+using namespace MulaPluginStarDict;
+
+class HeadwordBucketIndex::Private
+{
+    public:
+        Private()
+            : postingFile("StarDict's Bucket Index, Version: 0.2", ".hbi")
+        {
+        }
+
+        ~Private()
+        {
+        }
+
+        static quint32 bucket(int position, int length, quint32 character);
+        static quint32 lengthBucket(int length);
+
+        // The leading characters are indexed up to this many edits, the
+        // larger distances only use the length buckets
+        static const int maximumIndexedDistance = 2;
+
+        // The position code of the buckets keyed by the length alone
+        static const int lengthPosition = 3;
+
+        // The length of the words in the index file should be less than 256
+        static const int maximumWordLength = 256;
+
+        HashPostingFile postingFile;
+};
+
+quint32
+HeadwordBucketIndex::Private::bucket(int position, int length, quint32 character)
+{
+    // The position in the two highest bits, then the length and the
+    // character, colliding characters only add a few candidates
+    return (quint32(position) << 30) | (quint32(qMin(length, 255)) << 22) | ((character * 2654435761u) >> 10);
+}
+
+quint32
+HeadwordBucketIndex::Private::lengthBucket(int length)
+{
+    return (quint32(lengthPosition) << 30) | (quint32(qMin(length, 255)) << 22);
+}
+
+HeadwordBucketIndex::HeadwordBucketIndex()
+    : d(new Private)
+{
+}
+
+HeadwordBucketIndex::~HeadwordBucketIndex()
+{
+    delete d;
+}
+
+bool
+HeadwordBucketIndex::isLoaded() const
+{
+    return d->postingFile.isLoaded();
+}
+
+bool
+HeadwordBucketIndex::load(const QString& indexFilePath)
+{
+    return d->postingFile.load(indexFilePath);
+}
+
+bool
+HeadwordBucketIndex::build(const QString& indexFilePath)
+{
+    IndexFileScanner scanner;
+    if (!scanner.open(indexFilePath))
+        return false;
+
+    quint32 word[d->maximumWordLength];
+    QVector<HashPosting> postings;
+
+    while (scanner.next())
+    {
+        QByteArray utf8Word = scanner.word();
+        int length = BitParallelEditDistance::foldUtf8(utf8Word.constData(), utf8Word.size(), word, d->maximumWordLength);
+        if (length == 0)
+            continue;
+
+        HashPosting posting;
+        posting.id = scanner.index();
+
+        posting.hash = d->lengthBucket(length);
+        postings.append(posting);
+
+        for (int i = 0; i <= d->maximumIndexedDistance && i < length; ++i)
+        {
+            posting.hash = d->bucket(i, length, word[i]);
+            postings.append(posting);
+        }
+    }
+
+    if (!d->postingFile.save(indexFilePath, postings))
+    {
+        qDebug() << "Failed to build the bucket index for" << indexFilePath;
+        return false;
+    }
+
+    return true;
+}
+
+QVector<quint32>
+HeadwordBucketIndex::candidates(const quint32 *word, int length, int distance) const
+{
+    QVector<quint32> result;
+    if (!isLoaded() || length == 0)
+        return result;
+
+    QVector<quint32> buckets;
+
+    for (int candidateLength = qMax(1, length - distance); candidateLength <= length + distance; ++candidateLength)
+    {
+        // Every character of a short headword may be edited
+        if (candidateLength <= distance || distance > d->maximumIndexedDistance)
+        {
+            buckets.append(d->lengthBucket(candidateLength));
+            continue;
+        }
+
+        // At most distance characters of the headword are substituted or
+        // inserted, so one of its first distance + 1 characters is a
+        // character of the search word shifted by at most distance positions
+        for (int i = 0; i <= distance; ++i)
+        {
+            for (int j = qMax(0, i - distance); j < length && j <= i + distance; ++j)
+                buckets.append(d->bucket(i, candidateLength, word[j]));
+        }
+    }
+
+    qSort(buckets);
+    buckets.erase(std::unique(buckets.begin(), buckets.end()), buckets.end());
+
+    foreach (quint32 bucket, buckets)
+        d->postingFile.find(bucket, result);
+
+    // A headword is usually found through several of its buckets
+    qSort(result);
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+
+    return result;
+}
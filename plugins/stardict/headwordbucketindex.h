@@ -0,0 +1,125 @@
+/******************************************************************************
+ * This file is part of the Mula project
+ * Copyright (c) 2011 Laszlo Papp <lpapp@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef MULA_PLUGIN_STARDICT_HEADWORDBUCKETINDEX_H
+#define MULA_PLUGIN_STARDICT_HEADWORDBUCKETINDEX_H
+
+#include <QtCore/QVector>
+
+class QString;
+
+namespace MulaPluginStarDict
+{
+    /**
+     * \brief Index of the headwords grouped by length and leading letters
+     *
+     * Every headword is put into a bucket keyed by its length, and into the
+     * buckets keyed by its length and one of its first three lower case
+     * characters with the position of the character. The fuzzy search then
+     * only fetches the headwords of the plausible buckets instead of all of
+     * them.
+     *
+     * A headword within the given number of edits of the search word has a
+     * length that differs by at most that many characters. Every edit
+     * substitutes or inserts at most one character of the headword, so if
+     * the headword is longer than the number of edits, one of its first
+     * "edits + 1" characters is a character of the search word shifted by at
+     * most the number of edits. The headwords not longer than the number of
+     * edits, and all the headwords for more than two edits, are taken from
+     * the length buckets. Hence the candidates are a superset of the
+     * headwords within the distance, with or without transpositions.
+     *
+     * The index is built by a streaming pass over the index file, so it works
+     * with both kinds of index files without loading all the keys, and it is
+     * stored in a ".hbi" posting file next to the offset cache file.
+     *
+     * \see HashPostingFile, IndexFileScanner
+     */
+
+    class HeadwordBucketIndex
+    {
+        public:
+
+            /**
+             * Constructor
+             */
+
+            HeadwordBucketIndex();
+
+            /**
+             * Destructor
+             */
+
+            virtual ~HeadwordBucketIndex();
+
+            /**
+             * Loads the cache file of the index belonging to the desired index
+             * file. The cache is ignored if it is older than the index file.
+             *
+             * @param   indexFilePath   The complete file path of the index file
+             *
+             * @return True if the loading was successful, otherwise false.
+             *
+             * @see build
+             */
+
+            bool load(const QString& indexFilePath);
+
+            /**
+             * Builds the index over all the headwords of the index file and
+             * saves it into the cache file.
+             *
+             * @param   indexFilePath   The complete file path of the index file
+             *
+             * @return True if the building was successful, otherwise false.
+             *
+             * @see load
+             */
+
+            bool build(const QString& indexFilePath);
+
+            /**
+             * Returns whether the index is loaded
+             *
+             * @return True if the index is loaded, otherwise false.
+             */
+
+            bool isLoaded() const;
+
+            /**
+             * Returns the headwords of the plausible buckets for the lower
+             * case UTF-32 search word, which include every headword within
+             * the given number of edits
+             *
+             * @param   word        The lower case UTF-32 search word
+             * @param   length      The length of the search word
+             * @param   distance    The largest number of edits
+             *
+             * @return The sorted indices of the candidate word entries
+             */
+
+            QVector<quint32> candidates(const quint32 *word, int length, int distance) const;
+
+        private:
+            class Private;
+            Private *const d;
+    };
+}
+
+#endif // MULA_PLUGIN_STARDICT_HEADWORDBUCKETINDEX_H
@@ -0,0 +1,416 @@
+/******************************************************************************
+ * This file is part of the Mula project
+ * Copyright (c) 2011 Laszlo Papp <lpapp@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "headwordperfecthash.h"
+
+#include "cachelocations.h"
+#include "file.h"
+#include "indexfilescanner.h"
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QSaveFile>
+#include <QtCore/QString>
+#include <QtCore/QVector>
+#include <QtCore/QDebug>
+
+#include <algorithm>
+
+using namespace MulaPluginStarDict;
+
+struct PerfectHashSlot
+{
+    quint32 fingerprint;
+    quint32 position;
+};
+
+struct HashedHeadword
+{
+    quint64 hash;
+    quint32 position;
+
+    bool operator<(const HashedHeadword& other) const
+    {
+        return hash != other.hash ? hash < other.hash : position < other.position;
+    }
+
+    bool operator==(const HashedHeadword& other) const
+    {
+        return hash == other.hash;
+    }
+};
+
+static inline int
+populationCount(quint32 word)
+{
+    word = word - ((word >> 1) & 0x55555555);
+    word = (word & 0x33333333) + ((word >> 2) & 0x33333333);
+    return (((word + (word >> 4)) & 0x0f0f0f0f) * 0x01010101) >> 24;
+}
+
+class HeadwordPerfectHash::Private
+{
+    public:
+        Private()
+            : cacheMagicString("StarDict's Perfect Hash, Version: 0.2")
+            , mappedData(0)
+            , keyCount(0)
+            , levelCount(0)
+            , levelOffsets(0)
+            , bits(0)
+            , ranks(0)
+            , slots(0)
+        {
+        }
+
+        ~Private()
+        {
+        }
+
+        void unload();
+
+        static quint64 hash(const QString& word);
+        static int slotIndex(const quint32 *levelOffsets, int levelCount, const quint32 *bits, const quint32 *ranks, quint64 hash);
+        static quint32 levelPosition(quint64 hash, int level, quint32 bitCount);
+
+        static const int gamma = 2; // the number of the bits per key in a level
+        static const int maximumLevelCount = 32;
+        static const int rankSampleSize = 16; // the number of the 32 bit words between the rank samples
+
+        QByteArray cacheMagicString;
+        QFile mapFile;
+        uchar *mappedData;
+        quint32 keyCount;
+        quint32 levelCount;
+        const quint32 *levelOffsets;
+        const quint32 *bits;
+        const quint32 *ranks;
+        const PerfectHashSlot *slots;
+};
+
+void
+HeadwordPerfectHash::Private::unload()
+{
+    if (mappedData)
+        mapFile.unmap(mappedData);
+
+    mapFile.close();
+    mappedData = 0;
+    keyCount = 0;
+    levelCount = 0;
+    levelOffsets = 0;
+    bits = 0;
+    ranks = 0;
+    slots = 0;
+}
+
+quint64
+HeadwordPerfectHash::Private::hash(const QString& word)
+{
+    quint64 result = Q_UINT64_C(14695981039346656037);
+    foreach (QChar character, asciiCaseFolded(word))
+    {
+        result ^= character.unicode();
+        result *= Q_UINT64_C(1099511628211);
+    }
+
+    result ^= result >> 33;
+    result *= Q_UINT64_C(0xc4ceb9fe1a85ec53);
+    result ^= result >> 33;
+
+    return result;
+}
+
+quint32
+HeadwordPerfectHash::Private::levelPosition(quint64 hash, int level, quint32 bitCount)
+{
+    // An independent hash per level, mapped to the bit array without division
+    quint64 x = hash + Q_UINT64_C(0x9e3779b97f4a7c15) * (level + 1);
+    x = (x ^ (x >> 30)) * Q_UINT64_C(0xbf58476d1ce4e5b9);
+    x = (x ^ (x >> 27)) * Q_UINT64_C(0x94d049bb133111eb);
+    x ^= x >> 31;
+
+    return (quint64(quint32(x >> 32)) * bitCount) >> 32;
+}
+
+// Returns the slot of the key, i.e. the rank of the first set bit of the key
+// in the levels, or -1 if none of its bits is set
+int
+HeadwordPerfectHash::Private::slotIndex(const quint32 *levelOffsets, int levelCount, const quint32 *bits, const quint32 *ranks, quint64 hash)
+{
+    for (int level = 0; level < levelCount; ++level)
+    {
+        quint32 bitCount = (levelOffsets[level + 1] - levelOffsets[level]) * 32;
+        quint32 bit = levelOffsets[level] * 32 + levelPosition(hash, level, bitCount);
+
+        if (!(bits[bit >> 5] & (1u << (bit & 31))))
+            continue;
+
+        quint32 word = bit >> 5;
+        int rank = ranks[word / rankSampleSize];
+        for (quint32 i = word - word % rankSampleSize; i < word; ++i)
+            rank += populationCount(bits[i]);
+
+        return rank + populationCount(bits[word] & ((1u << (bit & 31)) - 1));
+    }
+
+    return -1;
+}
+
+HeadwordPerfectHash::HeadwordPerfectHash()
+    : d(new Private)
+{
+}
+
+HeadwordPerfectHash::~HeadwordPerfectHash()
+{
+    d->unload();
+    delete d;
+}
+
+bool
+HeadwordPerfectHash::isLoaded() const
+{
+    return d->slots != 0;
+}
+
+qint64
+HeadwordPerfectHash::fileSize() const
+{
+    return isLoaded() ? d->mapFile.size() : 0;
+}
+
+bool
+HeadwordPerfectHash::load(const QString& indexFilePath)
+{
+    const int headerSize = d->cacheMagicString.size() + 2 * sizeof(quint32);
+
+    foreach (const QString& cacheLocation, cacheLocations(indexFilePath, ".mph"))
+    {
+        QFileInfo fileInfoIndex(indexFilePath);
+        QFileInfo fileInfoCache(cacheLocation);
+
+        if (!fileInfoCache.exists() || fileInfoCache.lastModified() < fileInfoIndex.lastModified())
+            continue;
+
+        d->unload();
+
+        d->mapFile.setFileName(cacheLocation);
+        if (!d->mapFile.open(QIODevice::ReadOnly))
+        {
+            qDebug() << "Failed to open file:" << cacheLocation;
+            continue;
+        }
+
+        if (d->mapFile.size() < headerSize)
+            continue;
+
+        d->mappedData = d->mapFile.map(0, d->mapFile.size());
+        if (d->mappedData == NULL)
+        {
+            qDebug() << Q_FUNC_INFO << QString("Mapping the file %1 failed!").arg(cacheLocation);
+            continue;
+        }
+
+        if (d->cacheMagicString != QByteArray::fromRawData(reinterpret_cast<const char*>(d->mappedData), d->cacheMagicString.size()))
+            continue;
+
+        const quint32 *counts = reinterpret_cast<const quint32*>(d->mappedData + d->cacheMagicString.size());
+        quint32 keyCount = counts[0];
+        quint32 levelCount = counts[1];
+
+        if (keyCount == 0 || levelCount == 0 || levelCount > quint32(Private::maximumLevelCount)
+            || d->mapFile.size() < headerSize + qint64(levelCount + 1) * sizeof(quint32))
+            continue;
+
+        const quint32 *levelOffsets = counts + 2;
+        quint32 wordCount = levelOffsets[levelCount];
+        quint32 rankCount = wordCount / Private::rankSampleSize + 1;
+
+        if (d->mapFile.size() != headerSize + (qint64(levelCount) + 1 + wordCount + rankCount) * sizeof(quint32)
+                                 + qint64(keyCount) * sizeof(PerfectHashSlot))
+            continue;
+
+        d->keyCount = keyCount;
+        d->levelCount = levelCount;
+        d->levelOffsets = levelOffsets;
+        d->bits = levelOffsets + levelCount + 1;
+        d->ranks = d->bits + wordCount;
+        d->slots = reinterpret_cast<const PerfectHashSlot*>(d->ranks + rankCount);
+
+        return true;
+    }
+
+    d->unload();
+    return false;
+}
+
+bool
+HeadwordPerfectHash::build(const QString& indexFilePath)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    IndexFileScanner scanner;
+    if (!scanner.open(indexFilePath))
+        return false;
+
+    QVector<HashedHeadword> headwords;
+    while (scanner.next())
+    {
+        HashedHeadword headword;
+        headword.hash = d->hash(QString::fromUtf8(scanner.word()));
+        headword.position = scanner.index();
+        headwords.append(headword);
+    }
+
+    if (headwords.isEmpty())
+        return false;
+
+    // The ASCII case variants of a headword share the key, and the slot keeps
+    // the first one of them, which starts their run in the index
+    std::sort(headwords.begin(), headwords.end());
+    headwords.erase(std::unique(headwords.begin(), headwords.end()), headwords.end());
+
+    QVector<quint64> keys;
+    keys.reserve(headwords.size());
+    foreach (const HashedHeadword& headword, headwords)
+        keys.append(headword.hash);
+
+    QVector<quint32> bits;
+    QVector<quint32> levelOffsets;
+    levelOffsets.append(0);
+
+    for (int level = 0; !keys.isEmpty() && level < Private::maximumLevelCount; ++level)
+    {
+        quint32 wordCount = (qint64(keys.size()) * Private::gamma + 31) / 32;
+        quint32 bitCount = wordCount * 32;
+        QVector<quint32> seen(wordCount, 0);
+        QVector<quint32> collision(wordCount, 0);
+
+        foreach (quint64 key, keys)
+        {
+            quint32 bit = d->levelPosition(key, level, bitCount);
+            if (seen.at(bit >> 5) & (1u << (bit & 31)))
+                collision[bit >> 5] |= 1u << (bit & 31);
+            else
+                seen[bit >> 5] |= 1u << (bit & 31);
+        }
+
+        // The colliding keys are left for the next level
+        QVector<quint64> collidingKeys;
+        foreach (quint64 key, keys)
+        {
+            quint32 bit = d->levelPosition(key, level, bitCount);
+            if (collision.at(bit >> 5) & (1u << (bit & 31)))
+                collidingKeys.append(key);
+        }
+
+        for (quint32 i = 0; i < wordCount; ++i)
+            bits.append(seen.at(i) & ~collision.at(i));
+
+        levelOffsets.append(bits.size());
+        keys = collidingKeys;
+    }
+
+    if (!keys.isEmpty())
+    {
+        qDebug() << "Failed to place" << keys.size() << "headwords into the perfect hash of" << indexFilePath;
+        return false;
+    }
+
+    QVector<quint32> ranks(bits.size() / Private::rankSampleSize + 1, 0);
+    quint32 rank = 0;
+    for (int i = 0; i < bits.size(); ++i)
+    {
+        if (i % Private::rankSampleSize == 0)
+            ranks[i / Private::rankSampleSize] = rank;
+
+        rank += populationCount(bits.at(i));
+    }
+
+    if (bits.size() % Private::rankSampleSize == 0)
+        ranks[bits.size() / Private::rankSampleSize] = rank;
+
+    int levelCount = levelOffsets.size() - 1;
+    QVector<PerfectHashSlot> slots(headwords.size());
+    foreach (const HashedHeadword& headword, headwords)
+    {
+        int slot = d->slotIndex(levelOffsets.constData(), levelCount, bits.constData(), ranks.constData(), headword.hash);
+        Q_ASSERT(slot >= 0 && slot < slots.size());
+
+        slots[slot].fingerprint = quint32(headword.hash);
+        slots[slot].position = headword.position;
+    }
+
+    foreach (const QString& cacheLocation, cacheLocations(indexFilePath, ".mph"))
+    {
+        QSaveFile file(cacheLocation);
+        if (!file.open(QIODevice::WriteOnly))
+        {
+            qDebug() << "Failed to open file for writing:" << cacheLocation;
+            continue;
+        }
+
+        quint32 counts[2] = { quint32(slots.size()), quint32(levelCount) };
+        qint64 levelOffsetsSize = levelOffsets.size() * sizeof(quint32);
+        qint64 bitsSize = bits.size() * sizeof(quint32);
+        qint64 ranksSize = ranks.size() * sizeof(quint32);
+        qint64 slotsSize = slots.size() * sizeof(PerfectHashSlot);
+
+        if (file.write(d->cacheMagicString) != d->cacheMagicString.size()
+            || file.write(reinterpret_cast<const char*>(counts), sizeof(counts)) != sizeof(counts)
+            || file.write(reinterpret_cast<const char*>(levelOffsets.constData()), levelOffsetsSize) != levelOffsetsSize
+            || file.write(reinterpret_cast<const char*>(bits.constData()), bitsSize) != bitsSize
+            || file.write(reinterpret_cast<const char*>(ranks.constData()), ranksSize) != ranksSize
+            || file.write(reinterpret_cast<const char*>(slots.constData()), slotsSize) != slotsSize
+            || !file.commit())
+        {
+            continue;
+        }
+
+        qDebug() << "Save to cache" << cacheLocation;
+
+        if (!load(indexFilePath))
+            break;
+
+        qDebug() << "Built the perfect hash for" << indexFilePath << "in" << timer.elapsed() << "ms,"
+                 << slots.size() << "keys," << levelCount << "levels," << fileSize() << "bytes";
+
+        return true;
+    }
+
+    qDebug() << "Failed to build the perfect hash for" << indexFilePath;
+    return false;
+}
+
+int
+HeadwordPerfectHash::find(const QString& word) const
+{
+    if (!isLoaded())
+        return -1;
+
+    quint64 hash = d->hash(word);
+    int slot = d->slotIndex(d->levelOffsets, d->levelCount, d->bits, d->ranks, hash);
+    if (slot < 0 || d->slots[slot].fingerprint != quint32(hash))
+        return -1;
+
+    return d->slots[slot].position;
+}
@@ -0,0 +1,138 @@
+/******************************************************************************
+ * This file is part of the Mula project
+ * Copyright (c) 2011 Laszlo Papp <lpapp@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef MULA_PLUGIN_STARDICT_HEADWORDPERFECTHASH_H
+#define MULA_PLUGIN_STARDICT_HEADWORDPERFECTHASH_H
+
+#include <QtCore/QtGlobal>
+
+class QString;
+
+namespace MulaPluginStarDict
+{
+    /**
+     * \brief Minimal perfect hash table of the case folded headwords
+     *
+     * Only the ASCII letters are folded, the same way as the index is sorted,
+     * so the headwords sharing a key are adjacent in the index.
+     *
+     * The table maps every distinct case folded headword to its own slot
+     * without collisions, and the slot stores a fingerprint of the headword
+     * and the position of its first case variant in the index. An exact
+     * lookup then costs a hash, a slot read and a verification compare
+     * instead of a binary search over the index file.
+     *
+     * The hash function is built the BBHash way: every level is a bit array
+     * twice as large as the number of the keys left, and the keys hashed to
+     * an unshared bit of a level are placed there, the rest go on to the next
+     * level. The slot of a key is the rank of its bit among all the set bits,
+     * which is answered from the rank samples of every 512 bits.
+     *
+     * A word that is not a headword still ends up in some slot, or in none
+     * at all, so the fingerprint rejects it without reading the index.
+     *
+     * The table is stored in a ".mph" file next to the offset cache file,
+     * which is mapped into the memory when loaded.
+     *
+     * \see cacheLocations
+     */
+
+    class HeadwordPerfectHash
+    {
+        public:
+
+            /**
+             * Constructor
+             */
+
+            HeadwordPerfectHash();
+
+            /**
+             * Destructor
+             */
+
+            virtual ~HeadwordPerfectHash();
+
+            /**
+             * Loads the cache file of the table belonging to the desired
+             * index file. The cache is ignored if it is older than the index
+             * file.
+             *
+             * @param   indexFilePath   The complete file path of the index file
+             *
+             * @return True if the loading was successful, otherwise false.
+             *
+             * @see build
+             */
+
+            bool load(const QString& indexFilePath);
+
+            /**
+             * Builds the table over all the headwords of the index file and
+             * saves it into the cache file. The headwords are read from the
+             * index file directly, so the method can be called from any
+             * thread.
+             *
+             * @param   indexFilePath   The complete file path of the index file
+             *
+             * @return True if the building was successful, otherwise false.
+             *
+             * @see load
+             */
+
+            bool build(const QString& indexFilePath);
+
+            /**
+             * Returns whether the table is loaded
+             *
+             * @return True if the table is loaded, otherwise false.
+             */
+
+            bool isLoaded() const;
+
+            /**
+             * Returns the size of the loaded cache file in bytes
+             *
+             * @return The size of the cache file
+             */
+
+            qint64 fileSize() const;
+
+            /**
+             * Returns the index of the first headword that equals the word
+             * regardless of the case of its ASCII letters. These case
+             * variants of a headword are next to each other in the index, so
+             * the exact match is found by comparing the headwords from this
+             * index on.
+             *
+             * @param   word    The word to look up
+             *
+             * @return The index of the first case variant of the word, or -1
+             * if the word is not a headword, or the table is not loaded.
+             */
+
+            int find(const QString& word) const;
+
+        private:
+            class Private;
+            Private *const d;
+    };
+}
+
+#endif // MULA_PLUGIN_STARDICT_HEADWORDPERFECTHASH_H
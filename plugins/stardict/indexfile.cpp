@@ -50,6 +50,7 @@ IndexFile::IndexFile()
 
 IndexFile::~IndexFile()
 {
+    delete d;
 }
 
 bool
@@ -96,6 +97,15 @@ IndexFile::load(const QString& filePath)
     return true;
 }
 
+AbstractIndexFile*
+IndexFile::createReader() const
+{
+    // The word entries are implicitly shared and only read
+    IndexFile *reader = new IndexFile;
+    reader->d->wordEntryList = d->wordEntryList;
+    return reader;
+}
+
 QByteArray
 IndexFile::key(long index)
 {
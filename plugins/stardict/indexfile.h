@@ -52,6 +52,10 @@ namespace MulaPluginStarDict
 
             int lookup(const QByteArray& word);
 
+            /** Reimplemented from AbstractIndexFile::createReader() */
+
+            AbstractIndexFile* createReader() const;
+
         private:
             class Private;
             Private *const d;
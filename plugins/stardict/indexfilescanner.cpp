@@ -0,0 +1,169 @@
+/******************************************************************************
+ * This file is part of the Mula project
+ * Copyright (c) 2011 Laszlo Papp <lpapp@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "indexfilescanner.h"
+
+#include <QtCore/QFile>
+#include <QtCore/QString>
+#include <QtCore/QtEndian>
+#include <QtCore/QDebug>
+
+#include <string.h>
+#include <zlib.h>
+
+using namespace MulaPluginStarDict;
+
+class IndexFileScanner::Private
+{
+    public:
+        Private()
+            : file(0)
+            , position(0)
+            , index(-1)
+            , wordPosition(0)
+            , wordLength(0)
+            , dataOffset(0)
+            , dataSize(0)
+        {
+        }
+
+        ~Private()
+        {
+            if (file)
+                gzclose(file);
+        }
+
+        bool fill();
+
+        // The word entry is the word, its terminator, then the offset and
+        // the size, the word should be less than 256 bytes long
+        static const int wordEntrySize = 256 + 1 + 2 * sizeof(quint32);
+        static const int blockSize = 64 * 1024;
+
+        gzFile file;
+        QByteArray buffer;
+        int position;
+
+        int index;
+        int wordPosition;
+        int wordLength;
+        quint32 dataOffset;
+        quint32 dataSize;
+};
+
+bool
+IndexFileScanner::Private::fill()
+{
+    // Keep the unprocessed tail and append the next block after it
+    buffer.remove(0, position);
+    position = 0;
+
+    int size = buffer.size();
+    buffer.resize(size + blockSize);
+
+    int bytesRead = gzread(file, buffer.data() + size, blockSize);
+    if (bytesRead < 0)
+        bytesRead = 0;
+
+    buffer.resize(size + bytesRead);
+    return bytesRead > 0;
+}
+
+IndexFileScanner::IndexFileScanner()
+    : d(new Private)
+{
+}
+
+IndexFileScanner::~IndexFileScanner()
+{
+    delete d;
+}
+
+bool
+IndexFileScanner::open(const QString& filePath)
+{
+    if (d->file)
+        gzclose(d->file);
+
+    d->buffer.clear();
+    d->position = 0;
+    d->index = -1;
+
+    // gzread() reads the uncompressed files transparently
+    d->file = gzopen(QFile::encodeName(filePath).constData(), "rb");
+    if (!d->file)
+    {
+        qDebug() << "Failed to open file:" << filePath;
+        return false;
+    }
+
+    gzbuffer(d->file, d->blockSize);
+    return true;
+}
+
+bool
+IndexFileScanner::next()
+{
+    if (!d->file)
+        return false;
+
+    if (d->buffer.size() - d->position < d->wordEntrySize)
+        d->fill();
+
+    const char *entry = d->buffer.constData() + d->position;
+    int available = d->buffer.size() - d->position;
+
+    const char *terminator = static_cast<const char*>(memchr(entry, '\0', available));
+    if (!terminator || terminator - entry + 1 + 2 * int(sizeof(quint32)) > available)
+        return false;
+
+    d->wordPosition = d->position;
+    d->wordLength = terminator - entry;
+    d->dataOffset = qFromBigEndian<quint32>(reinterpret_cast<const uchar*>(terminator + 1));
+    d->dataSize = qFromBigEndian<quint32>(reinterpret_cast<const uchar*>(terminator + 1 + sizeof(quint32)));
+
+    d->position += d->wordLength + 1 + 2 * sizeof(quint32);
+    ++d->index;
+
+    return true;
+}
+
+int
+IndexFileScanner::index() const
+{
+    return d->index;
+}
+
+QByteArray
+IndexFileScanner::word() const
+{
+    return QByteArray::fromRawData(d->buffer.constData() + d->wordPosition, d->wordLength);
+}
+
+quint32
+IndexFileScanner::dataOffset() const
+{
+    return d->dataOffset;
+}
+
+quint32
+IndexFileScanner::dataSize() const
+{
+    return d->dataSize;
+}
@@ -0,0 +1,118 @@
+/******************************************************************************
+ * This file is part of the Mula project
+ * Copyright (c) 2011 Laszlo Papp <lpapp@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef MULA_PLUGIN_STARDICT_INDEXFILESCANNER_H
+#define MULA_PLUGIN_STARDICT_INDEXFILESCANNER_H
+
+#include <QtCore/QByteArray>
+
+class QString;
+
+namespace MulaPluginStarDict
+{
+    /**
+     * \brief Sequential reader of the word entries of an index file
+     *
+     * The scanner reads the ".idx" or ".idx.gz" file in large blocks and
+     * returns the word entries one by one in the order of the file. It uses
+     * its own file handle and does not touch the loaded index of the
+     * dictionary, hence the cache structures over the headwords can be built
+     * by a single streaming pass in any thread.
+     *
+     * \see IndexFile, OffsetCacheFile
+     */
+
+    class IndexFileScanner
+    {
+        public:
+
+            /**
+             * Constructor
+             */
+
+            IndexFileScanner();
+
+            /**
+             * Destructor
+             */
+
+            virtual ~IndexFileScanner();
+
+            /**
+             * Opens the index file, the file can be compressed with gzip
+             *
+             * @param   filePath    The complete file path of the index file
+             *
+             * @return True if the opening was successful, otherwise false.
+             */
+
+            bool open(const QString& filePath);
+
+            /**
+             * Reads the next word entry
+             *
+             * @return True if there was a next word entry, otherwise false.
+             *
+             * @see word, index
+             */
+
+            bool next();
+
+            /**
+             * Returns the index of the current word entry
+             *
+             * @return The index of the current word entry
+             */
+
+            int index() const;
+
+            /**
+             * Returns the UTF-8 encoded headword of the current word entry
+             *
+             * \note The returned data is only valid until the next call of
+             * next().
+             *
+             * @return The headword of the current word entry
+             */
+
+            QByteArray word() const;
+
+            /**
+             * Returns the offset of the data of the current word entry
+             *
+             * @return The data offset of the current word entry
+             */
+
+            quint32 dataOffset() const;
+
+            /**
+             * Returns the size of the data of the current word entry
+             *
+             * @return The data size of the current word entry
+             */
+
+            quint32 dataSize() const;
+
+        private:
+            class Private;
+            Private *const d;
+    };
+}
+
+#endif // MULA_PLUGIN_STARDICT_INDEXFILESCANNER_H
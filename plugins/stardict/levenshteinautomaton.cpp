@@ -0,0 +1,148 @@
+/******************************************************************************
+ * This file is part of the Mula project
+ * Copyright (c) 2011 Laszlo Papp <lpapp@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "levenshteinautomaton.h"
+
+#include <QtCore/QVector>
+
+using namespace MulaPluginStarDict;
+
+class LevenshteinAutomaton::Private
+{
+    public:
+        Private(const quint32 *word, int length, int limit)
+            : word(length)
+            , length(length)
+            , limit(limit)
+            // Every row below this depth is rejected
+            , maximumDepth(length + limit)
+            , depth(0)
+            , prefix(maximumDepth)
+            , rows((maximumDepth + 1) * (length + 1))
+        {
+            for (int j = 0; j < length; ++j)
+                this->word[j] = word[j];
+
+            for (int j = 0; j <= length; ++j)
+                rows[j] = qMin(j, limit);
+        }
+
+        ~Private()
+        {
+        }
+
+        int *row(int index)
+        {
+            return rows.data() + index * (length + 1);
+        }
+
+        const int *row(int index) const
+        {
+            return rows.constData() + index * (length + 1);
+        }
+
+        QVector<quint32> word;
+        int length;
+        int limit;
+        int maximumDepth;
+        int depth;
+
+        QVector<quint32> prefix;
+        QVector<int> rows;
+};
+
+LevenshteinAutomaton::LevenshteinAutomaton(const quint32 *word, int length, int limit)
+    : d(new Private(word, length, limit))
+{
+}
+
+LevenshteinAutomaton::~LevenshteinAutomaton()
+{
+    delete d;
+}
+
+int
+LevenshteinAutomaton::depth() const
+{
+    return d->depth;
+}
+
+quint32
+LevenshteinAutomaton::character(int index) const
+{
+    return d->prefix.at(index);
+}
+
+void
+LevenshteinAutomaton::reset(int depth)
+{
+    d->depth = qMin(depth, d->depth);
+}
+
+bool
+LevenshteinAutomaton::step(quint32 character)
+{
+    if (d->depth >= d->maximumDepth)
+        return false;
+
+    const quint32 *word = d->word.constData();
+    const int limit = d->limit;
+    const int i = ++d->depth;
+
+    d->prefix[i - 1] = character;
+
+    const int *previousRow = d->row(i - 1);
+    const int *transpositionRow = i > 1 ? d->row(i - 2) : 0;
+    const quint32 previousCharacter = i > 1 ? d->prefix.at(i - 2) : 0;
+    int *currentRow = d->row(i);
+
+    // The values are clamped to the limit, the exact value of the rejected
+    // cells does not matter
+    currentRow[0] = qMin(i, limit);
+    int minimum = currentRow[0];
+
+    for (int j = 1; j <= d->length; ++j)
+    {
+        int value = previousRow[j - 1] + (word[j - 1] == character ? 0 : 1);
+        value = qMin(value, previousRow[j] + 1);
+        value = qMin(value, currentRow[j - 1] + 1);
+
+        if (transpositionRow && j > 1 && character == word[j - 2] && previousCharacter == word[j - 1])
+            value = qMin(value, transpositionRow[j - 2] + 1);
+
+        currentRow[j] = qMin(value, limit);
+        minimum = qMin(minimum, currentRow[j]);
+    }
+
+    // If every cell reaches the limit, neither can the following rows get
+    // below it, not even with a transposition over the previous row
+    return minimum < limit;
+}
+
+int
+LevenshteinAutomaton::distance() const
+{
+    return d->row(d->depth)[d->length];
+}
+
+bool
+LevenshteinAutomaton::isAccepted() const
+{
+    return distance() < d->limit;
+}
@@ -0,0 +1,142 @@
+/******************************************************************************
+ * This file is part of the Mula project
+ * Copyright (c) 2011 Laszlo Papp <lpapp@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef MULA_PLUGIN_STARDICT_LEVENSHTEINAUTOMATON_H
+#define MULA_PLUGIN_STARDICT_LEVENSHTEINAUTOMATON_H
+
+#include <QtCore/QtGlobal>
+
+namespace MulaPluginStarDict
+{
+    /**
+     * \brief Levenshtein automaton of a word with a bounded distance
+     *
+     * The automaton accepts the strings whose edit distance, including the
+     * transposition of adjacent characters, is less than the limit from the
+     * word. It is simulated by keeping a row of the dynamic programming matrix
+     * for every consumed character, so the state after any prefix of the
+     * consumed string can be restored with reset() without recomputing it.
+     *
+     * This makes it possible to walk the sorted headwords of the index file
+     * in step with the automaton: the rows of the prefix shared with the
+     * previous headword are reused, and once a prefix is rejected every
+     * headword starting with that prefix can be skipped.
+     *
+     * \see BitParallelEditDistance
+     */
+
+    class LevenshteinAutomaton
+    {
+        public:
+
+            /**
+             * Constructor
+             *
+             * @param   word    The UTF-32 word to match
+             * @param   length  The length of the word
+             * @param   limit   The limit of the accepted distances
+             */
+
+            LevenshteinAutomaton(const quint32 *word, int length, int limit);
+
+            /**
+             * Destructor
+             */
+
+            virtual ~LevenshteinAutomaton();
+
+            /**
+             * Returns the number of the consumed characters
+             *
+             * @return The number of the consumed characters
+             *
+             * @see reset, step
+             */
+
+            int depth() const;
+
+            /**
+             * Returns a character of the consumed string
+             *
+             * @param   index   The position of the character, less than the
+             * current depth
+             *
+             * @return The UTF-32 character
+             *
+             * @see depth
+             */
+
+            quint32 character(int index) const;
+
+            /**
+             * Restores the state after the first characters of the consumed
+             * string
+             *
+             * @param   depth   The number of the characters to keep, not
+             * greater than the current depth
+             *
+             * @see depth
+             */
+
+            void reset(int depth);
+
+            /**
+             * Consumes the next character
+             *
+             * @param   character   The UTF-32 character
+             *
+             * @return True if the consumed string can still be continued to an
+             * accepted one, otherwise false. The automaton must be reset to a
+             * smaller depth after a rejection.
+             *
+             * @see reset, distance
+             */
+
+            bool step(quint32 character);
+
+            /**
+             * Returns the edit distance between the word and the consumed
+             * string
+             *
+             * @return The edit distance, or the limit if it is not less than the
+             * limit
+             *
+             * @see isAccepted
+             */
+
+            int distance() const;
+
+            /**
+             * Returns whether the consumed string is accepted
+             *
+             * @return True if the distance of the consumed string is less than
+             * the limit, otherwise false.
+             *
+             * @see distance
+             */
+
+            bool isAccepted() const;
+
+        private:
+            class Private;
+            Private *const d;
+    };
+}
+
+#endif // MULA_PLUGIN_STARDICT_LEVENSHTEINAUTOMATON_H
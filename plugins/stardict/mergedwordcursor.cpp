@@ -0,0 +1,274 @@
+/******************************************************************************
+ * This file is part of the Mula project
+ * Copyright (c) 2011 Laszlo Papp <lpapp@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "mergedwordcursor.h"
+
+#include "dictionary.h"
+#include "file.h"
+
+#include <QtCore/QVector>
+
+#include <algorithm>
+
+using namespace MulaPluginStarDict;
+
+struct CursorEntry
+{
+    int dictionaryIndex;
+    QString word;
+};
+
+// The standard heap functions keep the greatest element on the top, hence
+// the forward heap uses the reverse order
+class CursorEntryGreaterThan
+{
+    public:
+        bool operator()(const CursorEntry& entry1, const CursorEntry& entry2) const
+        {
+            return stardictStringCompare(entry1.word, entry2.word) > 0;
+        }
+};
+
+class CursorEntryLessThan
+{
+    public:
+        bool operator()(const CursorEntry& entry1, const CursorEntry& entry2) const
+        {
+            return stardictStringCompare(entry1.word, entry2.word) < 0;
+        }
+};
+
+class MergedWordCursor::Private
+{
+    public:
+        Private()
+            : forward(true)
+        {
+        }
+
+        ~Private()
+        {
+        }
+
+        static int lowerBound(Dictionary *dictionary, const QString& word);
+
+        void buildForwardHeap();
+        void buildBackwardHeap();
+
+        QList<Dictionary *> dictionaryList;
+
+        // The first headword not less than the current word in every
+        // dictionary
+        QVector<int> positions;
+
+        // The headwords at the positions while stepping forward, or the ones
+        // before the positions while stepping backward
+        QVector<CursorEntry> heap;
+        bool forward;
+
+        QString currentWord;
+};
+
+int
+MergedWordCursor::Private::lowerBound(Dictionary *dictionary, const QString& word)
+{
+    int first = 0;
+    int count = dictionary->articleCount();
+
+    while (count > 0)
+    {
+        int step = count / 2;
+        if (stardictStringCompare(dictionary->key(first + step), word) < 0)
+        {
+            first += step + 1;
+            count -= step + 1;
+        }
+        else
+        {
+            count = step;
+        }
+    }
+
+    return first;
+}
+
+void
+MergedWordCursor::Private::buildForwardHeap()
+{
+    heap.clear();
+
+    for (int i = 0; i < dictionaryList.size(); ++i)
+    {
+        if (positions.at(i) < dictionaryList.at(i)->articleCount())
+        {
+            CursorEntry entry = { i, dictionaryList.at(i)->key(positions.at(i)) };
+            heap.append(entry);
+        }
+    }
+
+    std::make_heap(heap.begin(), heap.end(), CursorEntryGreaterThan());
+    forward = true;
+    currentWord = heap.isEmpty() ? QString() : heap.first().word;
+}
+
+void
+MergedWordCursor::Private::buildBackwardHeap()
+{
+    heap.clear();
+
+    for (int i = 0; i < dictionaryList.size(); ++i)
+    {
+        if (positions.at(i) > 0)
+        {
+            CursorEntry entry = { i, dictionaryList.at(i)->key(positions.at(i) - 1) };
+            heap.append(entry);
+        }
+    }
+
+    std::make_heap(heap.begin(), heap.end(), CursorEntryLessThan());
+    forward = false;
+}
+
+MergedWordCursor::MergedWordCursor(const QList<Dictionary *>& dictionaryList)
+    : d(new Private)
+{
+    d->dictionaryList = dictionaryList;
+    toFront();
+}
+
+MergedWordCursor::~MergedWordCursor()
+{
+    delete d;
+}
+
+bool
+MergedWordCursor::seek(const QString& word)
+{
+    d->positions.resize(d->dictionaryList.size());
+    for (int i = 0; i < d->dictionaryList.size(); ++i)
+        d->positions[i] = d->lowerBound(d->dictionaryList.at(i), word);
+
+    d->buildForwardHeap();
+    return isValid();
+}
+
+void
+MergedWordCursor::toFront()
+{
+    d->positions.fill(0, d->dictionaryList.size());
+    d->buildForwardHeap();
+}
+
+void
+MergedWordCursor::toBack()
+{
+    d->positions.resize(d->dictionaryList.size());
+    for (int i = 0; i < d->dictionaryList.size(); ++i)
+        d->positions[i] = d->dictionaryList.at(i)->articleCount();
+
+    d->buildForwardHeap();
+}
+
+bool
+MergedWordCursor::isValid() const
+{
+    return !d->currentWord.isNull();
+}
+
+QString
+MergedWordCursor::word() const
+{
+    return d->currentWord;
+}
+
+int
+MergedWordCursor::position(int dictionaryIndex) const
+{
+    if (d->currentWord.isNull())
+        return invalidIndex;
+
+    Dictionary *dictionary = d->dictionaryList.at(dictionaryIndex);
+    int index = d->positions.at(dictionaryIndex);
+    if (index >= dictionary->articleCount() || dictionary->key(index) != d->currentWord)
+        return invalidIndex;
+
+    return index;
+}
+
+bool
+MergedWordCursor::next()
+{
+    if (!d->forward)
+        d->buildForwardHeap();
+
+    if (d->heap.isEmpty())
+        return false;
+
+    // Every dictionary containing the current word steps over it
+    while (!d->heap.isEmpty() && d->heap.first().word == d->currentWord)
+    {
+        std::pop_heap(d->heap.begin(), d->heap.end(), CursorEntryGreaterThan());
+        CursorEntry& entry = d->heap.last();
+        int index = ++d->positions[entry.dictionaryIndex];
+
+        if (index < d->dictionaryList.at(entry.dictionaryIndex)->articleCount())
+        {
+            entry.word = d->dictionaryList.at(entry.dictionaryIndex)->key(index);
+            std::push_heap(d->heap.begin(), d->heap.end(), CursorEntryGreaterThan());
+        }
+        else
+        {
+            d->heap.removeLast();
+        }
+    }
+
+    d->currentWord = d->heap.isEmpty() ? QString() : d->heap.first().word;
+    return isValid();
+}
+
+bool
+MergedWordCursor::previous()
+{
+    if (d->forward)
+        d->buildBackwardHeap();
+
+    if (d->heap.isEmpty())
+        return false;
+
+    // Every dictionary containing the previous word steps back onto it
+    d->currentWord = d->heap.first().word;
+    while (!d->heap.isEmpty() && d->heap.first().word == d->currentWord)
+    {
+        std::pop_heap(d->heap.begin(), d->heap.end(), CursorEntryLessThan());
+        CursorEntry& entry = d->heap.last();
+        int index = --d->positions[entry.dictionaryIndex];
+
+        if (index > 0)
+        {
+            entry.word = d->dictionaryList.at(entry.dictionaryIndex)->key(index - 1);
+            std::push_heap(d->heap.begin(), d->heap.end(), CursorEntryLessThan());
+        }
+        else
+        {
+            d->heap.removeLast();
+        }
+    }
+
+    return true;
+}
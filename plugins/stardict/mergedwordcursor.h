@@ -0,0 +1,156 @@
+/******************************************************************************
+ * This file is part of the Mula project
+ * Copyright (c) 2011 Laszlo Papp <lpapp@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef MULA_PLUGIN_STARDICT_MERGEDWORDCURSOR_H
+#define MULA_PLUGIN_STARDICT_MERGEDWORDCURSOR_H
+
+#include <QtCore/QList>
+#include <QtCore/QString>
+
+namespace MulaPluginStarDict
+{
+    class Dictionary;
+
+    /**
+     * \brief Iterates the headwords of several dictionaries as one sorted list
+     *
+     * The cursor merges the sorted index files of the dictionaries in the
+     * order of stardictStringCompare(), and lists a headword contained by
+     * several dictionaries once. It keeps a position for every dictionary,
+     * the first headword not less than the current word, and a heap of the
+     * headwords at these positions, so a step only compares O(log D)
+     * headwords instead of rescanning all the dictionaries.
+     *
+     * Stepping in the opposite direction than the previous step rebuilds the
+     * heap once, the following steps in the same direction are cheap again.
+     *
+     * \note The cursor does not take the ownership of the dictionaries, and it
+     * must not be used after the dictionary list has changed.
+     *
+     * \see StarDictDictionaryManager::createWordCursor
+     */
+
+    class MergedWordCursor
+    {
+        public:
+
+            /**
+             * Constructor, the cursor is positioned on the first headword
+             *
+             * @param dictionaryList The dictionaries to merge
+             */
+
+            MergedWordCursor(const QList<Dictionary *>& dictionaryList);
+
+            /**
+             * Destructor
+             */
+
+            virtual ~MergedWordCursor();
+
+            /**
+             * Positions the cursor on the first headword not less than the
+             * word in any of the dictionaries
+             *
+             * @param word The word to seek to
+             *
+             * @return True if there is such a headword, otherwise false, and
+             * the cursor is past the last headword.
+             *
+             * @see toFront, toBack
+             */
+
+            bool seek(const QString& word);
+
+            /**
+             * Positions the cursor on the first headword
+             *
+             * @see seek, toBack
+             */
+
+            void toFront();
+
+            /**
+             * Positions the cursor past the last headword, so previous() steps
+             * to the last headword
+             *
+             * @see seek, toFront
+             */
+
+            void toBack();
+
+            /**
+             * Returns whether the cursor is on a headword
+             *
+             * @return True if the cursor is on a headword, otherwise false if
+             * it is past the last headword.
+             */
+
+            bool isValid() const;
+
+            /**
+             * Returns the current headword
+             *
+             * @return The current headword, or an empty string if the cursor
+             * is past the last headword
+             */
+
+            QString word() const;
+
+            /**
+             * Returns the position of the current headword in the index file
+             * of the dictionary
+             *
+             * @param dictionaryIndex The index of the dictionary in the list
+             *
+             * @return The index of the headword, or invalidIndex if the
+             * dictionary does not contain the current headword
+             */
+
+            int position(int dictionaryIndex) const;
+
+            /**
+             * Steps to the next headword
+             *
+             * @return True if the cursor is on the next headword, otherwise
+             * false, and the cursor is past the last headword.
+             *
+             * @see previous
+             */
+
+            bool next();
+
+            /**
+             * Steps to the previous headword
+             *
+             * @return True if the cursor is on the previous headword,
+             * otherwise false, and the cursor stays on the first headword.
+             *
+             * @see next
+             */
+
+            bool previous();
+
+        private:
+            class Private;
+            Private *const d;
+    };
+}
+
+#endif // MULA_PLUGIN_STARDICT_MERGEDWORDCURSOR_H
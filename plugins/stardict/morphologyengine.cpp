@@ -0,0 +1,201 @@
+/******************************************************************************
+ * This file is part of the Mula project
+ * Copyright (c) 2011 Laszlo Papp <lpapp@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "morphologyengine.h"
+
+#include <QtCore/QSet>
+
+using namespace MulaPluginStarDict;
+
+// The regular English inflections
+static const MorphologyEngine::Rule englishRules[] = {
+    { "S",   2, 1, 0,   false, 0 },
+    { "ED",  2, 1, 0,   false, 0 },
+    { "LY",  3, 2, 0,   true,  0 },
+    { "ING", 4, 3, "E", true,  0 },
+    { "ES",  4, 2, 0,   false, "S|X|O|CH|SH" },
+    { "ED",  4, 2, 0,   true,  0 },
+    { "IED", 4, 3, "Y", false, 0 },
+    { "IES", 4, 3, "Y", false, 0 },
+    { "ER",  3, 3, 0,   false, 0 },
+    { "EST", 4, 3, 0,   false, 0 }
+};
+
+static bool
+isVowel(QChar inputChar)
+{
+    QChar ch = inputChar.toLower();
+    return ( ch == 'a' || ch == 'e' || ch == 'i' || ch == 'o' || ch == 'u' );
+}
+
+static bool
+isPureEnglish(const QString& word)
+{
+    foreach (QChar c, word)
+    {
+        if (c.unicode() >= 0x80)
+            return false;
+    }
+
+    return true;
+}
+
+// Collects the unique candidates in the order they are added
+class CandidateList
+{
+    public:
+        CandidateList(const QString& word)
+            : m_word(word)
+        {
+        }
+
+        void append(const QString& candidate)
+        {
+            if (candidate.isEmpty() || candidate == m_word || m_seen.contains(candidate))
+                return;
+
+            m_seen.insert(candidate);
+            m_candidates.append(candidate);
+        }
+
+        // Appends the form, and its lower case variant for the capitalized
+        // or upper case words
+        void appendForm(const QString& form, bool lowerCaseVariant)
+        {
+            append(form);
+            if (lowerCaseVariant)
+                append(form.toLower());
+        }
+
+        QStringList candidates() const
+        {
+            return m_candidates;
+        }
+
+    private:
+        QString m_word;
+        QSet<QString> m_seen;
+        QStringList m_candidates;
+};
+
+class MorphologyEngine::Private
+{
+    public:
+        Private(const Rule *rules, int ruleCount)
+            : rules(rules)
+            , ruleCount(ruleCount)
+        {
+        }
+
+        ~Private()
+        {
+        }
+
+        static bool hasStemEnding(const QString& stem, const char *stemEndings);
+        static bool hasDoubledConsonant(const QString& stem);
+
+        const Rule *rules;
+        int ruleCount;
+};
+
+bool
+MorphologyEngine::Private::hasStemEnding(const QString& stem, const char *stemEndings)
+{
+    if (!stemEndings)
+        return true;
+
+    foreach (const QString& ending, QString::fromLatin1(stemEndings).split('|'))
+    {
+        if (stem.endsWith(ending, Qt::CaseInsensitive))
+            return true;
+    }
+
+    return false;
+}
+
+bool
+MorphologyEngine::Private::hasDoubledConsonant(const QString& stem)
+{
+    // E.g. "stopp" of "stopping"
+    int length = stem.length();
+    return length > 3 && stem.at(length - 1) == stem.at(length - 2)
+        && !isVowel(stem.at(length - 2)) && isVowel(stem.at(length - 3));
+}
+
+MorphologyEngine::MorphologyEngine()
+    : d(new Private(englishRules, sizeof(englishRules) / sizeof(englishRules[0])))
+{
+}
+
+MorphologyEngine::MorphologyEngine(const Rule *rules, int ruleCount)
+    : d(new Private(rules, ruleCount))
+{
+}
+
+MorphologyEngine::~MorphologyEngine()
+{
+    delete d;
+}
+
+QStringList
+MorphologyEngine::candidates(const QString& word) const
+{
+    CandidateList candidateList(word);
+    if (word.isEmpty())
+        return candidateList.candidates();
+
+    // The case variants of the word
+    candidateList.append(word.toUpper());
+    candidateList.append(word.toLower());
+    candidateList.append(word.left(1).toUpper() + word.mid(1).toLower());
+
+    if (!isPureEnglish(word))
+        return candidateList.candidates();
+
+    for (int i = 0; i < d->ruleCount; ++i)
+    {
+        const Rule& rule = d->rules[i];
+        if (word.length() < rule.minimumWordLength)
+            continue;
+
+        QString suffix = QString::fromLatin1(rule.suffix);
+        bool isUpperCase = word.endsWith(suffix);
+        if (!isUpperCase && !word.endsWith(suffix.toLower()))
+            continue;
+
+        QString stem = word.left(word.length() - rule.truncateLength);
+        if (!d->hasStemEnding(stem, rule.stemEndings))
+            continue;
+
+        bool lowerCaseVariant = isUpperCase || word.at(0).isUpper();
+
+        if (rule.undouble && d->hasDoubledConsonant(stem))
+            candidateList.appendForm(stem.left(stem.length() - 1), lowerCaseVariant);
+
+        candidateList.appendForm(stem, lowerCaseVariant);
+
+        if (rule.addition)
+        {
+            QString addition = QString::fromLatin1(rule.addition);
+            candidateList.appendForm(stem + (isUpperCase ? addition : addition.toLower()), lowerCaseVariant);
+        }
+    }
+
+    return candidateList.candidates();
+}
@@ -0,0 +1,105 @@
+/******************************************************************************
+ * This file is part of the Mula project
+ * Copyright (c) 2011 Laszlo Papp <lpapp@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef MULA_PLUGIN_STARDICT_MORPHOLOGYENGINE_H
+#define MULA_PLUGIN_STARDICT_MORPHOLOGYENGINE_H
+
+#include <QtCore/QStringList>
+
+namespace MulaPluginStarDict
+{
+    /**
+     * \brief Rule table driven generator of the base forms of inflected words
+     *
+     * Every rule strips a suffix from the word and optionally appends another
+     * ending, e.g. "studies" becomes "study" by the rule that replaces the
+     * "ies" suffix by "y". The engine applies all the rules to the word at
+     * once and returns every candidate base form together with the case
+     * variants of the word, so the candidates can be resolved in a single
+     * pass over the sorted index.
+     *
+     * The default rule table covers the regular English inflections, and it
+     * is only applied to pure ASCII words.
+     *
+     * The engine does not have any state after the construction, so it can
+     * be used concurrently.
+     *
+     * \see Dictionary::lookupBatch
+     */
+
+    class MorphologyEngine
+    {
+        public:
+
+            /**
+             * \brief A suffix rule of the morphology engine
+             */
+
+            struct Rule
+            {
+                const char *suffix;         // The upper case suffix of the inflected word
+                int minimumWordLength;      // The shortest inflected word the rule applies to
+                int truncateLength;         // The number of the characters stripped from the end
+                const char *addition;       // The upper case ending appended to the stem, or NULL
+                bool undouble;              // Whether to try the stem without its doubled consonant
+                const char *stemEndings;    // The '|' separated upper case endings the stem needs to have, or NULL
+            };
+
+            /**
+             * Constructor, creates an engine with the English rule table
+             */
+
+            MorphologyEngine();
+
+            /**
+             * Constructor
+             *
+             * @param   rules       The rule table, which needs to outlive the
+             * engine
+             * @param   ruleCount   The number of the rules in the table
+             */
+
+            MorphologyEngine(const Rule *rules, int ruleCount);
+
+            /**
+             * Destructor
+             */
+
+            virtual ~MorphologyEngine();
+
+            /**
+             * Returns the candidate forms of the word to look up when the
+             * word itself is not found. The case variants of the word come
+             * first, then the base forms in the order of the rules. The
+             * candidates are unique and they do not contain the word itself.
+             *
+             * @param   word    The word to look up
+             *
+             * @return The candidate forms in the order of preference
+             */
+
+            QStringList candidates(const QString& word) const;
+
+        private:
+            class Private;
+            Private *const d;
+    };
+}
+
+#endif // MULA_PLUGIN_STARDICT_MORPHOLOGYENGINE_H
@@ -19,6 +19,7 @@
 
 #include "offsetcachefile.h"
 
+#include "cachelocations.h"
 #include "file.h"
 #include "wordentry.h"
 
@@ -30,7 +31,6 @@
 #include <QtCore/QDebug>
 #include <QtCore/QPair>
 #include <QtCore/QtEndian>
-#include <QtCore/QStandardPaths>
 
 using namespace MulaPluginStarDict;
 
@@ -79,6 +79,7 @@ OffsetCacheFile::OffsetCacheFile()
 
 OffsetCacheFile::~OffsetCacheFile()
 {
+    delete d;
 }
 
 QByteArray
@@ -117,21 +118,7 @@ OffsetCacheFile::firstWordDataOnPage(long pageIndex)
 QStringList
 OffsetCacheFile::cacheLocations(const QString& completeFilePath)
 {
-    QStringList result;
-    result.append(completeFilePath + ".oft");
-
-    QString cacheLocation = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
-    QFileInfo cacheLocationFileInfo(cacheLocation);
-    QDir cacheLocationDir;
-
-    if (!cacheLocationFileInfo.exists() && cacheLocationDir.mkdir(cacheLocation) == false)
-        return result;
-
-    if (!cacheLocationFileInfo.isDir())
-        return result;
-
-    result.append(cacheLocation + QDir::separator() + "sdcv" + QDir::separator() + QFileInfo(completeFilePath).fileName() + ".oft");
-    return result;
+    return MulaPluginStarDict::cacheLocations(completeFilePath, ".oft");
 }
 
 bool
@@ -319,6 +306,29 @@ OffsetCacheFile::load(const QString& completeFilePath)
     return true;
 }
 
+AbstractIndexFile*
+OffsetCacheFile::createReader() const
+{
+    OffsetCacheFile *reader = new OffsetCacheFile;
+    reader->d->pageOffsetList = d->pageOffsetList;
+    reader->d->wordCount = d->wordCount;
+    reader->d->first = d->first;
+    reader->d->last = d->last;
+    reader->d->middle = d->middle;
+    reader->d->realLast = d->realLast;
+
+    // The pages are read through a separate file handle
+    reader->d->indexFile.setFileName(d->indexFile.fileName());
+    if (!reader->d->indexFile.open(QIODevice::ReadOnly))
+    {
+        qDebug() << "Failed to open file:" << d->indexFile.fileName();
+        delete reader;
+        return 0;
+    }
+
+    return reader;
+}
+
 int
 OffsetCacheFile::lookupPage(const QByteArray& word)
 {
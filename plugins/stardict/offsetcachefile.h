@@ -91,6 +91,10 @@ namespace MulaPluginStarDict
 
             int lookup(const QByteArray& string);
 
+            /** Reimplemented from AbstractIndexFile::createReader() */
+
+            AbstractIndexFile* createReader() const;
+
         private:
 
             /**
@@ -0,0 +1,41 @@
+/******************************************************************************
+ * This file is part of the Mula project
+ * Copyright (c) 2011 Laszlo Papp <lpapp@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "phoneticencoder.h"
+
+#include "doublemetaphone.h"
+
+using namespace MulaPluginStarDict;
+
+PhoneticEncoder::PhoneticEncoder()
+{
+}
+
+PhoneticEncoder::~PhoneticEncoder()
+{
+}
+
+PhoneticEncoder*
+PhoneticEncoder::create(const QByteArray& name)
+{
+    if (name.isEmpty() || name == "doublemetaphone")
+        return new DoubleMetaphone;
+
+    return 0;
+}
@@ -0,0 +1,96 @@
+/******************************************************************************
+ * This file is part of the Mula project
+ * Copyright (c) 2011 Laszlo Papp <lpapp@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef MULA_PLUGIN_STARDICT_PHONETICENCODER_H
+#define MULA_PLUGIN_STARDICT_PHONETICENCODER_H
+
+#include <QtCore/QByteArray>
+#include <QtCore/QList>
+
+namespace MulaPluginStarDict
+{
+    /**
+     * \brief Interface of the algorithms that map a word to keys describing
+     * its pronunciation
+     *
+     * Words that sound alike get the same key even if they are spelled very
+     * differently, so the keys can be used to suggest the words that the
+     * user tried to write by ear. The rules of the pronunciation depend on
+     * the language, hence an encoder usually handles the words of a single
+     * language or script, and refuses to encode any other word.
+     *
+     * The encoders do not have any state, so they can be used concurrently.
+     *
+     * \see PhoneticIndex
+     */
+
+    class PhoneticEncoder
+    {
+        public:
+
+            /**
+             * Constructor
+             */
+
+            PhoneticEncoder();
+
+            /**
+             * Destructor
+             */
+
+            virtual ~PhoneticEncoder();
+
+            /**
+             * Returns the name of the encoder. The name identifies the
+             * encoder in the settings and in the cache files built with it.
+             *
+             * @return The name of the encoder
+             */
+
+            virtual QByteArray name() const = 0;
+
+            /**
+             * Returns the phonetic keys of the word. Words with several
+             * possible pronunciations have several keys.
+             *
+             * @param   word    The lower case UTF-32 word
+             * @param   length  The length of the word
+             *
+             * @return The keys of the word, or an empty list if the encoder
+             * does not handle the word
+             */
+
+            virtual QList<QByteArray> encode(const quint32 *word, int length) const = 0;
+
+            /**
+             * Creates the encoder with the given name. The caller takes the
+             * ownership of the encoder.
+             *
+             * @param   name    The name of the encoder, or an empty name for
+             * the default encoder of the Latin script
+             *
+             * @return The encoder, or NULL if there is no encoder with the
+             * given name
+             */
+
+            static PhoneticEncoder* create(const QByteArray& name = QByteArray());
+    };
+}
+
+#endif // MULA_PLUGIN_STARDICT_PHONETICENCODER_H
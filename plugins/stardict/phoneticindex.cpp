@@ -0,0 +1,154 @@
+/******************************************************************************
+ * This file is part of the Mula project
+ * Copyright (c) 2011 Laszlo Papp <lpapp@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "phoneticindex.h"
+
+#include "distance.h"
+#include "hashpostingfile.h"
+#include "indexfilescanner.h"
+#include "phoneticencoder.h"
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QScopedPointer>
+#include <QtCore/QString>
+#include <QtCore/QtAlgorithms>
+#include <QtCore/QDebug>
+
+#include <algorithm>
+
+using namespace MulaPluginStarDict;
+
+class PhoneticIndex::Private
+{
+    public:
+        Private(PhoneticEncoder *encoder)
+            : encoder(encoder)
+            , postingFile("StarDict's Phonetic Index (" + (encoder ? encoder->name() : QByteArray()) + "), Version: 0.1",
+                          ".pho")
+        {
+        }
+
+        ~Private()
+        {
+        }
+
+        static quint32 hash(const QByteArray& key);
+
+        QScopedPointer<PhoneticEncoder> encoder;
+        HashPostingFile postingFile;
+};
+
+quint32
+PhoneticIndex::Private::hash(const QByteArray& key)
+{
+    // FNV-1a over the bytes
+    quint32 result = 2166136261u;
+    for (int i = 0; i < key.size(); ++i)
+    {
+        result ^= uchar(key.at(i));
+        result *= 16777619u;
+    }
+
+    return result;
+}
+
+PhoneticIndex::PhoneticIndex(const QByteArray& encoderName)
+    : d(new Private(PhoneticEncoder::create(encoderName)))
+{
+}
+
+PhoneticIndex::~PhoneticIndex()
+{
+    delete d;
+}
+
+bool
+PhoneticIndex::isLoaded() const
+{
+    return d->postingFile.isLoaded();
+}
+
+bool
+PhoneticIndex::load(const QString& indexFilePath)
+{
+    if (d->encoder.isNull())
+        return false;
+
+    return d->postingFile.load(indexFilePath);
+}
+
+bool
+PhoneticIndex::build(const QString& indexFilePath)
+{
+    if (d->encoder.isNull())
+        return false;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    IndexFileScanner scanner;
+    if (!scanner.open(indexFilePath))
+        return false;
+
+    // The length of the words in the index file should be less than 256 bytes
+    quint32 word[256];
+    QVector<HashPosting> postings;
+
+    while (scanner.next())
+    {
+        QByteArray utf8Word = scanner.word();
+        int length = BitParallelEditDistance::foldUtf8(utf8Word.constData(), utf8Word.size(), word, 256);
+
+        HashPosting posting;
+        posting.id = scanner.index();
+        foreach (const QByteArray& key, d->encoder->encode(word, length))
+        {
+            posting.hash = d->hash(key);
+            postings.append(posting);
+        }
+    }
+
+    if (!d->postingFile.save(indexFilePath, postings))
+    {
+        qDebug() << "Failed to build the phonetic index for" << indexFilePath;
+        return false;
+    }
+
+    qDebug() << "Built the phonetic index for" << indexFilePath << "in" << timer.elapsed() << "ms,"
+             << d->postingFile.postingCount() << "postings," << d->postingFile.fileSize() << "bytes";
+
+    return true;
+}
+
+QVector<quint32>
+PhoneticIndex::candidates(const quint32 *word, int length) const
+{
+    QVector<quint32> result;
+    if (!isLoaded())
+        return result;
+
+    foreach (const QByteArray& key, d->encoder->encode(word, length))
+        d->postingFile.find(d->hash(key), result);
+
+    // A headword can share both of its keys with the search word
+    qSort(result);
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+
+    return result;
+}
@@ -0,0 +1,126 @@
+/******************************************************************************
+ * This file is part of the Mula project
+ * Copyright (c) 2011 Laszlo Papp <lpapp@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef MULA_PLUGIN_STARDICT_PHONETICINDEX_H
+#define MULA_PLUGIN_STARDICT_PHONETICINDEX_H
+
+#include <QtCore/QByteArray>
+#include <QtCore/QVector>
+
+class QString;
+
+namespace MulaPluginStarDict
+{
+    /**
+     * \brief Phonetic key index of the headwords for sound-alike suggestions
+     *
+     * The index maps the phonetic keys of the headwords to the headwords, so
+     * the headwords that sound like the search word are found by looking up
+     * the keys of the search word. Such misspellings, e.g. "nolij" for
+     * "knowledge", are usually too far for the edit distance based
+     * suggestions.
+     *
+     * The keys are computed by a PhoneticEncoder, which can be chosen
+     * according to the language of the dictionary. The headwords that the
+     * encoder does not handle are not indexed.
+     *
+     * The keys are stored as hashes in a ".pho" posting file next to the
+     * offset cache file, which is mapped into the memory when loaded. The
+     * name of the encoder is part of the magic string of the file, so the
+     * index is rebuilt when the encoder changes.
+     *
+     * \see HashPostingFile, PhoneticEncoder
+     */
+
+    class PhoneticIndex
+    {
+        public:
+
+            /**
+             * Constructor
+             *
+             * @param   encoderName     The name of the phonetic encoder, or an
+             * empty name for the default encoder
+             */
+
+            PhoneticIndex(const QByteArray& encoderName = QByteArray());
+
+            /**
+             * Destructor
+             */
+
+            virtual ~PhoneticIndex();
+
+            /**
+             * Loads the cache file of the index belonging to the desired index
+             * file. The cache is ignored if it is older than the index file or
+             * it was built with another encoder.
+             *
+             * @param   indexFilePath   The complete file path of the index file
+             *
+             * @return True if the loading was successful, otherwise false.
+             *
+             * @see build
+             */
+
+            bool load(const QString& indexFilePath);
+
+            /**
+             * Builds the index over all the headwords of the index file and
+             * saves it into the cache file. The headwords are read from the
+             * index file directly, so the method can be called from any
+             * thread.
+             *
+             * @param   indexFilePath   The complete file path of the index file
+             *
+             * @return True if the building was successful, otherwise false.
+             *
+             * @see load
+             */
+
+            bool build(const QString& indexFilePath);
+
+            /**
+             * Returns whether the index is loaded
+             *
+             * @return True if the index is loaded, otherwise false.
+             */
+
+            bool isLoaded() const;
+
+            /**
+             * Returns the candidate word entries for the lower case UTF-32
+             * search word, i.e. the headwords sharing a phonetic key with the
+             * search word.
+             *
+             * @param   word    The lower case UTF-32 search word
+             * @param   length  The length of the search word
+             *
+             * @return The sorted indices of the candidate word entries
+             */
+
+            QVector<quint32> candidates(const quint32 *word, int length) const;
+
+        private:
+            class Private;
+            Private *const d;
+    };
+}
+
+#endif // MULA_PLUGIN_STARDICT_PHONETICINDEX_H
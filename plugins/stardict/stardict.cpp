@@ -20,6 +20,9 @@
 #include "stardict.h"
 
 //#include "settingsdialog.h"
+#include "articlerenderer.h"
+#include "dictionarycatalog.h"
+#include "distance.h"
 #include "file.h"
 
 #include <core/dictionaryplugin.h>
@@ -30,10 +33,13 @@
 #include <QtCore/QCoreApplication>
 #include <QtCore/QDir>
 #include <QtCore/QFile>
+#include <QtCore/QReadWriteLock>
 #include <QtCore/QSettings>
-#include <QtCore/QStack>
+#include <QtCore/QTimer>
 #include <QtCore/QDebug>
 
+#include <limits.h>
+
 using namespace MulaPluginStarDict;
 
 class StarDict::Private
@@ -43,6 +49,9 @@ class StarDict::Private
             : dictionaryManager(new StarDictDictionaryManager)
             , reformatLists(false)
             , expandAbbreviations(false)
+            , lazyOpening(true)
+            , idleCloseTimeout(0)
+            , selectionLoaded(false)
         {
         }
 
@@ -55,13 +64,34 @@ class StarDict::Private
         QHash<QString, int> loadedDictionaries;
         bool reformatLists;
         bool expandAbbreviations;
+        QString fuzzyEngine;
+        bool lazyOpening;
+        int idleCloseTimeout; // in seconds, zero keeps the dictionaries open
+
+        // The queries share the lock, closing the idle dictionaries and
+        // reloading them need it exclusively
+        QReadWriteLock dictionaryLock;
+        QTimer idleTimer;
 
-        QString ifoBookName;
-        QString ifoFileName;
+        // Lists the ".ifo" files of the directories, and reports their changes
+        DictionaryCatalog catalog;
+        QStringList disabledIfoFilePaths;
+        bool selectionLoaded;
+
+        void updateLoadedDictionaries();
 
         const static int maximumFuzzy = 24;
+        const static int maximumPhonetic = 8;
 };
 
+void
+StarDict::Private::updateLoadedDictionaries()
+{
+    loadedDictionaries.clear();
+    for (int i = 0; i < dictionaryManager->dictionaryCount(); ++i)
+        loadedDictionaries[dictionaryManager->dictionaryName(i)] = i;
+}
+
 StarDict::StarDict(QObject *parent)
     : QObject(parent)
     , d(new Private)
@@ -71,6 +101,28 @@ StarDict::StarDict(QObject *parent)
     d->dictionaryDirectoryList = settings.value("StarDict/dictionaryDirectoryList", d->dictionaryDirectoryList).toStringList();
     d->reformatLists = settings.value("StarDict/reformatLists", true).toBool();
     d->expandAbbreviations = settings.value("StarDict/expandAbbreviations", true).toBool();
+    d->fuzzyEngine = settings.value("StarDict/fuzzyEngine", "fullscan").toString();
+    d->lazyOpening = settings.value("StarDict/lazyOpening", true).toBool();
+    d->idleCloseTimeout = settings.value("StarDict/idleCloseTimeout", 600).toInt();
+
+    if (d->fuzzyEngine == "bktree")
+        d->dictionaryManager->setFuzzyEngine(StarDictDictionaryManager::BKTREE);
+    else if (d->fuzzyEngine == "automaton")
+        d->dictionaryManager->setFuzzyEngine(StarDictDictionaryManager::AUTOMATON);
+    else if (d->fuzzyEngine == "parallelscan")
+        d->dictionaryManager->setFuzzyEngine(StarDictDictionaryManager::PARALLELSCAN);
+    else if (d->fuzzyEngine == "bucketscan")
+        d->dictionaryManager->setFuzzyEngine(StarDictDictionaryManager::BUCKETSCAN);
+    else if (d->fuzzyEngine == "trigram")
+        d->dictionaryManager->setFuzzyEngine(StarDictDictionaryManager::TRIGRAM);
+
+    d->dictionaryManager->setLazyOpening(d->lazyOpening);
+    if (d->idleCloseTimeout > 0)
+    {
+        connect(&d->idleTimer, SIGNAL(timeout()), SLOT(closeIdleDictionaries()));
+        d->idleTimer.start(d->idleCloseTimeout * 1000);
+    }
+
     if (d->dictionaryDirectoryList.isEmpty())
     {
 #ifdef Q_OS_UNIX
@@ -80,6 +132,12 @@ StarDict::StarDict(QObject *parent)
 #endif
         d->dictionaryDirectoryList.append(QDir::homePath() + "/.stardict/dic");
     }
+
+    d->catalog.setDirectories(d->dictionaryDirectoryList);
+    d->dictionaryManager->setCatalog(&d->catalog);
+    connect(&d->catalog, SIGNAL(dictionaryAdded(QString)), SLOT(addDictionary(QString)));
+    connect(&d->catalog, SIGNAL(dictionaryRemoved(QString)), SLOT(removeDictionary(QString)));
+    connect(&d->catalog, SIGNAL(dictionaryChanged(QString)), SLOT(reloadDictionary(QString)));
 }
 
 StarDict::~StarDict()
@@ -89,6 +147,9 @@ StarDict::~StarDict()
     settings.setValue("StarDict/dictionaryDirectoryList", d->dictionaryDirectoryList);
     settings.setValue("StarDict/reformatLists", d->reformatLists);
     settings.setValue("StarDict/expandAbbreviations", d->expandAbbreviations);
+    settings.setValue("StarDict/fuzzyEngine", d->fuzzyEngine);
+    settings.setValue("StarDict/lazyOpening", d->lazyOpening);
+    settings.setValue("StarDict/idleCloseTimeout", d->idleCloseTimeout);
 
     delete d->dictionaryManager;
 }
@@ -120,85 +181,55 @@ StarDict::authors() const
 MulaCore::DictionaryPlugin::Features
 StarDict::features() const
 {
-    return MulaCore::DictionaryPlugin::Features(SearchSimilar | SettingsDialog);
+    return MulaCore::DictionaryPlugin::Features(SearchSimilar | SettingsDialog | ConcurrentQueries);
 }
 
-QString
-StarDict::findAvailableDictionary(const QString& absolutePath)
-{
-    StarDictDictionaryInfo info;
-    if (info.loadFromIfoFile(absolutePath))
-        return info.bookName();
-
-    return QString();
-}
-
-QString
-StarDict::findIfoFile(const QString& absolutePath)
-{
-    StarDictDictionaryInfo info;
-    if (info.loadFromIfoFile(absolutePath) && info.bookName() == d->ifoBookName)
-        d->ifoFileName = absolutePath;
-
-    return QString();
-}
-
-template <typename Method>
 QStringList
-StarDict::recursiveTemplateFind(const QString& directoryPath, Method method)
+StarDict::availableDictionaryList()
 {
-    QDir dir(directoryPath);
     QStringList result;
 
-    // Going through the files
-    foreach (const QFileInfo& entryFileInfo, dir.entryInfoList(QDir::AllEntries | QDir::NoDotAndDotDot))
+    foreach (const QString& ifoFilePath, d->catalog.ifoFilePaths())
     {
-        QString absolutePath = entryFileInfo.absoluteFilePath();
-
-        if (entryFileInfo.isDir()) {
-            result.append(recursiveTemplateFind(absolutePath, method));
-        } else {
-            if (absolutePath.endsWith(QLatin1String(".ifo")))
-                result.append((this->*method)(absolutePath));
-        }
+        QString bookName = d->catalog.bookName(ifoFilePath);
+        if (!bookName.isEmpty())
+            result.append(bookName);
     }
 
     return result;
 }
 
-QStringList
-StarDict::availableDictionaryList()
-{
-    QStringList result;
-
-    foreach (const QString& directoryPath, d->dictionaryDirectoryList)
-       result.append(recursiveTemplateFind(directoryPath, &StarDict::findAvailableDictionary));
-
-    return result;
-}
-
 QStringList
 StarDict::loadedDictionaryList() const
 {
+    QReadLocker locker(&d->dictionaryLock);
     return d->loadedDictionaries.keys();
 }
 
 void
 StarDict::setLoadedDictionaryList(const QStringList &loadedDictionaryList)
 {
-    QStringList availableDictionaries = availableDictionaryList();
-    QStringList disabledDictionaries;
-    foreach (const QString& dictionary, availableDictionaries)
+    // The manager expects the ".ifo" files, not the book names
+    QStringList orderList;
+    foreach (const QString& dictionary, loadedDictionaryList)
     {
-        if (!loadedDictionaryList.contains(dictionary))
-            disabledDictionaries.append(dictionary);
+        QString ifoFilePath = d->catalog.ifoFilePath(dictionary);
+        if (!ifoFilePath.isEmpty())
+            orderList.append(ifoFilePath);
     }
 
-    d->dictionaryManager->reload(d->dictionaryDirectoryList, loadedDictionaryList, disabledDictionaries);
+    QStringList disabledIfoFilePaths;
+    foreach (const QString& ifoFilePath, d->catalog.ifoFilePaths())
+    {
+        if (!orderList.contains(ifoFilePath))
+            disabledIfoFilePaths.append(ifoFilePath);
+    }
 
-    d->loadedDictionaries.clear();
-    for (int i = 0; i < d->dictionaryManager->dictionaryCount(); ++i)
-        d->loadedDictionaries[d->dictionaryManager->dictionaryName(i)] = i;
+    QWriteLocker locker(&d->dictionaryLock);
+    d->disabledIfoFilePaths = disabledIfoFilePaths;
+    d->selectionLoaded = true;
+    d->dictionaryManager->reload(d->dictionaryDirectoryList, orderList, disabledIfoFilePaths);
+    d->updateLoadedDictionaries();
 }
 
 MulaCore::DictionaryInfo
@@ -206,7 +237,7 @@ StarDict::dictionaryInfo(const QString &dictionary)
 {
     StarDictDictionaryInfo nativeInfo;
     nativeInfo.setWordCount(0);
-    if (!nativeInfo.loadFromIfoFile(findDictionary(dictionary, d->dictionaryDirectoryList)))
+    if (!d->catalog.dictionaryInfo(findDictionary(dictionary), nativeInfo))
         return MulaCore::DictionaryInfo();
 
     MulaCore::DictionaryInfo result(name(), dictionary);
@@ -219,45 +250,123 @@ StarDict::dictionaryInfo(const QString &dictionary)
 bool
 StarDict::isTranslatable(const QString &dictionary, const QString &word)
 {
+    QReadLocker locker(&d->dictionaryLock);
     if (!d->loadedDictionaries.contains(dictionary))
         return false;
 
-    return d->dictionaryManager->simpleLookupWord(word.toUtf8().data(), d->loadedDictionaries[dictionary]) != -1 ? true : false;
+    return d->dictionaryManager->simpleLookupWord(word.toUtf8().data(), d->loadedDictionaries.value(dictionary)) != -1 ? true : false;
 }
 
 MulaCore::Translation
 StarDict::translate(const QString &dictionary, const QString &word)
 {
+    QReadLocker locker(&d->dictionaryLock);
     if (!d->loadedDictionaries.contains(dictionary) || word.isEmpty())
         return MulaCore::Translation();
 
-    int dictionaryIndex = d->loadedDictionaries[dictionary];
+    int dictionaryIndex = d->loadedDictionaries.value(dictionary);
     int index;
 
-    if ((index = d->dictionaryManager->simpleLookupWord(word.toUtf8().data(), d->loadedDictionaries[dictionary])) == -1)
+    if ((index = d->dictionaryManager->simpleLookupWord(word.toUtf8().data(), dictionaryIndex)) == -1)
         return MulaCore::Translation();
 
     return MulaCore::Translation(QString::fromUtf8(d->dictionaryManager->key(index, dictionaryIndex)),
             d->dictionaryManager->dictionaryName(dictionaryIndex),
-            parseData(d->dictionaryManager->data(index, dictionaryIndex).toUtf8(), dictionaryIndex, true,
+            parseData(d->dictionaryManager->dataList(QVector<int>() << index, dictionaryIndex).first(), dictionaryIndex, true,
                 d->reformatLists, d->expandAbbreviations));
 }
 
+QList<MulaCore::Translation>
+StarDict::translateBatch(const QString &dictionary, const QStringList &words)
+{
+    QReadLocker locker(&d->dictionaryLock);
+    if (!d->loadedDictionaries.contains(dictionary))
+        return QList<MulaCore::Translation>();
+
+    int dictionaryIndex = d->loadedDictionaries.value(dictionary);
+    QVector<int> indices = d->dictionaryManager->lookupWords(words, dictionaryIndex);
+    QVector<QByteArray> dataList = d->dictionaryManager->dataList(indices, dictionaryIndex);
+    QString dictionaryName = d->dictionaryManager->dictionaryName(dictionaryIndex);
+
+    QList<MulaCore::Translation> translations;
+    for (int i = 0; i < words.size(); ++i)
+    {
+        if (words.at(i).isEmpty() || indices.at(i) == -1)
+        {
+            translations.append(MulaCore::Translation());
+            continue;
+        }
+
+        translations.append(MulaCore::Translation(QString::fromUtf8(d->dictionaryManager->key(indices.at(i), dictionaryIndex)),
+                    dictionaryName,
+                    parseData(dataList.at(i), dictionaryIndex, true, d->reformatLists, d->expandAbbreviations)));
+    }
+
+    return translations;
+}
+
 QStringList
 StarDict::findSimilarWords(const QString &dictionary, const QString &word)
 {
+    QReadLocker locker(&d->dictionaryLock);
     if (!d->loadedDictionaries.contains(dictionary))
         return QStringList();
 
     QStringList fuzzyList;
-    if (!d->dictionaryManager->lookupWithFuzzy(word.toUtf8(), fuzzyList, d->maximumFuzzy, d->loadedDictionaries[dictionary]))
-        return QStringList();
+    int dictionaryIndex = d->loadedDictionaries.value(dictionary);
 
-    fuzzyList.reserve(d->maximumFuzzy);
+    // Prefer the precomputed suggestion index, it is not available while
+    // it is being built in the background
+    if (!d->dictionaryManager->lookupWithSymmetricDeleteIndex(word.toUtf8(), fuzzyList, d->maximumFuzzy, dictionaryIndex)
+        && !d->dictionaryManager->lookupWithFuzzy(word.toUtf8(), fuzzyList, d->maximumFuzzy, dictionaryIndex))
+    {
+        fuzzyList.clear();
+    }
+
+    // The words misspelled by ear are usually too far for the edit distance,
+    // so the sound-alike words are appended after the similar ones
+    QStringList phoneticList;
+    if (d->dictionaryManager->lookupWithPhoneticIndex(word.toUtf8(), phoneticList, d->maximumPhonetic, dictionaryIndex))
+    {
+        foreach (const QString& phoneticWord, phoneticList)
+        {
+            if (!fuzzyList.contains(phoneticWord))
+                fuzzyList.append(phoneticWord);
+        }
+    }
 
     return fuzzyList;
 }
 
+QList<MulaCore::SimilarWord>
+StarDict::findScoredSimilarWords(const QString &dictionary, const QString &word)
+{
+    QList<MulaCore::SimilarWord> similarWords;
+
+    // The length of the words in the index file should be less than 256
+    const int maximumWordLength = 256;
+    quint32 searchWord[maximumWordLength];
+    quint32 similarWord[maximumWordLength];
+
+    QByteArray utf8Word = word.toUtf8();
+    int searchWordLength = BitParallelEditDistance::foldUtf8(utf8Word.constData(), utf8Word.size(),
+                                                             searchWord, maximumWordLength);
+
+    // The suggestions are few, so scoring them again is cheaper than
+    // passing the distances through the fuzzy search engines
+    foreach (const QString& fuzzyWord, findSimilarWords(dictionary, word))
+    {
+        QByteArray utf8FuzzyWord = fuzzyWord.toUtf8();
+        int similarWordLength = BitParallelEditDistance::foldUtf8(utf8FuzzyWord.constData(), utf8FuzzyWord.size(),
+                                                                  similarWord, maximumWordLength);
+        int distance = BitParallelEditDistance::distance(similarWord, similarWordLength,
+                                                         searchWord, searchWordLength, INT_MAX);
+        similarWords.append(MulaCore::SimilarWord(fuzzyWord, distance));
+    }
+
+    return similarWords;
+}
+
 // int
 // StarDict::execSettingsDialog(QWidget *parent)
 // {
@@ -265,228 +374,93 @@ StarDict::findSimilarWords(const QString &dictionary, const QString &word)
     // return dialog.exec();
 // }
 
-QString
-StarDict::parseData(const QByteArray &data, int dictionaryIndex, bool htmlSpaces, bool reformatLists, bool expandAbbreviations)
+void
+StarDict::closeIdleDictionaries()
 {
-    Q_UNUSED(expandAbbreviations);
+    // Skip the round if a query is running, the dictionaries in use would not
+    // be closed anyway
+    if (!d->dictionaryLock.tryLockForWrite())
+        return;
 
-    QString result;
-    int position;
+    d->dictionaryManager->closeIdleDictionaries();
+    d->dictionaryLock.unlock();
+}
 
-    foreach (char ch, data)
-    {
-        switch (ch)
-        {
-            case 'm':
-            case 'l':
-            case 'g':
-            {
-                position += data.length() + 1;
-                result.append(QString::fromUtf8(data));
-                break;
-            }
-
-            case 't':
-            {
-                position += data.length() + 1;
-                result.append("<font class=\"example\">");
-                result.append(QString::fromUtf8(data));
-                result.append("</font>");
-                break;
-            }
-
-            case 'x':
-            {
-                QString string = QString::fromUtf8(data);
-                position += data.length() + 1;
-                xdxf2html(string);
-                result.append(string);
-                break;
-            }
-
-            case 'y':
-            {
-                position += data.length() + 1;
-                break;
-            }
-
-            case 'W':
-            case 'P':
-            {
-                position += *reinterpret_cast<const quint32*>(data.data()) + sizeof(quint32);
-                break;
-            }
-            default:
-                ; // nothing
-        }
-    }
+void
+StarDict::addDictionary(const QString& ifoFilePath)
+{
+    if (!d->selectionLoaded || d->disabledIfoFilePaths.contains(ifoFilePath))
+        return;
 
-    if (d->expandAbbreviations)
-    {
-        QRegExp regExp("_\\S+[\\.:]");
-        int position = 0;
-        while ((position = regExp.indexIn(result, position)) != -1)
-        {
-            int index;
-            if ((index = d->dictionaryManager->simpleLookupWord(result.mid(position, regExp.matchedLength()).toUtf8().data(), dictionaryIndex)) != -1)
-            {
-                QString expanded = "<font class=\"explanation\">";
-                expanded += parseData(d->dictionaryManager->data(index, dictionaryIndex).toUtf8());
-                if (result[position + regExp.matchedLength() - 1] == ':')
-                    expanded += ':';
-
-                expanded += "</font>";
-                result.replace(position, regExp.matchedLength(), expanded);
-                position += expanded.length();
-            }
-            else
-                position += regExp.matchedLength();
-        }
-    }
+    QWriteLocker locker(&d->dictionaryLock);
+    if (d->dictionaryManager->loadDictionary(ifoFilePath))
+        d->updateLoadedDictionaries();
+}
 
-    if (reformatLists)
-    {
-        int position = 0;
-        QStack<QChar> openedLists;
-        while (position < result.length())
-        {
-            if (result[position].isDigit())
-            {
-                int n = 0;
-                while (result[position + n].isDigit())
-                    ++n;
-
-                position += n;
-                if (result[position] == '&' && result.mid(position + 1, 3) == "gt;")
-                    result.replace(position, 4, ">");
-
-                QChar marker = result[position];
-                QString replacement;
-                if (marker == '>' || marker == '.' || marker == ')')
-                {
-                    if (n == 1 && result[position - 1] == '1') // open new list
-                    {
-                        if (openedLists.contains(marker))
-                        {
-                            replacement = "</li></ol>";
-                            while (openedLists.size() && openedLists.top() != marker)
-                            {
-                                replacement += "</li></ol>";
-                                openedLists.pop();
-                            }
-                        }
-                        openedLists.push(marker);
-                        replacement += "<ol>";
-                    }
-                    else
-                    {
-                        while (openedLists.size() && openedLists.top() != marker)
-                        {
-                            replacement += "</li></ol>";
-                            openedLists.pop();
-                        }
-                        replacement += "</li>";
-                    }
-                    replacement += "<li>";
-                    position -= n;
-                    n += position;
-
-                    while (result[position - 1].isSpace())
-                        --position;
-
-                    while (result[n + 1].isSpace())
-                        ++n;
-
-                    result.replace(position, n - position + 1, replacement);
-                    position += replacement.length();
-                }
-                else
-                    ++position;
-            }
-            else
-                ++position;
-        }
-        while (openedLists.size())
-        {
-            result.append("</li></ol>");
-            openedLists.pop();
-        }
-    }
+void
+StarDict::removeDictionary(const QString& ifoFilePath)
+{
+    QWriteLocker locker(&d->dictionaryLock);
+    if (d->dictionaryManager->unloadDictionary(ifoFilePath))
+        d->updateLoadedDictionaries();
+}
 
-    if (htmlSpaces)
-    {
-        int n = 0;
-        while (result[n].isSpace())
-            ++n;
+void
+StarDict::reloadDictionary(const QString& ifoFilePath)
+{
+    QWriteLocker locker(&d->dictionaryLock);
 
-        result.remove(0, n);
-        n = 0;
-        while (result[result.length() - 1 - n].isSpace())
-            ++n;
+    // The dictionary is unloaded if it can not be loaded again, so the list
+    // is updated either way
+    if (d->dictionaryManager->reloadDictionary(ifoFilePath))
+        qDebug() << "Reloaded the changed dictionary" << ifoFilePath;
 
-        result.remove(result.length() - n, n);
+    d->updateLoadedDictionaries();
+}
+
+// Expands the abbreviations with their articles in the same dictionary
+class DictionaryAbbreviationExpander : public ArticleRenderer::AbbreviationExpander
+{
+    public:
+        DictionaryAbbreviationExpander(StarDictDictionaryManager *dictionaryManager, int dictionaryIndex)
+            : m_dictionaryManager(dictionaryManager)
+            , m_dictionaryIndex(dictionaryIndex)
+        {
+        }
 
-        for (int position = 0; position < result.length();)
+        QString expand(const QString& abbreviation)
         {
-            switch (result[position].toLatin1())
-            {
-                case '[':
-                    result.insert(position, "<font class=\"transcription\">");
-                    position += 28 + 1; // sizeof "<font class=\"transcription\">" + 1
-                    break;
-                case ']':
-                    result.insert(position + 1, "</font>");
-                    position += 7 + 1; // sizeof "</font>" + 1
-                    break;
-                case '\t':
-                    result.insert(position, "&nbsp;&nbsp;&nbsp;&nbsp;");
-                    position += 24 + 1; // sizeof "&nbsp;&nbsp;&nbsp;&nbsp;" + 1
-                    break;
-                case '\n':
-                {
-                    int count = 1;
-                    n = 1;
-                    while (result[position + n].isSpace())
-                    {
-                        if (result[position + n] == '\n')
-                            ++count;
-                        ++n;
-                    }
-
-                    if (count > 1)
-                        result.replace(position, n, "</p><p>");
-                    else
-                        result.replace(position, n, "<br>");
-
-                    break;
-                }
-                default:
-                    ++position;
-            }
+            int index = m_dictionaryManager->simpleLookupWord(abbreviation.toUtf8(), m_dictionaryIndex);
+            if (index == -1)
+                return QString();
+
+            QVector<QByteArray> dataList = m_dictionaryManager->dataList(QVector<int>() << index, m_dictionaryIndex);
+            return ArticleRenderer().render(dataList.first());
         }
-    }
-    return result;
-}
+
+    private:
+        StarDictDictionaryManager *m_dictionaryManager;
+        int m_dictionaryIndex;
+};
 
 QString
-StarDict::findDictionary(const QString &name, const QStringList &dictionaryDirectoryList)
+StarDict::parseData(const QByteArray &data, int dictionaryIndex, bool htmlSpaces, bool reformatLists, bool expandAbbreviations)
 {
-    d->ifoBookName = name;
-    foreach (const QString& directoryPath, dictionaryDirectoryList)
-       recursiveTemplateFind(directoryPath, &StarDict::findIfoFile);
+    ArticleRenderer renderer;
+    renderer.setHtmlSpaces(htmlSpaces);
+    renderer.setReformatLists(reformatLists);
 
-    return d->ifoFileName;
+    DictionaryAbbreviationExpander expander(d->dictionaryManager, dictionaryIndex);
+    if (expandAbbreviations && dictionaryIndex != -1)
+        renderer.setAbbreviationExpander(&expander);
+
+    return renderer.render(data);
 }
 
-void
-StarDict::xdxf2html(QString &string)
+QString
+StarDict::findDictionary(const QString &name)
 {
-    string.replace("<abr>", "<font class=\"abbreviature\">");
-    string.replace("<tr>", "<font class=\"transcription\">[");
-    string.replace("</tr>", "]</font>");
-    string.replace("<ex>", "<font class=\"example\">");
-    string.remove(QRegExp("<k>.*<\\/k>"));
-    string.replace(QRegExp("(<\\/abr>)|(<\\ex>)"), "</font");
+    return d->catalog.ifoFilePath(name);
 }
 
 #include "stardict.moc"
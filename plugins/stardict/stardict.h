@@ -93,10 +93,18 @@ namespace MulaPluginStarDict
 
             MulaCore::Translation translate(const QString &dict, const QString &word);
 
+            /** Reimplemented from DictionaryPlugin::translateBatch() */
+
+            QList<MulaCore::Translation> translateBatch(const QString &dict, const QStringList &words);
+
             /** Reimplemented from DictionaryPlugin::findSimilarWords() */
 
             QStringList findSimilarWords(const QString &dict, const QString &word);
 
+            /** Reimplemented from DictionaryPlugin::findScoredSimilarWords() */
+
+            QList<MulaCore::SimilarWord> findScoredSimilarWords(const QString &dict, const QString &word);
+
             /** Reimplemented from DictionaryPlugin::dictionaryInfo() */
 
             MulaCore::DictionaryInfo dictionaryInfo(const QString &dictionaryUrl);
@@ -105,30 +113,45 @@ namespace MulaPluginStarDict
 
             friend class SettingsDialog;
 
-        private:
-            QString parseData(const QByteArray &data, int dictIndex = -1,
-                    bool htmlSpaces = false, bool reformatLists = false, bool expandAbbreviations = false);
+        private Q_SLOTS:
 
-            QString findDictionary(const QString &name, const QStringList &dictDirs);
-            static void xdxf2html(QString &str);
+            /**
+             * Closes the dictionaries that have been idle since the previous
+             * timeout of the idle timer
+             */
+
+            void closeIdleDictionaries();
 
             /**
-             * Finds the available dictionary from the desired ".ifo" file path
-             * and then return the relevant book name
+             * Loads the dictionary added to a dictionary directory, unless no
+             * dictionaries have been selected yet, or it has been disabled
              *
-             * @param absolutePath The complete path of the ".ifo" file
+             * @param ifoFilePath The absolute path of the ".ifo" file
+             */
+
+            void addDictionary(const QString& ifoFilePath);
+
+            /**
+             * Unloads the dictionary removed from a dictionary directory
              *
-             * @return The book name of the dictionary
+             * @param ifoFilePath The absolute path of the ".ifo" file
+             */
+
+            void removeDictionary(const QString& ifoFilePath);
+
+            /**
+             * Loads the dictionary again whose files have changed
              *
-             * @see findIfoFile, availableDictionaryList, loadedDictionaryList,
-             * setLoadedDictionaryList
+             * @param ifoFilePath The absolute path of the ".ifo" file
              */
 
-            QString findAvailableDictionary(const QString& absolutePath);
+            void reloadDictionary(const QString& ifoFilePath);
 
-            QString findIfoFile(const QString& absolutePath);
+        private:
+            QString parseData(const QByteArray &data, int dictIndex = -1,
+                    bool htmlSpaces = false, bool reformatLists = false, bool expandAbbreviations = false);
 
-            template <typename Method> QStringList recursiveTemplateFind(const QString& directoryPath, Method method);
+            QString findDictionary(const QString &name);
 
             class Private;
             Private *const d;
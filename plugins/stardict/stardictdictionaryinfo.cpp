@@ -59,12 +59,36 @@ StarDictDictionaryInfo::~StarDictDictionaryInfo()
 {
 }
 
+// Finds the value of the "key=value" line, the first line is the magic data
+static bool
+ifoValue(const QByteArray& buffer, const char *key, QByteArray& value)
+{
+    QByteArray line = QByteArray("\n") + key + '=';
+    int index = buffer.indexOf(line);
+    if (index == -1)
+        return false;
+
+    index += line.size();
+    int endIndex = buffer.indexOf('\n', index);
+    if (endIndex == -1)
+        endIndex = buffer.size();
+
+    value = buffer.mid(index, endIndex - index);
+    if (value.endsWith('\r'))
+        value.chop(1);
+
+    return true;
+}
+
 bool
 StarDictDictionaryInfo::loadFromIfoFile(const QString& ifoFilePath,
                                 bool isTreeDictionary)
 {
     d->ifoFilePath = ifoFilePath;
     QFile ifoFile(ifoFilePath);
+    if (!ifoFile.open(QIODevice::ReadOnly))
+        return false;
+
     QByteArray buffer = ifoFile.readAll();
 
     if (buffer.isEmpty())
@@ -77,96 +101,51 @@ StarDictDictionaryInfo::loadFromIfoFile(const QString& ifoFilePath,
     if (!buffer.startsWith(magicData))
         return false;
 
-    QByteArray byteArray;
-    int index;
-
-    byteArray = buffer.mid(strlen(magicData) - 1);
-
-    index = byteArray.indexOf("\nwordcount=");
-    if (index == -1)
-        return false;
-
-    index += sizeof("\nwordcount=") - 1;
-
+    // Keep the newline of the magic data, so every line starts with one
+    QByteArray byteArray = buffer.mid(magicData.size() - 1);
+    QByteArray value;
     bool ok;
-    d->wordCount = byteArray.mid(index, byteArray.indexOf('\n', index) - index).toLong(&ok, 10);
-
-    if (isTreeDictionary)
-    {
-        index = byteArray.indexOf("\ntdxfilesize=");
-        if (index == -1)
-            return false;
 
-        index += sizeof("\ntdxfilesize=");
-
-        d->indexFileSize = byteArray.mid(index, byteArray.indexOf('\n', index) - index).toLong(&ok, 10);
-    }
-    else
-    {
-        index = byteArray.indexOf("\nidxfilesize=");
-        if (index == -1)
-            return false;
-
-        index += sizeof("\nidxfilesize=");
-
-        d->indexFileSize = byteArray.mid(index, byteArray.indexOf('\n', index) - index).toLong(&ok, 10);
-    }
-
-    // bookname
-    index = byteArray.indexOf("\nbookname=");
-    if (index == -1)
+    if (!ifoValue(byteArray, "wordcount", value))
         return false;
 
-    index += sizeof("\nbookname=");
-    d->bookName = byteArray.indexOf('\n', index);
-
-    // author
-    index = byteArray.indexOf("\nauthor=");
-    if (index == -1)
+    d->wordCount = value.toULong(&ok, 10);
+    if (!ok)
         return false;
 
-    index += sizeof("\nauthor=");
-    d->author = byteArray.indexOf('\n', index);
-
-    // email
-    index = byteArray.indexOf("\nemail=");
-    if (index == -1)
+    if (!ifoValue(byteArray, isTreeDictionary ? "tdxfilesize" : "idxfilesize", value))
         return false;
 
-    index += sizeof("\nemail=");
-    d->email = byteArray.indexOf('\n', index);
+    d->indexFileSize = value.toULong(&ok, 10);
+    if (!ok)
+        return false;
 
-    // website
-    index = byteArray.indexOf("\nwebsite=");
-    if (index == -1)
+    if (!ifoValue(byteArray, "bookname", value))
         return false;
 
-    index += sizeof("\nwebsite=");
-    d->website = byteArray.indexOf('\n', index);
+    d->bookName = QString::fromUtf8(value);
 
-    // date
-    index = byteArray.indexOf("\ndate=");
-    if (index == -1)
-        return false;
+    // The rest of the fields are optional
+    if (ifoValue(byteArray, "idxoffsetbits", value))
+        d->indexOffsetBits = value.toULong();
 
-    index += sizeof("\ndate=");
-    d->date = byteArray.indexOf('\n', index);
+    if (ifoValue(byteArray, "author", value))
+        d->author = QString::fromUtf8(value);
 
-    // description
-    index = byteArray.indexOf("\ndescription=");
-    if (index == -1)
-        return false;
+    if (ifoValue(byteArray, "email", value))
+        d->email = QString::fromUtf8(value);
 
-    index += sizeof("\ndescription=");
-    d->description = byteArray.indexOf('\n', index);
+    if (ifoValue(byteArray, "website", value))
+        d->website = QString::fromUtf8(value);
 
-    // description
-    index = byteArray.indexOf("\nsametypesequence=");
-    if (index == -1)
-        return false;
+    if (ifoValue(byteArray, "date", value))
+        d->date = QString::fromUtf8(value);
+
+    if (ifoValue(byteArray, "description", value))
+        d->description = QString::fromUtf8(value);
 
-    index += sizeof("\nsametypesequence=");
-    d->sameTypeSequence = byteArray.indexOf('\n', index);
+    if (ifoValue(byteArray, "sametypesequence", value))
+        d->sameTypeSequence = QString::fromUtf8(value);
 
     return true;
 }
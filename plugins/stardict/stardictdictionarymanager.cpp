@@ -19,15 +19,36 @@
 
 #include "stardictdictionarymanager.h"
 
+#include "bktree.h"
+#include "datasearchjob.h"
 #include "distance.h"
 #include "dictionary.h"
+#include "dictionarycatalog.h"
+#include "dictionaryloadjob.h"
+#include "dictionaryzip.h"
 #include "file.h"
+#include "fuzzysearchjob.h"
+#include "headwordbucketindex.h"
+#include "levenshteinautomaton.h"
+#include "mergedwordcursor.h"
+#include "morphologyengine.h"
+#include "phoneticindex.h"
+#include "symmetricdeleteindex.h"
+#include "trigramindex.h"
 
 #include <QtCore/QtAlgorithms>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QHash>
+#include <QtCore/QSemaphore>
+#include <QtCore/QSet>
+#include <QtCore/QThreadPool>
 #include <QtCore/QString>
 #include <QtCore/QDir>
 #include <QtCore/QDebug>
 
+#include <algorithm>
+
+#include <limits.h>
 #include <zlib.h>
 
 using namespace MulaPluginStarDict;
@@ -35,33 +56,13 @@ using namespace MulaPluginStarDict;
 // Notice: read src/tools/DICTFILE_FORMAT for the dictionary
 // file's format information!
 
-static bool
-isVowel(QChar inputChar)
-{
-    QChar ch = inputChar.toLower();
-    return ( ch == 'a' || ch == 'e' || ch == 'i' || ch == 'o' || ch == 'u' );
-}
-
-static bool
-isPureEnglish(const QByteArray& word)
-{
-    foreach (char c, word)
-    {
-        //if(str[i]<0)
-        //if(str[i]<32 || str[i]>126) // tab equal 9,so this is not OK.
-        // Better use isascii() but not str[i]<0 while char is default unsigned in arm
-        if (!isascii(c))
-            return false;
-    }
-
-    return true;
-}
-
 class StarDictDictionaryManager::Private
 {
     public:
         Private()
-           : found(false)
+           : fuzzyEngine(FULLSCAN)
+           , lazyOpening(false)
+           , catalog(0)
         {
         }
 
@@ -73,11 +74,18 @@ class StarDictDictionaryManager::Private
         progress_func_t progressFunction;
 
         QList<Dictionary *> previous;
-        QList<Dictionary *> next;
 
-        bool found;
+        QThreadPool threadPool;
+        MorphologyEngine morphologyEngine;
+        FuzzyEngine fuzzyEngine;
+        bool lazyOpening;
+        const DictionaryCatalog *catalog;
+
         static const int maxMatchItemPerLib = 100;
         static const int maximumFuzzyDistance = 3; // at most MAX_FUZZY_DISTANCE-1 differences allowed when find similar words
+        static const int maximumWordLength = 256; // the length of the words in the index file should be less than 256
+        static const int minimumFuzzyRangeSize = 16384; // the smallest range of headwords scanned by a fuzzy search job
+        static const int minimumTrigramSimilarity = 20; // the smallest Jaccard similarity in percent of the trigram candidates
 
 };
 
@@ -93,13 +101,28 @@ StarDictDictionaryManager::~StarDictDictionaryManager()
     delete d;
 }
 
+// Starts building the suggestion indices of the dictionary in the background
+// if needed, the lazily opened dictionaries start it on their first use
+static void
+startIndexing(Dictionary *dictionary)
+{
+    if (!dictionary->isOpen())
+        return;
+
+    dictionary->headwordBloomFilter();
+    dictionary->headwordPerfectHash();
+    dictionary->symmetricDeleteIndex();
+    dictionary->phoneticIndex();
+}
+
 bool
 StarDictDictionaryManager::loadDictionary(const QString& ifoFilePath)
 {
     Dictionary *dictionary = new Dictionary;
-    if (dictionary->load(ifoFilePath))
+    if (dictionary->load(ifoFilePath, d->lazyOpening))
     {
         d->dictionaryList.append(dictionary);
+        startIndexing(dictionary);
     }
     else
     {
@@ -112,6 +135,54 @@ StarDictDictionaryManager::loadDictionary(const QString& ifoFilePath)
     return true;
 }
 
+bool
+StarDictDictionaryManager::unloadDictionary(const QString& ifoFilePath)
+{
+    for (int i = 0; i < d->dictionaryList.size(); ++i)
+    {
+        if (d->dictionaryList.at(i)->ifoFilePath() == ifoFilePath)
+        {
+            delete d->dictionaryList.takeAt(i);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool
+StarDictDictionaryManager::reloadDictionary(const QString& ifoFilePath)
+{
+    for (int i = 0; i < d->dictionaryList.size(); ++i)
+    {
+        if (d->dictionaryList.at(i)->ifoFilePath() != ifoFilePath)
+            continue;
+
+        delete d->dictionaryList.takeAt(i);
+
+        Dictionary *dictionary = new Dictionary;
+        if (!dictionary->load(ifoFilePath, d->lazyOpening))
+        {
+            qDebug() << "Could not reload the dictionary according to the given ifo"
+                "file:" << ifoFilePath;
+            delete dictionary;
+            return false;
+        }
+
+        d->dictionaryList.insert(i, dictionary);
+        startIndexing(dictionary);
+        return true;
+    }
+
+    return false;
+}
+
+void
+StarDictDictionaryManager::setCatalog(const DictionaryCatalog *catalog)
+{
+    d->catalog = catalog;
+}
+
 long
 StarDictDictionaryManager::articleCount(int index) const
 {
@@ -135,17 +206,53 @@ StarDictDictionaryManager::dictionaryCount() const
 QByteArray
 StarDictDictionaryManager::key(long keyIndex, int dictionaryIndex) const
 {
-    Q_ASSERT_X( keyIndex >= 0 && keyIndex < dictionaryCount(), Q_FUNC_INFO, "index out of range in list of dictionaries" );
+    Q_ASSERT_X( dictionaryIndex >= 0 && dictionaryIndex < dictionaryCount(), Q_FUNC_INFO, "index out of range in list of dictionaries" );
+    Q_ASSERT_X( keyIndex >= 0 && keyIndex < articleCount(dictionaryIndex), Q_FUNC_INFO, "index out of range in the dictionary" );
     return d->dictionaryList.at(dictionaryIndex)->key(keyIndex).toUtf8();
 }
 
 QString
 StarDictDictionaryManager::data(long dataIndex, int dictionaryIndex)
 {
-    Q_ASSERT_X( dataIndex >= 0 && dataIndex < dictionaryCount(), Q_FUNC_INFO, "index out of range in list of dictionaries" );
+    Q_ASSERT_X( dictionaryIndex >= 0 && dictionaryIndex < dictionaryCount(), Q_FUNC_INFO, "index out of range in list of dictionaries" );
+    Q_ASSERT_X( dataIndex >= 0 && dataIndex < articleCount(dictionaryIndex), Q_FUNC_INFO, "index out of range in the dictionary" );
     return d->dictionaryList.at(dictionaryIndex)->data(dataIndex);
 }
 
+void
+StarDictDictionaryManager::setLazyOpening(bool lazyOpening)
+{
+    d->lazyOpening = lazyOpening;
+}
+
+bool
+StarDictDictionaryManager::lazyOpening() const
+{
+    return d->lazyOpening;
+}
+
+void
+StarDictDictionaryManager::closeIdleDictionaries()
+{
+    foreach (Dictionary *dictionary, d->dictionaryList)
+    {
+        if (dictionary->closeIfIdle())
+            qDebug() << "Closed the idle dictionary" << dictionary->dictionaryName();
+    }
+}
+
+void
+StarDictDictionaryManager::setFuzzyEngine(FuzzyEngine fuzzyEngine)
+{
+    d->fuzzyEngine = fuzzyEngine;
+}
+
+StarDictDictionaryManager::FuzzyEngine
+StarDictDictionaryManager::fuzzyEngine() const
+{
+    return d->fuzzyEngine;
+}
+
 int
 StarDictDictionaryManager::lookupWord(int dictionaryIndex, const QString& searchWord)
 {
@@ -153,11 +260,25 @@ StarDictDictionaryManager::lookupWord(int dictionaryIndex, const QString& search
     return d->dictionaryList.at(dictionaryIndex)->lookup(searchWord);
 }
 
-template <typename Method>
 void
-StarDictDictionaryManager::recursiveTemplateHelper(const QString& directoryName, const QStringList& orderList, const QStringList& disableList,
-                                                    Method method)
+StarDictDictionaryManager::collectIfoFilePaths(const QString& directoryName, const QStringList& orderList,
+                                               const QStringList& disableList, QStringList& ifoFilePaths) const
 {
+    // The catalog has listed the directory already
+    if (d->catalog && d->catalog->contains(directoryName))
+    {
+        foreach (const QString& absolutePath, d->catalog->ifoFilePaths(directoryName))
+        {
+            if (qFind(orderList.begin(), orderList.end(), absolutePath) == orderList.end()
+                    && qFind(disableList.begin(), disableList.end(), absolutePath) == disableList.end())
+            {
+                ifoFilePaths.append(absolutePath);
+            }
+        }
+
+        return;
+    }
+
     QDir dir(directoryName);
 
     // Going through the files
@@ -166,31 +287,94 @@ StarDictDictionaryManager::recursiveTemplateHelper(const QString& directoryName,
         QString absolutePath = entryFileInfo.absoluteFilePath();
 
         if (entryFileInfo.isDir()) {
-            recursiveTemplateHelper(absolutePath, orderList, disableList, method);
+            collectIfoFilePaths(absolutePath, orderList, disableList, ifoFilePaths);
         } else {
             if (absolutePath.endsWith(QLatin1String(".ifo"))
                     && qFind(orderList.begin(), orderList.end(), absolutePath) == orderList.end()
                     && qFind(disableList.begin(), disableList.end(), absolutePath) == disableList.end())
             {
-                (this->*method)(absolutePath);
+                ifoFilePaths.append(absolutePath);
             }
         }
     }
 }
 
-void
-StarDictDictionaryManager::load(const QStringList& dictionaryDirectoryList,
-                                const QStringList& orderList,
-                                const QStringList& disableList)
+QStringList
+StarDictDictionaryManager::ifoFilePaths(const QStringList& dictionaryDirectoryList,
+                                        const QStringList& orderList,
+                                        const QStringList& disableList) const
 {
+    QStringList ifoFilePaths;
+
     foreach (const QString& absoluteFilePath, orderList)
     {
         if (qFind(disableList.begin(), disableList.end(), absoluteFilePath) == disableList.end())
-            loadDictionary(absoluteFilePath);
+            ifoFilePaths.append(absoluteFilePath);
     }
 
     foreach (const QString& directoryName, dictionaryDirectoryList)
-        recursiveTemplateHelper(directoryName, orderList, disableList, &StarDictDictionaryManager::loadDictionary);
+        collectIfoFilePaths(directoryName, orderList, disableList, ifoFilePaths);
+
+    return ifoFilePaths;
+}
+
+QList<Dictionary *>
+StarDictDictionaryManager::loadDictionaries(const QStringList& ifoFilePaths)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    QSemaphore finished;
+    QList<DictionaryLoadJob *> jobs;
+    foreach (const QString& ifoFilePath, ifoFilePaths)
+    {
+        DictionaryLoadJob *job = new DictionaryLoadJob(ifoFilePath, &finished, d->lazyOpening);
+        jobs.append(job);
+        d->threadPool.start(job);
+    }
+
+    // The pool is shared with the queries, so only the jobs of this load
+    // are waited for
+    finished.acquire(jobs.size());
+
+    // The dictionaries are collected in the order of the paths, regardless
+    // of which one finished loading first
+    QList<Dictionary *> dictionaries;
+    foreach (DictionaryLoadJob *job, jobs)
+    {
+        Dictionary *dictionary = job->takeDictionary();
+        if (dictionary)
+        {
+            qDebug() << "Loaded the dictionary" << job->ifoFilePath() << "in" << job->elapsed() << "ms";
+            startIndexing(dictionary);
+        }
+        else
+        {
+            qDebug() << "Could not load the dictionary according to the given ifo"
+                "file:" << job->ifoFilePath();
+        }
+
+        dictionaries.append(dictionary);
+    }
+
+    qDeleteAll(jobs);
+
+    if (!ifoFilePaths.isEmpty())
+        qDebug() << "Loaded" << ifoFilePaths.size() << "dictionaries in" << timer.elapsed() << "ms";
+
+    return dictionaries;
+}
+
+void
+StarDictDictionaryManager::load(const QStringList& dictionaryDirectoryList,
+                                const QStringList& orderList,
+                                const QStringList& disableList)
+{
+    foreach (Dictionary *dictionary, loadDictionaries(ifoFilePaths(dictionaryDirectoryList, orderList, disableList)))
+    {
+        if (dictionary)
+            d->dictionaryList.append(dictionary);
+    }
 }
 
 Dictionary*
@@ -213,16 +397,6 @@ StarDictDictionaryManager::reloaderFind(const QString& completeFilePath)
     return NULL;
 }
 
-void
-StarDictDictionaryManager::reloaderHelper(const QString &absolutePath)
-{
-    Dictionary *dictionary = reloaderFind(absolutePath);
-    if (dictionary)
-        d->next.append(dictionary);
-    else
-        loadDictionary(absolutePath);
-}
-
 void
 StarDictDictionaryManager::reload(const QStringList& dictionaryDirectoryList,
                                   const QStringList& orderList,
@@ -231,369 +405,517 @@ StarDictDictionaryManager::reload(const QStringList& dictionaryDirectoryList,
     d->previous = d->dictionaryList;
     d->dictionaryList.clear();
 
-    foreach (const QString& absoluteFilePath, orderList)
+    // The dictionaries loaded already are kept, only the new ones are loaded
+    QList<Dictionary *> dictionaries;
+    QStringList newIfoFilePaths;
+    foreach (const QString& ifoFilePath, ifoFilePaths(dictionaryDirectoryList, orderList, disableList))
     {
-        if (qFind(disableList.begin(), disableList.end(), absoluteFilePath) == disableList.end())
-            reloaderHelper(absoluteFilePath);
+        Dictionary *dictionary = reloaderFind(ifoFilePath);
+        if (!dictionary)
+            newIfoFilePaths.append(ifoFilePath);
+
+        dictionaries.append(dictionary);
     }
 
-    foreach (const QString& directoryName, dictionaryDirectoryList)
-        recursiveTemplateHelper(directoryName, orderList, disableList, &StarDictDictionaryManager::reloaderHelper);
+    QList<Dictionary *> newDictionaries = loadDictionaries(newIfoFilePaths);
+    foreach (Dictionary *dictionary, dictionaries)
+    {
+        if (!dictionary)
+            dictionary = newDictionaries.takeFirst();
+
+        if (dictionary)
+            d->dictionaryList.append(dictionary);
+    }
 
     qDeleteAll(d->previous);
+    d->previous.clear();
 }
 
-QByteArray
-StarDictDictionaryManager::poCurrentWord(int *iCurrent)
+MergedWordCursor*
+StarDictDictionaryManager::createWordCursor() const
 {
-    const char *poCurrentWord = NULL;
-    const char *word;
+    return new MergedWordCursor(d->dictionaryList);
+}
 
-    for (QVector<Dictionary *>::size_type iLib = 0; iLib < d->dictionaryList.size(); ++iLib)
+int
+StarDictDictionaryManager::lookupSimilarWord(QByteArray searchWord, int iLib)
+{
+    // The candidates are resolved in one pass, and the first one found in
+    // the order of preference wins
+    QStringList candidates = d->morphologyEngine.candidates(QString::fromUtf8(searchWord));
+    foreach (int index, d->dictionaryList.at(iLib)->lookupBatch(candidates))
     {
-        if (iCurrent[iLib] == invalidIndex)
-            continue;
+        if (index != invalidIndex)
+            return index;
+    }
 
-        if (iCurrent[iLib] >= articleCount(iLib) || iCurrent[iLib] < 0)
-            continue;
+    return invalidIndex;
+}
 
-        if (poCurrentWord == NULL )
+int
+StarDictDictionaryManager::simpleLookupWord(QByteArray searchWord, int iLib)
+{
+    int retval;
+
+    if ((retval = d->dictionaryList.at(iLib)->lookup(searchWord)) == -1) {
+        retval = lookupSimilarWord(searchWord, iLib);
+    }
+
+    return retval;
+}
+
+QVector<int>
+StarDictDictionaryManager::lookupWords(const QStringList& words, int dictionaryIndex)
+{
+    Q_ASSERT_X( dictionaryIndex >= 0 && dictionaryIndex < dictionaryCount(), Q_FUNC_INFO, "index out of range in list of dictionaries" );
+
+    // Every distinct word is looked up once
+    QHash<QString, int> wordPositions;
+    QStringList distinctWords;
+    foreach (const QString& word, words)
+    {
+        if (!wordPositions.contains(word))
         {
-            poCurrentWord = key(iCurrent[iLib], iLib);
+            wordPositions.insert(word, distinctWords.size());
+            distinctWords.append(word);
         }
-        else
-        {
-            word = key(iCurrent[iLib], iLib);
+    }
 
-            if (stardictStringCompare(poCurrentWord, word) > 0 )
-                poCurrentWord = word;
-        }
+    QVector<int> distinctIndices = d->dictionaryList.at(dictionaryIndex)->lookupBatch(distinctWords);
+
+    // The missing words fall back to their base forms like with a single lookup
+    for (int i = 0; i < distinctWords.size(); ++i)
+    {
+        if (distinctIndices.at(i) == invalidIndex)
+            distinctIndices[i] = lookupSimilarWord(distinctWords.at(i).toUtf8(), dictionaryIndex);
     }
-    return poCurrentWord;
+
+    QVector<int> indices;
+    indices.reserve(words.size());
+    foreach (const QString& word, words)
+        indices.append(distinctIndices.at(wordPositions.value(word)));
+
+    return indices;
 }
 
-QByteArray
-StarDictDictionaryManager::poNextWord(QByteArray searchWord, int* iCurrent)
+QVector<QByteArray>
+StarDictDictionaryManager::dataList(const QVector<int>& indices, int dictionaryIndex)
+{
+    Q_ASSERT_X( dictionaryIndex >= 0 && dictionaryIndex < dictionaryCount(), Q_FUNC_INFO, "index out of range in list of dictionaries" );
+    return d->dictionaryList.at(dictionaryIndex)->dataBatch(indices);
+}
+
+struct
+Fuzzystruct
 {
-    // the input can be:
-    // (word,iCurrent),read word,write iNext to iCurrent,and return next word. used by TopWin::NextCallback();
-    // (NULL,iCurrent),read iCurrent,write iNext to iCurrent,and return next word. used by AppCore::ListWords();
-    QByteArray currentWord = NULL;
-    QVector<Dictionary *>::size_type iCurrentLib = 0;
-    const char *word;
+    QByteArray pMatchWord;
+    int matchWordDistance;
+};
 
-    for (QVector<Dictionary *>::size_type iLib = 0; iLib < d->dictionaryList.size(); ++iLib)
-    {
-        if (!searchWord.isEmpty())
-            iCurrent[iLib] = d->dictionaryList.at(iLib)->lookup(searchWord);
+inline bool
+operator<(const Fuzzystruct & lh, const Fuzzystruct & rh)
+{
+    if (lh.matchWordDistance != rh.matchWordDistance)
+        return lh.matchWordDistance < rh.matchWordDistance;
 
-        if (iCurrent[iLib] == invalidIndex)
-            continue;
+    if (!lh.pMatchWord.isNull() && !rh.pMatchWord.isNull())
+        return stardictStringCompare(lh.pMatchWord, rh.pMatchWord) < 0;
 
-        if (iCurrent[iLib] >= articleCount(iLib) || iCurrent[iLib] < 0)
-            continue;
+    return false;
+}
 
-        if (currentWord.isNull())
-        {
-            currentWord = key(iCurrent[iLib], iLib);
-            iCurrentLib = iLib;
-        }
-        else
-        {
-            word = key(iCurrent[iLib], iLib);
+static bool
+insertFuzzyResult(Fuzzystruct *oFuzzystruct, int resultListSize, const QByteArray& matchWord, int distance, int& maximumDistance)
+{
+    int maximumDistanceAt = 0;
+    for (int j = 0; j < resultListSize; ++j)
+    {
+        if (oFuzzystruct[j].pMatchWord == matchWord)
+            return false; // already in list
 
-            if (stardictStringCompare(currentWord, word) > 0 )
-            {
-                currentWord = word;
-                iCurrentLib = iLib;
-            }
-        }
+        // find the position, it will certainly be found as maximumDistance is set by the last insertion
+        if (oFuzzystruct[j].matchWordDistance == maximumDistance)
+            maximumDistanceAt = j;
     }
 
-    if (!currentWord.isEmpty())
+    // The list is kept in the order of insertion, so the worst match found
+    // last is replaced, and the ties are resolved in the visiting order
+    for (int j = maximumDistanceAt; j < resultListSize - 1; ++j)
+        oFuzzystruct[j] = oFuzzystruct[j + 1];
+
+    oFuzzystruct[resultListSize - 1].pMatchWord = matchWord;
+    oFuzzystruct[resultListSize - 1].matchWordDistance = distance;
+
+    // calculate the new maximumDistance
+    maximumDistance = distance;
+    for (int j = 0; j < resultListSize; ++j)
     {
-        iCurrent[iCurrentLib]++;
-        for (QVector<Dictionary *>::size_type iLib = 0; iLib < d->dictionaryList.size(); ++iLib)
-        {
-            if (iLib == iCurrentLib)
-                continue;
+        if (oFuzzystruct[j].matchWordDistance > maximumDistance)
+            maximumDistance = oFuzzystruct[j].matchWordDistance;
+    }
 
-            if (iCurrent[iLib] == invalidIndex)
-                continue;
+    return true;
+}
 
-            if ( iCurrent[iLib] >= articleCount(iLib) || iCurrent[iLib] < 0)
-                continue;
+static bool
+hasAsciiPrefix(const Dictionary *dictionary, int index, const QByteArray& prefix)
+{
+    QByteArray word = dictionary->utf8Key(index);
+    return word.size() >= prefix.size() && !qstrnicmp(word.constData(), prefix.constData(), prefix.size());
+}
 
-            if (strcmp(currentWord, key(iCurrent[iLib], iLib)) == 0 )
-                iCurrent[iLib]++;
-        }
+// Returns the index of the first headword after the index that does not start
+// with the ASCII prefix in any case. The index is sorted by the ASCII case
+// folded headwords, so the headwords sharing such a prefix are adjacent, and
+// the end of the range is found by galloping forward and a binary search,
+// which costs only a few reads if the range is short. The headwords sharing
+// a prefix folded from other letters are spread over the index.
+static int
+skipAsciiPrefix(const Dictionary *dictionary, int index, int wordCount, const QByteArray& prefix)
+{
+    int low = index;
+    int step = 1;
+    int high = index + step;
 
-        currentWord = poCurrentWord(iCurrent);
+    while (high < wordCount && hasAsciiPrefix(dictionary, high, prefix))
+    {
+        low = high;
+        step *= 2;
+        high = index + step;
     }
-    return currentWord;
+
+    high = qMin(high, wordCount);
+
+    // The prefix is shared by low and not shared by high
+    while (high - low > 1)
+    {
+        int middle = low + (high - low) / 2;
+        if (hasAsciiPrefix(dictionary, middle, prefix))
+            low = middle;
+        else
+            high = middle;
+    }
+
+    return high;
 }
 
-QByteArray
-StarDictDictionaryManager::poPreviousWord(long *iCurrent)
+// Verifies the distance of the candidate headwords of an index and keeps the
+// best ones, the same way as the full scan does
+static bool
+scoreFuzzyCandidates(const Dictionary *dictionary, const QVector<quint32>& candidates,
+                     const quint32 *searchBuffer, int searchWordLength,
+                     Fuzzystruct *oFuzzystruct, int resultListSize, int& maximumDistance)
 {
-    // used by TopWin::PreviousCallback(); the iCurrent is cached by AppCore::TopWinWordChange();
-    QByteArray poCurrentWord = NULL;
-    QVector<Dictionary *>::size_type iCurrentLib = 0;
-    const char *word;
+    quint32 checkBuffer[256]; // the length of the words in the index file should be less than 256
+    bool found = false;
 
-    for (QVector<Dictionary *>::size_type iLib = 0; iLib < d->dictionaryList.size(); ++iLib)
+    foreach (quint32 index, candidates)
     {
-        if (iCurrent[iLib] == invalidIndex)
-            iCurrent[iLib] = articleCount(iLib);
-        else
-        {
-            if ( iCurrent[iLib] > articleCount(iLib) || iCurrent[iLib] <= 0)
-                continue;
-        }
+        QByteArray checkWord = dictionary->utf8Key(index);
+        int checkWordLength = BitParallelEditDistance::foldUtf8(checkWord.constData(), checkWord.size(), checkBuffer, 256);
 
-        if ( poCurrentWord.isNull() )
-        {
-            poCurrentWord = key(iCurrent[iLib] - 1, iLib);
-            iCurrentLib = iLib;
-        }
-        else
+        int distance = BitParallelEditDistance::distance(checkBuffer, checkWordLength,
+                                                         searchBuffer, searchWordLength, maximumDistance);
+        if (distance < maximumDistance && distance < searchWordLength)
         {
-            word = key(iCurrent[iLib] - 1, iLib);
-            if (stardictStringCompare(poCurrentWord, word) < 0 )
-            {
-                poCurrentWord = word;
-                iCurrentLib = iLib;
-            }
+            found = true;
+            insertFuzzyResult(oFuzzystruct, resultListSize, checkWord, distance, maximumDistance);
         }
     }
 
-    if (!poCurrentWord.isEmpty())
+    return found;
+}
+
+bool
+StarDictDictionaryManager::lookupWithFuzzy(const QByteArray& searchWord, QStringList& resultList, int resultListSize, int iLib)
+{
+    if (searchWord.isEmpty())
+        return false;
+
+    if (d->fuzzyEngine == PARALLELSCAN)
+        return lookupWithParallelFuzzy(searchWord, resultList, resultListSize, iLib);
+
+    Fuzzystruct *oFuzzystruct = new Fuzzystruct[resultListSize];
+
+    for (int i = 0; i < resultListSize; ++i)
     {
-        iCurrent[iCurrentLib]--;
-        for (QVector<Dictionary *>::size_type iLib = 0; iLib < d->dictionaryList.size(); ++iLib)
+        oFuzzystruct[i].pMatchWord = NULL;
+        oFuzzystruct[i].matchWordDistance = d->maximumFuzzyDistance;
+    }
+
+    int maximumDistance = d->maximumFuzzyDistance;
+    int iDistance;
+    bool found = false;
+
+    // The words are folded into UTF-32 buffers on the stack, so the distance
+    // computation does not allocate for every headword
+    QByteArray searchCheckWord;
+    quint32 searchCheckBuffer[Private::maximumWordLength];
+    long searchCheckWordLength;
+    quint32 searchBuffer[Private::maximumWordLength];
+    long searchWordLength = BitParallelEditDistance::foldUtf8(searchWord.constData(), searchWord.size(),
+                                                              searchBuffer, d->maximumWordLength);
+
+    if (d->progressFunction)
+        d->progressFunction();
+
+    Dictionary *dictionary = d->dictionaryList.at(iLib);
+    const BkTree *bkTree = (d->fuzzyEngine == BKTREE) ? dictionary->bkTree() : 0;
+    const HeadwordBucketIndex *bucketIndex = (d->fuzzyEngine == BUCKETSCAN) ? dictionary->headwordBucketIndex() : 0;
+    const TrigramIndex *trigramIndex = (d->fuzzyEngine == TRIGRAM) ? dictionary->trigramIndex() : 0;
+
+    if (bucketIndex)
+    {
+        // Only the headwords of the plausible buckets are fetched
+        QVector<quint32> candidates = bucketIndex->candidates(searchBuffer, searchWordLength, d->maximumFuzzyDistance - 1);
+        found = scoreFuzzyCandidates(dictionary, candidates, searchBuffer, searchWordLength,
+                                     oFuzzystruct, resultListSize, maximumDistance);
+    }
+    else if (trigramIndex)
+    {
+        // Only the headwords sharing enough trigrams are fetched, the full
+        // scan is used until the index is built in the background
+        QVector<quint32> candidates = trigramIndex->similarCandidates(searchBuffer, searchWordLength,
+                                                                      d->minimumTrigramSimilarity / 100.0);
+        found = scoreFuzzyCandidates(dictionary, candidates, searchBuffer, searchWordLength,
+                                     oFuzzystruct, resultListSize, maximumDistance);
+    }
+    else if (d->fuzzyEngine == AUTOMATON)
+    {
+        // Walk the sorted headwords in step with the automaton of the search
+        // word, consuming only the characters after the prefix shared with
+        // the previous headword
+        LevenshteinAutomaton automaton(searchBuffer, searchWordLength, d->maximumFuzzyDistance);
+        int wordNumber = articleCount(iLib);
+        int index = 0;
+
+        while (index < wordNumber)
         {
-            if (iLib == iCurrentLib)
-                continue;
+            searchCheckWord = dictionary->utf8Key(index);
+            searchCheckWordLength = BitParallelEditDistance::foldUtf8(searchCheckWord.constData(), searchCheckWord.size(),
+                                                                      searchCheckBuffer, d->maximumWordLength);
 
-            if (iCurrent[iLib] > articleCount(iLib) || iCurrent[iLib] <= 0)
-                continue;
+            // The automaton still holds the state of the previous headword
+            int sharedLength = 0;
+            int depth = qMin<int>(automaton.depth(), searchCheckWordLength);
+            while (sharedLength < depth && automaton.character(sharedLength) == searchCheckBuffer[sharedLength])
+                ++sharedLength;
+
+            automaton.reset(sharedLength);
 
-            if (poCurrentWord == key(iCurrent[iLib] - 1, iLib))
+            bool rejected = false;
+            for (int j = sharedLength; j < searchCheckWordLength; ++j)
             {
-                iCurrent[iLib]--;
+                if (!automaton.step(searchCheckBuffer[j]))
+                {
+                    rejected = true;
+                    break;
+                }
             }
-            else
+
+            if (rejected)
             {
-                if (iCurrent[iLib] == articleCount(iLib))
-                    iCurrent[iLib] = invalidIndex;
+                // No headword starting with the rejected prefix can match,
+                // but only an ASCII prefix can be skipped at once
+                QByteArray rejectedPrefix;
+                for (int j = 0; j < automaton.depth() && searchCheckBuffer[j] < 0x80; ++j)
+                    rejectedPrefix.append(char(searchCheckBuffer[j]));
+
+                if (rejectedPrefix.size() == automaton.depth())
+                    index = skipAsciiPrefix(dictionary, index, wordNumber, rejectedPrefix);
+                else
+                    ++index;
+
+                continue;
             }
+
+            iDistance = automaton.distance();
+            if (iDistance < maximumDistance && iDistance < searchWordLength)
+            {
+                found = true;
+                insertFuzzyResult(oFuzzystruct, resultListSize, searchCheckWord, iDistance, maximumDistance);
+            }
+
+            ++index;
         }
     }
-    return poCurrentWord;
-}
+    else if (bkTree)
+    {
+        // Only the neighbourhood of the search word is visited in the tree.
+        // The distance of the tree is never greater than the one of the
+        // scan, so the radius of the scan finds all of its matches, and the
+        // matches are scored in index order, so the ties are resolved like
+        // in the full scan.
+        QList<QPair<int, int> > matches = bkTree->search(QString::fromUtf8(searchWord), d->maximumFuzzyDistance - 1);
+        qSort(matches);
 
-bool
-StarDictDictionaryManager::lookupPattern(QString searchWord, int dictionaryIndex,
-                                         QString suffix, int wordLength, int truncateLength,
-                                         QString addition, bool check)
-{
-        int searchWordLength = searchWord.length();
-        if (!d->found && searchWordLength > wordLength)
+        int wordNumber = articleCount(iLib);
+        for (QList<QPair<int, int> >::const_iterator it = matches.constBegin(); it != matches.constEnd(); ++it)
         {
-            QString caseString;
-            int index;
-            bool isUpperCase = searchWord.endsWith(suffix.toUpper());
-            if (isUpperCase || searchWord.endsWith(suffix.toLower()))
+            // The cache file may belong to another version of the index
+            if (it->first >= wordNumber)
+                continue;
+
+            searchCheckWord = dictionary->utf8Key(it->first);
+            searchCheckWordLength = BitParallelEditDistance::foldUtf8(searchCheckWord.constData(), searchCheckWord.size(),
+                                                                      searchCheckBuffer, d->maximumWordLength);
+
+            iDistance = BitParallelEditDistance::distance(searchCheckBuffer, searchCheckWordLength,
+                                                          searchBuffer, searchWordLength, maximumDistance);
+            if (iDistance < maximumDistance && iDistance < searchWordLength)
             {
-                QString searchNewWord = searchWord.left(searchWordLength - truncateLength);
-                int searchNewWordLength = searchNewWord.length();
-                if ( check && searchNewWordLength > 3 && (searchNewWord.at(searchNewWordLength - 1) == searchNewWord.at(searchNewWordLength - 2))
-                        && !isVowel(searchNewWord.at(searchNewWordLength - 2)) && isVowel(searchNewWord.at(searchNewWordLength - 3)))
-                {  //doubled
-                    searchNewWord.remove(searchNewWordLength - 1, 1);
-                    if ((index = d->dictionaryList.at(dictionaryIndex)->lookup(searchNewWord)) != -1)
-                    {
-                        d->found = true;
-                    }
-                    else
-                    {
-                        if (isUpperCase || searchWord.at(0).isUpper())
-                        {
-                            caseString = searchNewWord.toLower();
-                            if (caseString.compare(searchNewWord))
-                            {
-                                if ((index = d->dictionaryList.at(dictionaryIndex)->lookup(caseString)) != -1)
-                                    d->found = true;
-                            }
-                        }
-
-                        if (!d->found)
-                            searchNewWord.append(searchNewWord.at(searchNewWordLength - 1));  //restore
-                    }
-                }
+                found = true;
+                insertFuzzyResult(oFuzzystruct, resultListSize, searchCheckWord, iDistance, maximumDistance);
+            }
+        }
+    }
+    else
+    {
+        //there are Chinese dicts and English dicts...
+        int wordNumber = articleCount(iLib);
+        for (int index = 0; index < wordNumber; ++index)
+        {
+            searchCheckWord = dictionary->utf8Key(index);
+            searchCheckWordLength = BitParallelEditDistance::foldUtf8(searchCheckWord.constData(), searchCheckWord.size(),
+                                                                      searchCheckBuffer, d->maximumWordLength);
 
-                if (!d->found)
-                {
-                    if ((index = d->dictionaryList.at(dictionaryIndex)->lookup(searchNewWord)) != -1)
-                    {
-                        d->found = true;
-                    }
-                    else if (isUpperCase || searchWord.at(0).isUpper())
-                    {
-                        caseString = searchNewWord.toLower();
-                        if (caseString.compare(searchNewWord))
-                        {
-                            if ((index = d->dictionaryList.at(dictionaryIndex)->lookup(caseString)) != -1)
-                                d->found = true;
-                        }
-                    }
-                }
+            // skip too long or too short words
+            if (searchCheckWordLength - searchWordLength >= maximumDistance
+                    || searchWordLength - searchCheckWordLength >= maximumDistance)
+                continue;
 
-                if (!d->found && !addition.isNull())
-                {
-                    if (isUpperCase)
-                        searchNewWord.append(addition.toUpper());
-                    else
-                        searchNewWord.append(addition.toLower());
-
-                    if ((index = d->dictionaryList.at(dictionaryIndex)->lookup(searchNewWord)) != -1)
-                    {
-                        d->found = true;
-                    }
-                    else if (isUpperCase || searchWord.at(0).isUpper())
-                    {
-                        caseString = searchNewWord.toLower();
-                        if (caseString.compare(searchNewWord))
-                        {
-                            if ((index = d->dictionaryList.at(dictionaryIndex)->lookup(caseString)) != -1)
-                                d->found = true;
-                        }
-                    }
-                }
+            iDistance = BitParallelEditDistance::distance(searchCheckBuffer, searchCheckWordLength,
+                                                          searchBuffer, searchWordLength, maximumDistance);
+            if (iDistance < maximumDistance && iDistance < searchWordLength)
+            {
+                // when searchWordLength=1,2 we need less fuzzy.
+                found = true;
+                insertFuzzyResult(oFuzzystruct, resultListSize, searchCheckWord, iDistance, maximumDistance);
             }
         }
+    }
+
+    if (found) // sort with distance
+        qSort(oFuzzystruct, oFuzzystruct + resultListSize);
+
+    resultList.clear();
+    for (int i = 0; i < resultListSize; ++i)
+    {
+        if (!oFuzzystruct[i].pMatchWord.isNull())
+            resultList.append(QString::fromUtf8(oFuzzystruct[i].pMatchWord));
+    }
 
-        return d->found;
+    delete [] oFuzzystruct;
+
+    return found;
 }
 
-int
-StarDictDictionaryManager::lookupSimilarWord(QByteArray searchWord, int iLib)
+class FuzzyMatchLessThan
 {
-    int iIndex;
+    public:
+        bool operator()(const FuzzyMatch& left, const FuzzyMatch& right) const
+        {
+            if (left.distance != right.distance)
+                return left.distance < right.distance;
 
-    // Upper case lookup
-    iIndex = d->dictionaryList.at(iLib)->lookup(searchWord.toUpper());
+            return stardictStringCompare(left.word, right.word) < 0;
+        }
+};
 
-    // Lower case lookup
-    if (iIndex == -1)
-        iIndex = d->dictionaryList.at(iLib)->lookup(searchWord.toLower());
+bool
+StarDictDictionaryManager::lookupWithParallelFuzzy(const QByteArray& searchWord, QStringList& resultList, int resultListSize, int iLib)
+{
+    if (searchWord.isEmpty())
+        return false;
 
-    // Upper the first character and lower others
-    if (!iIndex == -1)
-        iIndex = d->dictionaryList.at(iLib)->lookup(QString(QString(searchWord)[0].toUpper()) + searchWord.mid(1).toLower());
+    quint32 searchBuffer[Private::maximumWordLength];
+    int searchWordLength = BitParallelEditDistance::foldUtf8(searchWord.constData(), searchWord.size(),
+                                                             searchBuffer, d->maximumWordLength);
 
-    if (isPureEnglish(searchWord))
-    {
-        QString caseString;
-        // If not Found, try other status of searchWord.
-        int searchWordLength = searchWord.size();
-        bool isUpperCase;
-        QByteArray searchNewWord;
+    if (d->progressFunction)
+        d->progressFunction();
 
-        lookupPattern(searchWord, iLib, "S", 1, 1, QString(), false);
-        lookupPattern(searchWord, iLib, "ED", 1, 1, QString(), false);
-        lookupPattern(searchWord, iLib, "LY", 2, 2, QString(), true);
-        lookupPattern(searchWord, iLib, "ING", 3, 3, "E", true);
+    Dictionary *dictionary = d->dictionaryList.at(iLib);
+    int wordNumber = articleCount(iLib);
 
+    // Small ranges are not worth a job of their own
+    int jobCount = qBound(1, wordNumber / d->minimumFuzzyRangeSize, d->threadPool.maxThreadCount());
 
-        if (iIndex == -1 && searchWordLength > 3)
-        {
-            isUpperCase = (searchWord.endsWith("ES") //krazy:exclude=strings
-                        && (searchWord.at(searchWordLength - 3) == 'S'
-                        || searchWord.at(searchWordLength - 3) == 'X'
-                        || searchWord.at(searchWordLength - 3) == 'O'
-                        || (searchWordLength > 4 && searchWord.at(searchWordLength - 3) == 'H'
-                        && (searchWord.at(searchWordLength - 4) == 'C'
-                        || searchWord.at(searchWordLength - 4) == 'S'))));
-
-            if (isUpperCase ||
-                    (searchWord.endsWith("es") //krazy:exclude=strings
-                     && (searchWord.at(searchWordLength - 3) == 's'
-                     || searchWord.at(searchWordLength - 3) == 'x'
-                     || searchWord.at(searchWordLength - 3) == 'o'
-                     || (searchWordLength > 4 && searchWord.at(searchWordLength - 3) == 'h'
-                     && (searchWord.at(searchWordLength - 4) == 'c'
-                     || searchWord.at(searchWordLength - 4) == 's')))))
-            {
-                searchNewWord = searchWord.left(searchWordLength - 2);
-                if ((iIndex = d->dictionaryList.at(iLib)->lookup(searchNewWord)) == -1
-                    && (isUpperCase || QString::fromUtf8(searchWord).at(0).isUpper()))
-                {
-                    caseString = searchNewWord.toLower();
-                    if (caseString.compare(searchNewWord))
-                    {
-                        iIndex = d->dictionaryList.at(iLib)->lookup(caseString);
-                    }
-                }
-            }
-        }
+    // The largest distance still accepted, lowered by the jobs as their
+    // heaps fill up
+    QAtomicInt cutoff(d->maximumFuzzyDistance - 1);
+    QSemaphore finished;
+    QList<FuzzySearchJob *> jobs;
 
-        lookupPattern(searchWord, iLib, "ED", 3, 2, QString(), true);
-        lookupPattern(searchWord, iLib, "IED", 3, 3, "Y", false);
-        lookupPattern(searchWord, iLib, "IES", 3, 3, "Y", false);
-        lookupPattern(searchWord, iLib, "ER", 2, 3, QString(), false);
-        lookupPattern(searchWord, iLib, "EST", 3, 3, QString(), false);
+    for (int i = 0; i < jobCount; ++i)
+    {
+        AbstractIndexFile *indexReader = dictionary->createIndexReader();
+        if (!indexReader)
+            break;
 
+        int first = qint64(wordNumber) * i / jobCount;
+        int last = qint64(wordNumber) * (i + 1) / jobCount;
+        FuzzySearchJob *job = new FuzzySearchJob(indexReader, searchBuffer, searchWordLength,
+                                                 first, last, resultListSize, &cutoff, &finished);
+        jobs.append(job);
+        d->threadPool.start(job);
     }
 
-#if 0
-    else
+    // Other queries may run jobs on the same pool, so only the jobs of this
+    // search are waited for
+    finished.acquire(jobs.size());
+
+    QVector<FuzzyMatch> matches;
+    foreach (FuzzySearchJob *job, jobs)
+        matches += job->matches();
+
+    qDeleteAll(jobs);
+
+    if (jobs.size() < jobCount)
     {
-        //don't change iWordIndex here.
-        //when LookupSimilarWord all failed too, we want to use the old LookupWord index to list words.
-        //iWordIndex = invalidIndex;
+        qDebug() << "Failed to create the index readers for the fuzzy search";
+        return false;
     }
-#endif
-    return iIndex;
-}
 
-int
-StarDictDictionaryManager::simpleLookupWord(QByteArray searchWord, int iLib)
-{
-    int retval;
+    // Merge the heaps in the order of the sequential scan, dropping the
+    // headwords found by more than one job
+    qSort(matches);
 
-    if ((retval = d->dictionaryList.at(iLib)->lookup(searchWord)) == -1) {
-        retval = lookupSimilarWord(searchWord, iLib);
-    }
+    QVector<FuzzyMatch> bestMatches;
+    QSet<QByteArray> words;
+    foreach (const FuzzyMatch& match, matches)
+    {
+        if (bestMatches.size() == resultListSize)
+            break;
 
-    return retval;
-}
+        if (words.contains(match.word))
+            continue;
 
-struct
-Fuzzystruct
-{
-    QByteArray pMatchWord;
-    int matchWordDistance;
-};
+        words.insert(match.word);
+        bestMatches.append(match);
+    }
 
-inline bool
-operator<(const Fuzzystruct & lh, const Fuzzystruct & rh)
-{
-    if (lh.matchWordDistance != rh.matchWordDistance)
-        return lh.matchWordDistance < rh.matchWordDistance;
+    qSort(bestMatches.begin(), bestMatches.end(), FuzzyMatchLessThan());
 
-    if (!lh.pMatchWord.isNull() && !rh.pMatchWord.isNull())
-        return stardictStringCompare(lh.pMatchWord, rh.pMatchWord) < 0;
+    resultList.clear();
+    foreach (const FuzzyMatch& match, bestMatches)
+        resultList.append(QString::fromUtf8(match.word));
 
-    return false;
+    return !resultList.isEmpty();
 }
 
 bool
-StarDictDictionaryManager::lookupWithFuzzy(QByteArray searchWord, QStringList resultList, int resultListSize, int iLib)
+StarDictDictionaryManager::lookupWithSymmetricDeleteIndex(const QByteArray& searchWord, QStringList& resultList, int resultListSize, int iLib)
 {
-    if (searchWord.isEmpty())
+    Dictionary *dictionary = d->dictionaryList.at(iLib);
+    const SymmetricDeleteIndex *symmetricDeleteIndex = dictionary->symmetricDeleteIndex();
+    if (!symmetricDeleteIndex)
         return false;
 
+    resultList.clear();
+    if (searchWord.isEmpty())
+        return true;
+
     Fuzzystruct *oFuzzystruct = new Fuzzystruct[resultListSize];
 
     for (int i = 0; i < resultListSize; ++i)
@@ -603,88 +925,67 @@ StarDictDictionaryManager::lookupWithFuzzy(QByteArray searchWord, QStringList re
     }
 
     int maximumDistance = d->maximumFuzzyDistance;
-    int iDistance;
     bool found = false;
-    EditDistance oEditDistance;
 
-    long searchCheckWordLength;
-    long searchWordLength;
-    QString searchCheckWord;
-
-    searchWord.toLower();
+    quint32 searchBuffer[Private::maximumWordLength];
+    int searchWordLength = BitParallelEditDistance::foldUtf8(searchWord.constData(), searchWord.size(),
+                                                             searchBuffer, d->maximumWordLength);
 
-    if (d->progressFunction)
-        d->progressFunction();
+    found = scoreFuzzyCandidates(dictionary, symmetricDeleteIndex->candidates(searchBuffer, searchWordLength),
+                                 searchBuffer, searchWordLength, oFuzzystruct, resultListSize, maximumDistance);
 
+    if (found) // sort with distance
+        qSort(oFuzzystruct, oFuzzystruct + resultListSize);
 
-    //if (stardict_strcmp(searchWord, poGetWord(0,iLib))>=0 && stardict_strcmp(searchWord, poGetWord(articleCount(iLib)-1,iLib))<=0) {
-    //there are Chinese dicts and English dicts...
-    if (true)
+    for (int i = 0; i < resultListSize; ++i)
     {
-        int wordNumber = articleCount(iLib);
-        for (int index = 0; index < wordNumber; ++index)
-        {
-            searchCheckWord = key(index, iLib);
-            // tolower and skip too long or too short words
-            searchCheckWordLength = searchCheckWord.length();
-            searchWordLength = searchWord.length();
-            if (searchCheckWordLength - searchWordLength >= maximumDistance
-                    || searchWordLength - searchCheckWordLength >= maximumDistance)
-                continue;
+        if (!oFuzzystruct[i].pMatchWord.isNull())
+            resultList.append(QString::fromUtf8(oFuzzystruct[i].pMatchWord));
+    }
 
-            searchCheckWord.toLower();
+    delete [] oFuzzystruct;
 
-            iDistance = oEditDistance.calEditDistance(searchCheckWord, searchWord, maximumDistance);
-            if (iDistance < maximumDistance && iDistance < searchWordLength)
-            {
-                // when searchWordLength=1,2 we need less fuzzy.
-                found = true;
-                bool isAlreadyInList = false;
-                int maximumDistanceAt = 0;
-                for (int j = 0; j < resultListSize; ++j)
-                {
-                    if (!oFuzzystruct[j].pMatchWord.isNull() && searchCheckWord.compare(oFuzzystruct[j].pMatchWord) == 0)
-                    { //already in list
-                        isAlreadyInList = true;
-                        break;
-                    }
-
-                    //find the position,it will certainly be found (include the first time) as iMaxDistance is set by last time.
-                    if (oFuzzystruct[j].matchWordDistance == maximumDistance )
-                    {
-                        maximumDistanceAt = j;
-                    }
-                }
+    return true;
+}
 
-                if (!isAlreadyInList)
-                {
-                    oFuzzystruct[maximumDistanceAt].pMatchWord = searchCheckWord.toUtf8();
-                    oFuzzystruct[maximumDistanceAt].matchWordDistance = iDistance;
-                    // calc new iMaxDistance
-                    maximumDistance = iDistance;
-                    int tmpVal = maximumDistance; //stupid workaround for gcc bug 44545
-                    for (int j = 0; j < resultListSize; ++j)
-                    {
-                        if (oFuzzystruct[j].matchWordDistance > maximumDistance)
-                            tmpVal = oFuzzystruct[j].matchWordDistance;
-                    } // calc new iMaxDistance
-
-                    maximumDistance = tmpVal; // end of stupid workaround
-                }   // add to list
-            }   // find one
-        }   // each word
-    }   // ok for search
-//    }   // each lib
+bool
+StarDictDictionaryManager::lookupWithPhoneticIndex(const QByteArray& searchWord, QStringList& resultList, int resultListSize, int iLib)
+{
+    Dictionary *dictionary = d->dictionaryList.at(iLib);
+    const PhoneticIndex *phoneticIndex = dictionary->phoneticIndex();
+    if (!phoneticIndex)
+        return false;
 
-    if (found) // sort with distance
-        qSort(oFuzzystruct, oFuzzystruct + resultListSize);
+    resultList.clear();
+    if (searchWord.isEmpty())
+        return true;
 
-    for (int i = 0; i < resultListSize; ++i)
-        resultList[i] = oFuzzystruct[i].pMatchWord;
+    quint32 searchBuffer[Private::maximumWordLength];
+    quint32 checkBuffer[Private::maximumWordLength];
+    int searchWordLength = BitParallelEditDistance::foldUtf8(searchWord.constData(), searchWord.size(),
+                                                             searchBuffer, d->maximumWordLength);
 
-    delete [] oFuzzystruct;
+    QVector<FuzzyMatch> matches;
+    foreach (quint32 index, phoneticIndex->candidates(searchBuffer, searchWordLength))
+    {
+        FuzzyMatch match;
+        match.index = index;
+        match.word = dictionary->utf8Key(index);
+
+        int checkWordLength = BitParallelEditDistance::foldUtf8(match.word.constData(), match.word.size(),
+                                                                checkBuffer, d->maximumWordLength);
+        match.distance = BitParallelEditDistance::distance(checkBuffer, checkWordLength,
+                                                           searchBuffer, searchWordLength, INT_MAX);
+        matches.append(match);
+    }
 
-    return found;
+    int count = qMin(resultListSize, matches.size());
+    std::partial_sort(matches.begin(), matches.begin() + count, matches.end());
+
+    for (int i = 0; i < count; ++i)
+        resultList.append(QString::fromUtf8(matches.at(i).word));
+
+    return true;
 }
 
 inline bool
@@ -729,7 +1030,7 @@ StarDictDictionaryManager::lookupPattern(QByteArray patternWord, QStringList pat
 }
 
 bool
-StarDictDictionaryManager::lookupData(QByteArray search_word, QStringList resultList)
+StarDictDictionaryManager::lookupData(const QByteArray& search_word, QVector<QStringList>& resultList)
 {
     QStringList searchWords;
     QString searchWord;
@@ -778,35 +1079,77 @@ StarDictDictionaryManager::lookupData(QByteArray search_word, QStringList result
     if (searchWords.isEmpty())
         return false;
 
-    quint32 maximumSize = 0;
+    // Partition the word entries of every dictionary along the chunk
+    // boundaries of the data file, so that the jobs rarely inflate the same
+    // chunk, and search the partitions concurrently.
+    QList<QList<DataSearchJob *> > dictionaryJobs;
+    int jobCount = qMax(1, d->threadPool.maxThreadCount());
+    int startedJobCount = 0;
+    QSemaphore finished;
+
     for (QVector<Dictionary *>::size_type i = 0; i < d->dictionaryList.size(); ++i)
     {
-        if (!d->dictionaryList.at(i)->containFindData())
-            continue;
+        QList<DataSearchJob *> jobs;
+        Dictionary *dictionary = d->dictionaryList.at(i);
 
-        if (d->progressFunction)
-            d->progressFunction();
-
-        int wordSize = articleCount(i);
-        for (int j = 0; j < wordSize; ++j)
+        if (dictionary->containFindData() && dictionary->open())
         {
-            WordEntry wordEntry = d->dictionaryList.at(i)->wordEntry(j);
-            if (wordEntry.dataSize() > maximumSize)
+            if (d->progressFunction)
+                d->progressFunction();
+
+            for (int j = 0; j < jobCount; ++j)
+                jobs.append(new DataSearchJob(dictionary, searchWords, &finished));
+
+            // The index file is not reentrant, so the entries are fetched here
+            int wordSize = articleCount(i);
+            DictionaryZip *dictionaryZip = dictionary->compressedDictionaryFile();
+            int chunkCount = dictionaryZip ? dictionaryZip->chunkCount() : 0;
+
+            for (int j = 0; j < wordSize; ++j)
             {
-                maximumSize = wordEntry.dataSize();
+                WordEntry wordEntry = dictionary->wordEntry(j);
+
+                int jobIndex;
+                if (chunkCount > 0)
+                    jobIndex = qint64(wordEntry.dataOffset() / dictionaryZip->chunkLength()) * jobCount / chunkCount;
+                else
+                    jobIndex = qint64(j) * jobCount / wordSize;
+
+                jobs.at(qBound(0, jobIndex, jobCount - 1))->addWordEntry(j, wordEntry);
             }
 
-            if (d->dictionaryList.at(i)->findData(searchWords, wordEntry.dataOffset(), wordEntry.dataSize()))
-                resultList[i].append(wordEntry.data());
+            foreach (DataSearchJob *job, jobs)
+                d->threadPool.start(job);
+
+            startedJobCount += jobs.size();
         }
+
+        dictionaryJobs.append(jobs);
     }
 
-    QVector<Dictionary *>::size_type i;
-    for (i = 0; i < d->dictionaryList.size(); ++i)
-        if (!resultList[i].isEmpty())
-            break;
+    finished.acquire(startedJobCount);
 
-    return i != d->dictionaryList.size();
+    // Merge the matches of the partitions in index order
+    bool found = false;
+    resultList.resize(d->dictionaryList.size());
+
+    for (int i = 0; i < dictionaryJobs.size(); ++i)
+    {
+        QVector<long> matchedIndexes;
+        foreach (DataSearchJob *job, dictionaryJobs.at(i))
+            matchedIndexes += job->matchedIndexes();
+
+        qDeleteAll(dictionaryJobs.at(i));
+
+        qSort(matchedIndexes);
+        foreach (long index, matchedIndexes)
+            resultList[i].append(d->dictionaryList.at(i)->key(index));
+
+        if (!matchedIndexes.isEmpty())
+            found = true;
+    }
+
+    return found;
 }
 
 StarDictDictionaryManager::QueryType
@@ -23,10 +23,13 @@
 #include "dictionaryzip.h"
 
 #include <QtCore/QStringList>
+#include <QtCore/QVector>
 
 namespace MulaPluginStarDict
 {
     class Dictionary;
+    class DictionaryCatalog;
+    class MergedWordCursor;
     class StarDictDictionaryManager
     {
         public:
@@ -37,6 +40,15 @@ namespace MulaPluginStarDict
                 DATA,
             };
 
+            enum FuzzyEngine {
+                FULLSCAN,       // Computes the distance against every headword
+                BKTREE,         // Searches the cached BK-tree of the headwords
+                AUTOMATON,      // Walks the sorted headwords with a Levenshtein automaton
+                PARALLELSCAN,   // Computes the distance against every headword on the thread pool
+                BUCKETSCAN,     // Computes the distance against the headwords of the plausible length and letter buckets
+                TRIGRAM,        // Computes the distance against the headwords sharing enough trigrams
+            };
+
             typedef void (*progress_func_t)(void);
 
             /**
@@ -62,10 +74,73 @@ namespace MulaPluginStarDict
 
             bool loadDictionary(const QString& ifoFilePath);
 
+            /**
+             * Unloads the dictionary according to the ifo file path
+             *
+             * @param ifoFilePath The path of the relevant ifo file
+             *
+             * @return True if the dictionary was loaded, otherwise false.
+             *
+             * @see loadDictionary, reloadDictionary
+             */
+
+            bool unloadDictionary(const QString& ifoFilePath);
+
+            /**
+             * Loads the dictionary again according to the ifo file path, and
+             * puts it in the place of the loaded one in the dictionary list
+             *
+             * @param ifoFilePath The path of the relevant ifo file
+             *
+             * @return True if the dictionary was loaded and the reloading was
+             * successful, otherwise false. The dictionary is unloaded if the
+             * reloading fails.
+             *
+             * @see loadDictionary, unloadDictionary
+             */
+
+            bool reloadDictionary(const QString& ifoFilePath);
+
+            /**
+             * Sets the catalog listing the ".ifo" files of the directories
+             * instead of walking them on loading. The directories not in the
+             * catalog are still walked.
+             *
+             * @param catalog The catalog, the manager does not take its
+             * ownership
+             *
+             * @see load, reload
+             */
+
+            void setCatalog(const DictionaryCatalog *catalog);
+
+            /**
+             * Loads the dictionaries of the order list, then the ones found
+             * in the directories, except the disabled ones. The dictionaries
+             * are loaded concurrently, but they are listed in this order.
+             *
+             * @param dictionaryDirs    The directories to search recursively
+             * @param orderList         The ".ifo" files to load first
+             * @param disableList       The ".ifo" files not to load
+             *
+             * @see reload, loadDictionary
+             */
+
             void load(const QStringList& dictionaryDirs,
                       const QStringList& orderList,
                       const QStringList& disableList);
 
+            /**
+             * Reloads the dictionaries the same way as load() does, but keeps
+             * the dictionaries loaded already, and only loads the new ones.
+             *
+             * @param dictionaryDirs    The directories to search recursively
+             * @param orderList         The ".ifo" files to load first
+             * @param disableList       The ".ifo" files not to load
+             *
+             * @see load
+             */
+
             void reload(const QStringList& dictionaryDirs,
                         const QStringList& orderList,
                         const QStringList& disableList);
@@ -111,51 +186,237 @@ namespace MulaPluginStarDict
 
             /**
              * Returns the word data from the desired dictionary according to
-             * the proper entry index. Index must be a valid index position,
-             * i.e. between 0 and dictionaryCount()-1.
+             * the proper entry index. The dictionary index must be between 0
+             * and dictionaryCount()-1, and the key index between 0 and
+             * articleCount()-1 of that dictionary.
              *
              * @param   keyIndex        The index of the desired word
              * @param   dictionaryIndex The index of the desired dictionary
              *
              * @return  The word data
              *
-             * @see data, poCurrentWord, poNextWord, poPreviousWord
+             * @see data, createWordCursor
              */
 
             QByteArray key(long keyIndex, int dictionaryIndex) const;
 
             /**
              * Returns the desired word data of the relevant dictionary
-             * according to the given index. Index must be a valid index
-             * position, i.e. between 0 and dictionaryCount()-1.
+             * according to the given index. The dictionary index must be
+             * between 0 and dictionaryCount()-1, and the data index between 0
+             * and articleCount()-1 of that dictionary.
              *
              * @param   dataIndex       The index of the desired word data
              * @param   dictionaryIndex The index of the desired dictionary
              *
              * @return The word data
              *
-             * @see key, poCurrentWord, poNextWord, poPreviousWord
+             * @see key, createWordCursor
              */
 
             QString data(long dataIndex, int dictionaryIndex);
 
-            QByteArray poCurrentWord(int *iCurrent);
-            QByteArray poNextWord(QByteArray searchWord, int* iCurrent);
-            QByteArray poPreviousWord(long *iCurrent);
+            /**
+             * Creates a cursor that iterates the headwords of all the loaded
+             * dictionaries as one sorted list without duplicates
+             *
+             * \note The cursor must not be used after the dictionary list has
+             * changed.
+             *
+             * @return The cursor on the first headword, the caller takes its
+             * ownership
+             *
+             * @see key, lookupWord
+             */
+
+            MergedWordCursor* createWordCursor() const;
+
 
-            bool lookupPattern(QString searchWord, int dictionaryIndex, QString suffix, int wordLength, int truncateLength, QString addition, bool check);
             int lookupWord(int dictionaryIndex, const QString& searchWord);
 
             Dictionary *reloaderFind(const QString& url);
-            void reloaderHelper(const QString &absolutePath);
-            template <typename Method> void recursiveTemplateHelper(const QString& directoryName, const QStringList& orderList, const QStringList& disableList, Method method);
+            void collectIfoFilePaths(const QString& directoryName, const QStringList& orderList, const QStringList& disableList, QStringList& ifoFilePaths) const;
+            QStringList ifoFilePaths(const QStringList& dictionaryDirectoryList, const QStringList& orderList, const QStringList& disableList) const;
+
+            /**
+             * Loads the dictionaries concurrently on the thread pool
+             *
+             * @param ifoFilePaths  The paths of the ".ifo" files
+             *
+             * @return The dictionaries in the order of the paths, NULL for the
+             * ones that could not be loaded
+             */
+
+            QList<Dictionary *> loadDictionaries(const QStringList& ifoFilePaths);
 
             int lookupSimilarWord(QByteArray searchWord, int iLib);
             int simpleLookupWord(QByteArray searchWord, int iLib);
 
-            bool lookupWithFuzzy(QByteArray searchWord, QStringList resultList, int resultListSize, int iLib);
+            /**
+             * Looks up the words in the dictionary the same way as
+             * simpleLookupWord() does, but the distinct words are resolved
+             * together in one pass over the sorted index.
+             *
+             * @param words             The words to look up
+             * @param dictionaryIndex   The index of the dictionary in the list
+             *
+             * @return The indices of the words in the order of the given
+             * words, -1 for the words that are not found
+             *
+             * @see simpleLookupWord, dataList
+             */
+
+            QVector<int> lookupWords(const QStringList& words, int dictionaryIndex);
+
+            /**
+             * Returns the word data of the indices, read in the order of the
+             * data file
+             *
+             * @param indices           The indices of the desired words
+             * @param dictionaryIndex   The index of the dictionary in the list
+             *
+             * @return The word data in the order of the given indices
+             *
+             * @see data, lookupWords
+             */
+
+            QVector<QByteArray> dataList(const QVector<int>& indices, int dictionaryIndex);
+
+            /**
+             * Sets whether the dictionaries loaded afterwards only read their
+             * ".ifo" file, and open the data and the index files on their
+             * first use. The default is opening them on loading.
+             *
+             * @param lazyOpening Whether to open the dictionaries lazily
+             *
+             * @see lazyOpening, closeIdleDictionaries
+             */
+
+            void setLazyOpening(bool lazyOpening);
+
+            /**
+             * Returns whether the dictionaries are opened lazily
+             *
+             * @return True if the dictionaries are opened on their first use,
+             * otherwise false.
+             *
+             * @see setLazyOpening
+             */
+
+            bool lazyOpening() const;
+
+            /**
+             * Closes the dictionaries that have not been used since the
+             * previous call of this method. They are opened again on their
+             * next use.
+             *
+             * \note The method must not be called concurrently with the
+             * queries.
+             *
+             * @see Dictionary::closeIfIdle
+             */
+
+            void closeIdleDictionaries();
+
+            /**
+             * Sets the engine used for fuzzy searching. The default is the
+             * full scan of the headwords.
+             *
+             * @param fuzzyEngine The desired fuzzy search engine
+             *
+             * @see fuzzyEngine, lookupWithFuzzy
+             */
+
+            void setFuzzyEngine(FuzzyEngine fuzzyEngine);
+
+            /**
+             * Returns the engine used for fuzzy searching
+             *
+             * @return The fuzzy search engine
+             *
+             * @see setFuzzyEngine, lookupWithFuzzy
+             */
+
+            FuzzyEngine fuzzyEngine() const;
+
+            bool lookupWithFuzzy(const QByteArray& searchWord, QStringList& resultList, int resultListSize, int iLib);
+
+            /**
+             * Looks up the similar words of the search word by splitting the
+             * headwords into ranges that are scanned concurrently on the
+             * thread pool. The results are the same as the ones of the full
+             * scan.
+             *
+             * @param searchWord        The UTF-8 encoded search word
+             * @param resultList        The similar words ordered by distance
+             * @param resultListSize    The maximum number of similar words
+             * @param iLib              The index of the dictionary
+             *
+             * @return True if any similar word was found, otherwise false.
+             *
+             * @see lookupWithFuzzy, FuzzySearchJob
+             */
+
+            bool lookupWithParallelFuzzy(const QByteArray& searchWord, QStringList& resultList, int resultListSize, int iLib);
+
+            /**
+             * Looks up the similar words of the search word with the symmetric
+             * delete index of the dictionary. The results are the same as the
+             * ones of lookupWithFuzzy, but only the candidates sharing a delete
+             * variant with the search word are checked.
+             *
+             * @param searchWord        The UTF-8 encoded search word
+             * @param resultList        The similar words ordered by distance
+             * @param resultListSize    The maximum number of similar words
+             * @param iLib              The index of the dictionary
+             *
+             * @return True if the index of the dictionary is available and
+             * the result list is valid, otherwise false, e.g. if the index is
+             * still being built.
+             *
+             * @see lookupWithFuzzy
+             */
+
+            bool lookupWithSymmetricDeleteIndex(const QByteArray& searchWord, QStringList& resultList, int resultListSize, int iLib);
+
+            /**
+             * Looks up the headwords that sound like the search word with the
+             * phonetic index of the dictionary. The headwords sharing a
+             * phonetic key with the search word are ordered by their edit
+             * distance, but they are not limited by the maximum fuzzy
+             * distance.
+             *
+             * @param searchWord        The UTF-8 encoded search word
+             * @param resultList        The sound-alike words ordered by distance
+             * @param resultListSize    The maximum number of sound-alike words
+             * @param iLib              The index of the dictionary
+             *
+             * @return True if the index of the dictionary is available and
+             * the result list is valid, otherwise false.
+             *
+             * @see lookupWithSymmetricDeleteIndex
+             */
+
+            bool lookupWithPhoneticIndex(const QByteArray& searchWord, QStringList& resultList, int resultListSize, int iLib);
             int lookupPattern(QByteArray searchWord, QStringList resultList);
-            bool lookupData(QByteArray searchWord, QStringList resultList);
+
+            /**
+             * Looks up the desired words in the word data of all the
+             * dictionaries. The data search is partitioned per dictionary and
+             * the partitions are processed concurrently on a thread pool.
+             *
+             * The result holds the headwords of the matched word entries and
+             * not their word data, which can be fetched with data() if needed.
+             *
+             * @param searchWord    The space separated words that all need to
+             * be contained by the word data
+             * @param resultList    The matched headwords for each dictionary in
+             * index order
+             *
+             * @return True if any match was found, otherwise false.
+             */
+
+            bool lookupData(const QByteArray& searchWord, QVector<QStringList>& resultList);
 
             QueryType analyzeQuery(QString string, QString& result);
 
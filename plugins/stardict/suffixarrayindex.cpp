@@ -0,0 +1,388 @@
+/******************************************************************************
+ * This file is part of the Mula project
+ * Copyright (c) 2011 Laszlo Papp <lpapp@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "suffixarrayindex.h"
+
+#include "cachelocations.h"
+#include "indexfilescanner.h"
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QSaveFile>
+#include <QtCore/QString>
+#include <QtCore/QtAlgorithms>
+#include <QtCore/QDebug>
+
+#include <algorithm>
+
+#include <string.h>
+
+using namespace MulaPluginStarDict;
+
+// Returns the length of the suffix at the position up to and including the
+// separator after its headword
+static inline int
+suffixLength(const char *blob, int blobSize, int position)
+{
+    const void *separator = memchr(blob + position + 1, '\0', blobSize - position - 1);
+    return separator ? static_cast<const char*>(separator) - (blob + position) + 1 : blobSize - position;
+}
+
+// Compares the beginning of the suffix at the position with the substring,
+// returns zero if the suffix starts with the substring
+static inline int
+compareSuffix(const char *blob, int blobSize, int position, const QByteArray& substring)
+{
+    int length = suffixLength(blob, blobSize, position);
+    int result = memcmp(blob + position, substring.constData(), qMin(length, substring.size()));
+    if (result != 0)
+        return result;
+
+    return length < substring.size() ? -1 : 0;
+}
+
+class SuffixLessThan
+{
+    public:
+        SuffixLessThan(const char *blob, int blobSize)
+            : m_blob(blob)
+            , m_blobSize(blobSize)
+        {
+        }
+
+        bool operator()(quint32 left, quint32 right) const
+        {
+            int leftLength = suffixLength(m_blob, m_blobSize, left);
+            int rightLength = suffixLength(m_blob, m_blobSize, right);
+            int result = memcmp(m_blob + left, m_blob + right, qMin(leftLength, rightLength));
+
+            return result != 0 ? result < 0 : leftLength < rightLength;
+        }
+
+    private:
+        const char *m_blob;
+        int m_blobSize;
+};
+
+class SuffixArrayIndex::Private
+{
+    public:
+        Private()
+            : cacheMagicString("StarDict's Suffix Array, Version: 0.1")
+            , mappedData(0)
+            , headwordCount(0)
+            , blobSize(0)
+            , offsets(0)
+            , suffixes(0)
+            , blob(0)
+        {
+        }
+
+        ~Private()
+        {
+        }
+
+        void unload();
+
+        QByteArray cacheMagicString;
+        QFile mapFile;
+        uchar *mappedData;
+        quint32 headwordCount;
+        quint32 blobSize;
+        const quint32 *offsets;
+        const quint32 *suffixes;
+        const char *blob;
+};
+
+void
+SuffixArrayIndex::Private::unload()
+{
+    if (mappedData)
+        mapFile.unmap(mappedData);
+
+    mapFile.close();
+    mappedData = 0;
+    headwordCount = 0;
+    blobSize = 0;
+    offsets = 0;
+    suffixes = 0;
+    blob = 0;
+}
+
+SuffixArrayIndex::SuffixArrayIndex()
+    : d(new Private)
+{
+}
+
+SuffixArrayIndex::~SuffixArrayIndex()
+{
+    d->unload();
+    delete d;
+}
+
+bool
+SuffixArrayIndex::isLoaded() const
+{
+    return d->blob != 0;
+}
+
+qint64
+SuffixArrayIndex::fileSize() const
+{
+    return isLoaded() ? d->mapFile.size() : 0;
+}
+
+bool
+SuffixArrayIndex::load(const QString& indexFilePath)
+{
+    const int headerSize = d->cacheMagicString.size() + 2 * sizeof(quint32);
+
+    foreach (const QString& cacheLocation, cacheLocations(indexFilePath, ".sfx"))
+    {
+        QFileInfo fileInfoIndex(indexFilePath);
+        QFileInfo fileInfoCache(cacheLocation);
+
+        if (!fileInfoCache.exists() || fileInfoCache.lastModified() < fileInfoIndex.lastModified())
+            continue;
+
+        d->unload();
+
+        d->mapFile.setFileName(cacheLocation);
+        if (!d->mapFile.open(QIODevice::ReadOnly))
+        {
+            qDebug() << "Failed to open file:" << cacheLocation;
+            continue;
+        }
+
+        if (d->mapFile.size() < headerSize)
+            continue;
+
+        d->mappedData = d->mapFile.map(0, d->mapFile.size());
+        if (d->mappedData == NULL)
+        {
+            qDebug() << Q_FUNC_INFO << QString("Mapping the file %1 failed!").arg(cacheLocation);
+            continue;
+        }
+
+        if (d->cacheMagicString != QByteArray::fromRawData(reinterpret_cast<const char*>(d->mappedData), d->cacheMagicString.size()))
+            continue;
+
+        const quint32 *counts = reinterpret_cast<const quint32*>(d->mappedData + d->cacheMagicString.size());
+        quint32 headwordCount = counts[0];
+        quint32 blobSize = counts[1];
+
+        if (headwordCount == 0
+            || d->mapFile.size() != headerSize + (qint64(headwordCount) + blobSize) * sizeof(quint32) + blobSize)
+            continue;
+
+        d->headwordCount = headwordCount;
+        d->blobSize = blobSize;
+        d->offsets = counts + 2;
+        d->suffixes = d->offsets + headwordCount;
+        d->blob = reinterpret_cast<const char*>(d->suffixes + blobSize);
+
+        return true;
+    }
+
+    d->unload();
+    return false;
+}
+
+bool
+SuffixArrayIndex::build(const QString& indexFilePath)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    IndexFileScanner scanner;
+    if (!scanner.open(indexFilePath))
+        return false;
+
+    QByteArray blob;
+    QVector<quint32> offsets;
+
+    while (scanner.next())
+    {
+        offsets.append(blob.size());
+        blob.append('\0');
+        blob.append(QString::fromUtf8(scanner.word()).toLower().toUtf8());
+    }
+
+    if (offsets.isEmpty())
+        return false;
+
+    blob.append('\0');
+
+    QVector<quint32> suffixes(blob.size());
+    for (int i = 0; i < suffixes.size(); ++i)
+        suffixes[i] = i;
+
+    std::sort(suffixes.begin(), suffixes.end(), SuffixLessThan(blob.constData(), blob.size()));
+
+    foreach (const QString& cacheLocation, cacheLocations(indexFilePath, ".sfx"))
+    {
+        QSaveFile file(cacheLocation);
+        if (!file.open(QIODevice::WriteOnly))
+        {
+            qDebug() << "Failed to open file for writing:" << cacheLocation;
+            continue;
+        }
+
+        quint32 counts[2] = { quint32(offsets.size()), quint32(blob.size()) };
+        qint64 offsetsSize = offsets.size() * sizeof(quint32);
+        qint64 suffixesSize = suffixes.size() * sizeof(quint32);
+
+        if (file.write(d->cacheMagicString) != d->cacheMagicString.size()
+            || file.write(reinterpret_cast<const char*>(counts), sizeof(counts)) != sizeof(counts)
+            || file.write(reinterpret_cast<const char*>(offsets.constData()), offsetsSize) != offsetsSize
+            || file.write(reinterpret_cast<const char*>(suffixes.constData()), suffixesSize) != suffixesSize
+            || file.write(blob) != blob.size()
+            || !file.commit())
+        {
+            continue;
+        }
+
+        qDebug() << "Save to cache" << cacheLocation;
+
+        if (!load(indexFilePath))
+            break;
+
+        qDebug() << "Built the suffix array for" << indexFilePath << "in" << timer.elapsed() << "ms,"
+                 << fileSize() << "bytes";
+
+        return true;
+    }
+
+    qDebug() << "Failed to build the suffix array for" << indexFilePath;
+    return false;
+}
+
+void
+SuffixArrayIndex::find(const QByteArray& substring, bool start, bool end, QVector<quint32>& ids) const
+{
+    ids.clear();
+    if (!isLoaded() || substring.isEmpty())
+        return;
+
+    // The separators around the headwords anchor the substring
+    QByteArray key;
+    if (start)
+        key.append('\0');
+
+    key.append(substring);
+
+    if (end)
+        key.append('\0');
+
+    // The first suffix starting with the key
+    int first = 0;
+    int count = d->blobSize;
+    while (count > 0)
+    {
+        int step = count / 2;
+        if (compareSuffix(d->blob, d->blobSize, d->suffixes[first + step], key) < 0)
+        {
+            first += step + 1;
+            count -= step + 1;
+        }
+        else
+        {
+            count = step;
+        }
+    }
+
+    // The first suffix after the ones starting with the key
+    int last = first;
+    count = d->blobSize - first;
+    while (count > 0)
+    {
+        int step = count / 2;
+        if (compareSuffix(d->blob, d->blobSize, d->suffixes[last + step], key) == 0)
+        {
+            last += step + 1;
+            count -= step + 1;
+        }
+        else
+        {
+            count = step;
+        }
+    }
+
+    ids.reserve(last - first);
+    for (int i = first; i < last; ++i)
+    {
+        // The headword whose separator is the last one not after the suffix
+        const quint32 *offset = qUpperBound(d->offsets, d->offsets + d->headwordCount, d->suffixes[i]);
+        ids.append(offset - d->offsets - 1);
+    }
+
+    // A headword can contain the substring several times
+    qSort(ids);
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+}
+
+bool
+SuffixArrayIndex::patternCandidates(const QString& pattern, QVector<quint32>& ids) const
+{
+    ids.clear();
+    if (!isLoaded())
+        return false;
+
+    // Find the most selective literal part between the wildcards, the
+    // anchored ones are preferred among the parts of the same length
+    QByteArray bestSubstring;
+    bool bestStart = false;
+    bool bestEnd = false;
+    int bestLength = 0;
+
+    int segmentStart = 0;
+    for (int i = 0; i <= pattern.size(); ++i)
+    {
+        if (i < pattern.size() && pattern.at(i) != '*' && pattern.at(i) != '?' && pattern.at(i) != '[')
+            continue;
+
+        QByteArray substring = pattern.mid(segmentStart, i - segmentStart).toLower().toUtf8();
+        bool start = segmentStart == 0;
+        bool end = i == pattern.size();
+
+        int length = substring.size() * 2 + (start ? 1 : 0) + (end ? 1 : 0);
+        if (!substring.isEmpty() && length > bestLength)
+        {
+            bestSubstring = substring;
+            bestStart = start;
+            bestEnd = end;
+            bestLength = length;
+        }
+
+        if (i < pattern.size() && pattern.at(i) == '[')
+        {
+            while (i < pattern.size() && pattern.at(i) != ']')
+                ++i;
+        }
+
+        segmentStart = i + 1;
+    }
+
+    if (bestSubstring.isEmpty())
+        return false;
+
+    find(bestSubstring, bestStart, bestEnd, ids);
+    return true;
+}
@@ -0,0 +1,151 @@
+/******************************************************************************
+ * This file is part of the Mula project
+ * Copyright (c) 2011 Laszlo Papp <lpapp@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef MULA_PLUGIN_STARDICT_SUFFIXARRAYINDEX_H
+#define MULA_PLUGIN_STARDICT_SUFFIXARRAYINDEX_H
+
+#include <QtCore/QByteArray>
+#include <QtCore/QVector>
+
+class QString;
+
+namespace MulaPluginStarDict
+{
+    /**
+     * \brief Suffix array over the headwords for infix and suffix wildcard
+     * queries
+     *
+     * The lower case UTF-8 headwords are concatenated into a blob, each of
+     * them preceded and the last one followed by a '\0' separator, and the
+     * suffix array holds the positions of the blob sorted by the suffixes
+     * starting there. Every suffix is only compared up to the end of its
+     * headword, hence the suffixes with the same beginning are next to each
+     * other, and the occurrences of a substring are found by two binary
+     * searches. The separators anchor the substrings at the beginning or at
+     * the end of the headwords.
+     *
+     * The longest literal part of a wildcard pattern is looked up, so a
+     * pattern like "*graph*" or "*ology" costs a binary search and a step
+     * per headword containing the literal part, instead of a scan over all
+     * the headwords.
+     *
+     * The blob, the start positions of the headwords and the suffix array
+     * are stored in a ".sfx" file next to the offset cache file, which is
+     * mapped into the memory when loaded.
+     *
+     * \see cacheLocations
+     */
+
+    class SuffixArrayIndex
+    {
+        public:
+
+            /**
+             * Constructor
+             */
+
+            SuffixArrayIndex();
+
+            /**
+             * Destructor
+             */
+
+            virtual ~SuffixArrayIndex();
+
+            /**
+             * Loads the cache file of the index belonging to the desired index
+             * file. The cache is ignored if it is older than the index file.
+             *
+             * @param   indexFilePath   The complete file path of the index file
+             *
+             * @return True if the loading was successful, otherwise false.
+             *
+             * @see build
+             */
+
+            bool load(const QString& indexFilePath);
+
+            /**
+             * Builds the index over all the headwords of the index file and
+             * saves it into the cache file. The headwords are read from the
+             * index file directly, so the method can be called from any
+             * thread.
+             *
+             * @param   indexFilePath   The complete file path of the index file
+             *
+             * @return True if the building was successful, otherwise false.
+             *
+             * @see load
+             */
+
+            bool build(const QString& indexFilePath);
+
+            /**
+             * Returns whether the index is loaded
+             *
+             * @return True if the index is loaded, otherwise false.
+             */
+
+            bool isLoaded() const;
+
+            /**
+             * Returns the size of the loaded cache file in bytes
+             *
+             * @return The size of the cache file
+             */
+
+            qint64 fileSize() const;
+
+            /**
+             * Collects the word entries containing the substring
+             *
+             * @param   substring   The lower case UTF-8 substring
+             * @param   start       Whether the substring has to be at the
+             * beginning of the headwords
+             * @param   end         Whether the substring has to be at the end
+             * of the headwords
+             * @param   ids         The sorted indices of the word entries
+             */
+
+            void find(const QByteArray& substring, bool start, bool end, QVector<quint32>& ids) const;
+
+            /**
+             * Collects the candidate word entries of a wildcard pattern, i.e.
+             * the headwords containing the longest literal part of the
+             * pattern, regardless of the case.
+             *
+             * @param   pattern     The wildcard pattern
+             * @param   ids         The sorted indices of the candidate word
+             * entries
+             *
+             * @return True if the candidates are valid, otherwise false, e.g.
+             * if the pattern does not have any literal part.
+             *
+             * @see WildcardMatcher
+             */
+
+            bool patternCandidates(const QString& pattern, QVector<quint32>& ids) const;
+
+        private:
+            class Private;
+            Private *const d;
+    };
+}
+
+#endif // MULA_PLUGIN_STARDICT_SUFFIXARRAYINDEX_H
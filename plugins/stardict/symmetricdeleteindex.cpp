@@ -0,0 +1,198 @@
+/******************************************************************************
+ * This file is part of the Mula project
+ * Copyright (c) 2011 Laszlo Papp <lpapp@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "symmetricdeleteindex.h"
+
+#include "distance.h"
+#include "hashpostingfile.h"
+#include "indexfilescanner.h"
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QString>
+#include <QtCore/QtAlgorithms>
+#include <QtCore/QDebug>
+
+#include <algorithm>
+
+using namespace MulaPluginStarDict;
+
+class SymmetricDeleteIndex::Private
+{
+    public:
+        Private()
+            : postingFile("StarDict's Delete Index, Version: 0.1", ".sym")
+        {
+        }
+
+        ~Private()
+        {
+        }
+
+        static quint32 hash(const quint32 *word, int length);
+        static void addDeletes(quint32 *word, int length, int distance, QVector<quint32>& hashes);
+        static void deleteHashes(const quint32 *word, int length, QVector<quint32>& hashes);
+
+        HashPostingFile postingFile;
+};
+
+quint32
+SymmetricDeleteIndex::Private::hash(const quint32 *word, int length)
+{
+    // FNV-1a over the characters
+    quint32 result = 2166136261u;
+    for (int i = 0; i < length; ++i)
+    {
+        result ^= word[i];
+        result *= 16777619u;
+    }
+
+    return result;
+}
+
+void
+SymmetricDeleteIndex::Private::addDeletes(quint32 *word, int length, int distance, QVector<quint32>& hashes)
+{
+    hashes.append(hash(word, length));
+    if (distance == 0 || length == 0)
+        return;
+
+    // Delete every character in turn from a copy of the word
+    quint32 variant[prefixLength];
+    for (int i = 0; i < length; ++i)
+    {
+        // Deleting any character of a run gives the same variant
+        if (i > 0 && word[i] == word[i - 1])
+            continue;
+
+        int variantLength = 0;
+        for (int j = 0; j < length; ++j)
+        {
+            if (j != i)
+                variant[variantLength++] = word[j];
+        }
+
+        addDeletes(variant, variantLength, distance - 1, hashes);
+    }
+}
+
+void
+SymmetricDeleteIndex::Private::deleteHashes(const quint32 *word, int length, QVector<quint32>& hashes)
+{
+    quint32 prefix[prefixLength];
+    length = qMin(length, int(prefixLength));
+    for (int i = 0; i < length; ++i)
+        prefix[i] = word[i];
+
+    hashes.clear();
+    addDeletes(prefix, length, maximumDistance, hashes);
+
+    // The same variant can be reached by deleting in different orders
+    qSort(hashes);
+    hashes.erase(std::unique(hashes.begin(), hashes.end()), hashes.end());
+}
+
+SymmetricDeleteIndex::SymmetricDeleteIndex()
+    : d(new Private)
+{
+}
+
+SymmetricDeleteIndex::~SymmetricDeleteIndex()
+{
+    delete d;
+}
+
+bool
+SymmetricDeleteIndex::isLoaded() const
+{
+    return d->postingFile.isLoaded();
+}
+
+qint64
+SymmetricDeleteIndex::fileSize() const
+{
+    return d->postingFile.fileSize();
+}
+
+bool
+SymmetricDeleteIndex::load(const QString& indexFilePath)
+{
+    return d->postingFile.load(indexFilePath);
+}
+
+bool
+SymmetricDeleteIndex::build(const QString& indexFilePath)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    IndexFileScanner scanner;
+    if (!scanner.open(indexFilePath))
+        return false;
+
+    // The length of the words in the index file should be less than 256 bytes
+    quint32 word[256];
+    QVector<quint32> hashes;
+    QVector<HashPosting> postings;
+
+    while (scanner.next())
+    {
+        QByteArray utf8Word = scanner.word();
+        int length = BitParallelEditDistance::foldUtf8(utf8Word.constData(), utf8Word.size(), word, prefixLength);
+
+        d->deleteHashes(word, length, hashes);
+
+        HashPosting posting;
+        posting.id = scanner.index();
+        foreach (quint32 hash, hashes)
+        {
+            posting.hash = hash;
+            postings.append(posting);
+        }
+    }
+
+    if (!d->postingFile.save(indexFilePath, postings))
+    {
+        qDebug() << "Failed to build the delete index for" << indexFilePath;
+        return false;
+    }
+
+    qDebug() << "Built the delete index for" << indexFilePath << "in" << timer.elapsed() << "ms,"
+             << d->postingFile.postingCount() << "postings," << d->postingFile.fileSize() << "bytes";
+
+    return true;
+}
+
+QVector<quint32>
+SymmetricDeleteIndex::candidates(const quint32 *word, int length) const
+{
+    QVector<quint32> result;
+    if (!isLoaded())
+        return result;
+
+    QVector<quint32> hashes;
+    d->deleteHashes(word, length, hashes);
+
+    foreach (quint32 hash, hashes)
+        d->postingFile.find(hash, result);
+
+    qSort(result);
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+
+    return result;
+}
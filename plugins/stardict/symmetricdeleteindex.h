@@ -0,0 +1,133 @@
+/******************************************************************************
+ * This file is part of the Mula project
+ * Copyright (c) 2011 Laszlo Papp <lpapp@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef MULA_PLUGIN_STARDICT_SYMMETRICDELETEINDEX_H
+#define MULA_PLUGIN_STARDICT_SYMMETRICDELETEINDEX_H
+
+#include <QtCore/QVector>
+
+class QString;
+
+namespace MulaPluginStarDict
+{
+    /**
+     * \brief Symmetric delete index of the headwords for spelling suggestions
+     *
+     * The index maps every string that can be derived from a headword by
+     * deleting at most maximumDistance characters to the headword. Two words
+     * are within maximumDistance edits of each other, transpositions
+     * included, only if they share such a delete variant. Hence the
+     * candidates of a search word are collected by generating its own delete
+     * variants and looking them up, which takes a few binary searches instead
+     * of a scan over the headwords.
+     *
+     * Only the first prefixLength characters of the lower case words are
+     * used for the delete variants to keep the index small. The candidates
+     * are therefore a superset of the real matches, and their distance has
+     * to be verified by the caller.
+     *
+     * The variants are stored as hashes in a ".sym" posting file next to the
+     * offset cache file, which is mapped into the memory when loaded.
+     *
+     * \see HashPostingFile
+     */
+
+    class SymmetricDeleteIndex
+    {
+        public:
+
+            /**
+             * Constructor
+             */
+
+            SymmetricDeleteIndex();
+
+            /**
+             * Destructor
+             */
+
+            virtual ~SymmetricDeleteIndex();
+
+            /**
+             * Loads the cache file of the index belonging to the desired index
+             * file. The cache is ignored if it is older than the index file.
+             *
+             * @param   indexFilePath   The complete file path of the index file
+             *
+             * @return True if the loading was successful, otherwise false.
+             *
+             * @see build
+             */
+
+            bool load(const QString& indexFilePath);
+
+            /**
+             * Builds the index over all the headwords of the index file and
+             * saves it into the cache file. The headwords are read from the
+             * index file directly, so the method can be called from any
+             * thread.
+             *
+             * @param   indexFilePath   The complete file path of the index file
+             *
+             * @return True if the building was successful, otherwise false.
+             *
+             * @see load
+             */
+
+            bool build(const QString& indexFilePath);
+
+            /**
+             * Returns whether the index is loaded
+             *
+             * @return True if the index is loaded, otherwise false.
+             */
+
+            bool isLoaded() const;
+
+            /**
+             * Returns the size of the loaded cache file in bytes
+             *
+             * @return The size of the cache file
+             */
+
+            qint64 fileSize() const;
+
+            /**
+             * Returns the candidate word entries for the lower case UTF-32
+             * search word. The candidates include every headword within
+             * maximumDistance edits of the search word.
+             *
+             * @param   word    The lower case UTF-32 search word
+             * @param   length  The length of the search word
+             *
+             * @return The sorted indices of the candidate word entries
+             */
+
+            QVector<quint32> candidates(const quint32 *word, int length) const;
+
+            static const int maximumDistance = 2;
+            static const int prefixLength = 7;
+
+        private:
+            class Private;
+            Private *const d;
+    };
+}
+
+#endif // MULA_PLUGIN_STARDICT_SYMMETRICDELETEINDEX_H
@@ -0,0 +1,146 @@
+/******************************************************************************
+ * This file is part of the Mula project
+ * Copyright (c) 2011 Laszlo Papp <lpapp@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "articlerenderertest.h"
+
+#include <plugins/stardict/articlerenderer.h>
+
+#include <QtTest/QtTest>
+
+using namespace MulaPluginStarDict;
+
+class TestAbbreviationExpander : public ArticleRenderer::AbbreviationExpander
+{
+    public:
+        QString expand(const QString& abbreviation)
+        {
+            if (abbreviation == "_adj.")
+                return "adjective";
+
+            return QString();
+        }
+};
+
+ArticleRendererTest::ArticleRendererTest()
+{
+}
+
+ArticleRendererTest::~ArticleRendererTest()
+{
+}
+
+void ArticleRendererTest::testFields()
+{
+    QByteArray data;
+    data.append('m').append("meaning").append('\0');
+    data.append('W').append(QByteArray("\0\0\0\3abc", 7));
+    data.append('t').append("phonetic").append('\0');
+    data.append('y').append("skipped").append('\0');
+    data.append('h').append("<b>html</b>");
+
+    QCOMPARE(ArticleRenderer().render(data),
+             QString("meaning<font class=\"example\">phonetic</font><b>html</b>"));
+}
+
+void ArticleRendererTest::testHtmlSpaces_data()
+{
+    QTest::addColumn<QString>("text");
+    QTest::addColumn<QString>("html");
+
+    QTest::newRow("trimmed") << "  word  " << "word";
+    QTest::newRow("line break") << "one \n two" << "one <br>two";
+    QTest::newRow("paragraph") << "one\n\ntwo" << "one</p><p>two";
+    QTest::newRow("tab") << "one\ttwo" << "one&nbsp;&nbsp;&nbsp;&nbsp;two";
+    QTest::newRow("transcription") << "word [w3:d]" << "word <font class=\"transcription\">[w3:d]</font>";
+}
+
+void ArticleRendererTest::testHtmlSpaces()
+{
+    QFETCH(QString, text);
+    QFETCH(QString, html);
+
+    ArticleRenderer renderer;
+    renderer.setHtmlSpaces(true);
+    QCOMPARE(renderer.render('m' + text.toUtf8() + '\0'), html);
+}
+
+void ArticleRendererTest::testLists_data()
+{
+    QTest::addColumn<QString>("text");
+    QTest::addColumn<QString>("html");
+
+    QTest::newRow("list") << "word 1) one 2) two" << "word<ol><li>one</li><li>two</li></ol>";
+    QTest::newRow("escaped marker") << "1&gt; one 2&gt; two" << "<ol><li>one</li><li>two</li></ol>";
+    QTest::newRow("nested") << "1. a 1) b 2) c 2. d"
+        << "<ol><li>a<ol><li>b</li><li>c</li></ol></li><li>d</li></ol>";
+    QTest::newRow("new list") << "1) a 1) b" << "<ol><li>a</li></ol><ol><li>b</li></ol>";
+    QTest::newRow("decimal") << "costs 1.5 more" << "costs 1.5 more";
+    QTest::newRow("no open list") << "page 2) here" << "page 2) here";
+}
+
+void ArticleRendererTest::testLists()
+{
+    QFETCH(QString, text);
+    QFETCH(QString, html);
+
+    ArticleRenderer renderer;
+    renderer.setReformatLists(true);
+    QCOMPARE(renderer.render('m' + text.toUtf8() + '\0'), html);
+}
+
+void ArticleRendererTest::testAbbreviations()
+{
+    TestAbbreviationExpander expander;
+
+    ArticleRenderer renderer;
+    renderer.setAbbreviationExpander(&expander);
+
+    QCOMPARE(renderer.render(QByteArray("m_adj. big _n. thing\0", 21)),
+             QString("<font class=\"explanation\">adjective</font> big _n. thing"));
+    QCOMPARE(renderer.render(QByteArray("m_adj: big\0", 11)), QString("_adj: big"));
+}
+
+void ArticleRendererTest::testXdxf_data()
+{
+    QTest::addColumn<QString>("xdxf");
+    QTest::addColumn<QString>("html");
+
+    QTest::newRow("abbreviation") << "<abr>adj.</abr> big" << "<font class=\"abbreviature\">adj.</font> big";
+    QTest::newRow("transcription") << "<tr>w3:d</tr>" << "<font class=\"transcription\">[w3:d]</font>";
+    QTest::newRow("example") << "<ex>a big house</ex>" << "<font class=\"example\">a big house</font>";
+    QTest::newRow("keys") << "<k>one</k>first <k>two</k>second" << "first second";
+    QTest::newRow("other tags") << "<b>bold</b> <kref>link</kref>" << "<b>bold</b> <kref>link</kref>";
+    QTest::newRow("unterminated tag") << "a < b" << "a < b";
+}
+
+void ArticleRendererTest::testXdxf()
+{
+    QFETCH(QString, xdxf);
+    QFETCH(QString, html);
+
+    QString string = xdxf;
+    ArticleRenderer::xdxf2html(string);
+    QCOMPARE(string, html);
+
+    QCOMPARE(ArticleRenderer().render('x' + xdxf.toUtf8() + '\0'), html);
+}
+
+QTEST_MAIN(ArticleRendererTest)
+
+#include "articlerenderertest.moc"
@@ -0,0 +1,235 @@
+/******************************************************************************
+ * This file is part of the Mula project
+ * Copyright (c) 2011 Laszlo Papp <lpapp@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "bktreetest.h"
+#include "testdictionarywriter.h"
+
+#include <plugins/stardict/bktree.h>
+#include <plugins/stardict/distance.h>
+#include <plugins/stardict/stardictdictionarymanager.h>
+
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtTest/QtTest>
+
+using namespace MulaPluginStarDict;
+using namespace MulaPluginStarDictTest;
+
+BkTreeTest::BkTreeTest()
+{
+}
+
+BkTreeTest::~BkTreeTest()
+{
+}
+
+void BkTreeTest::initTestCase()
+{
+    QVERIFY(m_temporaryDir.isValid());
+
+    const char *syllables[] = { "ba", "ce", "di", "fo", "gu", "la", "me", "ni" };
+    for (int i = 0; i < 8; ++i)
+    {
+        for (int j = 0; j < 8; ++j)
+        {
+            for (int k = 0; k < 8; k += 3)
+                m_headwords << QString(syllables[i]) + syllables[j] + syllables[k];
+        }
+    }
+
+    m_headwords << "Apple" << "apple" << QString::fromUtf8("Ärger") << QString::fromUtf8("ärger");
+
+    m_indexFilePath = m_temporaryDir.path() + "/test.idx";
+    QVERIFY(writeIndexFile(m_indexFilePath, m_headwords));
+
+    QVERIFY(BkTree().build(m_indexFilePath));
+}
+
+void BkTreeTest::testSearch_data()
+{
+    QTest::addColumn<QString>("word");
+    QTest::addColumn<int>("maximumDistance");
+
+    QTest::newRow("exact") << "bacedi" << 0;
+    QTest::newRow("substitution") << "bacedo" << 1;
+    QTest::newRow("insertion") << "bacedii" << 2;
+    QTest::newRow("transposition") << "abcedi" << 2;
+    QTest::newRow("wide") << "lamefo" << 4;
+    QTest::newRow("case") << "APPEL" << 2;
+    QTest::newRow("no match") << "xyz" << 1;
+}
+
+void BkTreeTest::testSearch()
+{
+    QFETCH(QString, word);
+    QFETCH(int, maximumDistance);
+
+    BkTree bkTree;
+    QVERIFY(bkTree.load(m_indexFilePath));
+
+    QList<QPair<int, int> > matches = bkTree.search(word, maximumDistance);
+    qSort(matches);
+
+    // The tree has to find the same headwords as comparing against all of them
+    QList<QPair<int, int> > expectedMatches;
+    quint32 query[256];
+    quint32 headword[256];
+    QByteArray utf8Word = word.toUtf8();
+    int queryLength = BitParallelEditDistance::foldUtf8(utf8Word.constData(), utf8Word.size(), query, 256);
+
+    for (int i = 0; i < m_headwords.size(); ++i)
+    {
+        QByteArray utf8Headword = m_headwords.at(i).toUtf8();
+        int headwordLength = BitParallelEditDistance::foldUtf8(utf8Headword.constData(), utf8Headword.size(), headword, 256);
+        int distance = BkTree::distance(query, queryLength, headword, headwordLength);
+        if (distance <= maximumDistance)
+            expectedMatches.append(qMakePair(i, distance));
+    }
+
+    QCOMPARE(matches, expectedMatches);
+}
+
+void BkTreeTest::testCaseVariants()
+{
+    BkTree bkTree;
+    QVERIFY(bkTree.load(m_indexFilePath));
+
+    QList<QPair<int, int> > matches = bkTree.search(QString::fromUtf8("ÄRGER"), 0);
+    qSort(matches);
+
+    QList<QPair<int, int> > expectedMatches;
+    expectedMatches << qMakePair(m_headwords.indexOf(QString::fromUtf8("Ärger")), 0)
+                    << qMakePair(m_headwords.indexOf(QString::fromUtf8("ärger")), 0);
+
+    QCOMPARE(matches, expectedMatches);
+}
+
+void BkTreeTest::testInvalidCache()
+{
+    QString indexFilePath = m_temporaryDir.path() + "/invalid.idx";
+    QVERIFY(writeIndexFile(indexFilePath, m_headwords));
+
+    QFile cacheFile(indexFilePath + ".bkt");
+    QVERIFY(cacheFile.open(QIODevice::WriteOnly));
+    cacheFile.write("StarDict's BK-Tree, Version: 0.1");
+    cacheFile.write(QByteArray(64, '\0'));
+    cacheFile.close();
+
+    // The cache is not loaded, and it is not kept open either
+    BkTree bkTree;
+    QVERIFY(!bkTree.load(indexFilePath));
+    QVERIFY(!bkTree.isLoaded());
+    QVERIFY(cacheFile.remove());
+}
+
+void BkTreeTest::testCorruptCache_data()
+{
+    QTest::addColumn<int>("field");
+    QTest::addColumn<quint32>("value");
+
+    // The fields of the first node and of the first edge
+    QTest::newRow("text offset") << 1 << quint32(0xfffffff0);
+    QTest::newRow("text length") << 2 << quint32(100000);
+    QTest::newRow("first edge") << 3 << quint32(0xfffffff0);
+    QTest::newRow("edge count") << 4 << quint32(0xfffffff0);
+    QTest::newRow("edge child") << -1 << quint32(0);
+}
+
+void BkTreeTest::testCorruptCache()
+{
+    QFETCH(int, field);
+    QFETCH(quint32, value);
+
+    QString indexFilePath = m_temporaryDir.path() + "/corrupt.idx";
+    QVERIFY(writeIndexFile(indexFilePath, m_headwords));
+    QVERIFY(BkTree().build(indexFilePath));
+
+    // The header is the magic string and the three counts, followed by the
+    // nodes of five and the edges of two 32 bit fields
+    QFile cacheFile(indexFilePath + ".bkt");
+    QVERIFY(cacheFile.open(QIODevice::ReadWrite));
+    const QByteArray magicString("StarDict's BK-Tree, Version: 0.3");
+    QVERIFY(cacheFile.read(magicString.size()) == magicString);
+
+    quint32 nodeCount = 0;
+    QCOMPARE(cacheFile.read(reinterpret_cast<char*>(&nodeCount), sizeof(nodeCount)), qint64(sizeof(nodeCount)));
+
+    qint64 nodesOffset = magicString.size() + 3 * sizeof(quint32);
+    qint64 offset = field >= 0 ? nodesOffset + field * sizeof(quint32)
+                               : nodesOffset + nodeCount * 5 * sizeof(quint32) + sizeof(quint32);
+
+    QVERIFY(cacheFile.seek(offset));
+    QCOMPARE(cacheFile.write(reinterpret_cast<const char*>(&value), sizeof(value)), qint64(sizeof(value)));
+    cacheFile.close();
+
+    // The offsets are checked when loading, instead of being read out of
+    // the bounds of the mapped file
+    BkTree bkTree;
+    QVERIFY(!bkTree.load(indexFilePath));
+    QVERIFY(!bkTree.isLoaded());
+    QVERIFY(cacheFile.remove());
+}
+
+void BkTreeTest::testTranspositions_data()
+{
+    QTest::addColumn<QString>("word");
+    QTest::addColumn<QString>("expectedWord");
+
+    QTest::newRow("two transpositions") << "badcef" << "abcdef";
+    QTest::newRow("transposition and case") << "APPEL" << "Apple";
+    QTest::newRow("one transposition") << "mpale" << "maple";
+}
+
+void BkTreeTest::testTranspositions()
+{
+    QFETCH(QString, word);
+    QFETCH(QString, expectedWord);
+
+    QDir dir(m_temporaryDir.path());
+    if (!dir.exists("fuzzy"))
+    {
+        QVERIFY(dir.mkdir("fuzzy"));
+
+        QStringList headwords;
+        headwords << "abcdef" << "abcdfe" << "Apple" << "apple" << "applet" << "apply" << "maple" << "zebra";
+        QVERIFY(writeDictionary(dir.filePath("fuzzy/fuzzy"), headwords));
+
+        // The tree is built in the background otherwise
+        QVERIFY(BkTree().build(dir.filePath("fuzzy/fuzzy.idx")));
+    }
+
+    StarDictDictionaryManager dictionaryManager;
+    dictionaryManager.load(QStringList() << dir.filePath("fuzzy"), QStringList(), QStringList());
+    QCOMPARE(dictionaryManager.dictionaryCount(), 1);
+
+    QStringList fullScanResultList;
+    dictionaryManager.setFuzzyEngine(StarDictDictionaryManager::FULLSCAN);
+    QVERIFY(dictionaryManager.lookupWithFuzzy(word.toUtf8(), fullScanResultList, 4, 0));
+    QVERIFY(fullScanResultList.contains(expectedWord));
+
+    // The tree finds the same headwords within the radius of the scan
+    QStringList bkTreeResultList;
+    dictionaryManager.setFuzzyEngine(StarDictDictionaryManager::BKTREE);
+    QVERIFY(dictionaryManager.lookupWithFuzzy(word.toUtf8(), bkTreeResultList, 4, 0));
+    QCOMPARE(bkTreeResultList, fullScanResultList);
+}
+
+QTEST_MAIN(BkTreeTest)
+
+#include "bktreetest.moc"
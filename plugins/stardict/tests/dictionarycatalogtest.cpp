@@ -0,0 +1,178 @@
+/******************************************************************************
+ * This file is part of the Mula project
+ * Copyright (c) 2011 Laszlo Papp <lpapp@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "dictionarycatalogtest.h"
+
+#include <plugins/stardict/dictionarycatalog.h>
+#include <plugins/stardict/stardictdictionaryinfo.h>
+
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QStandardPaths>
+#include <QtTest/QtTest>
+
+using namespace MulaPluginStarDict;
+
+DictionaryCatalogTest::DictionaryCatalogTest()
+{
+}
+
+DictionaryCatalogTest::~DictionaryCatalogTest()
+{
+}
+
+void DictionaryCatalogTest::writeIfoFile(const QString& ifoFilePath, const QString& bookName)
+{
+    QFile ifoFile(ifoFilePath);
+    QVERIFY(ifoFile.open(QIODevice::WriteOnly));
+
+    ifoFile.write("StarDict's dict ifo file\nversion=2.4.2\n");
+    ifoFile.write("wordcount=1\nidxfilesize=10\nbookname=");
+    ifoFile.write(bookName.toUtf8());
+    ifoFile.write("\nsametypesequence=m\n");
+}
+
+void DictionaryCatalogTest::initTestCase()
+{
+    QVERIFY(m_temporaryDir.isValid());
+    QStandardPaths::setTestModeEnabled(true);
+
+    QDir dir(m_temporaryDir.path());
+    QVERIFY(dir.mkpath("first/nested"));
+    QVERIFY(dir.mkpath("second"));
+
+    writeIfoFile(dir.filePath("first/a.ifo"), "Alpha");
+    writeIfoFile(dir.filePath("first/nested/b.ifo"), "Beta");
+    writeIfoFile(dir.filePath("second/c.ifo"), "Gamma");
+
+    // Not a dictionary
+    QFile textFile(dir.filePath("first/readme.txt"));
+    QVERIFY(textFile.open(QIODevice::WriteOnly));
+}
+
+void DictionaryCatalogTest::testIfoFilePaths()
+{
+    QDir dir(m_temporaryDir.path());
+
+    DictionaryCatalog catalog;
+    catalog.setDirectories(QStringList() << dir.filePath("first") << dir.filePath("second"));
+
+    QStringList expected;
+    expected << dir.filePath("first/a.ifo") << dir.filePath("first/nested/b.ifo") << dir.filePath("second/c.ifo");
+    QCOMPARE(catalog.ifoFilePaths(), expected);
+}
+
+void DictionaryCatalogTest::testBookNames()
+{
+    QDir dir(m_temporaryDir.path());
+
+    DictionaryCatalog catalog;
+    catalog.setDirectories(QStringList() << dir.filePath("first") << dir.filePath("second"));
+
+    QCOMPARE(catalog.bookName(dir.filePath("second/c.ifo")), QString("Gamma"));
+    QCOMPARE(catalog.ifoFilePath("Beta"), dir.filePath("first/nested/b.ifo"));
+    QVERIFY(catalog.ifoFilePath("Delta").isEmpty());
+}
+
+void DictionaryCatalogTest::testSubdirectory()
+{
+    QDir dir(m_temporaryDir.path());
+
+    DictionaryCatalog catalog;
+    catalog.setDirectories(QStringList() << dir.filePath("first"));
+
+    QVERIFY(catalog.contains(dir.filePath("first/nested")));
+    QCOMPARE(catalog.ifoFilePaths(dir.filePath("first/nested")), QStringList() << dir.filePath("first/nested/b.ifo"));
+    QVERIFY(catalog.ifoFilePaths(dir.filePath("second")).isEmpty());
+}
+
+void DictionaryCatalogTest::testSetDirectories()
+{
+    QDir dir(m_temporaryDir.path());
+
+    DictionaryCatalog catalog;
+    catalog.setDirectories(QStringList() << dir.filePath("first") << dir.filePath("second"));
+    catalog.setDirectories(QStringList() << dir.filePath("second"));
+
+    QVERIFY(!catalog.contains(dir.filePath("first")));
+    QVERIFY(catalog.bookName(dir.filePath("first/a.ifo")).isEmpty());
+    QCOMPARE(catalog.ifoFilePaths(), QStringList() << dir.filePath("second/c.ifo"));
+}
+
+void DictionaryCatalogTest::testDictionaryAdded()
+{
+    QDir dir(m_temporaryDir.path());
+    QVERIFY(dir.mkpath("third"));
+
+    DictionaryCatalog catalog;
+    catalog.setDirectories(QStringList() << dir.filePath("third"));
+    QVERIFY(catalog.ifoFilePaths().isEmpty());
+
+    QSignalSpy spy(&catalog, SIGNAL(dictionaryAdded(QString)));
+    writeIfoFile(dir.filePath("third/d.ifo"), "Delta");
+
+    QVERIFY(spy.wait());
+    QCOMPARE(spy.at(0).at(0).toString(), dir.filePath("third/d.ifo"));
+    QCOMPARE(catalog.ifoFilePath("Delta"), dir.filePath("third/d.ifo"));
+}
+
+void DictionaryCatalogTest::testCache()
+{
+    QDir dir(m_temporaryDir.path());
+    QVERIFY(dir.mkpath("fourth"));
+    writeIfoFile(dir.filePath("fourth/e.ifo"), "Epsilon");
+
+    QString cacheFilePath = dir.filePath("catalog.cache");
+
+    {
+        DictionaryCatalog catalog;
+        catalog.setCacheFilePath(cacheFilePath);
+        catalog.setDirectories(QStringList() << dir.filePath("fourth"));
+    }
+
+    QVERIFY(QFile::exists(cacheFilePath));
+
+    {
+        DictionaryCatalog catalog;
+        catalog.setCacheFilePath(cacheFilePath);
+        catalog.setDirectories(QStringList() << dir.filePath("fourth"));
+
+        StarDictDictionaryInfo info;
+        QVERIFY(catalog.dictionaryInfo(dir.filePath("fourth/e.ifo"), info));
+        QCOMPARE(info.bookName(), QString("Epsilon"));
+        QCOMPARE(info.wordCount(), quint32(1));
+        QCOMPARE(info.sameTypeSequence(), QString("m"));
+    }
+
+    // The changed size of the file invalidates the cached entry
+    writeIfoFile(dir.filePath("fourth/e.ifo"), "Epsilon Revised");
+
+    {
+        DictionaryCatalog catalog;
+        catalog.setCacheFilePath(cacheFilePath);
+        catalog.setDirectories(QStringList() << dir.filePath("fourth"));
+
+        QCOMPARE(catalog.bookName(dir.filePath("fourth/e.ifo")), QString("Epsilon Revised"));
+        QVERIFY(catalog.ifoFilePath("Epsilon").isEmpty());
+    }
+}
+
+QTEST_MAIN(DictionaryCatalogTest)
+
+#include "dictionarycatalogtest.moc"
@@ -0,0 +1,319 @@
+/******************************************************************************
+ * This file is part of the Mula project
+ * Copyright (c) 2011 Laszlo Papp <lpapp@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include "dictionarytest.h"
+#include "testdictionarywriter.h"
+
+#include <plugins/stardict/dictionary.h>
+#include <plugins/stardict/headwordbucketindex.h>
+#include <plugins/stardict/headwordperfecthash.h>
+
+#include <QtCore/QList>
+#include <QtCore/QtEndian>
+#include <QtCore/QRegExp>
+#include <QtCore/QVector>
+#include <QtCore/QRunnable>
+#include <QtCore/QThreadPool>
+#include <QtTest/QtTest>
+
+using namespace MulaPluginStarDict;
+using namespace MulaPluginStarDictTest;
+
+// Creates the bucket index of the dictionary from a thread of the pool
+class IndexCreationJob : public QRunnable
+{
+    public:
+        IndexCreationJob(Dictionary *dictionary)
+            : m_dictionary(dictionary)
+            , m_bucketIndex(0)
+        {
+            setAutoDelete(false);
+        }
+
+        void run()
+        {
+            m_bucketIndex = m_dictionary->headwordBucketIndex();
+        }
+
+        const HeadwordBucketIndex* bucketIndex() const
+        {
+            return m_bucketIndex;
+        }
+
+    private:
+        Dictionary *m_dictionary;
+        const HeadwordBucketIndex *m_bucketIndex;
+};
+
+DictionaryTest::DictionaryTest()
+{
+}
+
+DictionaryTest::~DictionaryTest()
+{
+}
+
+void DictionaryTest::initTestCase()
+{
+    QVERIFY(m_temporaryDir.isValid());
+
+    m_headwords << "apple" << "banana" << "cherry" << "date" << "fig" << "grape";
+
+    QString basePath = m_temporaryDir.path() + "/test";
+    QVERIFY(writeDictionary(basePath, m_headwords));
+    m_ifoFilePath = basePath + ".ifo";
+
+    // Every article is longer than a chunk of the compressed data file, so
+    // every read spans chunks
+    for (int i = 0; i < 300; ++i)
+    {
+        m_batchHeadwords << QString("word%1").arg(i, 3, 10, QChar('0'));
+        m_batchArticles << QString("article %1 ").arg(i) + QString(70 + i % 50, QChar('a' + i % 26));
+    }
+
+    // The last headwords share the word data of the first ones
+    for (int i = 280; i < 300; ++i)
+        m_batchArticles[i] = m_batchArticles.at(i - 280);
+
+    QVERIFY(writeDictionary(m_temporaryDir.path() + "/plain", m_batchHeadwords, m_batchArticles));
+    QVERIFY(writeDictionary(m_temporaryDir.path() + "/compressed", m_batchHeadwords, m_batchArticles, 64));
+
+    // The headwords with accented letters in the order of the StarDict tools,
+    // where their case variants are not adjacent
+    m_accentedHeadwords << "Apfel" << "apfel" << "arm" << "Arm" << "uber" << "zebra"
+                        << QString::fromUtf8("Äpfel") << QString::fromUtf8("äpfel") << QString::fromUtf8("Ärger")
+                        << QString::fromUtf8("ärger") << QString::fromUtf8("Über") << QString::fromUtf8("über")
+                        << QString::fromUtf8("Übung") << QString::fromUtf8("übung") << QString::fromUtf8("ábc");
+    qSort(m_accentedHeadwords.begin(), m_accentedHeadwords.end(), IndexOrderLessThan());
+
+    QString accentedBasePath = m_temporaryDir.path() + "/accented";
+    QVERIFY(writeDictionary(accentedBasePath, m_accentedHeadwords));
+    QVERIFY(HeadwordPerfectHash().build(accentedBasePath + ".idx"));
+    m_accentedIfoFilePath = accentedBasePath + ".ifo";
+}
+
+void DictionaryTest::testLazyOpening()
+{
+    Dictionary dictionary;
+    QVERIFY(dictionary.load(m_ifoFilePath, true));
+    QVERIFY(!dictionary.isOpen());
+    QCOMPARE(dictionary.articleCount(), m_headwords.size());
+
+    // The first query opens the files
+    QCOMPARE(dictionary.lookup("cherry"), 2);
+    QVERIFY(dictionary.isOpen());
+
+    // The dictionary used since the previous check survives one check
+    QVERIFY(!dictionary.closeIfIdle());
+    QVERIFY(dictionary.isOpen());
+    QVERIFY(dictionary.closeIfIdle());
+    QVERIFY(!dictionary.isOpen());
+    QVERIFY(!dictionary.closeIfIdle());
+
+    // The closed dictionary is opened again on the next query
+    QCOMPARE(dictionary.lookup("fig"), 4);
+    QVERIFY(dictionary.isOpen());
+    QCOMPARE(dictionary.key(1), QString("banana"));
+    QVERIFY(dictionary.headwordBucketIndex());
+}
+
+void DictionaryTest::testConcurrentIndexCreation()
+{
+    Dictionary dictionary;
+    QVERIFY(dictionary.load(m_ifoFilePath, true));
+
+    // The index is created once, however many queries race for it
+    QThreadPool threadPool;
+    QList<IndexCreationJob *> jobs;
+    for (int i = 0; i < 8; ++i)
+    {
+        IndexCreationJob *job = new IndexCreationJob(&dictionary);
+        jobs.append(job);
+        threadPool.start(job);
+    }
+
+    threadPool.waitForDone();
+
+    foreach (IndexCreationJob *job, jobs)
+    {
+        QVERIFY(job->bucketIndex());
+        QCOMPARE(job->bucketIndex(), jobs.first()->bucketIndex());
+    }
+
+    qDeleteAll(jobs);
+}
+
+void DictionaryTest::testLookupCaseVariants()
+{
+    Dictionary dictionary;
+    QVERIFY(dictionary.load(m_accentedIfoFilePath));
+    QVERIFY(dictionary.headwordPerfectHash());
+
+    // Every headword is found, also the case variants not adjacent to the
+    // first one in the index
+    for (int i = 0; i < m_accentedHeadwords.size(); ++i)
+        QCOMPARE(dictionary.lookup(m_accentedHeadwords.at(i)), i);
+
+    QCOMPARE(dictionary.lookup("APFEL"), -1);
+    QCOMPARE(dictionary.lookup(QString::fromUtf8("ÜBUNG")), -1);
+    QCOMPARE(dictionary.lookup(QString::fromUtf8("ärgern")), -1);
+}
+
+void DictionaryTest::testLookupPattern_data()
+{
+    QTest::addColumn<QString>("pattern");
+
+    QTest::newRow("ascii prefix") << "a*";
+    QTest::newRow("upper case ascii prefix") << "Ar?";
+    QTest::newRow("accented prefix") << QString::fromUtf8("ä*");
+    QTest::newRow("upper case accented prefix") << QString::fromUtf8("Ü*");
+    QTest::newRow("accented literal") << QString::fromUtf8("über");
+    QTest::newRow("acute accent") << QString::fromUtf8("á*");
+    QTest::newRow("no prefix") << "*ger";
+}
+
+void DictionaryTest::testLookupPattern()
+{
+    QFETCH(QString, pattern);
+
+    QVector<int> expectedIndexList;
+    QRegExp regExp(pattern, Qt::CaseSensitive, QRegExp::Wildcard);
+    for (int i = 0; i < m_accentedHeadwords.size(); ++i)
+    {
+        if (regExp.exactMatch(m_accentedHeadwords.at(i)))
+            expectedIndexList.append(i);
+    }
+
+    QVERIFY(!expectedIndexList.isEmpty());
+
+    // The matches of a non-ASCII prefix are not adjacent in the index
+    Dictionary dictionary;
+    QVERIFY(dictionary.load(m_accentedIfoFilePath));
+    QCOMPARE(dictionary.lookupPattern(pattern, 100), expectedIndexList);
+}
+
+void DictionaryTest::testContainData_data()
+{
+    QTest::addColumn<QString>("sameTypeSequence");
+    QTest::addColumn<QByteArray>("data");
+
+    // The sizes of the resources are big-endian, and the resources are
+    // longer than the text sections
+    uchar size[sizeof(quint32)];
+    qToBigEndian<quint32>(300, size);
+    QByteArray resource = QByteArray(reinterpret_cast<const char*>(size), sizeof(size)) + QByteArray(300, 'r');
+
+    QTest::newRow("same type sequence") << "Wm" << resource + "the visible word";
+    QTest::newRow("typed sections") << QString() << 'W' + resource + "mthe visible word" + '\0';
+}
+
+void DictionaryTest::testContainData()
+{
+    QFETCH(QString, sameTypeSequence);
+    QFETCH(QByteArray, data);
+
+    Dictionary dictionary;
+    dictionary.setSameTypeSequence(sameTypeSequence);
+
+    // The resources are skipped by their sizes, to the text after them
+    QVERIFY(dictionary.containData(QStringList() << "visible", data));
+    QVERIFY(dictionary.containData(QStringList() << "visible" << "word", data));
+    QVERIFY(!dictionary.containData(QStringList() << "hidden", data));
+
+    // Truncated resources do not contain any word
+    QVERIFY(!dictionary.containData(QStringList() << "visible", data.left(100)));
+}
+
+void DictionaryTest::testLookupBatch_data()
+{
+    QTest::addColumn<QString>("name");
+
+    QTest::newRow("plain") << "plain";
+    QTest::newRow("compressed") << "compressed";
+}
+
+void DictionaryTest::testLookupBatch()
+{
+    QFETCH(QString, name);
+
+    Dictionary dictionary;
+    QVERIFY(dictionary.load(m_temporaryDir.path() + '/' + name + ".ifo"));
+
+    // Unsorted words with duplicates, and missing words before, between and
+    // after the headwords
+    QStringList words;
+    words << "word150" << "word007" << "missing" << "word150" << "aaa" << "word000"
+          << "word1505" << "zzz" << "word299" << "word007" << "word151";
+
+    QVector<int> indices = dictionary.lookupBatch(words);
+    QCOMPARE(indices.size(), words.size());
+
+    for (int i = 0; i < words.size(); ++i)
+    {
+        QCOMPARE(indices.at(i), m_batchHeadwords.indexOf(words.at(i)));
+        QCOMPARE(indices.at(i), dictionary.lookup(words.at(i)));
+    }
+
+    QVERIFY(dictionary.lookupBatch(QStringList()).isEmpty());
+}
+
+void DictionaryTest::testDataBatch_data()
+{
+    QTest::addColumn<QString>("name");
+
+    QTest::newRow("plain") << "plain";
+    QTest::newRow("compressed") << "compressed";
+}
+
+void DictionaryTest::testDataBatch()
+{
+    QFETCH(QString, name);
+
+    Dictionary dictionary;
+    QVERIFY(dictionary.load(m_temporaryDir.path() + '/' + name + ".ifo"));
+
+    // Unsorted indices with duplicates, invalid indices, and word entries
+    // sharing their word data
+    QVector<int> indices;
+    indices << 150 << 7 << -1 << 150 << m_batchHeadwords.size() << 0 << 299 << 281 << 1 << 7;
+
+    QVector<QByteArray> dataList = dictionary.dataBatch(indices);
+    QCOMPARE(dataList.size(), indices.size());
+
+    for (int i = 0; i < indices.size(); ++i)
+    {
+        int index = indices.at(i);
+        if (index < 0 || index >= m_batchHeadwords.size())
+        {
+            QVERIFY(dataList.at(i).isEmpty());
+            continue;
+        }
+
+        // The data of the "m" type sequence is the article with its type
+        QByteArray expectedData = 'm' + m_batchArticles.at(index).toUtf8() + '\0';
+        QCOMPARE(dataList.at(i), expectedData);
+    }
+
+    QVERIFY(dictionary.dataBatch(QVector<int>()).isEmpty());
+}
+
+QTEST_MAIN(DictionaryTest)
+
+#include "dictionarytest.moc"
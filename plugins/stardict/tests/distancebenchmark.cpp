@@ -0,0 +1,188 @@
+/******************************************************************************
+ * This file is part of the Mula project
+ * Copyright (c) 2011 Laszlo Papp <lpapp@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "distancebenchmark.h"
+#include "testdictionarywriter.h"
+
+#include <plugins/stardict/distance.h>
+#include <plugins/stardict/stardictdictionarymanager.h>
+#include <plugins/stardict/symmetricdeleteindex.h>
+
+#include <QtCore/QDir>
+#include <QtTest/QtTest>
+
+#include <algorithm>
+
+using namespace MulaPluginStarDict;
+using namespace MulaPluginStarDictTest;
+
+static const int maximumWordLength = 256;
+
+DistanceBenchmark::DistanceBenchmark()
+{
+}
+
+DistanceBenchmark::~DistanceBenchmark()
+{
+}
+
+void DistanceBenchmark::initTestCase()
+{
+    // A deterministic set of headword-like strings of different lengths
+    qsrand(42);
+    for (int i = 0; i < 10000; ++i)
+    {
+        int length = 3 + qrand() % 12;
+        QString word;
+        for (int j = 0; j < length; ++j)
+            word += QLatin1Char('a' + qrand() % 26);
+
+        m_words.append(word);
+    }
+
+    // The same words as a dictionary for the fuzzy lookups, with the delete
+    // index built in advance instead of in the background
+    QVERIFY(m_temporaryDir.isValid());
+    QStringList headwords = m_words;
+    qSort(headwords.begin(), headwords.end(), IndexOrderLessThan());
+    headwords.erase(std::unique(headwords.begin(), headwords.end()), headwords.end());
+
+    QDir dir(m_temporaryDir.path());
+    QVERIFY(dir.mkdir("fuzzy"));
+    QVERIFY(writeDictionary(dir.filePath("fuzzy/fuzzy"), headwords));
+    QVERIFY(SymmetricDeleteIndex().build(dir.filePath("fuzzy/fuzzy.idx")));
+}
+
+static void addBenchmarkRows()
+{
+    QTest::addColumn<QString>("searchWord");
+    QTest::addColumn<int>("limit");
+
+    QTest::newRow("short") << "dict" << 3;
+    QTest::newRow("medium") << "dictionary" << 3;
+    QTest::newRow("long") << "internationalization" << 3;
+}
+
+void DistanceBenchmark::benchmarkEditDistance_data()
+{
+    addBenchmarkRows();
+}
+
+void DistanceBenchmark::benchmarkEditDistance()
+{
+    QFETCH(QString, searchWord);
+    QFETCH(int, limit);
+
+    EditDistance editDistance;
+    int matches = 0;
+
+    QBENCHMARK {
+        matches = 0;
+        foreach (const QString& word, m_words)
+        {
+            if (editDistance.calEditDistance(word.toLower(), searchWord, limit) < limit)
+                ++matches;
+        }
+    }
+
+    Q_UNUSED(matches);
+}
+
+void DistanceBenchmark::benchmarkBitParallelEditDistance_data()
+{
+    addBenchmarkRows();
+}
+
+void DistanceBenchmark::benchmarkBitParallelEditDistance()
+{
+    QFETCH(QString, searchWord);
+    QFETCH(int, limit);
+
+    // Like the fuzzy search, work on the raw UTF-8 headwords
+    QList<QByteArray> utf8Words;
+    foreach (const QString& word, m_words)
+        utf8Words.append(word.toUtf8());
+
+    QByteArray utf8SearchWord = searchWord.toUtf8();
+    quint32 searchBuffer[maximumWordLength];
+    int searchLength = BitParallelEditDistance::foldUtf8(utf8SearchWord.constData(), utf8SearchWord.size(),
+                                                         searchBuffer, maximumWordLength);
+    quint32 wordBuffer[maximumWordLength];
+    int matches = 0;
+
+    QBENCHMARK {
+        matches = 0;
+        foreach (const QByteArray& word, utf8Words)
+        {
+            int wordLength = BitParallelEditDistance::foldUtf8(word.constData(), word.size(),
+                                                               wordBuffer, maximumWordLength);
+            if (BitParallelEditDistance::distance(wordBuffer, wordLength, searchBuffer, searchLength, limit) < limit)
+                ++matches;
+        }
+    }
+
+    Q_UNUSED(matches);
+}
+
+void DistanceBenchmark::benchmarkFuzzyLookup_data()
+{
+    addBenchmarkRows();
+}
+
+void DistanceBenchmark::benchmarkFuzzyLookup()
+{
+    QFETCH(QString, searchWord);
+
+    StarDictDictionaryManager dictionaryManager;
+    dictionaryManager.load(QStringList() << m_temporaryDir.path() + "/fuzzy", QStringList(), QStringList());
+    QCOMPARE(dictionaryManager.dictionaryCount(), 1);
+
+    // The latency of a query of the full scan
+    QStringList resultList;
+    QBENCHMARK {
+        dictionaryManager.lookupWithFuzzy(searchWord.toUtf8(), resultList, 10, 0);
+    }
+}
+
+void DistanceBenchmark::benchmarkSymmetricDeleteLookup_data()
+{
+    addBenchmarkRows();
+}
+
+void DistanceBenchmark::benchmarkSymmetricDeleteLookup()
+{
+    QFETCH(QString, searchWord);
+
+    StarDictDictionaryManager dictionaryManager;
+    dictionaryManager.load(QStringList() << m_temporaryDir.path() + "/fuzzy", QStringList(), QStringList());
+    QCOMPARE(dictionaryManager.dictionaryCount(), 1);
+
+    // The latency of a query of StarDict::findSimilarWords() once the delete
+    // index is available
+    QStringList resultList;
+    QVERIFY(dictionaryManager.lookupWithSymmetricDeleteIndex(searchWord.toUtf8(), resultList, 10, 0));
+
+    QBENCHMARK {
+        dictionaryManager.lookupWithSymmetricDeleteIndex(searchWord.toUtf8(), resultList, 10, 0);
+    }
+}
+
+QTEST_MAIN(DistanceBenchmark)
+
+#include "distancebenchmark.moc"
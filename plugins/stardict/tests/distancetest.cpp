@@ -0,0 +1,139 @@
+/******************************************************************************
+ * This file is part of the Mula project
+ * Copyright (c) 2011 Laszlo Papp <lpapp@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "distancetest.h"
+
+#include <plugins/stardict/distance.h>
+
+#include <QtCore/QVector>
+#include <QtTest/QtTest>
+
+static QVector<uint> fold(const QString& word)
+{
+    QByteArray utf8 = word.toUtf8();
+    QVector<uint> buffer(utf8.size());
+    buffer.resize(BitParallelEditDistance::foldUtf8(utf8.constData(), utf8.size(), buffer.data(), buffer.size()));
+    return buffer;
+}
+
+static int distance(const QString& string1, const QString& string2, int limit, bool transpositions = true)
+{
+    QVector<uint> ucs1 = fold(string1);
+    QVector<uint> ucs2 = fold(string2);
+    return BitParallelEditDistance::distance(ucs1.constData(), ucs1.size(), ucs2.constData(), ucs2.size(),
+                                             limit, transpositions);
+}
+
+DistanceTest::DistanceTest()
+{
+}
+
+DistanceTest::~DistanceTest()
+{
+}
+
+void DistanceTest::testDistance_data()
+{
+    QTest::addColumn<QString>("string1");
+    QTest::addColumn<QString>("string2");
+    QTest::addColumn<int>("levenshtein");
+    QTest::addColumn<int>("damerau");
+
+    QTest::newRow("equal") << "dictionary" << "dictionary" << 0 << 0;
+    QTest::newRow("empty") << "" << "word" << 4 << 4;
+    QTest::newRow("substitution") << "kitten" << "sitten" << 1 << 1;
+    QTest::newRow("classic") << "kitten" << "sitting" << 3 << 3;
+    QTest::newRow("transposition") << "recieve" << "receive" << 2 << 1;
+    QTest::newRow("swapped ends") << "ab" << "ba" << 2 << 1;
+    QTest::newRow("restricted") << "ca" << "abc" << 3 << 3;
+    QTest::newRow("case folding") << "Dictionary" << "dICTIONARY" << 0 << 0;
+    QTest::newRow("non-ascii") << QString::fromUtf8("szótár") << QString::fromUtf8("szotar") << 2 << 2;
+    QTest::newRow("non-ascii transposition") << QString::fromUtf8("őszi") << QString::fromUtf8("sőzi") << 2 << 1;
+}
+
+void DistanceTest::testDistance()
+{
+    QFETCH(QString, string1);
+    QFETCH(QString, string2);
+    QFETCH(int, levenshtein);
+    QFETCH(int, damerau);
+
+    QCOMPARE(distance(string1, string2, 100, false), levenshtein);
+    QCOMPARE(distance(string2, string1, 100, false), levenshtein);
+    QCOMPARE(distance(string1, string2, 100), damerau);
+    QCOMPARE(distance(string2, string1, 100), damerau);
+
+    QByteArray latin1 = string1.toLower().toLatin1();
+    QByteArray latin2 = string2.toLower().toLatin1();
+    QCOMPARE(BitParallelEditDistance::distance(latin1.constData(), latin1.size(), latin2.constData(), latin2.size(), 100),
+             damerau);
+}
+
+void DistanceTest::testLimit()
+{
+    QCOMPARE(distance("kitten", "sitting", 4), 3);
+    QVERIFY(distance("kitten", "sitting", 3) >= 3);
+    QVERIFY(distance("kitten", "sitting", 2) >= 2);
+    QVERIFY(distance("a", "abcdefgh", 3) >= 3);
+    QCOMPARE(distance("dictionary", "dictionary", 1), 0);
+}
+
+void DistanceTest::testLongWords()
+{
+    QString word1;
+    QString word2;
+    for (int i = 0; i < 50; ++i)
+    {
+        word1 += QLatin1String("ab");
+        word2 += QLatin1String("ab");
+    }
+
+    word2[10] = QLatin1Char('x');
+    word2.remove(70, 1);
+    word2.insert(90, QLatin1Char('y'));
+    qSwap(word2[40], word2[41]);
+
+    QCOMPARE(distance(word1, word2, 100, false), 5);
+    QCOMPARE(distance(word1, word2, 100), 4);
+    QVERIFY(distance(word1, word2, 3) >= 3);
+
+    // Only the first characters of the words longer than the maximum length
+    // are compared, so the second difference is not counted
+    QString longWord1 = QString(BitParallelEditDistance::maximumLength + 20, QLatin1Char('a'));
+    QString longWord2 = longWord1;
+    longWord2[10] = QLatin1Char('b');
+    longWord2[BitParallelEditDistance::maximumLength + 10] = QLatin1Char('b');
+
+    QCOMPARE(distance(longWord1, longWord2, 100), 1);
+}
+
+void DistanceTest::testFoldUtf8()
+{
+    QString word = QString::fromUtf8("ÁrvíztŰrő x");
+    QCOMPARE(fold(word), word.toLower().toUcs4());
+
+    uint buffer[4];
+    QByteArray utf8 = word.toUtf8();
+    QCOMPARE(BitParallelEditDistance::foldUtf8(utf8.constData(), utf8.size(), buffer, 4), 4);
+    QCOMPARE(buffer[0], uint(QChar(0xe1).unicode()));
+}
+
+QTEST_MAIN(DistanceTest)
+
+#include "distancetest.moc"
@@ -0,0 +1,89 @@
+/******************************************************************************
+ * This file is part of the Mula project
+ * Copyright (c) 2011 Laszlo Papp <lpapp@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "doublemetaphonetest.h"
+
+#include <plugins/stardict/doublemetaphone.h>
+
+#include <QtCore/QVector>
+#include <QtTest/QtTest>
+
+using namespace MulaPluginStarDict;
+
+static QList<QByteArray> encode(const QString& word)
+{
+    QVector<uint> characters = word.toLower().toUcs4();
+    return DoubleMetaphone().encode(characters.constData(), characters.size());
+}
+
+DoubleMetaphoneTest::DoubleMetaphoneTest()
+{
+}
+
+DoubleMetaphoneTest::~DoubleMetaphoneTest()
+{
+}
+
+void DoubleMetaphoneTest::testEncode_data()
+{
+    QTest::addColumn<QString>("word");
+    QTest::addColumn<QByteArray>("primary");
+    QTest::addColumn<QByteArray>("alternate");
+
+    QTest::newRow("silent start") << "gnome" << QByteArray("NM") << QByteArray("NM");
+    QTest::newRow("greek ch") << "chemistry" << QByteArray("KMST") << QByteArray("KMST");
+    QTest::newRow("ambiguous ch") << "Michael" << QByteArray("MKL") << QByteArray("MXL");
+    QTest::newRow("germanic sch") << "Schmidt" << QByteArray("XMT") << QByteArray("SMT");
+    QTest::newRow("th") << "Smith" << QByteArray("SM0") << QByteArray("XMT");
+    QTest::newRow("dge") << "edge" << QByteArray("AJ") << QByteArray("AJ");
+    QTest::newRow("spanish j") << "Jose" << QByteArray("HS") << QByteArray("HS");
+    QTest::newRow("gh") << "laugh" << QByteArray("LF") << QByteArray("LF");
+    QTest::newRow("polish") << "Filipowicz" << QByteArray("FLPT") << QByteArray("FLPF");
+    QTest::newRow("cedilla") << QString::fromUtf8("façade") << QByteArray("FST") << QByteArray("FST");
+    QTest::newRow("diacritics") << QString::fromUtf8("café") << QByteArray("KF") << QByteArray("KF");
+}
+
+void DoubleMetaphoneTest::testEncode()
+{
+    QFETCH(QString, word);
+    QFETCH(QByteArray, primary);
+    QFETCH(QByteArray, alternate);
+
+    QList<QByteArray> keys = encode(word);
+    QVERIFY(!keys.isEmpty());
+    QCOMPARE(keys.first(), primary);
+    QCOMPARE(keys.last(), alternate);
+}
+
+void DoubleMetaphoneTest::testSoundAlike()
+{
+    QCOMPARE(encode("nolij").first(), encode("knowledge").first());
+    QCOMPARE(encode("fonetik").first(), encode("phonetic").first());
+    QVERIFY(encode("Vasserman").contains(encode("Wasserman").last()));
+}
+
+void DoubleMetaphoneTest::testNonLatin()
+{
+    QVERIFY(encode(QString::fromUtf8("слово")).isEmpty());
+    QVERIFY(encode("1984").isEmpty());
+}
+
+QTEST_MAIN(DoubleMetaphoneTest)
+
+#include "doublemetaphonetest.moc"
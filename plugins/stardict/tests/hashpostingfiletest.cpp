@@ -0,0 +1,166 @@
+/******************************************************************************
+ * This file is part of the Mula project
+ * Copyright (c) 2011 Laszlo Papp <lpapp@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "hashpostingfiletest.h"
+#include "testdictionarywriter.h"
+
+#include <plugins/stardict/hashpostingfile.h>
+
+#include <QtCore/QFile>
+#include <QtCore/QVector>
+#include <QtTest/QtTest>
+
+using namespace MulaPluginStarDict;
+using namespace MulaPluginStarDictTest;
+
+static const char magicString[] = "StarDict's Test Postings, Version: 0.1";
+
+static HashPosting
+hashPosting(quint32 hash, quint32 id)
+{
+    HashPosting posting;
+    posting.hash = hash;
+    posting.id = id;
+    return posting;
+}
+
+HashPostingFileTest::HashPostingFileTest()
+{
+}
+
+HashPostingFileTest::~HashPostingFileTest()
+{
+}
+
+void HashPostingFileTest::initTestCase()
+{
+    QVERIFY(m_temporaryDir.isValid());
+
+    // Only the modification time of the index file matters
+    m_indexFilePath = m_temporaryDir.path() + "/postings.idx";
+    QVERIFY(writeIndexFile(m_indexFilePath, QStringList() << "headword"));
+}
+
+void HashPostingFileTest::testSave()
+{
+    // Unsorted postings with duplicate hashes
+    QVector<HashPosting> postings;
+    postings << hashPosting(7, 3) << hashPosting(5, 1) << hashPosting(7, 1) << hashPosting(9, 0)
+             << hashPosting(7, 2) << hashPosting(5, 4) << hashPosting(0xffffffffu, 5);
+
+    HashPostingFile postingFile(magicString, ".hpt");
+    QVERIFY(postingFile.save(m_indexFilePath, postings));
+    QVERIFY(postingFile.isLoaded());
+    QCOMPARE(postingFile.postingCount(), 7);
+    QCOMPARE(postingFile.fileSize(), qint64(sizeof(magicString) - 1 + sizeof(quint32) + 7 * sizeof(HashPosting)));
+
+    // The postings are sorted by the saving
+    for (int i = 1; i < postings.size(); ++i)
+        QVERIFY(postings.at(i - 1) < postings.at(i));
+}
+
+void HashPostingFileTest::testFind_data()
+{
+    QTest::addColumn<quint32>("hash");
+    QTest::addColumn<QVector<quint32> >("expectedIds");
+
+    QTest::newRow("duplicate hashes") << quint32(7) << (QVector<quint32>() << 1 << 2 << 3);
+    QTest::newRow("first hash") << quint32(5) << (QVector<quint32>() << 1 << 4);
+    QTest::newRow("single hash") << quint32(9) << (QVector<quint32>() << 0);
+    QTest::newRow("last hash") << quint32(0xffffffffu) << (QVector<quint32>() << 5);
+    QTest::newRow("missing hash") << quint32(6) << QVector<quint32>();
+    QTest::newRow("before the first hash") << quint32(0) << QVector<quint32>();
+}
+
+void HashPostingFileTest::testFind()
+{
+    QFETCH(quint32, hash);
+    QFETCH(QVector<quint32>, expectedIds);
+
+    HashPostingFile postingFile(magicString, ".hpt");
+    QVERIFY(postingFile.load(m_indexFilePath));
+
+    // The ids are appended to the list
+    QVector<quint32> ids;
+    ids << 42;
+    postingFile.find(hash, ids);
+
+    QCOMPARE(ids, QVector<quint32>() << 42 << expectedIds);
+}
+
+void HashPostingFileTest::testLoad()
+{
+    HashPostingFile postingFile(magicString, ".hpt");
+    QVERIFY(!postingFile.isLoaded());
+    QCOMPARE(postingFile.fileSize(), qint64(0));
+
+    QVERIFY(postingFile.load(m_indexFilePath));
+    QCOMPARE(postingFile.postingCount(), 7);
+
+    // Another extension belongs to another file
+    HashPostingFile otherPostingFile(magicString, ".hpx");
+    QVERIFY(!otherPostingFile.load(m_indexFilePath));
+}
+
+void HashPostingFileTest::testWrongMagic()
+{
+    HashPostingFile postingFile("StarDict's Test Postings, Version: 0.2", ".hpt");
+    QVERIFY(!postingFile.load(m_indexFilePath));
+    QVERIFY(!postingFile.isLoaded());
+
+    QVector<quint32> ids;
+    postingFile.find(7, ids);
+    QVERIFY(ids.isEmpty());
+}
+
+void HashPostingFileTest::testTruncated()
+{
+    QString indexFilePath = m_temporaryDir.path() + "/truncated.idx";
+    QVERIFY(writeIndexFile(indexFilePath, QStringList() << "headword"));
+
+    // The header promises more postings than the file holds
+    QFile cacheFile(indexFilePath + ".hpt");
+    QVERIFY(cacheFile.open(QIODevice::WriteOnly));
+    quint32 postingCount = 2;
+    HashPosting posting = hashPosting(1, 1);
+    cacheFile.write(magicString, sizeof(magicString) - 1);
+    cacheFile.write(reinterpret_cast<const char*>(&postingCount), sizeof(postingCount));
+    cacheFile.write(reinterpret_cast<const char*>(&posting), sizeof(posting));
+    cacheFile.close();
+
+    HashPostingFile postingFile(magicString, ".hpt");
+    QVERIFY(!postingFile.load(indexFilePath));
+    QVERIFY(!postingFile.isLoaded());
+    QCOMPARE(postingFile.postingCount(), 0);
+}
+
+void HashPostingFileTest::testEmpty()
+{
+    QString indexFilePath = m_temporaryDir.path() + "/empty.idx";
+    QVERIFY(writeIndexFile(indexFilePath, QStringList()));
+
+    QVector<HashPosting> postings;
+    HashPostingFile postingFile(magicString, ".hpt");
+    QVERIFY(!postingFile.save(indexFilePath, postings));
+    QVERIFY(!postingFile.isLoaded());
+}
+
+QTEST_MAIN(HashPostingFileTest)
+
+#include "hashpostingfiletest.moc"
@@ -0,0 +1,97 @@
+/******************************************************************************
+ * This file is part of the Mula project
+ * Copyright (c) 2011 Laszlo Papp <lpapp@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "headwordbloomfiltertest.h"
+#include "testdictionarywriter.h"
+
+#include <plugins/stardict/headwordbloomfilter.h>
+
+#include <QtTest/QtTest>
+
+using namespace MulaPluginStarDict;
+using namespace MulaPluginStarDictTest;
+
+HeadwordBloomFilterTest::HeadwordBloomFilterTest()
+{
+}
+
+HeadwordBloomFilterTest::~HeadwordBloomFilterTest()
+{
+}
+
+void HeadwordBloomFilterTest::initTestCase()
+{
+    QVERIFY(m_temporaryDir.isValid());
+
+    for (int i = 0; i < 2000; ++i)
+        m_headwords << QString("headword%1").arg(i);
+
+    m_headwords << QString::fromUtf8("Ärger") << "Zebra";
+
+    m_indexFilePath = m_temporaryDir.path() + "/test.idx";
+    QVERIFY(writeIndexFile(m_indexFilePath, m_headwords));
+
+    QVERIFY(HeadwordBloomFilter().build(m_indexFilePath));
+}
+
+void HeadwordBloomFilterTest::testHeadwords()
+{
+    HeadwordBloomFilter filter;
+    QVERIFY(filter.load(m_indexFilePath));
+
+    foreach (const QString& headword, m_headwords)
+        QVERIFY(filter.mayContain(headword));
+}
+
+void HeadwordBloomFilterTest::testCaseVariants()
+{
+    HeadwordBloomFilter filter;
+    QVERIFY(filter.load(m_indexFilePath));
+
+    QVERIFY(filter.mayContain("HEADWORD42"));
+    QVERIFY(filter.mayContain("zebra"));
+    QVERIFY(filter.mayContain(QString::fromUtf8("ärger")));
+}
+
+void HeadwordBloomFilterTest::testFalsePositiveRate()
+{
+    HeadwordBloomFilter filter;
+    QVERIFY(filter.load(m_indexFilePath));
+
+    int falsePositiveCount = 0;
+    for (int i = 0; i < 2000; ++i)
+    {
+        if (filter.mayContain(QString("missing%1").arg(i)))
+            ++falsePositiveCount;
+    }
+
+    // About 1% is expected with 10 bits per headword
+    QVERIFY(falsePositiveCount < 100);
+}
+
+void HeadwordBloomFilterTest::testNotLoaded()
+{
+    HeadwordBloomFilter filter;
+    QVERIFY(!filter.isLoaded());
+    QVERIFY(filter.mayContain("anything"));
+}
+
+QTEST_MAIN(HeadwordBloomFilterTest)
+
+#include "headwordbloomfiltertest.moc"
@@ -0,0 +1,174 @@
+/******************************************************************************
+ * This file is part of the Mula project
+ * Copyright (c) 2011 Laszlo Papp <lpapp@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include "headwordbucketindextest.h"
+#include "testdictionarywriter.h"
+
+#include <plugins/stardict/distance.h>
+#include <plugins/stardict/headwordbucketindex.h>
+#include <plugins/stardict/stardictdictionarymanager.h>
+
+#include <QtCore/QDir>
+#include <QtCore/QVector>
+#include <QtTest/QtTest>
+
+#include <limits.h>
+
+using namespace MulaPluginStarDict;
+using namespace MulaPluginStarDictTest;
+
+HeadwordBucketIndexTest::HeadwordBucketIndexTest()
+{
+}
+
+HeadwordBucketIndexTest::~HeadwordBucketIndexTest()
+{
+}
+
+void HeadwordBucketIndexTest::initTestCase()
+{
+    QVERIFY(m_temporaryDir.isValid());
+
+    const char *syllables[] = { "ba", "ce", "di", "fo", "gu", "la", "me", "ni" };
+    for (int i = 0; i < 8; ++i)
+    {
+        for (int j = 0; j < 8; ++j)
+        {
+            for (int k = 0; k < 8; k += 3)
+                m_headwords << QString(syllables[i]) + syllables[j] + syllables[k];
+        }
+    }
+
+    // Every character of the words of one or two characters can be edited
+    m_headwords << "a" << "b" << "x" << "ab" << "ba" << "xy" << "abc" << "Apple" << "apple"
+                << "bbacefo" << "cefoba" << "dictionary" << QString::fromUtf8("Übung");
+
+    m_indexFilePath = m_temporaryDir.path() + "/test.idx";
+    QVERIFY(writeIndexFile(m_indexFilePath, m_headwords));
+
+    QVERIFY(HeadwordBucketIndex().build(m_indexFilePath));
+
+    QVERIFY(QDir(m_temporaryDir.path()).mkpath("bucket"));
+    QVERIFY(writeDictionary(m_temporaryDir.path() + "/bucket/bucket", m_headwords));
+}
+
+void HeadwordBucketIndexTest::testCandidates_data()
+{
+    QTest::addColumn<QString>("word");
+    QTest::addColumn<int>("distance");
+
+    QTest::newRow("exact") << "bacefo" << 0;
+    QTest::newRow("substitution") << "xacefo" << 1;
+    QTest::newRow("transposition") << "abcefo" << 1;
+    QTest::newRow("deletion") << "acefo" << 1;
+    QTest::newRow("edited at both ends") << "xbacefox" << 2;
+    QTest::newRow("two leading insertions") << "xybacefo" << 2;
+    QTest::newRow("two leading substitutions") << "xyfoba" << 2;
+    QTest::newRow("one character") << "b" << 1;
+    QTest::newRow("one character, two edits") << "y" << 2;
+    QTest::newRow("two characters") << "ab" << 2;
+    QTest::newRow("two characters, one edit") << "yx" << 1;
+    QTest::newRow("three characters") << "abd" << 2;
+    QTest::newRow("case") << "APPEL" << 2;
+    QTest::newRow("accented") << QString::fromUtf8("ÜBNUG") << 1;
+    QTest::newRow("beyond the indexed distance") << "dictoinray" << 3;
+}
+
+void HeadwordBucketIndexTest::testCandidates()
+{
+    QFETCH(QString, word);
+    QFETCH(int, distance);
+
+    HeadwordBucketIndex bucketIndex;
+    QVERIFY(bucketIndex.load(m_indexFilePath));
+
+    quint32 query[256];
+    quint32 headword[256];
+    QByteArray utf8Word = word.toUtf8();
+    int queryLength = BitParallelEditDistance::foldUtf8(utf8Word.constData(), utf8Word.size(), query, 256);
+
+    QVector<quint32> candidates = bucketIndex.candidates(query, queryLength, distance);
+
+    // The candidates are sorted without duplicates
+    for (int i = 1; i < candidates.size(); ++i)
+        QVERIFY(candidates.at(i - 1) < candidates.at(i));
+
+    // Every headword within the distance has to be a candidate, compared
+    // against a full scan with transpositions
+    int matchCount = 0;
+    for (int i = 0; i < m_headwords.size(); ++i)
+    {
+        QByteArray utf8Headword = m_headwords.at(i).toUtf8();
+        int headwordLength = BitParallelEditDistance::foldUtf8(utf8Headword.constData(), utf8Headword.size(), headword, 256);
+
+        if (BitParallelEditDistance::distance(query, queryLength, headword, headwordLength, INT_MAX) <= distance)
+        {
+            QVERIFY2(candidates.contains(i), qPrintable(m_headwords.at(i)));
+            ++matchCount;
+        }
+    }
+
+    QVERIFY(matchCount > 0);
+    QVERIFY(candidates.size() < m_headwords.size());
+}
+
+void HeadwordBucketIndexTest::testBucketScan_data()
+{
+    QTest::addColumn<QString>("searchWord");
+
+    QTest::newRow("edited at both ends") << "xbacefox";
+    QTest::newRow("transposition") << "abcefo";
+    QTest::newRow("two leading insertions") << "xybacefo";
+    QTest::newRow("two characters") << "ax";
+    QTest::newRow("three characters") << "abd";
+    QTest::newRow("accented") << QString::fromUtf8("ÜBNUG");
+}
+
+void HeadwordBucketIndexTest::testBucketScan()
+{
+    QFETCH(QString, searchWord);
+
+    StarDictDictionaryManager dictionaryManager;
+    dictionaryManager.load(QStringList() << m_temporaryDir.path() + "/bucket", QStringList(), QStringList());
+    QCOMPARE(dictionaryManager.dictionaryCount(), 1);
+
+    QStringList fullScanResultList;
+    dictionaryManager.setFuzzyEngine(StarDictDictionaryManager::FULLSCAN);
+    bool fullScanFound = dictionaryManager.lookupWithFuzzy(searchWord.toUtf8(), fullScanResultList, 10, 0);
+    QVERIFY(fullScanFound);
+
+    QStringList bucketScanResultList;
+    dictionaryManager.setFuzzyEngine(StarDictDictionaryManager::BUCKETSCAN);
+    QCOMPARE(dictionaryManager.lookupWithFuzzy(searchWord.toUtf8(), bucketScanResultList, 10, 0), fullScanFound);
+    QCOMPARE(bucketScanResultList, fullScanResultList);
+}
+
+void HeadwordBucketIndexTest::testNotLoaded()
+{
+    HeadwordBucketIndex bucketIndex;
+    QVERIFY(!bucketIndex.isLoaded());
+
+    quint32 query[] = { 'a' };
+    QVERIFY(bucketIndex.candidates(query, 1, 1).isEmpty());
+}
+
+QTEST_MAIN(HeadwordBucketIndexTest)
+
+#include "headwordbucketindextest.moc"
@@ -0,0 +1,108 @@
+/******************************************************************************
+ * This file is part of the Mula project
+ * Copyright (c) 2011 Laszlo Papp <lpapp@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "headwordperfecthashtest.h"
+#include "testdictionarywriter.h"
+
+#include <plugins/stardict/headwordperfecthash.h>
+
+#include <QtTest/QtTest>
+
+using namespace MulaPluginStarDict;
+using namespace MulaPluginStarDictTest;
+
+HeadwordPerfectHashTest::HeadwordPerfectHashTest()
+{
+}
+
+HeadwordPerfectHashTest::~HeadwordPerfectHashTest()
+{
+}
+
+void HeadwordPerfectHashTest::initTestCase()
+{
+    QVERIFY(m_temporaryDir.isValid());
+
+    // The accented case variants are not adjacent in the index, "Übung" is
+    // sorted between "Ärger" and "ärger"
+    m_headwords << "Apple" << "apple" << QString::fromUtf8("Ärger") << QString::fromUtf8("ärger")
+                << QString::fromUtf8("Übung");
+    for (int i = 0; i < 2000; ++i)
+        m_headwords << QString("headword%1").arg(i);
+
+    qSort(m_headwords.begin(), m_headwords.end(), IndexOrderLessThan());
+    QCOMPARE(m_headwords.indexOf(QString::fromUtf8("Übung")), m_headwords.indexOf(QString::fromUtf8("Ärger")) + 1);
+
+    m_indexFilePath = m_temporaryDir.path() + "/test.idx";
+    QVERIFY(writeIndexFile(m_indexFilePath, m_headwords));
+
+    QVERIFY(HeadwordPerfectHash().build(m_indexFilePath));
+}
+
+void HeadwordPerfectHashTest::testHeadwords()
+{
+    HeadwordPerfectHash perfectHash;
+    QVERIFY(perfectHash.load(m_indexFilePath));
+
+    foreach (const QString& headword, m_headwords)
+    {
+        if (headword != "apple")
+            QCOMPARE(perfectHash.find(headword), m_headwords.indexOf(headword));
+    }
+}
+
+void HeadwordPerfectHashTest::testCaseVariants()
+{
+    HeadwordPerfectHash perfectHash;
+    QVERIFY(perfectHash.load(m_indexFilePath));
+
+    // The first ASCII case variant in the index is returned for all of them
+    QCOMPARE(perfectHash.find("Apple"), 0);
+    QCOMPARE(perfectHash.find("apple"), 0);
+    QCOMPARE(perfectHash.find("APPLE"), 0);
+    QCOMPARE(perfectHash.find("HEADWORD42"), m_headwords.indexOf("headword42"));
+
+    // The accented letters are not folded, as they are not in the index
+    QCOMPARE(perfectHash.find(QString::fromUtf8("Ärger")), m_headwords.indexOf(QString::fromUtf8("Ärger")));
+    QCOMPARE(perfectHash.find(QString::fromUtf8("ärger")), m_headwords.indexOf(QString::fromUtf8("ärger")));
+    QCOMPARE(perfectHash.find(QString::fromUtf8("ÄRGER")), m_headwords.indexOf(QString::fromUtf8("Ärger")));
+    QCOMPARE(perfectHash.find(QString::fromUtf8("übung")), -1);
+}
+
+void HeadwordPerfectHashTest::testMissingWords()
+{
+    HeadwordPerfectHash perfectHash;
+    QVERIFY(perfectHash.load(m_indexFilePath));
+
+    for (int i = 0; i < 2000; ++i)
+        QCOMPARE(perfectHash.find(QString("missing%1").arg(i)), -1);
+
+    QCOMPARE(perfectHash.find(QString()), -1);
+}
+
+void HeadwordPerfectHashTest::testNotLoaded()
+{
+    HeadwordPerfectHash perfectHash;
+    QVERIFY(!perfectHash.isLoaded());
+    QCOMPARE(perfectHash.find("apple"), -1);
+}
+
+QTEST_MAIN(HeadwordPerfectHashTest)
+
+#include "headwordperfecthashtest.moc"
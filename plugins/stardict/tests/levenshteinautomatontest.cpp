@@ -0,0 +1,104 @@
+/******************************************************************************
+ * This file is part of the Mula project
+ * Copyright (c) 2011 Laszlo Papp <lpapp@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "levenshteinautomatontest.h"
+
+#include <plugins/stardict/distance.h>
+#include <plugins/stardict/levenshteinautomaton.h>
+
+#include <QtCore/QVector>
+#include <QtTest/QtTest>
+
+using namespace MulaPluginStarDict;
+
+static bool feed(LevenshteinAutomaton& automaton, const QString& word)
+{
+    foreach (uint character, word.toUcs4())
+    {
+        if (!automaton.step(character))
+            return false;
+    }
+
+    return true;
+}
+
+LevenshteinAutomatonTest::LevenshteinAutomatonTest()
+{
+}
+
+LevenshteinAutomatonTest::~LevenshteinAutomatonTest()
+{
+}
+
+void LevenshteinAutomatonTest::testDistance()
+{
+    static const char *const words[] = {
+        "dictionary", "dictionaries", "diction", "fiction", "dicitonary",
+        "dictoinary", "dictinary", "ditcionary", "dictionray", "xdictionary"
+    };
+
+    QVector<uint> searchWord = QString::fromLatin1("dictionary").toUcs4();
+    const int limit = 3;
+
+    for (unsigned int i = 0; i < sizeof(words) / sizeof(words[0]); ++i)
+    {
+        QVector<uint> word = QString::fromLatin1(words[i]).toUcs4();
+        int expected = BitParallelEditDistance::distance(word.constData(), word.size(),
+                                                         searchWord.constData(), searchWord.size(), limit);
+
+        LevenshteinAutomaton automaton(searchWord.constData(), searchWord.size(), limit);
+        bool alive = feed(automaton, QLatin1String(words[i]));
+
+        QCOMPARE(alive && automaton.isAccepted(), expected < limit);
+        if (expected < limit)
+            QCOMPARE(automaton.distance(), expected);
+    }
+}
+
+void LevenshteinAutomatonTest::testRejection()
+{
+    QVector<uint> searchWord = QString::fromLatin1("word").toUcs4();
+    LevenshteinAutomaton automaton(searchWord.constData(), searchWord.size(), 2);
+
+    QVERIFY(automaton.step('w'));
+    QVERIFY(automaton.step('x'));
+    QVERIFY(!automaton.step('y'));
+    QCOMPARE(automaton.depth(), 3);
+}
+
+void LevenshteinAutomatonTest::testReset()
+{
+    QVector<uint> searchWord = QString::fromLatin1("receive").toUcs4();
+    LevenshteinAutomaton automaton(searchWord.constData(), searchWord.size(), 2);
+
+    QVERIFY(feed(automaton, QLatin1String("recieve")));
+    QCOMPARE(automaton.distance(), 1);
+
+    // Continue from the shared "rec" prefix
+    automaton.reset(3);
+    QCOMPARE(automaton.depth(), 3);
+    QCOMPARE(automaton.character(2), uint('c'));
+    QVERIFY(feed(automaton, QLatin1String("eive")));
+    QCOMPARE(automaton.distance(), 0);
+    QVERIFY(automaton.isAccepted());
+}
+
+QTEST_MAIN(LevenshteinAutomatonTest)
+
+#include "levenshteinautomatontest.moc"
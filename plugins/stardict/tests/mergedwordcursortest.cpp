@@ -0,0 +1,142 @@
+/******************************************************************************
+ * This file is part of the Mula project
+ * Copyright (c) 2011 Laszlo Papp <lpapp@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "mergedwordcursortest.h"
+#include "testdictionarywriter.h"
+
+#include <plugins/stardict/dictionary.h>
+#include <plugins/stardict/file.h>
+#include <plugins/stardict/mergedwordcursor.h>
+
+#include <QtTest/QtTest>
+
+using namespace MulaPluginStarDict;
+using namespace MulaPluginStarDictTest;
+
+MergedWordCursorTest::MergedWordCursorTest()
+{
+}
+
+MergedWordCursorTest::~MergedWordCursorTest()
+{
+}
+
+void MergedWordCursorTest::loadDictionary(const QString& name, const QStringList& headwords)
+{
+    QString basePath = m_temporaryDir.path() + '/' + name;
+    QVERIFY(writeDictionary(basePath, headwords));
+
+    Dictionary *dictionary = new Dictionary;
+    QVERIFY(dictionary->load(basePath + ".ifo"));
+    m_dictionaries.append(dictionary);
+}
+
+void MergedWordCursorTest::initTestCase()
+{
+    QVERIFY(m_temporaryDir.isValid());
+
+    loadDictionary("first", QStringList() << "apple" << "banana" << "cherry" << "grape");
+    loadDictionary("second", QStringList() << "Apple" << "banana" << "date" << "grape" << "kiwi");
+    loadDictionary("third", QStringList() << "cherry" << "fig");
+
+    // The headwords in the order of the index files, without duplicates
+    m_mergedHeadwords << "Apple" << "apple" << "banana" << "cherry" << "date" << "fig" << "grape" << "kiwi";
+}
+
+void MergedWordCursorTest::cleanupTestCase()
+{
+    qDeleteAll(m_dictionaries);
+}
+
+void MergedWordCursorTest::testForward()
+{
+    MergedWordCursor cursor(m_dictionaries);
+
+    QStringList headwords;
+    for (bool valid = cursor.isValid(); valid; valid = cursor.next())
+        headwords.append(cursor.word());
+
+    QCOMPARE(headwords, m_mergedHeadwords);
+    QVERIFY(!cursor.isValid());
+    QVERIFY(!cursor.next());
+}
+
+void MergedWordCursorTest::testBackward()
+{
+    MergedWordCursor cursor(m_dictionaries);
+    cursor.toBack();
+    QVERIFY(!cursor.isValid());
+
+    QStringList headwords;
+    while (cursor.previous())
+        headwords.prepend(cursor.word());
+
+    QCOMPARE(headwords, m_mergedHeadwords);
+    QCOMPARE(cursor.word(), m_mergedHeadwords.first());
+}
+
+void MergedWordCursorTest::testChangeDirection()
+{
+    MergedWordCursor cursor(m_dictionaries);
+
+    QVERIFY(cursor.next());
+    QVERIFY(cursor.next());
+    QVERIFY(cursor.next());
+    QCOMPARE(cursor.word(), QString("cherry"));
+
+    QVERIFY(cursor.previous());
+    QCOMPARE(cursor.word(), QString("banana"));
+
+    QVERIFY(cursor.next());
+    QCOMPARE(cursor.word(), QString("cherry"));
+
+    QVERIFY(cursor.next());
+    QCOMPARE(cursor.word(), QString("date"));
+}
+
+void MergedWordCursorTest::testSeek()
+{
+    MergedWordCursor cursor(m_dictionaries);
+
+    QVERIFY(cursor.seek("date"));
+    QCOMPARE(cursor.word(), QString("date"));
+
+    QVERIFY(cursor.seek("eel"));
+    QCOMPARE(cursor.word(), QString("fig"));
+
+    QVERIFY(cursor.previous());
+    QCOMPARE(cursor.word(), QString("date"));
+
+    QVERIFY(!cursor.seek("zebra"));
+    QVERIFY(!cursor.isValid());
+}
+
+void MergedWordCursorTest::testPositions()
+{
+    MergedWordCursor cursor(m_dictionaries);
+
+    QVERIFY(cursor.seek("grape"));
+    QCOMPARE(cursor.position(0), 3);
+    QCOMPARE(cursor.position(1), 3);
+    QCOMPARE(cursor.position(2), int(invalidIndex));
+}
+
+QTEST_MAIN(MergedWordCursorTest)
+
+#include "mergedwordcursortest.moc"
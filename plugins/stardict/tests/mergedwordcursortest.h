@@ -0,0 +1,58 @@
+/******************************************************************************
+ * This file is part of the Mula project
+ * Copyright (c) 2011 Laszlo Papp <lpapp@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef MULA_CORE_MERGEDWORDCURSORTEST_H
+#define MULA_CORE_MERGEDWORDCURSORTEST_H
+
+#include <QtCore/QList>
+#include <QtCore/QObject>
+#include <QtCore/QStringList>
+#include <QtCore/QTemporaryDir>
+
+namespace MulaPluginStarDict
+{
+    class Dictionary;
+}
+
+class MergedWordCursorTest : public QObject
+{
+        Q_OBJECT
+
+    public:
+        MergedWordCursorTest();
+        virtual ~MergedWordCursorTest();
+
+    private Q_SLOTS:
+        void initTestCase();
+        void cleanupTestCase();
+        void testForward();
+        void testBackward();
+        void testChangeDirection();
+        void testSeek();
+        void testPositions();
+
+    private:
+        void loadDictionary(const QString& name, const QStringList& headwords);
+
+        QTemporaryDir m_temporaryDir;
+        QList<MulaPluginStarDict::Dictionary *> m_dictionaries;
+        QStringList m_mergedHeadwords;
+};
+
+#endif // MULA_CORE_MERGEDWORDCURSORTEST_H
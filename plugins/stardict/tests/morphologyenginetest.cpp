@@ -0,0 +1,93 @@
+/******************************************************************************
+ * This file is part of the Mula project
+ * Copyright (c) 2011 Laszlo Papp <lpapp@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "morphologyenginetest.h"
+
+#include <plugins/stardict/morphologyengine.h>
+
+#include <QtTest/QtTest>
+
+using namespace MulaPluginStarDict;
+
+MorphologyEngineTest::MorphologyEngineTest()
+{
+}
+
+MorphologyEngineTest::~MorphologyEngineTest()
+{
+}
+
+void MorphologyEngineTest::testBaseForms_data()
+{
+    QTest::addColumn<QString>("word");
+    QTest::addColumn<QString>("baseForm");
+
+    QTest::newRow("plural") << "books" << "book";
+    QTest::newRow("es plural") << "boxes" << "box";
+    QTest::newRow("ch plural") << "churches" << "church";
+    QTest::newRow("ies plural") << "studies" << "study";
+    QTest::newRow("past") << "walked" << "walk";
+    QTest::newRow("past of e ending") << "baked" << "bake";
+    QTest::newRow("ied past") << "carried" << "carry";
+    QTest::newRow("doubled past") << "stopped" << "stop";
+    QTest::newRow("gerund") << "walking" << "walk";
+    QTest::newRow("gerund of e ending") << "making" << "make";
+    QTest::newRow("doubled gerund") << "running" << "run";
+    QTest::newRow("adverb") << "quickly" << "quick";
+    QTest::newRow("comparative") << "bigger" << "big";
+    QTest::newRow("superlative") << "tallest" << "tall";
+    QTest::newRow("upper case") << "STUDIES" << "STUDY";
+    QTest::newRow("capitalized") << "Running" << "run";
+}
+
+void MorphologyEngineTest::testBaseForms()
+{
+    QFETCH(QString, word);
+    QFETCH(QString, baseForm);
+
+    QVERIFY(MorphologyEngine().candidates(word).contains(baseForm));
+}
+
+void MorphologyEngineTest::testCaseVariants()
+{
+    QStringList candidates = MorphologyEngine().candidates("hello");
+
+    QCOMPARE(candidates.mid(0, 2), QStringList() << "HELLO" << "Hello");
+    QVERIFY(!candidates.contains("hello"));
+    QCOMPARE(candidates.toSet().size(), candidates.size());
+}
+
+void MorphologyEngineTest::testPriority()
+{
+    QStringList candidates = MorphologyEngine().candidates("running");
+
+    QVERIFY(candidates.indexOf("run") < candidates.indexOf("runn"));
+    QVERIFY(candidates.indexOf("RUNNING") < candidates.indexOf("run"));
+}
+
+void MorphologyEngineTest::testNonEnglish()
+{
+    QStringList candidates = MorphologyEngine().candidates(QString::fromUtf8("größes"));
+
+    QCOMPARE(candidates, QStringList() << QString::fromUtf8("GRÖSSES") << QString::fromUtf8("Größes"));
+}
+
+QTEST_MAIN(MorphologyEngineTest)
+
+#include "morphologyenginetest.moc"
@@ -0,0 +1,296 @@
+/******************************************************************************
+ * This file is part of the Mula project
+ * Copyright (c) 2011 Laszlo Papp <lpapp@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "stardictdictionarymanagertest.h"
+#include "testdictionarywriter.h"
+
+#include <plugins/stardict/stardictdictionarymanager.h>
+
+#include <QtCore/QDir>
+#include <QtCore/QVector>
+#include <QtTest/QtTest>
+
+using namespace MulaPluginStarDict;
+using namespace MulaPluginStarDictTest;
+
+StarDictDictionaryManagerTest::StarDictDictionaryManagerTest()
+{
+}
+
+StarDictDictionaryManagerTest::~StarDictDictionaryManagerTest()
+{
+}
+
+void StarDictDictionaryManagerTest::initTestCase()
+{
+    QVERIFY(m_temporaryDir.isValid());
+
+    for (int i = 0; i < 200; ++i)
+    {
+        QString article = QString("article %1").arg(i);
+        if (i % 3 == 0)
+            article += " alpha";
+
+        if (i % 5 == 0)
+            article += " beta";
+
+        // Vary the length so that the articles straddle the chunk boundaries
+        article += QString(i % 7, '.');
+
+        m_headwords << QString("word%1").arg(i, 3, 10, QChar('0'));
+        m_articles << article;
+    }
+
+    // The last headwords share the word data of the first ones
+    for (int i = 180; i < 200; ++i)
+        m_articles[i] = m_articles.at(i - 180);
+
+    QDir dir(m_temporaryDir.path());
+    QVERIFY(dir.mkpath("data/plain"));
+    QVERIFY(dir.mkpath("data/compressed"));
+
+    QVERIFY(writeDictionary(dir.filePath("data/plain/plain"), m_headwords, m_articles));
+    QVERIFY(writeDictionary(dir.filePath("data/compressed/compressed"), m_headwords, m_articles, 64));
+
+    // The headwords starting with an accented letter are not adjacent to
+    // their case variants in the index, unlike the ones starting with an
+    // ASCII letter
+    QStringList fuzzyHeadwords;
+    fuzzyHeadwords << "Apfel" << "apfel" << "arm" << "Arm" << "armee" << "uber" << "ubel"
+                   << "Zebra" << "zebra" << "zebu";
+    fuzzyHeadwords << QString::fromUtf8("Äpfel") << QString::fromUtf8("äpfel") << QString::fromUtf8("Ärger")
+                   << QString::fromUtf8("ärger") << QString::fromUtf8("Über") << QString::fromUtf8("über")
+                   << QString::fromUtf8("übel") << QString::fromUtf8("Übung") << QString::fromUtf8("übung");
+
+    for (int i = 1; i < 10; ++i)
+        fuzzyHeadwords << QString::fromUtf8("Äzzzz%1").arg(i) << QString::fromUtf8("äzzzz%1").arg(i);
+
+    for (int i = 0; i < 100; ++i)
+        fuzzyHeadwords << QString("arm%1").arg(i) << QString("Zeb%1").arg(i);
+
+    qSort(fuzzyHeadwords.begin(), fuzzyHeadwords.end(), IndexOrderLessThan());
+
+    QVERIFY(dir.mkpath("fuzzy"));
+    QVERIFY(writeDictionary(dir.filePath("fuzzy/fuzzy"), fuzzyHeadwords));
+
+    // Enough headwords for several jobs of the parallel scan, with the
+    // neighbours of a word spread over all of them
+    QStringList parallelHeadwords;
+    for (char first = 'a'; first <= 'z'; ++first)
+    {
+        for (char second = 'a'; second <= 'z'; ++second)
+        {
+            for (char third = 'a'; third <= 'z'; ++third)
+            {
+                QByteArray word;
+                word.append(first).append(second).append(third);
+                parallelHeadwords << QString::fromLatin1(word + 'a') << QString::fromLatin1(word + 'm') << QString::fromLatin1(word + 'z');
+            }
+        }
+    }
+
+    QVERIFY(dir.mkpath("parallel"));
+    QVERIFY(writeDictionary(dir.filePath("parallel/parallel"), parallelHeadwords));
+
+    QVERIFY(dir.mkpath("order"));
+    QVERIFY(writeDictionary(dir.filePath("order/alpha"), QStringList() << "alpha"));
+    QVERIFY(writeDictionary(dir.filePath("order/beta"), QStringList() << "beta"));
+    QVERIFY(writeDictionary(dir.filePath("order/gamma"), QStringList() << "gamma"));
+}
+
+void StarDictDictionaryManagerTest::testLookupData_data()
+{
+    QTest::addColumn<QString>("searchWord");
+
+    QTest::newRow("single word") << "alpha";
+    QTest::newRow("all the words") << "alpha beta";
+    QTest::newRow("number") << "article 7";
+    QTest::newRow("no match") << "gamma";
+}
+
+void StarDictDictionaryManagerTest::testLookupData()
+{
+    QFETCH(QString, searchWord);
+
+    QStringList expectedHeadwords;
+    for (int i = 0; i < m_headwords.size(); ++i)
+    {
+        bool matched = true;
+        foreach (const QString& word, searchWord.split(' '))
+            matched = matched && m_articles.at(i).contains(word);
+
+        if (matched)
+            expectedHeadwords.append(m_headwords.at(i));
+    }
+
+    StarDictDictionaryManager dictionaryManager;
+    dictionaryManager.load(QStringList() << m_temporaryDir.path() + "/data", QStringList(), QStringList());
+    QCOMPARE(dictionaryManager.dictionaryCount(), 2);
+
+    // The matches of the concurrent jobs are merged in index order for both
+    // the plain and the chunked data file
+    QVector<QStringList> resultList;
+    QCOMPARE(dictionaryManager.lookupData(searchWord.toUtf8(), resultList), !expectedHeadwords.isEmpty());
+    QCOMPARE(resultList.size(), 2);
+    QCOMPARE(resultList.at(0), expectedHeadwords);
+    QCOMPARE(resultList.at(1), expectedHeadwords);
+}
+
+void StarDictDictionaryManagerTest::testKeyAndData()
+{
+    StarDictDictionaryManager dictionaryManager;
+    dictionaryManager.load(QStringList() << m_temporaryDir.path() + "/data/plain", QStringList(), QStringList());
+    QCOMPARE(dictionaryManager.dictionaryCount(), 1);
+    QCOMPARE(dictionaryManager.articleCount(0), long(m_headwords.size()));
+
+    // The headword indexes go far beyond the count of the dictionaries
+    for (int i = 0; i < m_headwords.size(); ++i)
+    {
+        QCOMPARE(dictionaryManager.key(i, 0), m_headwords.at(i).toUtf8());
+        QVERIFY(dictionaryManager.data(i, 0).contains(m_articles.at(i)));
+    }
+}
+
+void StarDictDictionaryManagerTest::testAutomaton_data()
+{
+    QTest::addColumn<QString>("searchWord");
+
+    QTest::newRow("lower case") << "apfle";
+    QTest::newRow("upper case") << "ARME";
+    QTest::newRow("accented") << QString::fromUtf8("äpfle");
+    QTest::newRow("accented upper case") << QString::fromUtf8("ÜBRE");
+    QTest::newRow("without accent") << "ubung";
+    QTest::newRow("between case variants") << QString::fromUtf8("übung");
+    QTest::newRow("rejected accented prefix") << QString::fromUtf8("ärm");
+    QTest::newRow("many prefixes") << "zebr";
+}
+
+void StarDictDictionaryManagerTest::testAutomaton()
+{
+    QFETCH(QString, searchWord);
+
+    StarDictDictionaryManager dictionaryManager;
+    dictionaryManager.load(QStringList() << m_temporaryDir.path() + "/fuzzy", QStringList(), QStringList());
+    QCOMPARE(dictionaryManager.dictionaryCount(), 1);
+
+    QStringList fullScanResultList;
+    dictionaryManager.setFuzzyEngine(StarDictDictionaryManager::FULLSCAN);
+    bool fullScanFound = dictionaryManager.lookupWithFuzzy(searchWord.toUtf8(), fullScanResultList, 8, 0);
+
+    // Skipping the rejected prefixes must not lose any headword
+    QStringList automatonResultList;
+    dictionaryManager.setFuzzyEngine(StarDictDictionaryManager::AUTOMATON);
+    QCOMPARE(dictionaryManager.lookupWithFuzzy(searchWord.toUtf8(), automatonResultList, 8, 0), fullScanFound);
+    QCOMPARE(automatonResultList, fullScanResultList);
+}
+
+void StarDictDictionaryManagerTest::testParallelFuzzy_data()
+{
+    QTest::addColumn<QString>("searchWord");
+    QTest::addColumn<int>("resultListSize");
+
+    QTest::newRow("ties in the first job") << "mmmm" << 10;
+    QTest::newRow("ties across the jobs") << "mmmm" << 40;
+    QTest::newRow("ties in the last job") << "zzzz" << 10;
+    QTest::newRow("more than the matches") << "mmmm" << 100;
+    QTest::newRow("transposition") << "mmzm" << 24;
+}
+
+void StarDictDictionaryManagerTest::testParallelFuzzy()
+{
+    QFETCH(QString, searchWord);
+    QFETCH(int, resultListSize);
+
+    StarDictDictionaryManager dictionaryManager;
+    dictionaryManager.load(QStringList() << m_temporaryDir.path() + "/parallel", QStringList(), QStringList());
+    QCOMPARE(dictionaryManager.dictionaryCount(), 1);
+
+    QStringList fullScanResultList;
+    dictionaryManager.setFuzzyEngine(StarDictDictionaryManager::FULLSCAN);
+    QVERIFY(dictionaryManager.lookupWithFuzzy(searchWord.toUtf8(), fullScanResultList, resultListSize, 0));
+
+    // The ties are resolved in index order like in the full scan, whichever
+    // job finds them
+    QStringList parallelResultList;
+    dictionaryManager.setFuzzyEngine(StarDictDictionaryManager::PARALLELSCAN);
+    QVERIFY(dictionaryManager.lookupWithFuzzy(searchWord.toUtf8(), parallelResultList, resultListSize, 0));
+    QCOMPARE(parallelResultList, fullScanResultList);
+}
+
+void StarDictDictionaryManagerTest::testLoadOrder()
+{
+    QString directory = m_temporaryDir.path() + "/order";
+
+    // The dictionaries are loaded concurrently, but listed in the order of
+    // the directory scan
+    StarDictDictionaryManager dictionaryManager;
+    dictionaryManager.load(QStringList() << directory, QStringList(), QStringList());
+    QCOMPARE(dictionaryManager.dictionaryCount(), 3);
+    QCOMPARE(dictionaryManager.dictionaryName(0), QString("alpha"));
+    QCOMPARE(dictionaryManager.dictionaryName(1), QString("beta"));
+    QCOMPARE(dictionaryManager.dictionaryName(2), QString("gamma"));
+
+    // The order list comes first, and the disabled dictionaries are skipped
+    StarDictDictionaryManager orderedDictionaryManager;
+    orderedDictionaryManager.load(QStringList() << directory,
+                                  QStringList() << directory + "/gamma.ifo",
+                                  QStringList() << directory + "/beta.ifo");
+    QCOMPARE(orderedDictionaryManager.dictionaryCount(), 2);
+    QCOMPARE(orderedDictionaryManager.dictionaryName(0), QString("gamma"));
+    QCOMPARE(orderedDictionaryManager.dictionaryName(1), QString("alpha"));
+}
+
+void StarDictDictionaryManagerTest::testReload()
+{
+    QDir dir(m_temporaryDir.path());
+    QVERIFY(dir.mkpath("reload"));
+    QVERIFY(writeDictionary(dir.filePath("reload/alpha"), QStringList() << "alpha"));
+    QVERIFY(writeDictionary(dir.filePath("reload/beta"), QStringList() << "beta"));
+
+    QString directory = dir.filePath("reload");
+    QString alphaIfoFilePath = directory + "/alpha.ifo";
+
+    StarDictDictionaryManager dictionaryManager;
+    dictionaryManager.load(QStringList() << directory, QStringList() << alphaIfoFilePath, QStringList());
+    QCOMPARE(dictionaryManager.dictionaryCount(), 2);
+
+    // The files of a loaded dictionary are gone, so only the dictionary kept
+    // from the previous load can still be listed
+    QDir reloadDir(directory);
+    foreach (const QString& fileName, reloadDir.entryList(QStringList() << "alpha.*", QDir::Files))
+        QVERIFY(reloadDir.remove(fileName));
+
+    QVERIFY(writeDictionary(dir.filePath("reload/gamma"), QStringList() << "gamma"));
+
+    dictionaryManager.reload(QStringList() << directory, QStringList() << alphaIfoFilePath, QStringList());
+    QCOMPARE(dictionaryManager.dictionaryCount(), 3);
+    QCOMPARE(dictionaryManager.dictionaryName(0), QString("alpha"));
+    QCOMPARE(dictionaryManager.dictionaryName(1), QString("beta"));
+    QCOMPARE(dictionaryManager.dictionaryName(2), QString("gamma"));
+    QCOMPARE(dictionaryManager.key(0, 0), QByteArray("alpha"));
+
+    // A dictionary left out of the reload is unloaded
+    dictionaryManager.reload(QStringList() << directory, QStringList(), QStringList() << directory + "/beta.ifo");
+    QCOMPARE(dictionaryManager.dictionaryCount(), 1);
+    QCOMPARE(dictionaryManager.dictionaryName(0), QString("gamma"));
+}
+
+QTEST_MAIN(StarDictDictionaryManagerTest)
+
+#include "stardictdictionarymanagertest.moc"
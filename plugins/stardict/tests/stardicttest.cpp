@@ -0,0 +1,115 @@
+/******************************************************************************
+ * This file is part of the Mula project
+ * Copyright (c) 2011 Laszlo Papp <lpapp@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include "stardicttest.h"
+#include "testdictionarywriter.h"
+
+#include <plugins/stardict/stardict.h>
+
+#include <QtCore/QDir>
+#include <QtCore/QSettings>
+#include <QtCore/QStandardPaths>
+#include <QtTest/QtTest>
+
+using namespace MulaPluginStarDict;
+using namespace MulaPluginStarDictTest;
+
+StarDictTest::StarDictTest()
+{
+}
+
+StarDictTest::~StarDictTest()
+{
+}
+
+void StarDictTest::initTestCase()
+{
+    QVERIFY(m_temporaryDir.isValid());
+    QStandardPaths::setTestModeEnabled(true);
+
+    // The plugin reads and writes its settings, which must not touch the
+    // settings of the user
+    QDir dir(m_temporaryDir.path());
+    QVERIFY(dir.mkpath("settings"));
+    QVERIFY(dir.mkpath("dic"));
+    QSettings::setPath(QSettings::NativeFormat, QSettings::UserScope, dir.filePath("settings"));
+    QSettings::setPath(QSettings::IniFormat, QSettings::UserScope, dir.filePath("settings"));
+
+    QSettings settings("mula","mula");
+    settings.setValue("StarDict/dictionaryDirectoryList", QStringList() << dir.filePath("dic"));
+    settings.setValue("StarDict/idleCloseTimeout", 0);
+
+    // The articles span the chunks of the compressed data file
+    QStringList articles;
+    for (int i = 0; i < 100; ++i)
+    {
+        m_headwords << QString("word%1").arg(i, 2, 10, QChar('0'));
+        articles << QString("article %1 ").arg(i) + QString(60 + i % 20, QChar('a' + i % 26));
+    }
+
+    QVERIFY(writeDictionary(dir.filePath("dic/batch"), m_headwords, articles, 64));
+}
+
+void StarDictTest::testTranslateBatch()
+{
+    StarDict starDict;
+    starDict.setLoadedDictionaryList(QStringList() << "batch");
+    QCOMPARE(starDict.loadedDictionaryList(), QStringList() << "batch");
+
+    // Unsorted words with duplicates and missing words
+    QStringList words;
+    words << "word42" << "word07" << "missing" << "word42" << "" << "word00" << "word99" << "word425";
+
+    QList<MulaCore::Translation> translations = starDict.translateBatch("batch", words);
+    QCOMPARE(translations.size(), words.size());
+
+    for (int i = 0; i < words.size(); ++i)
+    {
+        // The batch resolves the words the same way as one by one
+        MulaCore::Translation translation = starDict.translate("batch", words.at(i));
+        QCOMPARE(translations.at(i).title(), translation.title());
+        QCOMPARE(translations.at(i).dictionaryName(), translation.dictionaryName());
+        QCOMPARE(translations.at(i).translation(), translation.translation());
+
+        if (m_headwords.contains(words.at(i)))
+        {
+            QCOMPARE(translations.at(i).title(), words.at(i));
+            QCOMPARE(translations.at(i).dictionaryName(), QString("batch"));
+            QVERIFY(translations.at(i).translation().contains(QString("article %1 ").arg(m_headwords.indexOf(words.at(i)))));
+        }
+        else
+        {
+            QVERIFY(translations.at(i).title().isEmpty());
+            QVERIFY(translations.at(i).translation().isEmpty());
+        }
+    }
+}
+
+void StarDictTest::testTranslateBatchUnknownDictionary()
+{
+    StarDict starDict;
+    starDict.setLoadedDictionaryList(QStringList() << "batch");
+
+    QVERIFY(starDict.translateBatch("unknown", QStringList() << "word42").isEmpty());
+}
+
+QTEST_MAIN(StarDictTest)
+
+#include "stardicttest.moc"
@@ -0,0 +1,122 @@
+/******************************************************************************
+ * This file is part of the Mula project
+ * Copyright (c) 2011 Laszlo Papp <lpapp@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "suffixarrayindextest.h"
+#include "testdictionarywriter.h"
+
+#include <plugins/stardict/suffixarrayindex.h>
+
+#include <QtCore/QVector>
+#include <QtTest/QtTest>
+
+using namespace MulaPluginStarDict;
+using namespace MulaPluginStarDictTest;
+
+SuffixArrayIndexTest::SuffixArrayIndexTest()
+{
+}
+
+SuffixArrayIndexTest::~SuffixArrayIndexTest()
+{
+}
+
+void SuffixArrayIndexTest::initTestCase()
+{
+    QVERIFY(m_temporaryDir.isValid());
+
+    m_headwords << "action" << "biography" << "biology" << "dictionary" << "fiction" << "graph"
+                << "graphic" << "mention" << "nation" << "ology" << "paragraph" << "station";
+
+    m_indexFilePath = m_temporaryDir.path() + "/test.idx";
+    QVERIFY(writeIndexFile(m_indexFilePath, m_headwords));
+
+    QVERIFY(SuffixArrayIndex().build(m_indexFilePath));
+}
+
+void SuffixArrayIndexTest::testPatternCandidates_data()
+{
+    QTest::addColumn<QString>("pattern");
+
+    QTest::newRow("suffix") << "*tion";
+    QTest::newRow("infix") << "*graph*";
+    QTest::newRow("prefix") << "graph*";
+    QTest::newRow("exact") << "nation";
+    QTest::newRow("single character") << "?ction";
+    QTest::newRow("character set") << "[fm]*tion";
+    QTest::newRow("case") << "*TION";
+    QTest::newRow("short") << "*a*";
+    QTest::newRow("no match") << "*xyz*";
+}
+
+void SuffixArrayIndexTest::testPatternCandidates()
+{
+    QFETCH(QString, pattern);
+
+    SuffixArrayIndex suffixArrayIndex;
+    QVERIFY(suffixArrayIndex.load(m_indexFilePath));
+
+    QVector<quint32> candidates;
+    QVERIFY(suffixArrayIndex.patternCandidates(pattern, candidates));
+
+    // Every match has to be a candidate
+    QRegExp rx(pattern, Qt::CaseInsensitive, QRegExp::Wildcard);
+    for (int i = 0; i < m_headwords.size(); ++i)
+    {
+        if (rx.exactMatch(m_headwords.at(i)))
+            QVERIFY(candidates.contains(i));
+    }
+
+    QVERIFY(candidates.size() < m_headwords.size());
+}
+
+void SuffixArrayIndexTest::testShortPattern()
+{
+    SuffixArrayIndex suffixArrayIndex;
+    QVERIFY(suffixArrayIndex.load(m_indexFilePath));
+
+    QVector<quint32> candidates;
+    QVERIFY(!suffixArrayIndex.patternCandidates("*?*", candidates));
+}
+
+void SuffixArrayIndexTest::testFind()
+{
+    SuffixArrayIndex suffixArrayIndex;
+    QVERIFY(suffixArrayIndex.load(m_indexFilePath));
+
+    QVector<quint32> ids;
+    suffixArrayIndex.find("graph", false, false, ids);
+    QCOMPARE(ids, QVector<quint32>() << m_headwords.indexOf("biography") << m_headwords.indexOf("graph")
+                                     << m_headwords.indexOf("graphic") << m_headwords.indexOf("paragraph"));
+
+    suffixArrayIndex.find("graph", true, false, ids);
+    QCOMPARE(ids, QVector<quint32>() << m_headwords.indexOf("graph") << m_headwords.indexOf("graphic"));
+
+    suffixArrayIndex.find("ology", false, true, ids);
+    QCOMPARE(ids, QVector<quint32>() << m_headwords.indexOf("biology") << m_headwords.indexOf("ology"));
+
+    suffixArrayIndex.find("ology", true, true, ids);
+    QCOMPARE(ids, QVector<quint32>() << m_headwords.indexOf("ology"));
+
+    suffixArrayIndex.find("xyz", false, false, ids);
+    QVERIFY(ids.isEmpty());
+}
+
+QTEST_MAIN(SuffixArrayIndexTest)
+
+#include "suffixarrayindextest.moc"
@@ -0,0 +1,140 @@
+/******************************************************************************
+ * This file is part of the Mula project
+ * Copyright (c) 2011 Laszlo Papp <lpapp@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "symmetricdeleteindextest.h"
+#include "testdictionarywriter.h"
+
+#include <plugins/stardict/distance.h>
+#include <plugins/stardict/symmetricdeleteindex.h>
+
+#include <QtCore/QVector>
+#include <QtTest/QtTest>
+
+#include <limits.h>
+
+using namespace MulaPluginStarDict;
+using namespace MulaPluginStarDictTest;
+
+SymmetricDeleteIndexTest::SymmetricDeleteIndexTest()
+{
+}
+
+SymmetricDeleteIndexTest::~SymmetricDeleteIndexTest()
+{
+}
+
+void SymmetricDeleteIndexTest::initTestCase()
+{
+    QVERIFY(m_temporaryDir.isValid());
+
+    const char *syllables[] = { "ba", "ce", "di", "fo", "gu", "la", "me", "ni" };
+    for (int i = 0; i < 8; ++i)
+    {
+        for (int j = 0; j < 8; ++j)
+        {
+            for (int k = 0; k < 8; k += 3)
+                m_headwords << QString(syllables[i]) + syllables[j] + syllables[k];
+        }
+    }
+
+    m_headwords << "a" << "ab" << "Apple" << "apple" << "dictionaries" << "dictionary"
+                << "international" << "internationally";
+
+    m_indexFilePath = m_temporaryDir.path() + "/test.idx";
+    QVERIFY(writeIndexFile(m_indexFilePath, m_headwords));
+
+    QVERIFY(SymmetricDeleteIndex().build(m_indexFilePath));
+}
+
+void SymmetricDeleteIndexTest::testCandidates_data()
+{
+    QTest::addColumn<QString>("word");
+
+    QTest::newRow("exact") << "bacefo";
+    QTest::newRow("transposition") << "bcaefo";
+    QTest::newRow("deletion") << "bacef";
+    QTest::newRow("insertion") << "xbacefo";
+    QTest::newRow("appended") << "bacefoo";
+    QTest::newRow("short") << "b";
+    QTest::newRow("two characters") << "ab";
+    QTest::newRow("case") << "APPEL";
+    QTest::newRow("long transposition") << "dictoinary";
+    QTest::newRow("long deletion") << "dictionry";
+    QTest::newRow("beyond the prefix") << "internatinoally";
+    QTest::newRow("no match") << "xyz";
+}
+
+void SymmetricDeleteIndexTest::testCandidates()
+{
+    QFETCH(QString, word);
+
+    SymmetricDeleteIndex symmetricDeleteIndex;
+    QVERIFY(symmetricDeleteIndex.load(m_indexFilePath));
+
+    quint32 query[256];
+    quint32 headword[256];
+    QByteArray utf8Word = word.toUtf8();
+    int queryLength = BitParallelEditDistance::foldUtf8(utf8Word.constData(), utf8Word.size(), query, 256);
+
+    QVector<quint32> candidates = symmetricDeleteIndex.candidates(query, queryLength);
+
+    // The candidates are sorted without duplicates
+    for (int i = 1; i < candidates.size(); ++i)
+        QVERIFY(candidates.at(i - 1) < candidates.at(i));
+
+    // Every headword within the maximum distance has to be a candidate
+    for (int i = 0; i < m_headwords.size(); ++i)
+    {
+        QByteArray utf8Headword = m_headwords.at(i).toUtf8();
+        int headwordLength = BitParallelEditDistance::foldUtf8(utf8Headword.constData(), utf8Headword.size(), headword, 256);
+        int distance = BitParallelEditDistance::distance(query, queryLength, headword, headwordLength, INT_MAX);
+
+        if (distance <= SymmetricDeleteIndex::maximumDistance)
+            QVERIFY(candidates.contains(i));
+    }
+
+    QVERIFY(candidates.size() < m_headwords.size());
+}
+
+void SymmetricDeleteIndexTest::testCaseVariants()
+{
+    SymmetricDeleteIndex symmetricDeleteIndex;
+    QVERIFY(symmetricDeleteIndex.load(m_indexFilePath));
+
+    quint32 query[256];
+    int queryLength = BitParallelEditDistance::foldUtf8("APPLE", 5, query, 256);
+
+    QVector<quint32> candidates = symmetricDeleteIndex.candidates(query, queryLength);
+    QVERIFY(candidates.contains(m_headwords.indexOf("Apple")));
+    QVERIFY(candidates.contains(m_headwords.indexOf("apple")));
+}
+
+void SymmetricDeleteIndexTest::testNotLoaded()
+{
+    SymmetricDeleteIndex symmetricDeleteIndex;
+    QVERIFY(!symmetricDeleteIndex.isLoaded());
+    QCOMPARE(symmetricDeleteIndex.fileSize(), qint64(0));
+
+    quint32 query[] = { 'a' };
+    QVERIFY(symmetricDeleteIndex.candidates(query, 1).isEmpty());
+}
+
+QTEST_MAIN(SymmetricDeleteIndexTest)
+
+#include "symmetricdeleteindextest.moc"
@@ -0,0 +1,240 @@
+/******************************************************************************
+ * This file is part of the Mula project
+ * Copyright (c) 2011 Laszlo Papp <lpapp@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef MULA_PLUGIN_STARDICT_TESTDICTIONARYWRITER_H
+#define MULA_PLUGIN_STARDICT_TESTDICTIONARYWRITER_H
+
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QHash>
+#include <QtCore/QStringList>
+#include <QtCore/QtEndian>
+
+/**
+ * Helpers writing small StarDict files for the tests. They are inline since
+ * every test is built from its own source file.
+ */
+namespace MulaPluginStarDictTest
+{
+    /**
+     * \brief The order of the index files written by the StarDict tools
+     *
+     * The tools compare the ASCII letters case-insensitively and the other
+     * bytes of the UTF-8 headwords as they are, so "Ärger", "Übung" and
+     * "ärger" follow each other in this order.
+     */
+    class IndexOrderLessThan
+    {
+        public:
+            bool operator()(const QString& left, const QString& right) const
+            {
+                QByteArray leftWord = left.toUtf8();
+                QByteArray rightWord = right.toUtf8();
+                QByteArray leftFolded = leftWord;
+                QByteArray rightFolded = rightWord;
+
+                for (int i = 0; i < leftFolded.size(); ++i)
+                {
+                    if (leftFolded.at(i) >= 'A' && leftFolded.at(i) <= 'Z')
+                        leftFolded[i] = leftFolded.at(i) - 'A' + 'a';
+                }
+
+                for (int i = 0; i < rightFolded.size(); ++i)
+                {
+                    if (rightFolded.at(i) >= 'A' && rightFolded.at(i) <= 'Z')
+                        rightFolded[i] = rightFolded.at(i) - 'A' + 'a';
+                }
+
+                if (leftFolded != rightFolded)
+                    return leftFolded < rightFolded;
+
+                return leftWord < rightWord;
+            }
+    };
+
+    /**
+     * Writes an index file with an entry for each of the headwords
+     *
+     * @param   indexFilePath   The complete file path of the index file
+     * @param   headwords       The headwords in the order of the index
+     * @param   offsets         The offsets of the articles, or empty for a
+     *                          dummy offset and size of zero
+     * @param   sizes           The sizes of the articles
+     *
+     * @return True if the writing was successful, otherwise false.
+     */
+    inline bool writeIndexFile(const QString& indexFilePath, const QStringList& headwords,
+                               const QList<quint32>& offsets = QList<quint32>(),
+                               const QList<quint32>& sizes = QList<quint32>())
+    {
+        QFile indexFile(indexFilePath);
+        if (!indexFile.open(QIODevice::WriteOnly))
+            return false;
+
+        for (int i = 0; i < headwords.size(); ++i)
+        {
+            uchar offsetAndSize[8];
+            qToBigEndian<quint32>(offsets.value(i), offsetAndSize);
+            qToBigEndian<quint32>(sizes.value(i), offsetAndSize + 4);
+
+            indexFile.write(headwords.at(i).toUtf8());
+            indexFile.putChar('\0');
+            indexFile.write(reinterpret_cast<const char*>(offsetAndSize), sizeof(offsetAndSize));
+        }
+
+        indexFile.close();
+        return indexFile.error() == QFile::NoError;
+    }
+
+    /**
+     * Returns the CRC-32 checksum of the data as stored in the gzip trailer
+     */
+    inline quint32 gzipCrc32(const QByteArray& data)
+    {
+        quint32 crc = 0xffffffffu;
+        for (int i = 0; i < data.size(); ++i)
+        {
+            crc ^= uchar(data.at(i));
+            for (int bit = 0; bit < 8; ++bit)
+                crc = (crc >> 1) ^ (0xedb88320u & (0u - (crc & 1)));
+        }
+
+        return ~crc;
+    }
+
+    /**
+     * Writes the data into a dictzip file. The chunks are stored as
+     * uncompressed deflate blocks, which the dictzip readers inflate like
+     * any other block, so the tests do not depend on the compressor.
+     *
+     * @param   filePath    The complete file path of the dictzip file
+     * @param   data        The uncompressed data
+     * @param   chunkLength The uncompressed length of the chunks
+     *
+     * @return True if the writing was successful, otherwise false.
+     */
+    inline bool writeDictionaryZip(const QString& filePath, const QByteArray& data, int chunkLength)
+    {
+        int chunkCount = qMax(1, (data.size() + chunkLength - 1) / chunkLength);
+        uchar buffer[4];
+
+        QByteArray header("\x1f\x8b\x08\x04\0\0\0\0\0\x03", 10);
+        qToLittleEndian<quint16>(10 + 2 * chunkCount, buffer);
+        header.append(reinterpret_cast<const char*>(buffer), 2);
+        header.append("RA");
+        qToLittleEndian<quint16>(6 + 2 * chunkCount, buffer);
+        header.append(reinterpret_cast<const char*>(buffer), 2);
+        qToLittleEndian<quint16>(1, buffer);
+        header.append(reinterpret_cast<const char*>(buffer), 2);
+        qToLittleEndian<quint16>(chunkLength, buffer);
+        header.append(reinterpret_cast<const char*>(buffer), 2);
+        qToLittleEndian<quint16>(chunkCount, buffer);
+        header.append(reinterpret_cast<const char*>(buffer), 2);
+
+        QByteArray chunks;
+        for (int i = 0; i < chunkCount; ++i)
+        {
+            QByteArray chunk = data.mid(i * chunkLength, chunkLength);
+
+            // A stored block: the final flag, the length and its complement
+            chunks.append(i == chunkCount - 1 ? '\x01' : '\0');
+            qToLittleEndian<quint16>(chunk.size(), buffer);
+            qToLittleEndian<quint16>(~quint16(chunk.size()), buffer + 2);
+            chunks.append(reinterpret_cast<const char*>(buffer), 4);
+            chunks.append(chunk);
+
+            qToLittleEndian<quint16>(chunk.size() + 5, buffer);
+            header.append(reinterpret_cast<const char*>(buffer), 2);
+        }
+
+        QFile file(filePath);
+        if (!file.open(QIODevice::WriteOnly))
+            return false;
+
+        file.write(header);
+        file.write(chunks);
+        qToLittleEndian<quint32>(gzipCrc32(data), buffer);
+        file.write(reinterpret_cast<const char*>(buffer), 4);
+        qToLittleEndian<quint32>(data.size(), buffer);
+        file.write(reinterpret_cast<const char*>(buffer), 4);
+
+        file.close();
+        return file.error() == QFile::NoError;
+    }
+
+    /**
+     * Writes the ifo, index and data files of a dictionary with the
+     * "sametypesequence=m" articles of the headwords. Identical articles
+     * share their word data. The name of the dictionary is the base name of
+     * the path.
+     *
+     * @param   basePath    The file path of the dictionary without extension
+     * @param   headwords   The headwords in the order of the index
+     * @param   articles    The articles of the headwords, or empty for empty
+     *                      articles
+     * @param   chunkLength The chunk length of a compressed ".dict.dz" data
+     *                      file, or zero for a plain ".dict" data file
+     *
+     * @return True if the writing was successful, otherwise false.
+     */
+    inline bool writeDictionary(const QString& basePath, const QStringList& headwords,
+                                const QStringList& articles = QStringList(), int chunkLength = 0)
+    {
+        QByteArray data;
+        QList<quint32> offsets;
+        QList<quint32> sizes;
+        QHash<QByteArray, quint32> articleOffsets;
+        for (int i = 0; i < headwords.size(); ++i)
+        {
+            QByteArray article = articles.value(i).toUtf8();
+            if (!articleOffsets.contains(article))
+            {
+                articleOffsets.insert(article, data.size());
+                data.append(article);
+            }
+
+            offsets.append(articleOffsets.value(article));
+            sizes.append(article.size());
+        }
+
+        if (!writeIndexFile(basePath + ".idx", headwords, offsets, sizes))
+            return false;
+
+        QFile ifoFile(basePath + ".ifo");
+        if (!ifoFile.open(QIODevice::WriteOnly))
+            return false;
+
+        ifoFile.write("StarDict's dict ifo file\nversion=2.4.2\n");
+        ifoFile.write("wordcount=" + QByteArray::number(headwords.size()));
+        ifoFile.write("\nidxfilesize=" + QByteArray::number(QFileInfo(basePath + ".idx").size()));
+        ifoFile.write("\nbookname=" + QFileInfo(basePath).fileName().toUtf8() + "\nsametypesequence=m\n");
+        ifoFile.close();
+
+        if (chunkLength > 0)
+            return writeDictionaryZip(basePath + ".dict.dz", data, chunkLength);
+
+        QFile dataFile(basePath + ".dict");
+        if (!dataFile.open(QIODevice::WriteOnly))
+            return false;
+
+        return dataFile.write(data) == data.size();
+    }
+}
+
+#endif // MULA_PLUGIN_STARDICT_TESTDICTIONARYWRITER_H
@@ -0,0 +1,113 @@
+/******************************************************************************
+ * This file is part of the Mula project
+ * Copyright (c) 2011 Laszlo Papp <lpapp@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "trigramindextest.h"
+#include "testdictionarywriter.h"
+
+#include <plugins/stardict/distance.h>
+#include <plugins/stardict/trigramindex.h>
+
+#include <QtCore/QVector>
+#include <QtTest/QtTest>
+
+using namespace MulaPluginStarDict;
+using namespace MulaPluginStarDictTest;
+
+TrigramIndexTest::TrigramIndexTest()
+{
+}
+
+TrigramIndexTest::~TrigramIndexTest()
+{
+}
+
+void TrigramIndexTest::initTestCase()
+{
+    QVERIFY(m_temporaryDir.isValid());
+
+    m_headwords << "action" << "biography" << "dictionary" << "fiction" << "graph"
+                << "graphic" << "mention" << "nation" << "paragraph" << "station";
+
+    m_indexFilePath = m_temporaryDir.path() + "/test.idx";
+    QVERIFY(writeIndexFile(m_indexFilePath, m_headwords));
+
+    QVERIFY(TrigramIndex().build(m_indexFilePath));
+}
+
+void TrigramIndexTest::testPatternCandidates_data()
+{
+    QTest::addColumn<QString>("pattern");
+
+    QTest::newRow("suffix") << "*tion";
+    QTest::newRow("infix") << "*graph*";
+    QTest::newRow("prefix") << "graph*";
+    QTest::newRow("exact") << "nation";
+    QTest::newRow("single character") << "?ction";
+    QTest::newRow("character set") << "[fm]*tion";
+    QTest::newRow("case") << "*TION";
+    QTest::newRow("no match") << "*xyz*";
+}
+
+void TrigramIndexTest::testPatternCandidates()
+{
+    QFETCH(QString, pattern);
+
+    TrigramIndex trigramIndex;
+    QVERIFY(trigramIndex.load(m_indexFilePath));
+
+    QVector<quint32> candidates;
+    QVERIFY(trigramIndex.patternCandidates(pattern, candidates));
+
+    // Every match has to be a candidate
+    QRegExp rx(pattern, Qt::CaseInsensitive, QRegExp::Wildcard);
+    for (int i = 0; i < m_headwords.size(); ++i)
+    {
+        if (rx.exactMatch(m_headwords.at(i)))
+            QVERIFY(candidates.contains(i));
+    }
+
+    QVERIFY(candidates.size() < m_headwords.size());
+}
+
+void TrigramIndexTest::testShortPattern()
+{
+    TrigramIndex trigramIndex;
+    QVERIFY(trigramIndex.load(m_indexFilePath));
+
+    QVector<quint32> candidates;
+    QVERIFY(!trigramIndex.patternCandidates("*a*", candidates));
+}
+
+void TrigramIndexTest::testSimilarCandidates()
+{
+    TrigramIndex trigramIndex;
+    QVERIFY(trigramIndex.load(m_indexFilePath));
+
+    QByteArray searchWord("dictoinary");
+    quint32 word[256];
+    int length = BitParallelEditDistance::foldUtf8(searchWord.constData(), searchWord.size(), word, 256);
+
+    QVector<quint32> candidates = trigramIndex.similarCandidates(word, length, 0.2);
+    QVERIFY(candidates.contains(m_headwords.indexOf("dictionary")));
+    QVERIFY(!candidates.contains(m_headwords.indexOf("graph")));
+}
+
+QTEST_MAIN(TrigramIndexTest)
+
+#include "trigramindextest.moc"
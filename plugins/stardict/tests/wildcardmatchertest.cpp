@@ -0,0 +1,88 @@
+/******************************************************************************
+ * This file is part of the Mula project
+ * Copyright (c) 2011 Laszlo Papp <lpapp@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "wildcardmatchertest.h"
+
+#include <plugins/stardict/wildcardmatcher.h>
+
+#include <QtCore/QRegExp>
+#include <QtCore/QStringList>
+#include <QtTest/QtTest>
+
+using namespace MulaPluginStarDict;
+
+WildcardMatcherTest::WildcardMatcherTest()
+{
+}
+
+WildcardMatcherTest::~WildcardMatcherTest()
+{
+}
+
+void WildcardMatcherTest::testExactMatch_data()
+{
+    QTest::addColumn<QString>("pattern");
+
+    QTest::newRow("literal") << "internal";
+    QTest::newRow("prefix") << "inter*";
+    QTest::newRow("prefix and suffix") << "inter*al";
+    QTest::newRow("suffix") << "*tion";
+    QTest::newRow("infix") << "*na*";
+    QTest::newRow("backtracking") << "*a*a*l";
+    QTest::newRow("single character") << "?ction";
+    QTest::newRow("multibyte character") << QString::fromUtf8("?lan");
+    QTest::newRow("set") << "[fm]*tion";
+    QTest::newRow("range") << "[a-f]*";
+    QTest::newRow("negated set") << "[^a-f]*";
+    QTest::newRow("case") << "Inter*";
+    QTest::newRow("everything") << "*";
+}
+
+void WildcardMatcherTest::testExactMatch()
+{
+    QFETCH(QString, pattern);
+
+    static const char *const words[] = {
+        "internal", "international", "interval", "inter", "action", "fiction", "mention",
+        "nation", "banana", "élan", "plan", "Internet", ""
+    };
+
+    QRegExp rx(pattern, Qt::CaseSensitive, QRegExp::Wildcard);
+    WildcardMatcher matcher(pattern);
+
+    for (unsigned int i = 0; i < sizeof(words) / sizeof(words[0]); ++i)
+    {
+        QString word = QString::fromUtf8(words[i]);
+        QCOMPARE(matcher.exactMatch(word.toUtf8()), rx.exactMatch(word));
+    }
+}
+
+void WildcardMatcherTest::testLiteralPrefix()
+{
+    QCOMPARE(WildcardMatcher("inter*al").literalPrefix(), QByteArray("inter"));
+    QCOMPARE(WildcardMatcher("*tion").literalPrefix(), QByteArray());
+    QCOMPARE(WildcardMatcher("a?c").literalPrefix(), QByteArray("a"));
+
+    QVERIFY(WildcardMatcher("nation").isLiteral());
+    QVERIFY(!WildcardMatcher("nation*").isLiteral());
+}
+
+QTEST_MAIN(WildcardMatcherTest)
+
+#include "wildcardmatchertest.moc"
@@ -0,0 +1,117 @@
+/******************************************************************************
+ * This file is part of the Mula project
+ * Copyright (c) 2011 Laszlo Papp <lpapp@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "xdxfbenchmark.h"
+
+#include <plugins/stardict/articlerenderer.h>
+
+#include <QtCore/QRegExp>
+#include <QtTest/QtTest>
+
+using namespace MulaPluginStarDict;
+
+// The former conversion, kept as the baseline of the streaming one
+static void regExpXdxf2html(QString &string)
+{
+    string.replace("<abr>", "<font class=\"abbreviature\">");
+    string.replace("<tr>", "<font class=\"transcription\">[");
+    string.replace("</tr>", "]</font>");
+    string.replace("<ex>", "<font class=\"example\">");
+    string.remove(QRegExp("<k>.*<\\/k>"));
+    string.replace(QRegExp("(<\\/abr>)|(<\\ex>)"), "</font");
+}
+
+XdxfBenchmark::XdxfBenchmark()
+{
+}
+
+XdxfBenchmark::~XdxfBenchmark()
+{
+}
+
+void XdxfBenchmark::initTestCase()
+{
+    // A deterministic set of articles shaped like the ones of the large
+    // XDXF dictionaries
+    qsrand(42);
+    for (int i = 0; i < 5000; ++i)
+    {
+        QString article = QString("<k>headword%1</k>\n<tr>h'edw3:d</tr>\n").arg(i);
+        int senses = 1 + qrand() % 8;
+        for (int j = 0; j < senses; ++j)
+        {
+            article += QString("%1) <abr>n.</abr> ").arg(j + 1);
+            int length = 5 + qrand() % 30;
+            for (int k = 0; k < length; ++k)
+            {
+                for (int l = 3 + qrand() % 8; l > 0; --l)
+                    article += QLatin1Char('a' + qrand() % 26);
+
+                article += QLatin1Char(' ');
+            }
+
+            article += "\n<ex>an example of the sense</ex> <kref>see also</kref>\n";
+        }
+
+        m_articles.append(article);
+    }
+}
+
+void XdxfBenchmark::benchmarkRegExp()
+{
+    QBENCHMARK {
+        foreach (const QString& article, m_articles)
+        {
+            QString string = article;
+            regExpXdxf2html(string);
+        }
+    }
+}
+
+void XdxfBenchmark::benchmarkStreaming()
+{
+    QBENCHMARK {
+        foreach (const QString& article, m_articles)
+        {
+            QString string = article;
+            ArticleRenderer::xdxf2html(string);
+        }
+    }
+}
+
+void XdxfBenchmark::benchmarkRender()
+{
+    // The whole rendering of the 'x' fields, as the plugin does it
+    QList<QByteArray> data;
+    foreach (const QString& article, m_articles)
+        data.append('x' + article.toUtf8() + '\0');
+
+    ArticleRenderer renderer;
+    renderer.setHtmlSpaces(true);
+    renderer.setReformatLists(true);
+
+    QBENCHMARK {
+        foreach (const QByteArray& field, data)
+            renderer.render(field);
+    }
+}
+
+QTEST_MAIN(XdxfBenchmark)
+
+#include "xdxfbenchmark.moc"
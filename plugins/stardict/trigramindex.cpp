@@ -0,0 +1,505 @@
+/******************************************************************************
+ * This file is part of the Mula project
+ * Copyright (c) 2011 Laszlo Papp <lpapp@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "trigramindex.h"
+
+#include "cachelocations.h"
+#include "distance.h"
+#include "hashpostingfile.h"
+#include "indexfilescanner.h"
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QSaveFile>
+#include <QtCore/QString>
+#include <QtCore/QtAlgorithms>
+#include <QtCore/QDebug>
+
+#include <algorithm>
+#include <iterator>
+
+using namespace MulaPluginStarDict;
+
+// The posting list of a trigram in the cache file
+struct TrigramEntry
+{
+    quint32 hash;
+    quint32 offset;
+    quint32 count;
+};
+
+inline bool
+operator<(const TrigramEntry& left, const TrigramEntry& right)
+{
+    return left.hash < right.hash;
+}
+
+inline bool
+entryCountLessThan(const TrigramEntry *left, const TrigramEntry *right)
+{
+    return left->count < right->count;
+}
+
+class TrigramIndex::Private
+{
+    public:
+        Private()
+            : cacheMagicString("StarDict's Trigram Index, Version: 0.1")
+            , mappedData(0)
+            , headwordCount(0)
+            , trigramCount(0)
+            , entries(0)
+            , trigramCounts(0)
+            , postings(0)
+            , postingsSize(0)
+        {
+        }
+
+        ~Private()
+        {
+        }
+
+        void unload();
+
+        static quint32 hash(const quint32 *trigram);
+        static void trigrams(const quint32 *word, int length, bool start, bool end, QVector<quint32>& hashes);
+        static void encode(QByteArray& data, quint32 value);
+
+        const TrigramEntry* entry(quint32 hash) const;
+        void decode(const TrigramEntry *entry, QVector<quint32>& ids) const;
+
+        // The characters of the headwords are not expected to be control
+        // characters, so they can be used as the padding markers
+        static const quint32 startMarker = 0x02;
+        static const quint32 endMarker = 0x03;
+
+        // The length of the words in the index file should be less than 256
+        static const int maximumWordLength = 256;
+
+        QByteArray cacheMagicString;
+        QFile mapFile;
+        uchar *mappedData;
+        quint32 headwordCount;
+        quint32 trigramCount;
+        const TrigramEntry *entries;
+        const uchar *trigramCounts;
+        const uchar *postings;
+        qint64 postingsSize;
+};
+
+void
+TrigramIndex::Private::unload()
+{
+    if (mappedData)
+        mapFile.unmap(mappedData);
+
+    mapFile.close();
+    mappedData = 0;
+    headwordCount = 0;
+    trigramCount = 0;
+    entries = 0;
+    trigramCounts = 0;
+    postings = 0;
+    postingsSize = 0;
+}
+
+quint32
+TrigramIndex::Private::hash(const quint32 *trigram)
+{
+    // FNV-1a over the characters
+    quint32 result = 2166136261u;
+    for (int i = 0; i < 3; ++i)
+    {
+        result ^= trigram[i];
+        result *= 16777619u;
+    }
+
+    return result;
+}
+
+void
+TrigramIndex::Private::trigrams(const quint32 *word, int length, bool start, bool end, QVector<quint32>& hashes)
+{
+    quint32 padded[maximumWordLength + 2];
+    int paddedLength = 0;
+
+    if (start)
+        padded[paddedLength++] = startMarker;
+
+    for (int i = 0; i < length && i < maximumWordLength; ++i)
+        padded[paddedLength++] = word[i];
+
+    if (end)
+        padded[paddedLength++] = endMarker;
+
+    for (int i = 0; i + 3 <= paddedLength; ++i)
+        hashes.append(hash(padded + i));
+}
+
+void
+TrigramIndex::Private::encode(QByteArray& data, quint32 value)
+{
+    // Seven bits per byte, the highest bit tells that more bytes follow
+    while (value >= 0x80)
+    {
+        data.append(char((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+
+    data.append(char(value));
+}
+
+const TrigramEntry*
+TrigramIndex::Private::entry(quint32 hash) const
+{
+    TrigramEntry key;
+    key.hash = hash;
+    key.offset = 0;
+    key.count = 0;
+
+    const TrigramEntry *it = qLowerBound(entries, entries + trigramCount, key);
+    if (it == entries + trigramCount || it->hash != hash)
+        return 0;
+
+    return it;
+}
+
+void
+TrigramIndex::Private::decode(const TrigramEntry *entry, QVector<quint32>& ids) const
+{
+    const uchar *data = postings + entry->offset;
+    const uchar *end = postings + postingsSize;
+    quint32 id = 0;
+
+    for (quint32 i = 0; i < entry->count && data < end; ++i)
+    {
+        quint32 delta = 0;
+        int shift = 0;
+        while (data < end && (*data & 0x80))
+        {
+            delta |= quint32(*data++ & 0x7f) << shift;
+            shift += 7;
+        }
+
+        if (data < end)
+            delta |= quint32(*data++) << shift;
+
+        id += delta;
+        ids.append(id);
+    }
+}
+
+TrigramIndex::TrigramIndex()
+    : d(new Private)
+{
+}
+
+TrigramIndex::~TrigramIndex()
+{
+    d->unload();
+    delete d;
+}
+
+bool
+TrigramIndex::isLoaded() const
+{
+    return d->entries != 0;
+}
+
+qint64
+TrigramIndex::fileSize() const
+{
+    return isLoaded() ? d->mapFile.size() : 0;
+}
+
+bool
+TrigramIndex::load(const QString& indexFilePath)
+{
+    const int headerSize = d->cacheMagicString.size() + 2 * sizeof(quint32);
+
+    foreach (const QString& cacheLocation, cacheLocations(indexFilePath, ".tri"))
+    {
+        QFileInfo fileInfoIndex(indexFilePath);
+        QFileInfo fileInfoCache(cacheLocation);
+
+        if (!fileInfoCache.exists() || fileInfoCache.lastModified() < fileInfoIndex.lastModified())
+            continue;
+
+        d->unload();
+
+        d->mapFile.setFileName(cacheLocation);
+        if (!d->mapFile.open(QIODevice::ReadOnly))
+        {
+            qDebug() << "Failed to open file:" << cacheLocation;
+            continue;
+        }
+
+        if (d->mapFile.size() < headerSize)
+            continue;
+
+        d->mappedData = d->mapFile.map(0, d->mapFile.size());
+        if (d->mappedData == NULL)
+        {
+            qDebug() << Q_FUNC_INFO << QString("Mapping the file %1 failed!").arg(cacheLocation);
+            continue;
+        }
+
+        if (d->cacheMagicString != QByteArray::fromRawData(reinterpret_cast<const char*>(d->mappedData), d->cacheMagicString.size()))
+            continue;
+
+        const quint32 *counts = reinterpret_cast<const quint32*>(d->mappedData + d->cacheMagicString.size());
+        quint32 headwordCount = counts[0];
+        quint32 trigramCount = counts[1];
+
+        qint64 postingsOffset = headerSize + qint64(trigramCount) * sizeof(TrigramEntry) + headwordCount;
+        if (trigramCount == 0 || d->mapFile.size() < postingsOffset)
+            continue;
+
+        d->headwordCount = headwordCount;
+        d->trigramCount = trigramCount;
+        d->entries = reinterpret_cast<const TrigramEntry*>(d->mappedData + headerSize);
+        d->trigramCounts = reinterpret_cast<const uchar*>(d->entries + trigramCount);
+        d->postings = d->trigramCounts + headwordCount;
+        d->postingsSize = d->mapFile.size() - postingsOffset;
+
+        return true;
+    }
+
+    d->unload();
+    return false;
+}
+
+bool
+TrigramIndex::build(const QString& indexFilePath)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    IndexFileScanner scanner;
+    if (!scanner.open(indexFilePath))
+        return false;
+
+    quint32 word[Private::maximumWordLength];
+    QVector<quint32> hashes;
+    QVector<HashPosting> trigramPostings;
+
+    // The number of the distinct trigrams of every headword for the
+    // similarity, the long headwords are not similar to any search word
+    QByteArray trigramCounts;
+
+    while (scanner.next())
+    {
+        QByteArray utf8Word = scanner.word();
+        int length = BitParallelEditDistance::foldUtf8(utf8Word.constData(), utf8Word.size(), word, Private::maximumWordLength);
+
+        hashes.clear();
+        d->trigrams(word, length, true, true, hashes);
+        qSort(hashes);
+        hashes.erase(std::unique(hashes.begin(), hashes.end()), hashes.end());
+
+        trigramCounts.append(char(qMin(hashes.size(), 255)));
+
+        HashPosting posting;
+        posting.id = scanner.index();
+        foreach (quint32 hash, hashes)
+        {
+            posting.hash = hash;
+            trigramPostings.append(posting);
+        }
+    }
+
+    if (trigramPostings.isEmpty())
+        return false;
+
+    qSort(trigramPostings);
+
+    // Delta encode the sorted headword indices of every trigram
+    QVector<TrigramEntry> entries;
+    QByteArray postings;
+    quint32 previousId = 0;
+
+    foreach (const HashPosting& posting, trigramPostings)
+    {
+        if (entries.isEmpty() || entries.last().hash != posting.hash)
+        {
+            TrigramEntry entry;
+            entry.hash = posting.hash;
+            entry.offset = postings.size();
+            entry.count = 0;
+            entries.append(entry);
+            previousId = 0;
+        }
+
+        d->encode(postings, posting.id - previousId);
+        previousId = posting.id;
+        ++entries.last().count;
+    }
+
+    trigramPostings.clear();
+
+    foreach (const QString& cacheLocation, cacheLocations(indexFilePath, ".tri"))
+    {
+        QSaveFile file(cacheLocation);
+        if (!file.open(QIODevice::WriteOnly))
+        {
+            qDebug() << "Failed to open file for writing:" << cacheLocation;
+            continue;
+        }
+
+        quint32 counts[2] = { quint32(trigramCounts.size()), quint32(entries.size()) };
+        qint64 entriesSize = entries.size() * sizeof(TrigramEntry);
+
+        if (file.write(d->cacheMagicString) != d->cacheMagicString.size()
+            || file.write(reinterpret_cast<const char*>(counts), sizeof(counts)) != sizeof(counts)
+            || file.write(reinterpret_cast<const char*>(entries.constData()), entriesSize) != entriesSize
+            || file.write(trigramCounts) != trigramCounts.size()
+            || file.write(postings) != postings.size()
+            || !file.commit())
+        {
+            continue;
+        }
+
+        qDebug() << "Save to cache" << cacheLocation;
+
+        if (!load(indexFilePath))
+            break;
+
+        qDebug() << "Built the trigram index for" << indexFilePath << "in" << timer.elapsed() << "ms,"
+                 << entries.size() << "trigrams," << fileSize() << "bytes";
+
+        return true;
+    }
+
+    qDebug() << "Failed to build the trigram index for" << indexFilePath;
+    return false;
+}
+
+bool
+TrigramIndex::patternCandidates(const QString& pattern, QVector<quint32>& ids) const
+{
+    ids.clear();
+    if (!isLoaded())
+        return false;
+
+    QByteArray utf8Pattern = pattern.toUtf8();
+    quint32 characters[Private::maximumWordLength];
+    int length = BitParallelEditDistance::foldUtf8(utf8Pattern.constData(), utf8Pattern.size(),
+                                                   characters, Private::maximumWordLength);
+
+    // Collect the trigrams of the literal parts between the wildcards, the
+    // first and the last part are anchored unless a wildcard precedes or
+    // follows them
+    QVector<quint32> hashes;
+    int segmentStart = 0;
+
+    for (int i = 0; i <= length; ++i)
+    {
+        if (i < length && characters[i] != '*' && characters[i] != '?' && characters[i] != '[')
+            continue;
+
+        d->trigrams(characters + segmentStart, i - segmentStart, segmentStart == 0, i == length, hashes);
+
+        if (i < length && characters[i] == '[')
+        {
+            while (i < length && characters[i] != ']')
+                ++i;
+        }
+
+        segmentStart = i + 1;
+    }
+
+    qSort(hashes);
+    hashes.erase(std::unique(hashes.begin(), hashes.end()), hashes.end());
+
+    if (hashes.isEmpty())
+        return false;
+
+    QVector<const TrigramEntry*> entries;
+    foreach (quint32 hash, hashes)
+    {
+        const TrigramEntry *entry = d->entry(hash);
+        if (!entry)
+            return true;
+
+        entries.append(entry);
+    }
+
+    // Intersect starting with the shortest posting list
+    qSort(entries.begin(), entries.end(), entryCountLessThan);
+
+    d->decode(entries.first(), ids);
+
+    QVector<quint32> postings;
+    QVector<quint32> intersection;
+    for (int i = 1; i < entries.size() && !ids.isEmpty(); ++i)
+    {
+        postings.clear();
+        d->decode(entries.at(i), postings);
+
+        intersection.clear();
+        std::set_intersection(ids.constBegin(), ids.constEnd(), postings.constBegin(), postings.constEnd(),
+                              std::back_inserter(intersection));
+        ids = intersection;
+    }
+
+    return true;
+}
+
+QVector<quint32>
+TrigramIndex::similarCandidates(const quint32 *word, int length, qreal minimumSimilarity) const
+{
+    QVector<quint32> result;
+    if (!isLoaded())
+        return result;
+
+    QVector<quint32> hashes;
+    d->trigrams(word, length, true, true, hashes);
+    qSort(hashes);
+    hashes.erase(std::unique(hashes.begin(), hashes.end()), hashes.end());
+
+    // Every occurrence of a headword is a trigram shared with the search word
+    QVector<quint32> ids;
+    foreach (quint32 hash, hashes)
+    {
+        const TrigramEntry *entry = d->entry(hash);
+        if (entry)
+            d->decode(entry, ids);
+    }
+
+    qSort(ids);
+
+    int searchCount = hashes.size();
+    for (int i = 0; i < ids.size();)
+    {
+        quint32 id = ids.at(i);
+        int sharedCount = 0;
+        for (; i < ids.size() && ids.at(i) == id; ++i)
+            ++sharedCount;
+
+        if (id >= d->headwordCount)
+            continue;
+
+        int unionCount = searchCount + d->trigramCounts[id] - sharedCount;
+        if (sharedCount >= minimumSimilarity * unionCount)
+            result.append(id);
+    }
+
+    return result;
+}
@@ -0,0 +1,154 @@
+/******************************************************************************
+ * This file is part of the Mula project
+ * Copyright (c) 2011 Laszlo Papp <lpapp@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef MULA_PLUGIN_STARDICT_TRIGRAMINDEX_H
+#define MULA_PLUGIN_STARDICT_TRIGRAMINDEX_H
+
+#include <QtCore/QVector>
+
+class QString;
+
+namespace MulaPluginStarDict
+{
+    /**
+     * \brief Trigram inverted index of the headwords for substring and
+     * similarity queries
+     *
+     * The index maps every trigram, i.e. every sequence of three consecutive
+     * characters, of the lower case headwords to the headwords containing it.
+     * The headwords are padded with a start and an end marker, so the
+     * trigrams also tell whether a substring is at the beginning or at the
+     * end of the headword.
+     *
+     * A headword can only match a wildcard pattern if it contains all the
+     * trigrams of the literal parts of the pattern, hence the candidates of
+     * a pattern are the intersection of the posting lists of its trigrams.
+     * Similar words share most of their trigrams, hence the Jaccard
+     * similarity of the trigram sets is used to preselect the candidates of
+     * the fuzzy search.
+     *
+     * The posting lists are stored delta and variable byte encoded in a
+     * ".tri" file next to the offset cache file, which is mapped into the
+     * memory when loaded. The trigrams are stored as hashes, so the
+     * candidates are a superset of the real matches, and they have to be
+     * verified by the caller.
+     *
+     * \see cacheLocations
+     */
+
+    class TrigramIndex
+    {
+        public:
+
+            /**
+             * Constructor
+             */
+
+            TrigramIndex();
+
+            /**
+             * Destructor
+             */
+
+            virtual ~TrigramIndex();
+
+            /**
+             * Loads the cache file of the index belonging to the desired index
+             * file. The cache is ignored if it is older than the index file.
+             *
+             * @param   indexFilePath   The complete file path of the index file
+             *
+             * @return True if the loading was successful, otherwise false.
+             *
+             * @see build
+             */
+
+            bool load(const QString& indexFilePath);
+
+            /**
+             * Builds the index over all the headwords of the index file and
+             * saves it into the cache file. The headwords are read from the
+             * index file directly, so the method can be called from any
+             * thread.
+             *
+             * @param   indexFilePath   The complete file path of the index file
+             *
+             * @return True if the building was successful, otherwise false.
+             *
+             * @see load
+             */
+
+            bool build(const QString& indexFilePath);
+
+            /**
+             * Returns whether the index is loaded
+             *
+             * @return True if the index is loaded, otherwise false.
+             */
+
+            bool isLoaded() const;
+
+            /**
+             * Returns the size of the loaded cache file in bytes
+             *
+             * @return The size of the cache file
+             */
+
+            qint64 fileSize() const;
+
+            /**
+             * Collects the candidate word entries of a wildcard pattern, where
+             * '*' matches any sequence of characters, '?' matches a single
+             * character and '[...]' matches a set of characters. The
+             * candidates include every headword matching the pattern,
+             * regardless of the case.
+             *
+             * @param   pattern     The wildcard pattern
+             * @param   ids         The sorted indices of the candidate word
+             * entries
+             *
+             * @return True if the candidates are valid, otherwise false, e.g.
+             * if the literal parts of the pattern are too short to have any
+             * trigram.
+             */
+
+            bool patternCandidates(const QString& pattern, QVector<quint32>& ids) const;
+
+            /**
+             * Returns the candidate word entries for the lower case UTF-32
+             * search word, i.e. the headwords whose trigram set has at least
+             * the given Jaccard similarity with the one of the search word.
+             *
+             * @param   word                The lower case UTF-32 search word
+             * @param   length              The length of the search word
+             * @param   minimumSimilarity   The smallest similarity between 0
+             * and 1
+             *
+             * @return The sorted indices of the candidate word entries
+             */
+
+            QVector<quint32> similarCandidates(const quint32 *word, int length, qreal minimumSimilarity) const;
+
+        private:
+            class Private;
+            Private *const d;
+    };
+}
+
+#endif // MULA_PLUGIN_STARDICT_TRIGRAMINDEX_H
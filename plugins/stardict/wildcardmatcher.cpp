@@ -0,0 +1,308 @@
+/******************************************************************************
+ * This file is part of the Mula project
+ * Copyright (c) 2011 Laszlo Papp <lpapp@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "wildcardmatcher.h"
+
+#include <QtCore/QPair>
+#include <QtCore/QString>
+#include <QtCore/QVector>
+
+#include <string.h>
+
+using namespace MulaPluginStarDict;
+
+class WildcardMatcher::Private
+{
+    public:
+        Private()
+        {
+        }
+
+        ~Private()
+        {
+        }
+
+        enum TokenType {
+            LITERAL,        // Matches the UTF-8 bytes of the literal
+            ANYCHARACTER,   // Matches a single character, '?'
+            ANYSEQUENCE,    // Matches any sequence of characters, '*'
+            CHARACTERSET    // Matches a character of the set, '[...]'
+        };
+
+        struct Token
+        {
+            TokenType type;
+            QByteArray literal;
+            QVector<QPair<uint, uint> > ranges;
+            bool negated;
+        };
+
+        void compile(const QVector<uint>& pattern);
+        void appendLiteral(uint character);
+        int compileSet(const QVector<uint>& pattern, int position);
+
+        static int decode(const char *word, int length, int position, uint *character);
+        static bool containsCharacter(const Token& token, uint character);
+
+        QVector<Token> tokens;
+};
+
+void
+WildcardMatcher::Private::appendLiteral(uint character)
+{
+    if (tokens.isEmpty() || tokens.last().type != LITERAL)
+    {
+        Token token;
+        token.type = LITERAL;
+        token.negated = false;
+        tokens.append(token);
+    }
+
+    tokens.last().literal.append(QString::fromUcs4(&character, 1).toUtf8());
+}
+
+// Compiles the set starting at the position of the '[' character and returns
+// the position after the closing ']' character, or -1 if the set is not
+// closed, and then the '[' character is a literal
+int
+WildcardMatcher::Private::compileSet(const QVector<uint>& pattern, int position)
+{
+    Token token;
+    token.type = CHARACTERSET;
+    token.negated = false;
+
+    int i = position + 1;
+    if (i < pattern.size() && pattern.at(i) == '^')
+    {
+        token.negated = true;
+        ++i;
+    }
+
+    // A ']' right after the opening bracket is a member of the set
+    for (bool first = true; i < pattern.size() && (first || pattern.at(i) != ']'); first = false)
+    {
+        uint low = pattern.at(i++);
+        uint high = low;
+
+        if (i + 1 < pattern.size() && pattern.at(i) == '-' && pattern.at(i + 1) != ']')
+        {
+            high = pattern.at(i + 1);
+            i += 2;
+        }
+
+        token.ranges.append(qMakePair(low, high));
+    }
+
+    if (i >= pattern.size())
+        return -1;
+
+    tokens.append(token);
+    return i + 1;
+}
+
+void
+WildcardMatcher::Private::compile(const QVector<uint>& pattern)
+{
+    for (int i = 0; i < pattern.size();)
+    {
+        uint character = pattern.at(i);
+
+        if (character == '*')
+        {
+            // Consecutive '*' tokens are the same as a single one
+            if (tokens.isEmpty() || tokens.last().type != ANYSEQUENCE)
+            {
+                Token token;
+                token.type = ANYSEQUENCE;
+                token.negated = false;
+                tokens.append(token);
+            }
+
+            ++i;
+        }
+        else if (character == '?')
+        {
+            Token token;
+            token.type = ANYCHARACTER;
+            token.negated = false;
+            tokens.append(token);
+            ++i;
+        }
+        else if (character == '[')
+        {
+            int next = compileSet(pattern, i);
+            if (next == -1)
+            {
+                appendLiteral(character);
+                ++i;
+            }
+            else
+            {
+                i = next;
+            }
+        }
+        else
+        {
+            appendLiteral(character);
+            ++i;
+        }
+    }
+}
+
+int
+WildcardMatcher::Private::decode(const char *word, int length, int position, uint *character)
+{
+    const uchar *data = reinterpret_cast<const uchar *>(word);
+    uint result = data[position];
+    int extraBytes = 0;
+
+    if (result >= 0xf0)
+    {
+        result &= 0x07;
+        extraBytes = 3;
+    }
+    else if (result >= 0xe0)
+    {
+        result &= 0x0f;
+        extraBytes = 2;
+    }
+    else if (result >= 0xc0)
+    {
+        result &= 0x1f;
+        extraBytes = 1;
+    }
+
+    ++position;
+    for (; extraBytes && position < length && (data[position] & 0xc0) == 0x80; --extraBytes, ++position)
+        result = (result << 6) | (data[position] & 0x3f);
+
+    *character = result;
+    return position;
+}
+
+bool
+WildcardMatcher::Private::containsCharacter(const Token& token, uint character)
+{
+    bool contained = false;
+    for (int i = 0; i < token.ranges.size() && !contained; ++i)
+        contained = character >= token.ranges.at(i).first && character <= token.ranges.at(i).second;
+
+    return contained != token.negated;
+}
+
+WildcardMatcher::WildcardMatcher(const QString& pattern)
+    : d(new Private)
+{
+    d->compile(pattern.toUcs4());
+}
+
+WildcardMatcher::~WildcardMatcher()
+{
+    delete d;
+}
+
+bool
+WildcardMatcher::exactMatch(const QByteArray& word) const
+{
+    return exactMatch(word.constData(), word.size());
+}
+
+bool
+WildcardMatcher::exactMatch(const char *word, int length) const
+{
+    const int tokenCount = d->tokens.size();
+    int tokenIndex = 0;
+    int position = 0;
+
+    // The last '*' token and the position where its match ends
+    int starTokenIndex = -1;
+    int starPosition = 0;
+
+    while (tokenIndex < tokenCount || position < length)
+    {
+        if (tokenIndex < tokenCount)
+        {
+            const Private::Token& token = d->tokens.at(tokenIndex);
+            uint character;
+
+            switch (token.type)
+            {
+            case Private::ANYSEQUENCE:
+                starTokenIndex = tokenIndex++;
+                starPosition = position;
+                continue;
+            case Private::LITERAL:
+                if (position + token.literal.size() <= length
+                        && memcmp(word + position, token.literal.constData(), token.literal.size()) == 0)
+                {
+                    position += token.literal.size();
+                    ++tokenIndex;
+                    continue;
+                }
+                break;
+            case Private::ANYCHARACTER:
+                if (position < length)
+                {
+                    position = d->decode(word, length, position, &character);
+                    ++tokenIndex;
+                    continue;
+                }
+                break;
+            case Private::CHARACTERSET:
+                if (position < length)
+                {
+                    int next = d->decode(word, length, position, &character);
+                    if (d->containsCharacter(token, character))
+                    {
+                        position = next;
+                        ++tokenIndex;
+                        continue;
+                    }
+                }
+                break;
+            }
+        }
+
+        // Let the last '*' token match one more character and retry
+        if (starTokenIndex == -1 || starPosition >= length)
+            return false;
+
+        uint character;
+        starPosition = d->decode(word, length, starPosition, &character);
+        position = starPosition;
+        tokenIndex = starTokenIndex + 1;
+    }
+
+    return true;
+}
+
+QByteArray
+WildcardMatcher::literalPrefix() const
+{
+    if (d->tokens.isEmpty() || d->tokens.first().type != Private::LITERAL)
+        return QByteArray();
+
+    return d->tokens.first().literal;
+}
+
+bool
+WildcardMatcher::isLiteral() const
+{
+    return d->tokens.size() == 1 && d->tokens.first().type == Private::LITERAL;
+}
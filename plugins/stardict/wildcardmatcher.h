@@ -0,0 +1,114 @@
+/******************************************************************************
+ * This file is part of the Mula project
+ * Copyright (c) 2011 Laszlo Papp <lpapp@kde.org>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef MULA_PLUGIN_STARDICT_WILDCARDMATCHER_H
+#define MULA_PLUGIN_STARDICT_WILDCARDMATCHER_H
+
+#include <QtCore/QByteArray>
+
+class QString;
+
+namespace MulaPluginStarDict
+{
+    /**
+     * \brief Matcher of wildcard patterns against UTF-8 encoded words
+     *
+     * The pattern is compiled once into a sequence of literal, any
+     * character, any sequence and character set tokens, and the words are
+     * matched on their UTF-8 bytes without converting them to QString. The
+     * syntax is the same as the one of QRegExp::Wildcard, i.e. '*' matches
+     * any sequence of characters, '?' matches a single character and
+     * '[...]' matches a set of characters, which can contain ranges and can
+     * be negated by a leading '^'. The matching is case sensitive.
+     *
+     * Only the '*' tokens can match a variable number of characters, so a
+     * mismatch only needs to backtrack to the last '*' token, which keeps
+     * the matching linear for the usual patterns.
+     *
+     * The matcher does not have any state after the compilation, so it can
+     * be used concurrently.
+     */
+
+    class WildcardMatcher
+    {
+        public:
+
+            /**
+             * Constructor
+             *
+             * @param   pattern     The wildcard pattern to compile
+             */
+
+            WildcardMatcher(const QString& pattern);
+
+            /**
+             * Destructor
+             */
+
+            virtual ~WildcardMatcher();
+
+            /**
+             * Returns whether the whole UTF-8 encoded word matches the pattern
+             *
+             * @param   word    The UTF-8 encoded word
+             * @param   length  The length of the word in bytes
+             *
+             * @return True if the word matches the pattern, otherwise false.
+             */
+
+            bool exactMatch(const char *word, int length) const;
+
+            /**
+             * Returns whether the whole UTF-8 encoded word matches the pattern
+             *
+             * @param   word    The UTF-8 encoded word
+             *
+             * @return True if the word matches the pattern, otherwise false.
+             */
+
+            bool exactMatch(const QByteArray& word) const;
+
+            /**
+             * Returns the literal characters at the beginning of the pattern
+             * before the first wildcard. Every matching word starts with the
+             * prefix, so the search can be restricted to the range of the
+             * sorted headwords with this prefix.
+             *
+             * @return The UTF-8 encoded literal prefix, or an empty array if
+             * the pattern starts with a wildcard
+             */
+
+            QByteArray literalPrefix() const;
+
+            /**
+             * Returns whether the pattern does not contain any wildcard, i.e.
+             * only the literal prefix itself matches it.
+             *
+             * @return True if the pattern is a literal, otherwise false.
+             */
+
+            bool isLiteral() const;
+
+        private:
+            class Private;
+            Private *const d;
+    };
+}
+
+#endif // MULA_PLUGIN_STARDICT_WILDCARDMATCHER_H